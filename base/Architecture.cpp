@@ -11,14 +11,181 @@
     For the licensing terms refer to the file 'LICENSE'.
  ***************************************************************************/
 
+#include <base/platforms/features.h>
 #include <base/Architecture.h>
+#include <base/UnitTest.h>
+
+#if defined(_COM_AZURE_DEV__BASE__X86_INTRINSICS)
+#  if (_COM_AZURE_DEV__BASE__COMPILER == _COM_AZURE_DEV__BASE__COMPILER_MSC)
+#    include <intrin.h>
+#  else
+#    include <cpuid.h>
+#  endif
+#endif
+
+#if (_COM_AZURE_DEV__BASE__ARCH == _COM_AZURE_DEV__BASE__ARM64)
+#  if (_COM_AZURE_DEV__BASE__OS == _COM_AZURE_DEV__BASE__GNULINUX)
+#    include <sys/auxv.h>
+#    include <asm/hwcap.h>
+#  elif (_COM_AZURE_DEV__BASE__FLAVOR == _COM_AZURE_DEV__BASE__WIN32)
+#    include <windows.h>
+#  endif
+#endif
 
 _COM_AZURE_DEV__BASE__ENTER_NAMESPACE
 
+namespace {
+
+#if defined(_COM_AZURE_DEV__BASE__X86_INTRINSICS)
+  /** Registers returned by CPUID. */
+  class CPUID {
+  public:
+
+    uint32 eax = 0;
+    uint32 ebx = 0;
+    uint32 ecx = 0;
+    uint32 edx = 0;
+
+    CPUID(uint32 leaf, uint32 subleaf = 0) noexcept
+    {
+#  if (_COM_AZURE_DEV__BASE__COMPILER == _COM_AZURE_DEV__BASE__COMPILER_MSC)
+      int registers[4] = {0, 0, 0, 0};
+      __cpuidex(registers, leaf, subleaf);
+      eax = registers[0];
+      ebx = registers[1];
+      ecx = registers[2];
+      edx = registers[3];
+#  else
+      unsigned int a = 0, b = 0, c = 0, d = 0;
+      if (__get_cpuid_count(leaf, subleaf, &a, &b, &c, &d)) {
+        eax = a;
+        ebx = b;
+        ecx = c;
+        edx = d;
+      }
+#  endif
+    }
+  };
+
+  /** Returns the state components enabled by the operating system (XCR0). */
+  inline uint64 getEnabledStates() noexcept
+  {
+#  if (_COM_AZURE_DEV__BASE__COMPILER == _COM_AZURE_DEV__BASE__COMPILER_MSC)
+    return _xgetbv(0);
+#  else
+    uint32 low = 0;
+    uint32 high = 0;
+    __asm__ __volatile__ ("xgetbv" : "=a" (low), "=d" (high) : "c" (0));
+    return (static_cast<uint64>(high) << 32) | low;
+#  endif
+  }
+#endif
+
+  unsigned int detectTechnologies() noexcept
+  {
+    unsigned int result = 0;
+#if defined(_COM_AZURE_DEV__BASE__X86_INTRINSICS)
+    const unsigned int maximum = CPUID(0).eax;
+    if (maximum < 1) {
+      return result;
+    }
+    const CPUID features(1);
+    if (features.edx & (1U << 0)) {
+      result |= Architecture::FPU;
+    }
+    if (features.edx & (1U << 23)) {
+      result |= Architecture::MMX;
+    }
+    if (features.edx & (1U << 25)) {
+      result |= Architecture::SSE;
+    }
+    if (features.edx & (1U << 26)) {
+      result |= Architecture::SSE2;
+    }
+    if (features.edx & (1U << 28)) {
+      result |= Architecture::HYPER_THREADING;
+    }
+    if (features.ecx & (1U << 0)) {
+      result |= Architecture::SSE3;
+    }
+    if (features.ecx & (1U << 1)) {
+      result |= Architecture::CLMUL;
+    }
+    if (features.ecx & (1U << 9)) {
+      result |= Architecture::SSSE3;
+    }
+    if (features.ecx & (1U << 19)) {
+      result |= Architecture::SSE41;
+    }
+    if (features.ecx & (1U << 20)) {
+      result |= Architecture::SSE42;
+    }
+    if (features.ecx & (1U << 25)) {
+      result |= Architecture::AES;
+    }
+
+    // AVX requires that the operating system saves the YMM and ZMM registers
+    const bool xsave = (features.ecx & (1U << 27)) != 0; // OSXSAVE
+    const uint64 states = xsave ? getEnabledStates() : 0;
+    const bool ymm = (states & 0x06) == 0x06;
+    const bool zmm = (states & 0xe6) == 0xe6;
+    if (ymm && (features.ecx & (1U << 28))) {
+      result |= Architecture::AVX;
+    }
+    if (maximum >= 7) {
+      const CPUID extended(7);
+      if ((result & Architecture::AVX) && (extended.ebx & (1U << 5))) {
+        result |= Architecture::AVX2;
+      }
+      if (zmm && (result & Architecture::AVX2) && (extended.ebx & (1U << 16))) {
+        result |= Architecture::AVX512F;
+        if (extended.ebx & (1U << 30)) {
+          result |= Architecture::AVX512BW;
+        }
+      }
+      if (extended.ebx & (1U << 29)) {
+        result |= Architecture::SHA1 | Architecture::SHA256;
+      }
+    }
+#elif (_COM_AZURE_DEV__BASE__ARCH == _COM_AZURE_DEV__BASE__ARM64)
+    result |= Architecture::FPU | Architecture::NEON;
+#  if (_COM_AZURE_DEV__BASE__OS == _COM_AZURE_DEV__BASE__GNULINUX)
+    const unsigned long capabilities = getauxval(AT_HWCAP);
+    if (capabilities & HWCAP_AES) {
+      result |= Architecture::AES;
+    }
+    if (capabilities & HWCAP_PMULL) {
+      result |= Architecture::CLMUL;
+    }
+    if (capabilities & HWCAP_SHA1) {
+      result |= Architecture::SHA1;
+    }
+    if (capabilities & HWCAP_SHA2) {
+      result |= Architecture::SHA256;
+    }
+    if (capabilities & HWCAP_CRC32) {
+      result |= Architecture::CRC32;
+    }
+#  elif (_COM_AZURE_DEV__BASE__OS == _COM_AZURE_DEV__BASE__MACOS)
+    // all 64-bit Apple processors have the cryptography and CRC-32 extensions
+    result |= Architecture::AES | Architecture::CLMUL | Architecture::SHA1 | Architecture::SHA256 | Architecture::CRC32;
+#  elif (_COM_AZURE_DEV__BASE__FLAVOR == _COM_AZURE_DEV__BASE__WIN32)
+    if (IsProcessorFeaturePresent(PF_ARM_V8_CRYPTO_INSTRUCTIONS_AVAILABLE)) {
+      result |= Architecture::AES | Architecture::CLMUL | Architecture::SHA1 | Architecture::SHA256;
+    }
+    if (IsProcessorFeaturePresent(PF_ARM_V8_CRC32_INSTRUCTIONS_AVAILABLE)) {
+      result |= Architecture::CRC32;
+    }
+#  endif
+#endif
+    return result;
+  }
+}
+
 unsigned int Architecture::getTechonologies() noexcept
 {
-  unsigned int result = 0;
-  return result;
+  static const unsigned int technologies = detectTechnologies();
+  return technologies;
 }
 
 Architecture::Major Architecture::getArchitecture() noexcept
@@ -92,4 +259,45 @@ Architecture::Minor Architecture::getMinorArchitecture() noexcept
   return result;
 }
 
+#if defined(_COM_AZURE_DEV__BASE__TESTS)
+
+class TEST_CLASS(Architecture) : public UnitTest {
+public:
+
+  TEST_PRIORITY(10);
+  TEST_PROJECT("base");
+
+  void run() override
+  {
+    const unsigned int technologies = Architecture::getTechonologies();
+    TEST_EQUAL(technologies, Architecture::getTechonologies());
+    if (technologies & Architecture::AVX2) {
+      TEST_ASSERT(Architecture::hasTechnology(Architecture::AVX));
+    }
+    if (technologies & Architecture::AVX512F) {
+      TEST_ASSERT(Architecture::hasTechnology(Architecture::AVX2));
+    }
+
+    static const char* NAMES[] = {
+      "FPU", "MMX", "SSE", "SSE2", "SSE3", "3DNow", "3DNow2", "HyperThreading",
+      "SSSE3", "SSE4.1", "SSE4.2", "AVX", "AVX2", "AVX512F", "AVX512BW",
+      "AES", "CLMUL", "SHA1", "SHA256", "NEON", "CRC32"
+    };
+    String text;
+    for (unsigned int i = 0; i < getArraySize(NAMES); ++i) {
+      if (technologies & (1U << i)) {
+        if (text) {
+          text += " ";
+        }
+        text += NAMES[i];
+      }
+    }
+    TEST_PRINT(format() << "Architecture " << Architecture::getArchitectureAsString() << ": " << text);
+  }
+};
+
+TEST_REGISTER(Architecture);
+
+#endif
+
 _COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
@@ -15,6 +15,23 @@
 
 #include <base/string/String.h>
 
+#if ((_COM_AZURE_DEV__BASE__ARCH == _COM_AZURE_DEV__BASE__X86) || \
+     (_COM_AZURE_DEV__BASE__ARCH == _COM_AZURE_DEV__BASE__X86_64)) && \
+    ((_COM_AZURE_DEV__BASE__COMPILER == _COM_AZURE_DEV__BASE__COMPILER_GCC) || \
+     (_COM_AZURE_DEV__BASE__COMPILER == _COM_AZURE_DEV__BASE__COMPILER_LLVM) || \
+     (_COM_AZURE_DEV__BASE__COMPILER == _COM_AZURE_DEV__BASE__COMPILER_MSC))
+/** Defined if x86 intrinsics can be used for code selected at runtime by Architecture::hasTechnology(). */
+#  define _COM_AZURE_DEV__BASE__X86_INTRINSICS
+#endif
+
+#if (_COM_AZURE_DEV__BASE__COMPILER == _COM_AZURE_DEV__BASE__COMPILER_GCC) || \
+    (_COM_AZURE_DEV__BASE__COMPILER == _COM_AZURE_DEV__BASE__COMPILER_LLVM)
+/** Compiles the function for the given instruction set extensions (e.g. "avx2"). */
+#  define _COM_AZURE_DEV__BASE__TARGET(FEATURES) __attribute__((target(FEATURES)))
+#else
+#  define _COM_AZURE_DEV__BASE__TARGET(FEATURES)
+#endif
+
 _COM_AZURE_DEV__BASE__ENTER_NAMESPACE
 
 /**
@@ -56,7 +73,20 @@ public:
     SSE3 = 1U << 4, /**< Streaming SIMD Extensions (SSE) 3. */
     NOW3D = 1U << 5, /**< 3DNow. */
     NOW3D2 = 1U << 6, /**< 3DNow 2. */
-    HYPER_THREADING = 1U << 7 /**< Hyper-threading. */
+    HYPER_THREADING = 1U << 7, /**< Hyper-threading. */
+    SSSE3 = 1U << 8, /**< Supplemental Streaming SIMD Extensions (SSSE3). */
+    SSE41 = 1U << 9, /**< Streaming SIMD Extensions (SSE) 4.1. */
+    SSE42 = 1U << 10, /**< Streaming SIMD Extensions (SSE) 4.2. */
+    AVX = 1U << 11, /**< Advanced Vector Extensions (AVX). */
+    AVX2 = 1U << 12, /**< Advanced Vector Extensions (AVX) 2. */
+    AVX512F = 1U << 13, /**< AVX-512 foundation. */
+    AVX512BW = 1U << 14, /**< AVX-512 byte and word instructions. */
+    AES = 1U << 15, /**< AES instructions (AES-NI or ARMv8 cryptography extension). */
+    CLMUL = 1U << 16, /**< Carry-less multiplication (PCLMULQDQ or ARMv8 PMULL). */
+    SHA1 = 1U << 17, /**< SHA-1 instructions (SHA extensions or ARMv8 cryptography extension). */
+    SHA256 = 1U << 18, /**< SHA-256 instructions (SHA extensions or ARMv8 cryptography extension). */
+    NEON = 1U << 19, /**< ARM Advanced SIMD (NEON). */
+    CRC32 = 1U << 20 /**< ARMv8 CRC-32 instructions. */
   };
 
   /** The major architecture. */
@@ -124,9 +154,19 @@ public:
   }
 
   /**
-    Returns the supported technologies.
+    Returns the technologies supported by the processor and the operating
+    system. The technologies are only detected once.
   */
   static unsigned int getTechonologies() noexcept;
+
+  /**
+    Returns true if the given technology is supported by the processor and the
+    operating system.
+  */
+  static inline bool hasTechnology(Technology technology) noexcept
+  {
+    return (getTechonologies() & technology) != 0;
+  }
   
   /**
     Returns the major architecture.
@@ -0,0 +1,462 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#include <base/AsyncLogger.h>
+#include <base/Trace.h>
+#include <base/Date.h>
+#include <base/Timer.h>
+#include <base/string/StringOutputStream.h>
+#include <base/string/Format.h>
+#include <base/concurrency/ExclusiveSynchronize.h>
+#include <base/concurrency/ThreadLocalContext.h>
+#include <base/objectmodel/JSON.h>
+#include <base/io/MemoryOutputStream.h>
+#include <base/UnitTest.h>
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+namespace {
+
+  const Literal MESSAGE_TYPES[] = {
+    MESSAGE("INFORMATION"),
+    MESSAGE("WARNING"),
+    MESSAGE("ERROR")
+  };
+
+  inline const Literal& getMessageType(SystemLogger::MessageType type) noexcept
+  {
+    return MESSAGE_TYPES[(static_cast<unsigned int>(type) < getArraySize(MESSAGE_TYPES)) ? type : 0];
+  }
+
+  /** Substitutes %1, %2, ... like Format::Subst. */
+  void writeMessage(FormatOutputStream& stream, const AsyncLogger::Record& record)
+  {
+    const char* src = record.format;
+    const char* end = src + record.formatLength;
+    const char* segmentBegin = src;
+    while (src != end) {
+      if (*src != '%') {
+        ++src;
+        continue;
+      }
+      stream.write(Cast::pointer<const uint8*>(segmentBegin), static_cast<unsigned int>(src - segmentBegin));
+      ++src; // skip %
+      if ((src != end) && (*src == '%')) { // escaped %
+        stream << '%';
+        segmentBegin = ++src;
+        continue;
+      }
+      const char* digitsBegin = src;
+      unsigned int index = 0;
+      while ((src != end) && ASCIITraits::isDigit(*src) && ((src - digitsBegin) < 2)) {
+        index = index * 10 + ASCIITraits::digitToValue(*src++);
+      }
+      if (src == digitsBegin) { // no digits
+        stream << '%';
+      } else if ((index > 0) && (index <= record.numberOfArguments)) {
+        stream << record.arguments[index - 1];
+      } else {
+        stream << MESSAGE("<NULL>"); // missing argument
+      }
+      segmentBegin = src;
+    }
+    stream.write(Cast::pointer<const uint8*>(segmentBegin), static_cast<unsigned int>(src - segmentBegin));
+  }
+}
+
+String AsyncLogger::Record::getMessage() const
+{
+  StringOutputStream stream;
+  writeMessage(stream, *this);
+  return stream.toString();
+}
+
+void AsyncLogger::Sink::flush()
+{
+}
+
+void AsyncLogger::SystemLoggerSink::write(const Record& record)
+{
+  SystemLogger::write(record.type, record.getMessage());
+}
+
+void AsyncLogger::TraceSink::write(const Record& record)
+{
+  const String message = format() << getMessageType(record.type) << ": " << record.getMessage();
+  Trace::message(message.native());
+}
+
+AsyncLogger::Config::Config()
+{
+}
+
+AsyncLogger::StreamSink::StreamSink(OutputStream& _stream, bool _json)
+  : stream(_stream), json(_json)
+{
+}
+
+void AsyncLogger::StreamSink::write(const Record& record)
+{
+  if (json) {
+    ObjectModel o;
+    auto object = o.createObject();
+    object->setValue(o.createString("time"), o.createString(Date(record.time).getISO8601_US()));
+    object->setValue(o.createString("type"), o.createString(getMessageType(record.type).getValue()));
+    object->setValue(o.createString("thread"), o.createInteger(record.thread));
+    object->setValue(o.createString("format"), o.createString(String(record.format, record.formatLength)));
+    object->setValue(o.createString("message"), o.createString(record.getMessage()));
+    buffer.append(JSON::getJSONNoFormatting(object));
+  } else {
+    StringOutputStream line;
+    line << Date(record.time).getISO8601_US() << ' ' << getMessageType(record.type)
+         << " [" << record.thread << "] ";
+    writeMessage(line, record);
+    buffer.append(line.getString());
+  }
+  buffer.append('\n');
+}
+
+void AsyncLogger::StreamSink::flush()
+{
+  const uint8* src = buffer.getBytes();
+  MemorySize size = buffer.getLength();
+  while (size > 0) {
+    const unsigned int bytesWritten = stream.write(
+      src, static_cast<unsigned int>(minimum<MemorySize>(size, PrimitiveTraits<unsigned int>::MAXIMUM)), false
+    );
+    src += bytesWritten;
+    size -= bytesWritten;
+  }
+  stream.flush();
+  buffer.forceToLength(0);
+}
+
+AsyncLogger::Ring::Ring(MemorySize _capacity)
+{
+  capacity = 1;
+  while (capacity < _capacity) {
+    capacity <<= 1;
+  }
+  records = new Record[capacity];
+}
+
+AsyncLogger::Ring::~Ring()
+{
+  delete[] records;
+}
+
+void AsyncLogger::Writer::run()
+{
+  while (!logger->terminated) {
+    logger->wakeup.reset();
+    logger->drained.reset();
+    const uint64 requested = logger->flushRequests;
+    logger->drain();
+    logger->flushCompleted = requested;
+    logger->drained.signal();
+    logger->wakeup.wait(logger->config.interval);
+  }
+  logger->drain();
+  logger->flushCompleted = static_cast<uint64>(logger->flushRequests);
+  logger->drained.signal();
+}
+
+AsyncLogger::AsyncLogger(Reference<Sink> _sink, const Config& _config)
+  : config(_config), sink(_sink), thread(&runnable)
+{
+  bassert(sink, NullPointer(this));
+  config.capacity = maximum(config.capacity, 2U);
+  config.interval = maximum(config.interval, 1000U);
+  runnable.logger = this;
+  thread.start();
+}
+
+AsyncLogger::Ring* AsyncLogger::getRing()
+{
+  Ring* result = ring.getKey();
+  if (!result) {
+    result = new Ring(config.capacity);
+    result->tokens = config.rate;
+    result->lastRefill = Timer::getNow();
+    {
+      ExclusiveSynchronize<MutualExclusion> _guard(lock);
+      try {
+        rings.append(result);
+      } catch (...) {
+        delete result;
+        throw;
+      }
+    }
+    ring.setKey(result);
+  }
+  return result;
+}
+
+bool AsyncLogger::push(
+  SystemLogger::MessageType type,
+  const Literal& format,
+  const AnyValue* arguments,
+  unsigned int numberOfArguments) noexcept
+{
+  try {
+    Ring* current = getRing();
+
+    if (config.rate) { // token bucket
+      const uint64 now = Timer::getNow();
+      current->tokens = minimum<double>(current->tokens + (now - current->lastRefill) * static_cast<double>(config.rate)/1000000, config.rate);
+      current->lastRefill = now;
+      if (current->tokens < 1) {
+        ++current->limited;
+        return false;
+      }
+      current->tokens -= 1;
+    }
+
+    const MemorySize head = current->head;
+    const MemorySize pending = head - current->tail;
+    if (pending >= current->capacity) {
+      ++current->dropped;
+      return false;
+    }
+
+    Record& record = current->records[head & (current->capacity - 1)];
+    record.type = type;
+    record.time = Date::getNow().getValue();
+    auto tlc = Thread::getLocalContext();
+    record.thread = tlc ? tlc->simpleId : 0;
+    record.format = format.getValue();
+    record.formatLength = format.getLength();
+    record.numberOfArguments = numberOfArguments;
+    for (unsigned int i = 0; i < numberOfArguments; ++i) {
+      record.arguments[i] = arguments[i];
+    }
+    current->head = head + 1; // publish
+
+    if (pending == (current->capacity/2)) {
+      wakeup.signal(); // do not wait for interval
+    }
+    return true;
+  } catch (...) {
+    return false;
+  }
+}
+
+MemorySize AsyncLogger::drain()
+{
+  Array<Ring*> snapshot;
+  {
+    ExclusiveSynchronize<MutualExclusion> _guard(lock);
+    snapshot = rings;
+  }
+
+  MemorySize count = 0;
+  for (MemorySize i = 0; i < snapshot.getSize(); ++i) {
+    Ring* current = snapshot[i];
+    MemorySize tail = current->tail;
+    const MemorySize head = current->head;
+    while (tail != head) {
+      Record& record = current->records[tail & (current->capacity - 1)];
+      try {
+        sink->write(record);
+      } catch (...) {
+        // ignore sink errors to keep logging
+      }
+      for (unsigned int a = 0; a < record.numberOfArguments; ++a) {
+        record.arguments[a] = AnyValue(); // release resources
+      }
+      current->tail = ++tail; // make slot available
+      ++count;
+    }
+  }
+
+  if (count) {
+    try {
+      sink->flush();
+    } catch (...) {
+      // ignore sink errors to keep logging
+    }
+    written += count;
+  }
+  return count;
+}
+
+void AsyncLogger::flush()
+{
+  flushRequests += 1;
+  const uint64 requested = flushRequests;
+  wakeup.signal();
+  while (flushCompleted < requested) {
+    drained.wait(config.interval);
+  }
+}
+
+uint64 AsyncLogger::getWritten() const noexcept
+{
+  return written;
+}
+
+uint64 AsyncLogger::getDropped()
+{
+  ExclusiveSynchronize<MutualExclusion> _guard(lock);
+  uint64 result = 0;
+  for (MemorySize i = 0; i < rings.getSize(); ++i) {
+    result += rings[i]->dropped;
+  }
+  return result;
+}
+
+uint64 AsyncLogger::getLimited()
+{
+  ExclusiveSynchronize<MutualExclusion> _guard(lock);
+  uint64 result = 0;
+  for (MemorySize i = 0; i < rings.getSize(); ++i) {
+    result += rings[i]->limited;
+  }
+  return result;
+}
+
+MemorySize AsyncLogger::getNumberOfRings()
+{
+  ExclusiveSynchronize<MutualExclusion> _guard(lock);
+  return rings.getSize();
+}
+
+AsyncLogger::~AsyncLogger()
+{
+  terminated = 1;
+  wakeup.signal();
+  thread.join();
+  for (MemorySize i = 0; i < rings.getSize(); ++i) {
+    delete rings[i];
+  }
+}
+
+#if defined(_COM_AZURE_DEV__BASE__TESTS)
+
+class TEST_CLASS(AsyncLogger) : public UnitTest {
+public:
+
+  TEST_PRIORITY(100);
+  TEST_PROJECT("base");
+  TEST_TIMEOUT_MS(30 * 1000);
+
+  class MemorySink : public AsyncLogger::Sink {
+  public:
+
+    Array<String> messages;
+    unsigned int batches = 0;
+
+    void write(const AsyncLogger::Record& record) override
+    {
+      messages.append(record.getMessage());
+    }
+
+    void flush() override
+    {
+      ++batches;
+    }
+  };
+
+  class Producer : public Runnable {
+  public:
+
+    AsyncLogger* logger = nullptr;
+    unsigned int id = 0;
+
+    void run() override
+    {
+      for (unsigned int i = 0; i < 100; ++i) {
+        logger->log(SystemLogger::INFORMATION, MESSAGE("thread %1 message %2"), id, i);
+      }
+    }
+  };
+
+  void run() override
+  {
+    {
+      Reference<MemorySink> sink = new MemorySink();
+      AsyncLogger logger(sink);
+      TEST_ASSERT(logger.log(SystemLogger::WARNING, MESSAGE("Value %1 and %2 (100%%)."), 123, String("text")));
+      TEST_ASSERT(logger.log(SystemLogger::ERROR, MESSAGE("Missing %3.")));
+      logger.flush();
+      TEST_EQUAL(logger.getWritten(), 2);
+      TEST_EQUAL(sink->messages.getSize(), 2);
+      TEST_EQUAL(sink->messages[0], "Value 123 and text (100%).");
+      TEST_EQUAL(sink->messages[1], "Missing <NULL>.");
+
+      Producer producers[4];
+      Thread* threads[4];
+      for (unsigned int i = 0; i < getArraySize(producers); ++i) {
+        producers[i].logger = &logger;
+        producers[i].id = i;
+        threads[i] = new Thread(&producers[i]);
+        threads[i]->start();
+      }
+      for (unsigned int i = 0; i < getArraySize(producers); ++i) {
+        threads[i]->join();
+        delete threads[i];
+      }
+      logger.flush();
+      TEST_EQUAL(logger.getWritten() + logger.getDropped(), 2 + 4 * 100);
+      TEST_EQUAL(logger.getNumberOfRings(), 1 + 4); // one ring per thread until logger is destroyed
+    }
+
+    { // rate limit
+      Reference<MemorySink> sink = new MemorySink();
+      AsyncLogger::Config config;
+      config.rate = 10;
+      AsyncLogger logger(sink, config);
+      unsigned int accepted = 0;
+      for (unsigned int i = 0; i < 100; ++i) {
+        if (logger.log(SystemLogger::INFORMATION, MESSAGE("%1"), i)) {
+          ++accepted;
+        }
+      }
+      TEST_ASSERT(accepted < 20);
+      TEST_EQUAL(logger.getLimited(), 100 - accepted);
+    }
+
+    { // full ring
+      Reference<MemorySink> sink = new MemorySink();
+      AsyncLogger::Config config;
+      config.capacity = 4;
+      config.interval = 1000 * 1000;
+      AsyncLogger logger(sink, config);
+      for (unsigned int i = 0; i < 100; ++i) {
+        logger.log(SystemLogger::INFORMATION, MESSAGE("%1"), i);
+      }
+      logger.flush();
+      TEST_EQUAL(logger.getWritten() + logger.getDropped(), 100);
+      TEST_ASSERT(logger.getDropped() > 0);
+    }
+
+    { // stream sink
+      MemoryOutputStream mos;
+      {
+        AsyncLogger logger(new AsyncLogger::StreamSink(mos, true));
+        logger.log(SystemLogger::INFORMATION, MESSAGE("Hello %1"), "World");
+      }
+      Allocator<uint8> buffer;
+      mos.swap(buffer);
+      const String text(reinterpret_cast<const char*>(buffer.getElements()), buffer.getSize());
+      TEST_ASSERT(text.indexOf("\"message\":\"Hello World\"") >= 0);
+      TEST_ASSERT(text.endsWith("\n"));
+    }
+  }
+};
+
+TEST_REGISTER(AsyncLogger);
+
+#endif
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
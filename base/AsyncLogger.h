@@ -0,0 +1,270 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#pragma once
+
+#include <base/concurrency/Thread.h>
+#include <base/SystemLogger.h>
+#include <base/AnyValue.h>
+#include <base/Literal.h>
+#include <base/collection/Array.h>
+#include <base/concurrency/AtomicCounter.h>
+#include <base/concurrency/Event.h>
+#include <base/concurrency/MutualExclusion.h>
+#include <base/concurrency/Runnable.h>
+#include <base/concurrency/ThreadKey.h>
+#include <base/io/OutputStream.h>
+#include <base/mem/Reference.h>
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+/**
+  Asynchronous structured logger. Each thread appends records to its own
+  lock-free ring buffer and a background thread formats the records and writes
+  them to the sink in batches. The arguments are captured as AnyValue and are
+  only formatted by the background thread. Records are dropped (and counted)
+  instead of blocking when a ring buffer is full or the rate limit of the
+  thread is exceeded.
+
+  Each thread that logs gets its own ring buffer of Config::capacity records
+  which is kept until the logger is destroyed, also after the thread has
+  exited. Memory usage thus grows with the number of distinct threads that
+  have logged. Use a thread pool or a smaller capacity when many short lived
+  threads log.
+
+  @code
+  AsyncLogger logger(new AsyncLogger::StreamSink(file));
+  logger.log(SystemLogger::WARNING, MESSAGE("Request %1 took %2 ms."), id, elapsed);
+  @endcode
+
+  @short Asynchronous logger.
+  @version 1.0
+*/
+
+class _COM_AZURE_DEV__BASE__API AsyncLogger : public Object {
+public:
+
+  /** The maximum number of arguments per record. */
+  static constexpr unsigned int MAXIMUM_ARGUMENTS = 8;
+
+  /** Log record. */
+  class _COM_AZURE_DEV__BASE__API Record {
+  public:
+
+    /** The type of the message. */
+    SystemLogger::MessageType type = SystemLogger::INFORMATION;
+    /** The time in microseconds since epoch (UTC). */
+    int64 time = 0;
+    /** The simple id of the thread. */
+    unsigned int thread = 0;
+    /** The message format. Literal. */
+    const char* format = nullptr;
+    /** The length of the format. */
+    MemorySize formatLength = 0;
+    /** The number of arguments. */
+    unsigned int numberOfArguments = 0;
+    /** The arguments. */
+    AnyValue arguments[MAXIMUM_ARGUMENTS];
+
+    /** Returns the message with the arguments substituted. */
+    String getMessage() const;
+  };
+
+  /** Receives the formatted records. All methods are invoked from the writer thread only. */
+  class _COM_AZURE_DEV__BASE__API Sink : public ReferenceCountedObject {
+  public:
+
+    /** Writes the given record. */
+    virtual void write(const Record& record) = 0;
+
+    /** Called at the end of each batch. */
+    virtual void flush();
+  };
+
+  /** Writes records to the system logger. */
+  class _COM_AZURE_DEV__BASE__API SystemLoggerSink : public Sink {
+  public:
+
+    void write(const Record& record) override;
+  };
+
+  /** Writes records using Trace. */
+  class _COM_AZURE_DEV__BASE__API TraceSink : public Sink {
+  public:
+
+    void write(const Record& record) override;
+  };
+
+  /** Writes records to an output stream as text lines or JSON lines. Each batch is written using a single write. */
+  class _COM_AZURE_DEV__BASE__API StreamSink : public Sink {
+  private:
+
+    OutputStream& stream;
+    bool json = false;
+    String buffer;
+  public:
+
+    /**
+      Initializes sink.
+
+      @param stream The output stream. Must outlive the logger.
+      @param json Write records as JSON lines.
+    */
+    StreamSink(OutputStream& stream, bool json = false);
+
+    void write(const Record& record) override;
+
+    void flush() override;
+  };
+
+  /** Configuration. */
+  class _COM_AZURE_DEV__BASE__API Config {
+  public:
+
+    /** The number of records per thread. Rounded up to power of 2. */
+    unsigned int capacity = 1024;
+    /** The maximum number of records per second per thread. 0 disables rate limiting. */
+    unsigned int rate = 0;
+    /** The maximum time in microseconds between batches. */
+    unsigned int interval = 10 * 1000;
+
+    /** Initializes config. */
+    Config();
+  };
+private:
+
+  /** Single producer single consumer ring buffer. */
+  class Ring {
+  public:
+
+    /** The records. */
+    Record* records = nullptr;
+    /** The capacity. Power of 2. */
+    MemorySize capacity = 0;
+    /** The next record to write. Only written by producer. */
+    AtomicCounter<MemorySize> head;
+    /** The next record to read. Only written by consumer. */
+    AtomicCounter<MemorySize> tail;
+    /** The number of dropped records due to full ring. */
+    AtomicCounter<uint64> dropped;
+    /** The number of dropped records due to rate limit. */
+    AtomicCounter<uint64> limited;
+    /** Available tokens for rate limit. Producer only. */
+    double tokens = 0;
+    /** Last token update. Producer only. */
+    uint64 lastRefill = 0;
+
+    Ring(MemorySize capacity);
+
+    Ring(const Ring& copy) = delete;
+    Ring& operator=(const Ring& assign) = delete;
+
+    ~Ring();
+  };
+
+  /** Writer thread. */
+  class Writer : public Runnable {
+  public:
+
+    AsyncLogger* logger = nullptr;
+
+    void run() override;
+  };
+
+  friend class Writer;
+
+  /** The configuration. */
+  Config config;
+  /** The sink. */
+  Reference<Sink> sink;
+  /** The ring of the current thread. */
+  ThreadKey<Ring> ring;
+  /** Guards registration of rings. */
+  MutualExclusion lock;
+  /** All rings. Owned by the logger. */
+  Array<Ring*> rings;
+  /** Wakes writer. */
+  Event wakeup;
+  /** Signaled after each batch. */
+  Event drained;
+  /** Flush requests. */
+  AtomicCounter<uint64> flushRequests;
+  /** Completed flush requests. */
+  AtomicCounter<uint64> flushCompleted;
+  /** The number of written records. */
+  AtomicCounter<uint64> written;
+  /** Set when the writer must stop. */
+  AtomicCounter<unsigned int> terminated;
+  /** The writer. */
+  Writer runnable;
+  /** The writer thread. */
+  Thread thread;
+
+  /** Returns the ring of the current thread. */
+  Ring* getRing();
+
+  /** Appends record. */
+  bool push(SystemLogger::MessageType type, const Literal& format, const AnyValue* arguments, unsigned int numberOfArguments) noexcept;
+
+  /** Writes all pending records. Returns the number of records. */
+  MemorySize drain();
+public:
+
+  /**
+    Initializes the logger and starts the writer thread.
+
+    @param sink The sink.
+    @param config The configuration.
+  */
+  AsyncLogger(Reference<Sink> sink, const Config& config = Config());
+
+  AsyncLogger(const AsyncLogger& copy) = delete;
+  AsyncLogger& operator=(const AsyncLogger& assign) = delete;
+
+  /**
+    Logs the given message. The arguments replace %1, %2, ... of the format and
+    are formatted by the writer thread. Never blocks. Returns false if the
+    record was dropped.
+  */
+  template<typename... ARGS>
+  inline bool log(SystemLogger::MessageType type, const Literal& format, ARGS&&... args) noexcept
+  {
+    static_assert(sizeof...(ARGS) <= MAXIMUM_ARGUMENTS, "Too many arguments.");
+    try {
+      const AnyValue arguments[sizeof...(ARGS) + 1] = { AnyValue(std::forward<ARGS>(args))... };
+      return push(type, format, arguments, sizeof...(ARGS));
+    } catch (...) {
+      return false; // e.g. out of memory while copying argument
+    }
+  }
+
+  /** Waits until all records logged before the call have been written. */
+  void flush();
+
+  /** Returns the number of written records. */
+  uint64 getWritten() const noexcept;
+
+  /** Returns the number of records dropped due to full ring buffers. */
+  uint64 getDropped();
+
+  /** Returns the number of records dropped due to rate limiting. */
+  uint64 getLimited();
+
+  /** Returns the number of ring buffers (i.e. the number of threads that have logged). */
+  MemorySize getNumberOfRings();
+
+  /** Writes pending records and stops the writer thread. */
+  ~AsyncLogger();
+};
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
@@ -199,13 +199,13 @@ inline bool equal(const TYPE* left, const TYPE* right, MemorySize count)
 template<>
 inline bool equal<char>(const char* left, const char* right, MemorySize count)
 {
-  return isoc::memcmp(left, right, count);
+  return isoc::memcmp(left, right, count) == 0;
 }
 
 template<>
 inline bool equal<uint8>(const uint8* left, const uint8* right, MemorySize count)
 {
-  return isoc::memcmp(left, right, count);
+  return isoc::memcmp(left, right, count) == 0;
 }
 #endif
 
@@ -165,64 +165,111 @@ public:
   }
 };
 
+/**
+  Insertion sort. O(n^2) but fast for small arrays and arrays which are almost
+  sorted. Stable. operator<= used for comparison of values.
+*/
 template<class TYPE>
-inline void mergeSortTiny(TYPE* begin, const MemorySize size)
+void insertionSort(TYPE* begin, TYPE* end)
 {
-  auto end = begin + size; // we lower end per loop
-  while (true) { // loop until all items sorted
-    auto current = begin; // restart
-    if (current == end) { // done - no more items to sort
-      break;
-    }
-
-    // move max to end
-    bool swapped = false;
-    auto next = current;
-    ++next;
-    while (next != end) {
-      if (!(*current <= *next)) { // dont swap on = but < is the primary comparison operator for algorithms
-        swapper(*current, *next);
-        swapped = true;
-      }
-      ++current;
-      ++next;
-    }
-    if (!swapped) {
-      return; // nothing to do
+  if (begin == end) {
+    return;
+  }
+  for (TYPE* current = begin + 1; current != end; ++current) {
+    if (*(current - 1) <= *current) {
+      continue; // already in order
     }
-    end = current; // max now at end so no need to look at this again
+    TYPE value = moveObject(*current);
+    TYPE* dest = current;
+    do {
+      *dest = moveObject(*(dest - 1));
+      --dest;
+    } while ((dest != begin) && !(*(dest - 1) <= value));
+    *dest = moveObject(value);
   }
 }
 
+/**
+  Insertion sort. O(n^2) but fast for small arrays and arrays which are almost
+  sorted. Stable. Predicate must return true if the first value may be before
+  the second value (e.g. a <= b).
+*/
 template<class TYPE, class PREDICATE>
-inline void mergeSortTiny(TYPE* begin, const MemorySize size, PREDICATE predicate)
+void insertionSort(TYPE* begin, TYPE* end, PREDICATE predicate)
 {
-  auto end = begin + size; // we lower end per loop
-  while (true) { // loop until all items sorted
-    auto current = begin; // restart
-    if (current == end) { // done - no more items to sort
-      break;
+  if (begin == end) {
+    return;
+  }
+  for (TYPE* current = begin + 1; current != end; ++current) {
+    if (predicate(*(current - 1), *current)) {
+      continue; // already in order
     }
+    TYPE value = moveObject(*current);
+    TYPE* dest = current;
+    do {
+      *dest = moveObject(*(dest - 1));
+      --dest;
+    } while ((dest != begin) && !predicate(*(dest - 1), value));
+    *dest = moveObject(value);
+  }
+}
 
-    // move max to end
-    bool swapped = false;
-    auto next = current;
-    ++next;
-    while (next != end) {
-      if (!predicate(*current, *next)) {
-        swapper(*current, *next);
-        swapped = true;
-      }
-      ++current;
-      ++next;
+/** Insertion sort. Random access iterator required. operator<= used for comparison of values. */
+template<class ITERATOR>
+void insertionSort(const ITERATOR& begin, const ITERATOR& end)
+{
+  const RandomAccessIterator* ensureRandomAccessIterator =
+    static_cast<const typename ITERATOR::Category*>(nullptr);
+  typedef typename ITERATOR::Value TYPE;
+  const MemorySize size = end - begin;
+  for (MemorySize i = 1; i < size; ++i) {
+    if (begin[i - 1] <= begin[i]) {
+      continue; // already in order
     }
-    if (!swapped) {
-      return; // nothing to do
+    TYPE value = moveObject(begin[i]);
+    MemorySize j = i;
+    do {
+      begin[j] = moveObject(begin[j - 1]);
+      --j;
+    } while ((j > 0) && !(begin[j - 1] <= value));
+    begin[j] = moveObject(value);
+  }
+}
+
+/** Insertion sort. Random access iterator required. */
+template<class ITERATOR, class PREDICATE>
+void insertionSort(const ITERATOR& begin, const ITERATOR& end, PREDICATE predicate)
+{
+  const RandomAccessIterator* ensureRandomAccessIterator =
+    static_cast<const typename ITERATOR::Category*>(nullptr);
+  typedef typename ITERATOR::Value TYPE;
+  const MemorySize size = end - begin;
+  for (MemorySize i = 1; i < size; ++i) {
+    if (predicate(begin[i - 1], begin[i])) {
+      continue; // already in order
     }
-    end = current; // max now at end so no need to look at this again
+    TYPE value = moveObject(begin[i]);
+    MemorySize j = i;
+    do {
+      begin[j] = moveObject(begin[j - 1]);
+      --j;
+    } while ((j > 0) && !predicate(begin[j - 1], value));
+    begin[j] = moveObject(value);
   }
 }
 
+template<class TYPE>
+inline void mergeSortTiny(TYPE* begin, const MemorySize size)
+{
+  insertionSort(begin, begin + size);
+}
+
+template<class TYPE, class PREDICATE>
+inline void mergeSortTiny(TYPE* begin, const MemorySize size, PREDICATE predicate)
+{
+  insertionSort(begin, begin + size, predicate);
+}
+
 template<class TYPE>
 inline void mergeSortMerge(TYPE* a, const TYPE* aEnd, TYPE* b, const TYPE* bEnd, TYPE* dest)
 {
@@ -262,7 +309,7 @@ inline void mergeSortMerge(TYPE* a, const TYPE* aEnd, TYPE* b, const TYPE* bEnd,
 }
 
 /**
-  Merge sort. O(n log(n)). Random access iterator required. operator<= used for comparison of values.
+  Merge sort. O(n log(n)). Stable. Random access iterator required. operator<= used for comparison of values.
 
   It is recommended that the Value of the iterator supports move assignment.
 */
@@ -274,11 +321,11 @@ void mergeSort(const ITERATOR& begin, const ITERATOR& end)
   const RandomAccessIterator* ensureRandomAccessIterator =
     static_cast<const typename ITERATOR::Category*>(nullptr);
   
-  constexpr MemorySize TINY = 8;
+  constexpr MemorySize TINY = 16;
 
   const MemorySize size = end - begin;
   if (size <= TINY) {
-    bubbleSort(begin, end);
+    insertionSort(begin, end);
     return; // nothing to do
   }
 
@@ -324,11 +371,11 @@ void mergeSort(const ITERATOR& begin, const ITERATOR& end, PREDICATE predicate)
   const RandomAccessIterator* ensureRandomAccessIterator =
     static_cast<const typename ITERATOR::Category*>(nullptr);
   
-  constexpr MemorySize TINY = 8;
+  constexpr MemorySize TINY = 16;
 
   const MemorySize size = end - begin;
   if (size <= TINY) {
-    bubbleSort(begin, end, predicate);
+    insertionSort(begin, end, predicate);
     return; // nothing to do
   }
 
@@ -894,10 +894,10 @@ public:
   {
     ComputeTask profiler("Array::sort()");
     elements.copyOnWrite();
-    if (getSize() >= 128) {
+    if (getSize() > 32) {
       mergeSort(begin(), end());
     } else {
-      bubbleSort(begin(), end());
+      insertionSort(begin(), end());
     }
   }
 
@@ -907,10 +907,10 @@ public:
   {
     ComputeTask profiler("Array::sort()");
     elements.copyOnWrite();
-    if (getSize() >= 128) {
+    if (getSize() > 32) {
       mergeSort(begin(), end(), predicate);
     } else {
-      bubbleSort(begin(), end(), predicate);
+      insertionSort(begin(), end(), predicate);
     }
   }
 
@@ -331,8 +331,9 @@ public:
                     destNode->setNext(srcNode);
                     destNode = destNode->getNext();
                     // destNode->setNext(nullptr); // only set for last node
+                  } else {
+                    parentSrcNode = srcNode; // parent is unchanged for moved node
                   }
-                  parentSrcNode = srcNode;
                   srcNode = nextNode;
                 }
                 destNode->setNext(nullptr);
@@ -363,8 +364,9 @@ public:
                     destNode->setNext(srcNode);
                     destNode = destNode->getNext();
                     // destNode->setNext(nullptr); // only set for last node
+                  } else {
+                    parentSrcNode = srcNode; // parent is unchanged for moved node
                   }
-                  parentSrcNode = srcNode;
                   srcNode = nextNode;
                 }
                 destNode->setNext(nullptr); // terminate linked list
@@ -0,0 +1,366 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#include <base/collection/ParallelAlgorithm.h>
+#include <base/concurrency/ThreadPool.h>
+#include <base/concurrency/Process.h>
+#include <base/concurrency/Semaphore.h>
+#include <base/concurrency/MutualExclusion.h>
+#include <base/concurrency/ExclusiveSynchronize.h>
+#include <base/InvalidException.h>
+#include <base/OutOfRange.h>
+#include <base/Timer.h>
+#include <base/UnitTest.h>
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+void ParallelJobs::Job::run()
+{
+  try {
+    process();
+  } catch (...) {
+    failed = true; // processed again by caller to raise the exception
+  }
+}
+
+ParallelJobs::Job::~Job()
+{
+}
+
+unsigned int ParallelJobs::getThreads(unsigned int threads) noexcept
+{
+  if (!threads) {
+    threads = maximum<unsigned int>(static_cast<unsigned int>(Process::getNumberOfOnlineProcessors()), 1);
+  }
+  return threads;
+}
+
+MemorySize ParallelJobs::getNumberOfJobs(MemorySize size, unsigned int threads, MemorySize grain) noexcept
+{
+  return maximum<MemorySize>(minimum<MemorySize>(getThreads(threads), size/maximum<MemorySize>(grain, 1)), 1);
+}
+
+ParallelJobs::ParallelJobs()
+{
+}
+
+void ParallelJobs::add(Job* job)
+{
+  jobs.append(job);
+}
+
+namespace {
+
+  /** Does nothing. Returned to the pool when another thread took the last job. */
+  class Idle : public Runnable {
+  public:
+
+    void run() override
+    {
+    }
+  };
+
+  /** Provides the jobs to the pool and to the calling thread and signals completion of each job. */
+  class Provider : public JobProvider {
+  private:
+
+    /** Runs the job and signals completion. */
+    class Task : public Runnable {
+    public:
+
+      ParallelJobs::Job* job = nullptr;
+      Semaphore* completed = nullptr;
+
+      void run() override
+      {
+        job->run(); // does not throw
+        completed->post();
+      }
+    };
+
+    MutualExclusion lock;
+    Array<Task> tasks;
+    MemorySize next = 0;
+    Semaphore completed;
+    Idle idle;
+  public:
+
+    Provider(ParallelJobs::Job* const* jobs, MemorySize size)
+    {
+      tasks.setSize(size);
+      Task* task = tasks.getElements();
+      for (MemorySize i = 0; i < size; ++i) {
+        task[i].job = jobs[i];
+        task[i].completed = &completed;
+      }
+    }
+
+    bool isEmpty() const override
+    {
+      ExclusiveSynchronize<MutualExclusion> _guard(lock);
+      return next == tasks.getSize();
+    }
+
+    Runnable* pop() override
+    {
+      ExclusiveSynchronize<MutualExclusion> _guard(lock);
+      if (next == tasks.getSize()) {
+        return &idle; // the calling thread may have taken the job after the pool checked isEmpty()
+      }
+      return &tasks.getElements()[next++];
+    }
+
+    /** Runs jobs in the calling thread until no jobs are left and waits for all jobs to complete. */
+    void help()
+    {
+      while (!isEmpty()) {
+        pop()->run();
+      }
+      for (MemorySize i = 0; i < tasks.getSize(); ++i) {
+        completed.wait();
+      }
+    }
+  };
+}
+
+void ParallelJobs::run()
+{
+  if (!jobs) {
+    return;
+  }
+  Provider provider(jobs.getElements(), jobs.getSize());
+  {
+    ThreadPool pool(&provider, static_cast<unsigned int>(jobs.getSize() - 1));
+    for (MemorySize i = 1; i < jobs.getSize(); ++i) {
+      pool.post();
+    }
+    provider.help();
+  }
+
+  for (Job* job : jobs) {
+    if (job->failed) {
+      job->failed = false;
+      job->process();
+      _throw InvalidException("Parallel job failed.");
+    }
+  }
+}
+
+ParallelJobs::~ParallelJobs()
+{
+  for (Job* job : jobs) {
+    delete job;
+  }
+}
+
+#if defined(_COM_AZURE_DEV__BASE__TESTS)
+
+class TEST_CLASS(ParallelAlgorithm) : public UnitTest {
+public:
+
+  TEST_PRIORITY(50);
+  TEST_PROJECT("base/collection");
+
+  class Item {
+  public:
+
+    unsigned int key = 0;
+    unsigned int order = 0;
+
+    inline bool operator<=(const Item& compare) const noexcept
+    {
+      return key <= compare.key;
+    }
+  };
+
+  static bool isStable(const Array<Item>& items)
+  {
+    for (MemorySize i = 1; i < items.getSize(); ++i) {
+      if ((items[i - 1].key > items[i].key) ||
+          ((items[i - 1].key == items[i].key) && (items[i - 1].order > items[i].order))) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void run() override
+  {
+    Array<int> small = {5, -1, 3, 3, 9, 0, -7, 2};
+    insertionSort(small.begin(), small.end());
+    TEST_EQUAL(small, Array<int>({-7, -1, 0, 2, 3, 3, 5, 9}));
+    small.sort([](int a, int b) { return a >= b; });
+    TEST_EQUAL(small, Array<int>({9, 5, 3, 3, 2, 0, -1, -7}));
+
+    Array<Item> items;
+    items.setSize(100000 + 7);
+    for (MemorySize i = 0; i < items.getSize(); ++i) {
+      items[i].key = Random::random<uint32>() % 1000;
+      items[i].order = static_cast<unsigned int>(i);
+    }
+    Array<Item> copy = items;
+    copy.sort();
+    TEST_ASSERT(isStable(copy));
+    for (unsigned int threads : {1, 2, 3, 4, 7}) {
+      Array<Item> sorted = items;
+      parallelSort(sorted, threads);
+      TEST_ASSERT(isStable(sorted));
+    }
+
+    for (MemorySize size : {0, 1, 31, 33, 1000, 300000}) {
+      Array<int> values;
+      values.setSize(size);
+      for (MemorySize i = 0; i < size; ++i) {
+        values[i] = static_cast<int>(Random::random<uint32>());
+      }
+      Array<int> expected = values;
+      expected.sort();
+      Array<int> sorted = values;
+      parallelSort(sorted, 4);
+      TEST_ASSERT(sorted == expected);
+      sorted = values;
+      parallelSort(sorted, [](int a, int b) { return a >= b; }, 3);
+      bool descending = true;
+      for (MemorySize i = 1; i < size; ++i) {
+        descending = descending && (sorted[i - 1] >= sorted[i]);
+      }
+      TEST_ASSERT(descending);
+      sorted = values;
+      radixSort(sorted);
+      TEST_ASSERT(sorted == expected);
+    }
+
+    Array<int8> bytes = {5, -128, 127, 0, -1, 1};
+    for (unsigned int i = 0; i < 100; ++i) {
+      bytes.append(static_cast<int8>(Random::random<uint32>()));
+    }
+    Array<int8> expectedBytes = bytes;
+    expectedBytes.sort();
+    radixSort(bytes);
+    TEST_ASSERT(bytes == expectedBytes);
+
+    Array<uint64> longs;
+    longs.setSize(5000);
+    for (MemorySize i = 0; i < longs.getSize(); ++i) {
+      longs[i] = (static_cast<uint64>(Random::random<uint32>()) << 32) | (i % 3);
+    }
+    Array<uint64> expectedLongs = longs;
+    expectedLongs.sort();
+    radixSort(longs);
+    TEST_ASSERT(longs == expectedLongs);
+
+    Array<int64> numbers;
+    numbers.setSize(200000);
+    for (MemorySize i = 0; i < numbers.getSize(); ++i) {
+      numbers[i] = static_cast<int64>(i) - 1000;
+    }
+    parallelTransform(numbers, [](int64 value) { return value * 2; }, 4);
+    TEST_EQUAL(numbers[1000], 0);
+    TEST_EQUAL(numbers[199999], 2 * (199999 - 1000));
+    const int64 sum = parallelReduce(numbers, static_cast<int64>(0), [](int64 a, int64 b) { return a + b; }, 4);
+    int64 expectedSum = 0;
+    for (int64 value : numbers) {
+      expectedSum += value;
+    }
+    TEST_EQUAL(sum, expectedSum);
+    TEST_EQUAL(parallelReduce(Array<int64>(), static_cast<int64>(7), [](int64 a, int64 b) { return a + b; }), 7);
+
+    TEST_EQUAL(parallelFind(numbers, [](int64 value) { return value >= 300000; }, 4), 151000);
+    TEST_EQUAL(parallelFind(numbers, [](int64 value) { return value <= -2000; }, 4), 0);
+    TEST_EQUAL(parallelFind(numbers, [](int64 value) { return value == 3; }, 4), -1);
+
+    TEST_EXCEPTION(parallelTransform(numbers, [](int64 value) -> int64 {
+      if (value == 2 * (150000 - 1000)) {
+        _throw OutOfRange();
+      }
+      return value;
+    }, 4), OutOfRange);
+  }
+};
+
+TEST_REGISTER(ParallelAlgorithm);
+
+class TEST_CLASS(ParallelAlgorithmBenchmark) : public UnitTest {
+public:
+
+  TEST_PRIORITY(1000);
+  TEST_PROJECT("base/collection");
+  TEST_IMPACT(LOW);
+  TEST_TIMEOUT_MS(120 * 1000);
+
+  void run() override
+  {
+    Timer timer;
+    {
+      Array<uint32> values;
+      values.setSize(24);
+      Array<uint32> sorted;
+      uint64 sortTime = 0;
+      uint64 bubbleTime = 0;
+      for (unsigned int i = 0; i < 20000; ++i) {
+        for (MemorySize j = 0; j < values.getSize(); ++j) {
+          values[j] = Random::random<uint32>();
+        }
+        sorted = values;
+        timer.start();
+        sorted.sort();
+        sortTime += timer.getLiveMicroseconds();
+        sorted = values;
+        timer.start();
+        bubbleSort(sorted.begin(), sorted.end());
+        bubbleTime += timer.getLiveMicroseconds();
+      }
+      TEST_PRINT(format() << "24 elements x 20000: insertion sort: " << sortTime << " us, bubble sort: " << bubbleTime << " us");
+    }
+
+    for (MemorySize size : {64 * 1024, 1024 * 1024, 4 * 1024 * 1024}) {
+      Array<uint32> values;
+      values.setSize(size);
+      for (MemorySize i = 0; i < size; ++i) {
+        values[i] = Random::random<uint32>();
+      }
+
+      Array<uint32> sorted = values;
+      timer.start();
+      sorted.sort();
+      const uint64 serialTime = timer.getLiveMicroseconds();
+      const Array<uint32> expected = sorted;
+
+      sorted = values;
+      timer.start();
+      radixSort(sorted);
+      const uint64 radixTime = timer.getLiveMicroseconds();
+      TEST_ASSERT(sorted == expected);
+
+      StringOutputStream stream;
+      stream << "Size: " << size << " mergeSort: " << serialTime << " us, radixSort: " << radixTime << " us";
+      for (unsigned int threads : {1, 2, 4, 8}) {
+        sorted = values;
+        timer.start();
+        parallelSort(sorted, threads);
+        const uint64 parallelTime = timer.getLiveMicroseconds();
+        TEST_ASSERT(sorted == expected);
+        stream << ", parallelSort(" << threads << "): " << parallelTime << " us";
+      }
+      stream << FLUSH;
+      TEST_PRINT(stream.getString());
+    }
+    TEST_PRINT(format() << "Processors: " << Process::getNumberOfOnlineProcessors());
+  }
+};
+
+TEST_REGISTER(ParallelAlgorithmBenchmark);
+
+#endif
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
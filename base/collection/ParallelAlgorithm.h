@@ -0,0 +1,475 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#pragma once
+
+#include <base/collection/Algorithm.h>
+#include <base/collection/Array.h>
+#include <base/concurrency/Thread.h>
+#include <base/concurrency/AtomicCounter.h>
+#include <type_traits>
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+/**
+  Jobs for the parallel algorithms. The jobs are run by a ThreadPool and by
+  the calling thread so n threads use a pool of n-1 threads. A failed job is
+  processed again by the calling thread to raise the original exception.
+
+  @short Jobs of parallel algorithm.
+  @version 1.0
+*/
+
+class _COM_AZURE_DEV__BASE__API ParallelJobs {
+public:
+
+  /** The default minimum number of elements per job. */
+  static constexpr MemorySize GRAIN = 32 * 1024;
+
+  /** Job. */
+  class _COM_AZURE_DEV__BASE__API Job : public Runnable {
+  public:
+
+    /** The index of the job. */
+    MemorySize index = 0;
+    /** The first element. */
+    MemorySize begin = 0;
+    /** The end element. */
+    MemorySize end = 0;
+    /** Set if process() raised an exception. */
+    bool failed = false;
+
+    /** Processes the job. */
+    virtual void process() = 0;
+
+    /** Processes the job and catches any exception. */
+    void run() override;
+
+    virtual ~Job();
+  };
+private:
+
+  /** The jobs. */
+  Array<Job*> jobs;
+public:
+
+  /** Returns the number of threads. Returns the number of online processors for 0. */
+  static unsigned int getThreads(unsigned int threads) noexcept;
+
+  /** Returns the number of jobs for the given number of elements. */
+  static MemorySize getNumberOfJobs(MemorySize size, unsigned int threads, MemorySize grain = GRAIN) noexcept;
+
+  /** Initializes empty job list. */
+  ParallelJobs();
+
+  ParallelJobs(const ParallelJobs&) = delete;
+  ParallelJobs& operator=(const ParallelJobs&) = delete;
+
+  /** Adds the job. The job is destroyed with this object. */
+  void add(Job* job);
+
+  /** Runs the jobs and waits for all jobs to complete. Raises the exception of the first failed job. */
+  void run();
+
+  /** Destroys the jobs. */
+  ~ParallelJobs();
+};
+
+/** Job calling body(index, begin, end). */
+template<class BODY>
+class ParallelBodyJob : public ParallelJobs::Job {
+public:
+
+  BODY body;
+
+  inline ParallelBodyJob(const BODY& _body) : body(_body)
+  {
+  }
+
+  void process() override
+  {
+    body(index, begin, end);
+  }
+};
+
+/** Calls body(index, begin, end) for the given number of consecutive parts of [0; size). */
+template<class BODY>
+void parallelRun(MemorySize size, MemorySize count, BODY body)
+{
+  if (count <= 1) {
+    body(0, 0, size);
+    return;
+  }
+  ParallelJobs jobs;
+  for (MemorySize i = 0; i < count; ++i) {
+    ParallelBodyJob<BODY>* job = new ParallelBodyJob<BODY>(body);
+    job->index = i;
+    job->begin = size * i/count;
+    job->end = size * (i + 1)/count;
+    jobs.add(job);
+  }
+  jobs.run();
+}
+
+/**
+  Calls body(begin, end) for consecutive parts of [0; size) in parallel.
+
+  @param threads The number of threads. Uses the number of online processors if 0.
+  @param grain The minimum number of elements per part.
+*/
+template<class BODY>
+void parallelFor(MemorySize size, BODY body, unsigned int threads = 0, MemorySize grain = ParallelJobs::GRAIN)
+{
+  parallelRun(size, ParallelJobs::getNumberOfJobs(size, threads, grain), [&body](MemorySize, MemorySize begin, MemorySize end) {
+    body(begin, end);
+  });
+}
+
+/** Writes operation(src[i]) to dest[i] in parallel. The arrays may be the same. */
+template<class TYPE, class RESULT, class OPERATION>
+void parallelTransform(const TYPE* src, const TYPE* end, RESULT* dest, OPERATION operation, unsigned int threads = 0)
+{
+  parallelFor(end - src, [src, dest, &operation](MemorySize begin, MemorySize end) {
+    for (MemorySize i = begin; i < end; ++i) {
+      dest[i] = operation(src[i]);
+    }
+  }, threads);
+}
+
+/** Replaces each element with operation(element) in parallel. */
+template<class TYPE, class OPERATION>
+void parallelTransform(Array<TYPE>& array, OPERATION operation, unsigned int threads = 0)
+{
+  TYPE* elements = array.getElements();
+  parallelTransform<TYPE, TYPE, OPERATION>(elements, elements + array.getSize(), elements, operation, threads);
+}
+
+/**
+  Returns operation(...operation(operation(identity, src[0]), src[1])..., src[n-1])
+  computed in parallel. The operation must be associative and identity must
+  be the identity of the operation (e.g. 0 for addition). The parts are
+  combined in order so the operation does not have to be commutative.
+*/
+template<class TYPE, class RESULT, class OPERATION>
+RESULT parallelReduce(const TYPE* src, const TYPE* end, const RESULT& identity, OPERATION operation, unsigned int threads = 0)
+{
+  const MemorySize size = end - src;
+  const MemorySize count = ParallelJobs::getNumberOfJobs(size, threads);
+  Array<RESULT> partials;
+  partials.setSize(maximum<MemorySize>(count, 1), identity);
+  RESULT* partial = partials.getElements();
+  parallelRun(size, count, [src, partial, &operation](MemorySize index, MemorySize begin, MemorySize end) {
+    RESULT result = partial[index];
+    for (MemorySize i = begin; i < end; ++i) {
+      result = operation(result, src[i]);
+    }
+    partial[index] = result;
+  });
+  RESULT result = partial[0];
+  for (MemorySize i = 1; i < partials.getSize(); ++i) {
+    result = operation(result, partial[i]);
+  }
+  return result;
+}
+
+/** Returns the reduction of the elements. See parallelReduce(). */
+template<class TYPE, class RESULT, class OPERATION>
+inline RESULT parallelReduce(const Array<TYPE>& array, const RESULT& identity, OPERATION operation, unsigned int threads = 0)
+{
+  const TYPE* elements = array.getFirstReference();
+  return parallelReduce(elements, elements + array.getSize(), identity, operation, threads);
+}
+
+/**
+  Returns the first element for which the predicate is true. Returns end if
+  not found. The parts are searched in parallel and a part stops once an
+  element has been found in an earlier part.
+*/
+template<class TYPE, class PREDICATE>
+const TYPE* parallelFind(const TYPE* src, const TYPE* end, PREDICATE predicate, unsigned int threads = 0)
+{
+  const long long size = end - src;
+  AtomicCounter<long long> found(size);
+  parallelRun(size, ParallelJobs::getNumberOfJobs(size, threads), [src, &found, &predicate](MemorySize, MemorySize begin, MemorySize end) {
+    const MemorySize BLOCK = 4096;
+    for (MemorySize i = begin; i < end; i += BLOCK) {
+      if (static_cast<MemorySize>(static_cast<long long>(found)) < i) {
+        return; // found in earlier part
+      }
+      const MemorySize last = minimum(i + BLOCK, end);
+      for (MemorySize j = i; j < last; ++j) {
+        if (predicate(src[j])) {
+          long long expected = found;
+          while ((static_cast<long long>(j) < expected) && !found.compareAndExchange(expected, j)) {
+          }
+          return;
+        }
+      }
+    }
+  });
+  return src + static_cast<long long>(found);
+}
+
+/** Returns the index of the first element for which the predicate is true. Returns -1 if not found. */
+template<class TYPE, class PREDICATE>
+MemoryDiff parallelFind(const Array<TYPE>& array, PREDICATE predicate, unsigned int threads = 0)
+{
+  const TYPE* elements = array.getFirstReference();
+  const TYPE* end = elements + array.getSize();
+  const TYPE* result = parallelFind(elements, end, predicate, threads);
+  return (result != end) ? (result - elements) : -1;
+}
+
+/** Returns a <= b. */
+class ParallelLessOrEqual {
+public:
+
+  template<class TYPE>
+  inline bool operator()(const TYPE& a, const TYPE& b) const
+  {
+    return a <= b;
+  }
+};
+
+/** Stable merge sort of the given elements using the given buffer. */
+template<class TYPE, class PREDICATE>
+void parallelSortRange(TYPE* begin, MemorySize size, TYPE* buffer, PREDICATE predicate)
+{
+  const MemorySize TINY = 16;
+  for (MemorySize i = 0; i < size; i += TINY) {
+    insertionSort(begin + i, begin + minimum(i + TINY, size), predicate);
+  }
+  TYPE* src = begin;
+  TYPE* dest = buffer;
+  for (MemorySize width = TINY; width < size; width *= 2) {
+    for (MemorySize i = 0; i < size; ) { // merge pair of blocks
+      const MemorySize m = minimum(i + width, size);
+      const MemorySize end = minimum(i + 2 * width, size);
+      mergeSortMerge(src + i, src + m, src + m, src + end, dest + i, predicate);
+      i = end;
+    }
+    swapper(dest, src);
+  }
+  if (src != begin) {
+    for (MemorySize i = 0; i < size; ++i) {
+      begin[i] = moveObject(src[i]);
+    }
+  }
+}
+
+/**
+  Stable parallel merge sort. The parts are sorted in parallel and then
+  merged pairwise in parallel. Each merge is split into independent parts
+  by binary search so all threads are used until the last merge.
+
+  @param predicate Returns true if the first value may be before the second value (e.g. a <= b).
+  @param threads The number of threads. Uses the number of online processors if 0.
+*/
+template<class TYPE, class PREDICATE>
+void parallelSort(TYPE* begin, TYPE* end, PREDICATE predicate, unsigned int threads)
+{
+  ComputeTask profiler("parallelSort()");
+  const MemorySize size = end - begin;
+  const MemorySize count = ParallelJobs::getNumberOfJobs(size, threads);
+  if (size <= 32) {
+    insertionSort(begin, end, predicate);
+    return;
+  }
+  Allocator<TYPE> buffer(size);
+  TYPE* temp = buffer.getElements();
+
+  Array<MemorySize> bounds; // the sorted runs
+  bounds.setSize(count + 1);
+  MemorySize* bound = bounds.getElements();
+  for (MemorySize i = 0; i <= count; ++i) {
+    bound[i] = size * i/count;
+  }
+  parallelRun(size, count, [begin, temp, &predicate](MemorySize, MemorySize first, MemorySize last) {
+    parallelSortRange(begin + first, last - first, temp + first, predicate);
+  });
+
+  TYPE* src = begin;
+  TYPE* dest = temp;
+  MemorySize runs = count;
+  while (runs > 1) {
+    const MemorySize pairs = runs/2;
+    const MemorySize parts = maximum<MemorySize>(count/pairs, 1); // per pair
+
+    // the parts of each merge are found by binary search in the second run
+    class Part {
+    public:
+
+      MemorySize a = 0;
+      MemorySize aEnd = 0;
+      MemorySize b = 0;
+      MemorySize bEnd = 0;
+      /** The first destination element. */
+      MemorySize offset = 0;
+    };
+    Array<Part> merges;
+    merges.setSize(pairs * parts + (runs % 2));
+    Part* merge = merges.getElements();
+    for (MemorySize p = 0; p < pairs; ++p) {
+      const MemorySize a = bound[2 * p];
+      const MemorySize b = bound[2 * p + 1];
+      const MemorySize bEnd = bound[2 * p + 2];
+      MemorySize previousA = a;
+      MemorySize previousB = b;
+      for (MemorySize k = 1; k <= parts; ++k) {
+        MemorySize splitA = b;
+        MemorySize splitB = bEnd;
+        if (k < parts) {
+          splitA = a + (b - a) * k/parts;
+          if (splitA < b) {
+            MemorySize low = previousB;
+            MemorySize high = bEnd;
+            while (low < high) { // first element of second run after src[splitA]
+              const MemorySize middle = low + (high - low)/2;
+              if (predicate(src[splitA], src[middle])) {
+                high = middle;
+              } else {
+                low = middle + 1;
+              }
+            }
+            splitB = low;
+          }
+        }
+        merge->a = previousA;
+        merge->aEnd = splitA;
+        merge->b = previousB;
+        merge->bEnd = splitB;
+        merge->offset = previousA + (previousB - b);
+        ++merge;
+        previousA = splitA;
+        previousB = splitB;
+      }
+    }
+    if (runs % 2) { // last run is moved
+      merge->a = bound[runs - 1];
+      merge->aEnd = bound[runs];
+      merge->b = bound[runs];
+      merge->bEnd = bound[runs];
+      merge->offset = merge->a;
+    }
+
+    const Part* _merges = merges.getFirstReference();
+    parallelRun(merges.getSize(), merges.getSize(), [src, dest, _merges, &predicate](MemorySize index, MemorySize, MemorySize) {
+      const Part& part = _merges[index];
+      mergeSortMerge(
+        src + part.a, src + part.aEnd, src + part.b, src + part.bEnd, dest + part.offset, predicate
+      );
+    });
+
+    for (MemorySize i = 0; i <= pairs; ++i) {
+      bound[i] = bound[minimum(2 * i, runs)];
+    }
+    if (runs % 2) {
+      bound[pairs + 1] = bound[runs];
+    }
+    runs = pairs + (runs % 2);
+    swapper(src, dest);
+  }
+
+  if (src != begin) {
+    parallelRun(size, count, [begin, src](MemorySize, MemorySize first, MemorySize last) {
+      for (MemorySize i = first; i < last; ++i) {
+        begin[i] = moveObject(src[i]);
+      }
+    });
+  }
+}
+
+/** Stable parallel merge sort. operator<= used for comparison of values. See parallelSort(). */
+template<class TYPE>
+inline void parallelSort(TYPE* begin, TYPE* end, unsigned int threads = 0)
+{
+  parallelSort(begin, end, ParallelLessOrEqual(), threads);
+}
+
+/** Sorts the array. See parallelSort(). */
+template<class TYPE, class PREDICATE>
+inline void parallelSort(Array<TYPE>& array, PREDICATE predicate, unsigned int threads)
+{
+  TYPE* elements = array.getElements();
+  parallelSort(elements, elements + array.getSize(), predicate, threads);
+}
+
+/** Sorts the array. See parallelSort(). */
+template<class TYPE>
+inline void parallelSort(Array<TYPE>& array, unsigned int threads = 0)
+{
+  TYPE* elements = array.getElements();
+  parallelSort(elements, elements + array.getSize(), ParallelLessOrEqual(), threads);
+}
+
+/**
+  LSD radix sort for integers. O(n). Stable. Sorts a byte at a time using a
+  buffer of the same size and skips bytes which are the same for all values.
+*/
+template<class TYPE>
+void radixSort(TYPE* begin, TYPE* end)
+{
+  static_assert(std::is_integral<TYPE>::value && !std::is_same<TYPE, bool>::value, "Integer type required.");
+  ComputeTask profiler("radixSort()");
+  typedef typename std::make_unsigned<TYPE>::type Unsigned;
+  const Unsigned FLIP = std::is_signed<TYPE>::value ? (static_cast<Unsigned>(1) << (sizeof(TYPE) * 8 - 1)) : 0;
+  const MemorySize size = end - begin;
+  if (size <= 64) {
+    insertionSort(begin, end);
+    return;
+  }
+
+  MemorySize counts[sizeof(TYPE)][256];
+  fill<MemorySize>(&counts[0][0], sizeof(TYPE) * 256, 0);
+  for (const TYPE* src = begin; src != end; ++src) { // histogram of all bytes in one pass
+    const Unsigned key = static_cast<Unsigned>(*src) ^ FLIP;
+    for (unsigned int d = 0; d < sizeof(TYPE); ++d) {
+      ++counts[d][(key >> (d * 8)) & 0xff];
+    }
+  }
+
+  Allocator<TYPE> buffer(size);
+  TYPE* src = begin;
+  TYPE* dest = buffer.getElements();
+  for (unsigned int d = 0; d < sizeof(TYPE); ++d) {
+    MemorySize* count = counts[d];
+    const unsigned int shift = d * 8;
+    if (count[(static_cast<Unsigned>(*src) ^ FLIP) >> shift & 0xff] == size) {
+      continue; // same byte for all values
+    }
+    MemorySize offset = 0;
+    for (unsigned int i = 0; i < 256; ++i) {
+      const MemorySize n = count[i];
+      count[i] = offset;
+      offset += n;
+    }
+    for (MemorySize i = 0; i < size; ++i) {
+      const TYPE value = src[i];
+      dest[count[((static_cast<Unsigned>(value) ^ FLIP) >> shift) & 0xff]++] = value;
+    }
+    swapper(src, dest);
+  }
+  if (src != begin) {
+    copy<TYPE>(begin, src, size);
+  }
+}
+
+/** Sorts the array. See radixSort(). */
+template<class TYPE>
+inline void radixSort(Array<TYPE>& array)
+{
+  TYPE* elements = array.getElements();
+  radixSort(elements, elements + array.getSize());
+}
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
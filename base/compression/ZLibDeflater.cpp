@@ -153,7 +153,7 @@ MemorySize ZLibDeflater::push(const uint8* buffer, MemorySize _size)
   int code = deflate(context, internal::ZLibDeflater::NO_FLUSH);
   bassert(code == internal::ZLibDeflater::OK, IOException(this));
   availableBytes = static_cast<unsigned int>(this->buffer.getSize()) - context->avail_out;
-  return context->total_out;
+  return context->total_in;
 #else
   _COM_AZURE_DEV__BASE__NOT_SUPPORTED();
 #endif
@@ -127,7 +127,7 @@ MemorySize ZLibInflater::push(const uint8* buffer, MemorySize _size)
 void ZLibInflater::pushEnd()
 {
 #if (defined(_COM_AZURE_DEV__BASE__USE_ZLIB))
-  if (state != ENDED) {
+  if ((state != ENDED) && (state != FINISHED)) { // FINISHED once the end of the stream has been pushed
     bassert(state == RUNNING, IOException(this));
     state = FINISHING;
   }
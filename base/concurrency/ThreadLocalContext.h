@@ -51,6 +51,14 @@ public:
   StringOutputStream stringOutputStream;
   /** String output stream. */
   unsigned int stringOutputStreamUsage = 0;
+  /**
+    Line output stream used by ThreadFormatOutputStream. Separate from
+    stringOutputStream since formatting a line may itself claim
+    stringOutputStream (e.g. ThreadStringOutputStream used by Format::Subst).
+  */
+  StringOutputStream lineOutputStream;
+  /** Usage of line output stream. */
+  unsigned int lineOutputStreamUsage = 0;
   /** Random generator. */
   RandomInputStream randomInputStream;
   /** Last known stack trace for exception. */
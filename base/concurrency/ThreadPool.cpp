@@ -151,6 +151,9 @@ void ThreadPool::terminate() noexcept
   ExclusiveSynchronize<Guard> _guard(guard);
   terminated = true;
   forEach(pool, invokeMember(&Thread::terminate));
+  for (MemorySize i = 0; i < pool.getSize(); ++i) {
+    semaphore.post(); // wake waiting threads
+  }
 }
 
 void ThreadPool::join() noexcept
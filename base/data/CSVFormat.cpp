@@ -14,11 +14,35 @@
 #include <base/data/CSVFormat.h>
 #include <base/string/StringOutputStream.h>
 #include <base/string/LineReader.h>
+#include <base/string/ByteScanner.h>
 #include <base/io/FileInputStream.h>
 #include <base/io/EndOfFile.h>
+#include <base/UnitTest.h>
 
 _COM_AZURE_DEV__BASE__ENTER_NAMESPACE
 
+namespace {
+
+  /** Sets the field at the given index. Reuses the fields of the previous line. */
+  inline void setField(Array<String>& result, MemorySize index, const String& field)
+  {
+    if (index < result.getSize()) {
+      result[index] = field;
+    } else {
+      result.append(field);
+    }
+  }
+
+  /** Returns the end of the given bytes without the ending spaces. */
+  inline const uint8* trimEnd(const uint8* begin, const uint8* end) noexcept
+  {
+    while ((end != begin) && (end[-1] == ' ')) {
+      --end;
+    }
+    return end;
+  }
+}
+
 String CSVFormat::quote(const String& text)
 {
   String result(text.getLength() + 2);
@@ -104,7 +128,11 @@ String CSVFormat::join(const std::initializer_list<String>& items)
 
 void CSVFormat::parse(const String& line, Array<String>& result)
 {
-  // TAG: add support for reusing result buffers
+  if (separator < 0x80) {
+    parseBytes(line, result);
+    return;
+  }
+
   result.setSize(0);
   
   String field = String::makeCapacity(1024);
@@ -200,6 +228,81 @@ void CSVFormat::parse(const String& line, Array<String>& result)
   field.forceToLength(0);
 }
 
+void CSVFormat::parseBytes(const String& line, Array<String>& result)
+{
+  // the separator, quote, and backslash never occur within UTF-8 sequences so we can scan bytes
+  const uint8 separator = static_cast<uint8>(this->separator);
+  const uint8* src = reinterpret_cast<const uint8*>(line.native());
+  const uint8* end = src + line.getLength();
+  MemorySize count = 0;
+  String field;
+  while (true) {
+    if (trimSpaces) { // trim initial spaces
+      while ((src != end) && (*src == ' ')) {
+        ++src;
+      }
+    }
+
+    const uint8* begin = src;
+    src = ByteScanner::findAny(src, end, separator, '"');
+    if ((src == end) || (*src == separator)) { // common case without quotes
+      const uint8* fieldEnd = trimSpaces ? trimEnd(begin, src) : src;
+      setField(result, count++, String(reinterpret_cast<const char*>(begin), fieldEnd - begin));
+      if (src == end) {
+        break;
+      }
+      ++src; // skip separator
+      continue;
+    }
+
+    field.forceToLength(0);
+    field.append(ConstSpan<char>(reinterpret_cast<const char*>(begin), src - begin));
+    ++src; // skip quote
+    bool closed = false;
+    while (!closed) {
+      begin = src;
+      src = ByteScanner::findAny(src, end, '"', '\\');
+      field.append(ConstSpan<char>(reinterpret_cast<const char*>(begin), src - begin));
+      if (src == end) { // unterminated quote
+        break;
+      }
+      if (*src == '\\') { // escape
+        if (((src + 1) == end) || (src[1] != '"')) {
+          _throw InvalidFormat("Invalid CSV format.");
+        }
+        field.append('"');
+        src += 2;
+      } else if (((src + 1) != end) && (src[1] == '"')) { // escaped quote
+        field.append('"');
+        src += 2;
+      } else {
+        closed = true;
+        ++src;
+      }
+    }
+
+    if (!closed) {
+      if (trimSpaces) {
+        field.removeFrom(trimEnd(field.getBytes(), field.getBytes() + field.getLength()) - field.getBytes());
+      }
+      setField(result, count++, field.copy());
+      break;
+    }
+
+    while ((src != end) && (*src == ' ')) {
+      ++src;
+    }
+    setField(result, count++, field.copy());
+    if (src == end) {
+      break;
+    }
+    if (*src++ != separator) {
+      _throw InvalidFormat("Expected separator.");
+    }
+  }
+  result.setSize(count);
+}
+
 Array<Array<String> > CSVFormat::load(InputStream* is)
 {
   Array<Array<String> > result;
@@ -239,4 +342,85 @@ void CSVFormat::load(InputStream* is, LineConsumer* consumer)
   }
 }
 
+void CSVFormat::load(const uint8* src, const uint8* end, LineConsumer* consumer)
+{
+  Array<String> fields;
+  fields.ensureCapacity(128);
+  String line;
+  while (src != end) {
+    const uint8* begin = src;
+    src = ByteScanner::findEndOfLine(src, end);
+    if (src != begin) {
+      line = String(reinterpret_cast<const char*>(begin), src - begin);
+      parse(line, fields);
+      (*consumer)(fields);
+    }
+    if (src != end) {
+      ++src; // eol
+    }
+  }
+}
+
+#if defined(_COM_AZURE_DEV__BASE__TESTS)
+
+class TEST_CLASS(CSVFormat) : public UnitTest {
+public:
+
+  TEST_PRIORITY(200);
+  TEST_PROJECT("base/data");
+
+  static String join(const Array<String>& fields)
+  {
+    String result;
+    for (const auto& field : fields) {
+      result += '[';
+      result += field;
+      result += ']';
+    }
+    return result;
+  }
+
+  void run() override
+  {
+    CSVFormat csv;
+    Array<String> fields;
+    csv.parse("a;bc;;d", fields);
+    TEST_EQUAL(join(fields), "[a][bc][][d]");
+    csv.parse("  a  ;  b c ;", fields);
+    TEST_EQUAL(join(fields), "[a][b c][]");
+    csv.parse("a; ", fields);
+    TEST_EQUAL(join(fields), "[a][]");
+    csv.parse("", fields);
+    TEST_EQUAL(join(fields), "[]");
+    csv.parse("\"a; b \" ; \"\";x", fields);
+    TEST_EQUAL(join(fields), "[a; b ][][x]");
+    csv.parse("\"say \"\"hi\"\"\";\"esc \\\"q\\\"\"", fields);
+    TEST_EQUAL(join(fields), "[say \"hi\"][esc \"q\"]");
+    csv.parse("a\\b;x\"y;z\";w", fields);
+    TEST_EQUAL(join(fields), "[a\\b][xy;z][w]");
+    csv.parse("\"open ", fields);
+    TEST_EQUAL(join(fields), "[open]");
+    csv.parse("\xc3\xa6\xc3\xb8;\"\xc3\xa5\"", fields);
+    TEST_EQUAL(join(fields), "[\xc3\xa6\xc3\xb8][\xc3\xa5]");
+    csv.parse("a;b;c;d;e;f;g;h;i;j;k;l;m;n;o;p;q;r;s;t;u;v;w;x;y;z", fields);
+    TEST_EQUAL(fields.getSize(), 26);
+    TEST_EQUAL(fields[25], "z");
+    TEST_EXCEPTION(csv.parse("\"a\" b;c", fields), InvalidFormat);
+    TEST_EXCEPTION(csv.parse("\"a\\b\"", fields), InvalidFormat);
+    TEST_EXCEPTION(csv.parse("\"a\\", fields), InvalidFormat);
+
+    CSVFormat untrimmed(',', false);
+    untrimmed.parse(" a , b ", fields);
+    TEST_EQUAL(join(fields), "[ a ][ b ]");
+
+    CSVFormat wide(0x2502);
+    wide.parse("a \xe2\x94\x82 b", fields);
+    TEST_EQUAL(join(fields), "[a][b]");
+  }
+};
+
+TEST_REGISTER(CSVFormat);
+
+#endif
+
 _COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
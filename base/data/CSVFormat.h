@@ -26,6 +26,9 @@ private:
 
   ucs4 separator = ';';
   bool trimSpaces = true;
+
+  /** Parses line for a separator within ASCII. */
+  void parseBytes(const String& line, Array<String>& result);
 public:
 
   /** Quote string. */
@@ -43,7 +46,7 @@ public:
   /** Joing items into row. */
   String join(const std::initializer_list<String>& items);
 
-  /** Parses line. */
+  /** Parses line. The fields of the given array are reused. */
   void parse(const String& line, Array<String>& result);
 
   /** Loads CSV data. */
@@ -61,6 +64,13 @@ public:
   
   /** Loads CSV data. */
   void load(InputStream* is, LineConsumer* consumer);
+
+  /**
+    Loads CSV data from memory. Both CR and LF end a line and blank lines are
+    skipped like for LineReader. A record never spans lines so the data can be
+    split after any CR or LF.
+  */
+  void load(const uint8* src, const uint8* end, LineConsumer* consumer);
 };
 
 _COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
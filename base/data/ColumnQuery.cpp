@@ -0,0 +1,1687 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#include <base/data/ColumnQuery.h>
+#include <base/concurrency/Process.h>
+#include <base/concurrency/Thread.h>
+#include <base/string/StringOutputStream.h>
+#include <base/Timer.h>
+#include <base/Random.h>
+#include <base/UnitTest.h>
+
+#if (_COM_AZURE_DEV__BASE__COMPILER == _COM_AZURE_DEV__BASE__COMPILER_MSC)
+#  include <intrin.h>
+#endif
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+namespace {
+
+  typedef ColumnTable::Column Column;
+
+  /** Marks a missing group. */
+  constexpr uint32 NONE = 0xffffffff;
+
+  /** The number of rows processed at a time by groupBy(). */
+  constexpr MemorySize BATCH_SIZE = 1024;
+
+  /** Returns the index of the lowest set bit. Value must not be 0. */
+  inline unsigned int getLowestBit(uint64 value) noexcept
+  {
+#if (_COM_AZURE_DEV__BASE__COMPILER == _COM_AZURE_DEV__BASE__COMPILER_GCC) || \
+    (_COM_AZURE_DEV__BASE__COMPILER == _COM_AZURE_DEV__BASE__COMPILER_LLVM)
+    return __builtin_ctzll(value);
+#elif (_COM_AZURE_DEV__BASE__COMPILER == _COM_AZURE_DEV__BASE__COMPILER_MSC) && defined(_M_X64)
+    unsigned long result = 0;
+    _BitScanForward64(&result, value);
+    return result;
+#else
+    unsigned int result = 0;
+    while (!(value & 1)) {
+      value >>= 1;
+      ++result;
+    }
+    return result;
+#endif
+  }
+
+  /** Returns true if the value of the row is present. */
+  inline bool isPresent(const uint64* valid, MemorySize row) noexcept
+  {
+    return !valid || ((valid[row/64] >> (row % 64)) & 1);
+  }
+
+  /** Returns true for bool and integer columns. */
+  inline bool isIntegral(DataTable::Type type) noexcept
+  {
+    return (type == DataTable::TYPE_BOOL) || (type == DataTable::TYPE_INT32) || (type == DataTable::TYPE_INT64);
+  }
+
+  /** Returns the hash key of the value. */
+  inline uint64 toKey(int64 value) noexcept
+  {
+    return static_cast<uint64>(value);
+  }
+
+  /** Returns the hash key of the value. */
+  inline uint64 toKey(int32 value) noexcept
+  {
+    return toKey(static_cast<int64>(value));
+  }
+
+  /** Returns the hash key of the value. */
+  inline uint64 toKey(uint8 value) noexcept
+  {
+    return value;
+  }
+
+  /** Returns the hash key of the dictionary code. */
+  inline uint64 toKey(uint32 code) noexcept
+  {
+    return code;
+  }
+
+  /** Returns the hash key of the value. Zeros and NaNs are normalized. */
+  inline uint64 toKey(double value) noexcept
+  {
+    if (value == 0) {
+      return 0; // -0
+    }
+    if (value != value) {
+      return 0x7ff8000000000000ULL;
+    }
+    uint64 result = 0;
+    copy<uint8>(reinterpret_cast<uint8*>(&result), reinterpret_cast<const uint8*>(&value), sizeof(result));
+    return result;
+  }
+
+  /** Returns the hash key of the value. */
+  inline uint64 toKey(float value) noexcept
+  {
+    return toKey(static_cast<double>(value));
+  }
+
+  /** Returns the value of the hash key. */
+  inline double toDouble(uint64 key) noexcept
+  {
+    double result = 0;
+    copy<uint8>(reinterpret_cast<uint8*>(&result), reinterpret_cast<const uint8*>(&key), sizeof(result));
+    return result;
+  }
+
+  template<typename TYPE>
+  inline void getKeys(const TYPE* values, const MemorySize* rows, MemorySize count, uint64* keys) noexcept
+  {
+    for (MemorySize i = 0; i < count; ++i) {
+      keys[i] = toKey(values[rows[i]]);
+    }
+  }
+
+  /** Returns the hash keys of the given rows. */
+  void getKeys(const Column& column, const MemorySize* rows, MemorySize count, uint64* keys) noexcept
+  {
+    switch (column.getType()) {
+    case DataTable::TYPE_BOOL:
+      getKeys(column.getBools(), rows, count, keys);
+      break;
+    case DataTable::TYPE_INT32:
+      getKeys(column.getInts(), rows, count, keys);
+      break;
+    case DataTable::TYPE_INT64:
+      getKeys(column.getLongs(), rows, count, keys);
+      break;
+    case DataTable::TYPE_FLOAT32:
+      getKeys(column.getFloats(), rows, count, keys);
+      break;
+    case DataTable::TYPE_FLOAT64:
+      getKeys(column.getDoubles(), rows, count, keys);
+      break;
+    case DataTable::TYPE_STRING:
+    default:
+      getKeys(column.getCodes(), rows, count, keys);
+    }
+  }
+
+  /** Open addressing hash map from 64-bit key to 32-bit value. */
+  class KeyMap {
+  private:
+
+    Array<uint64> keys;
+    Array<uint32> values;
+    uint64* _keys = nullptr;
+    uint32* _values = nullptr;
+    MemorySize mask = 0;
+    MemorySize size = 0;
+
+    /** Returns the bucket for the key. Hash<uint64> is the identity which clusters sequential keys. */
+    static inline MemorySize getBucket(uint64 key) noexcept
+    {
+      key ^= key >> 33;
+      key *= 0xff51afd7ed558ccdULL;
+      key ^= key >> 33;
+      return static_cast<MemorySize>(key);
+    }
+
+    void setCapacity(MemorySize capacity)
+    {
+      Array<uint64> oldKeys = keys;
+      Array<uint32> oldValues = values;
+      keys = Array<uint64>();
+      values = Array<uint32>();
+      keys.setSize(capacity, 0);
+      values.setSize(capacity, NONE);
+      _keys = keys.getElements();
+      _values = values.getElements();
+      mask = capacity - 1;
+      const uint64* src = oldKeys.getFirstReference();
+      const uint32* value = oldValues.getFirstReference();
+      for (MemorySize i = 0; i < oldValues.getSize(); ++i) {
+        if (value[i] != NONE) {
+          MemorySize bucket = getBucket(src[i]) & mask;
+          while (_values[bucket] != NONE) {
+            bucket = (bucket + 1) & mask;
+          }
+          _keys[bucket] = src[i];
+          _values[bucket] = value[i];
+        }
+      }
+    }
+  public:
+
+    KeyMap()
+    {
+      setCapacity(64);
+    }
+
+    KeyMap(const KeyMap&) = delete;
+    KeyMap& operator=(const KeyMap&) = delete;
+
+    /** Returns the value for the key. Returns NONE if not found. */
+    inline uint32 find(uint64 key) const noexcept
+    {
+      for (MemorySize bucket = getBucket(key) & mask; ; bucket = (bucket + 1) & mask) {
+        if (_values[bucket] == NONE) {
+          return NONE;
+        }
+        if (_keys[bucket] == key) {
+          return _values[bucket];
+        }
+      }
+    }
+
+    /** Returns the value for the key. Adds the given value if not found. */
+    inline uint32 add(uint64 key, uint32 value)
+    {
+      MemorySize bucket = getBucket(key) & mask;
+      for (; _values[bucket] != NONE; bucket = (bucket + 1) & mask) {
+        if (_keys[bucket] == key) {
+          return _values[bucket];
+        }
+      }
+      if ((size + 1) * 2 > (mask + 1)) { // keep load below 50%
+        setCapacity((mask + 1) * 2);
+        return add(key, value);
+      }
+      _keys[bucket] = key;
+      _values[bucket] = value;
+      ++size;
+      return value;
+    }
+  };
+
+  /** Assigns a group index per distinct key in order of first occurrence. */
+  class Groups {
+  private:
+
+    /** Group per dictionary code or bool value. */
+    Array<uint32> dense;
+    uint32* _dense = nullptr;
+    KeyMap map;
+    uint32 nullGroup = NONE;
+    /** The key per group. */
+    Array<uint64> keys;
+
+    inline uint32 addGroup(uint64 key)
+    {
+      const uint32 result = static_cast<uint32>(keys.getSize());
+      keys.append(key);
+      return result;
+    }
+  public:
+
+    Groups(const Column& column)
+    {
+      MemorySize size = 0;
+      switch (column.getType()) {
+      case DataTable::TYPE_BOOL:
+        size = 2;
+        break;
+      case DataTable::TYPE_STRING:
+        size = column.getDictionary().getSize();
+        break;
+      default:
+        ;
+      }
+      if (size) {
+        dense.setSize(size, NONE);
+        _dense = dense.getElements();
+      }
+    }
+
+    Groups(const Groups&) = delete;
+    Groups& operator=(const Groups&) = delete;
+
+    /** Returns the number of groups. */
+    inline MemorySize getSize() const noexcept
+    {
+      return keys.getSize();
+    }
+
+    /** Returns the key of the group. */
+    inline uint64 getKey(uint32 group) const noexcept
+    {
+      return keys.getFirstReference()[group];
+    }
+
+    /** Returns true if the group is for missing values. */
+    inline bool isNull(uint32 group) const noexcept
+    {
+      return group == nullGroup;
+    }
+
+    /** Returns the group for missing values. */
+    inline uint32 getNullGroup()
+    {
+      if (nullGroup == NONE) {
+        nullGroup = addGroup(0);
+      }
+      return nullGroup;
+    }
+
+    /** Returns the group for the key. */
+    inline uint32 getGroup(uint64 key)
+    {
+      if (_dense) {
+        uint32& group = _dense[key];
+        if (group == NONE) {
+          group = addGroup(key);
+        }
+        return group;
+      }
+      const uint32 group = map.add(key, static_cast<uint32>(keys.getSize()));
+      if (group == keys.getSize()) {
+        keys.append(key);
+      }
+      return group;
+    }
+  };
+
+  /** Accumulates count, sum, minimum, and maximum per group. Integer columns accumulate as int64. */
+  class Accumulator {
+  public:
+
+    const Column* column = nullptr;
+    bool integral = false;
+    Array<int64> counts;
+    Array<int64> longSums;
+    Array<int64> longMinimums;
+    Array<int64> longMaximums;
+    Array<double> sums;
+    Array<double> minimums;
+    Array<double> maximums;
+
+    void setSize(MemorySize size)
+    {
+      counts.setSize(size, 0);
+      if (column->getType() == DataTable::TYPE_STRING) {
+        return;
+      }
+      if (integral) {
+        longSums.setSize(size, 0);
+        longMinimums.setSize(size, 0);
+        longMaximums.setSize(size, 0);
+      } else {
+        sums.setSize(size, 0);
+        minimums.setSize(size, 0);
+        maximums.setSize(size, 0);
+      }
+    }
+
+    template<typename TYPE, typename ACCUMULATOR>
+    static void update(
+      const TYPE* values, const uint64* valid, const MemorySize* rows, const uint32* groups, MemorySize size,
+      int64* counts, ACCUMULATOR* sums, ACCUMULATOR* minimums, ACCUMULATOR* maximums) noexcept
+    {
+      for (MemorySize i = 0; i < size; ++i) {
+        const MemorySize row = rows[i];
+        if (valid && !isPresent(valid, row)) {
+          continue;
+        }
+        const uint32 group = groups[i];
+        const ACCUMULATOR value = values[row];
+        const bool first = !counts[group];
+        sums[group] += value;
+        minimums[group] = (first || (value < minimums[group])) ? value : minimums[group];
+        maximums[group] = (first || (value > maximums[group])) ? value : maximums[group];
+        ++counts[group];
+      }
+    }
+
+    /** Accumulates the values of the rows. */
+    void update(const MemorySize* rows, const uint32* groups, MemorySize size) noexcept
+    {
+      const uint64* valid = column->getValidBitmap();
+      int64* _counts = counts.getElements();
+      switch (column->getType()) {
+      case DataTable::TYPE_BOOL:
+        update(column->getBools(), valid, rows, groups, size, _counts, longSums.getElements(), longMinimums.getElements(), longMaximums.getElements());
+        break;
+      case DataTable::TYPE_INT32:
+        update(column->getInts(), valid, rows, groups, size, _counts, longSums.getElements(), longMinimums.getElements(), longMaximums.getElements());
+        break;
+      case DataTable::TYPE_INT64:
+        update(column->getLongs(), valid, rows, groups, size, _counts, longSums.getElements(), longMinimums.getElements(), longMaximums.getElements());
+        break;
+      case DataTable::TYPE_FLOAT32:
+        update(column->getFloats(), valid, rows, groups, size, _counts, sums.getElements(), minimums.getElements(), maximums.getElements());
+        break;
+      case DataTable::TYPE_FLOAT64:
+        update(column->getDoubles(), valid, rows, groups, size, _counts, sums.getElements(), minimums.getElements(), maximums.getElements());
+        break;
+      case DataTable::TYPE_STRING:
+      default:
+        for (MemorySize i = 0; i < size; ++i) {
+          _counts[groups[i]] += isPresent(valid, rows[i]) ? 1 : 0;
+        }
+      }
+    }
+
+    template<typename ACCUMULATOR>
+    static void merge(Array<ACCUMULATOR>& sums, Array<ACCUMULATOR>& minimums, Array<ACCUMULATOR>& maximums, bool first,
+      uint32 group, const Array<ACCUMULATOR>& otherSums, const Array<ACCUMULATOR>& otherMinimums, const Array<ACCUMULATOR>& otherMaximums, uint32 other)
+    {
+      sums[group] += otherSums[other];
+      minimums[group] = first ? otherMinimums[other] : minimum(minimums[group], otherMinimums[other]);
+      maximums[group] = first ? otherMaximums[other] : maximum(maximums[group], otherMaximums[other]);
+    }
+
+    /** Adds the accumulated values of the other group to the group. */
+    void merge(uint32 group, const Accumulator& accumulator, uint32 other)
+    {
+      const int64 count = accumulator.counts[other];
+      if (!count) {
+        return;
+      }
+      const bool first = !counts[group];
+      counts[group] += count;
+      if (column->getType() == DataTable::TYPE_STRING) {
+        return;
+      }
+      if (integral) {
+        merge(longSums, longMinimums, longMaximums, first, group, accumulator.longSums, accumulator.longMinimums, accumulator.longMaximums, other);
+      } else {
+        merge(sums, minimums, maximums, first, group, accumulator.sums, accumulator.minimums, accumulator.maximums, other);
+      }
+    }
+  };
+
+  /** Returns a == b. */
+  class Equal {
+  public:
+
+    template<typename A, typename B>
+    inline bool operator()(A a, B b) const noexcept
+    {
+      return a == b;
+    }
+  };
+
+  /** Returns a != b. */
+  class NotEqual {
+  public:
+
+    template<typename A, typename B>
+    inline bool operator()(A a, B b) const noexcept
+    {
+      return a != b;
+    }
+  };
+
+  /** Returns a < b. */
+  class Less {
+  public:
+
+    template<typename A, typename B>
+    inline bool operator()(A a, B b) const noexcept
+    {
+      return a < b;
+    }
+  };
+
+  /** Returns a <= b. */
+  class LessEqual {
+  public:
+
+    template<typename A, typename B>
+    inline bool operator()(A a, B b) const noexcept
+    {
+      return a <= b;
+    }
+  };
+
+  /** Returns a > b. */
+  class Greater {
+  public:
+
+    template<typename A, typename B>
+    inline bool operator()(A a, B b) const noexcept
+    {
+      return a > b;
+    }
+  };
+
+  /** Returns a >= b. */
+  class GreaterEqual {
+  public:
+
+    template<typename A, typename B>
+    inline bool operator()(A a, B b) const noexcept
+    {
+      return a >= b;
+    }
+  };
+
+  /** Returns the precomputed match of the dictionary code. */
+  class Match {
+  public:
+
+    const uint8* matches = nullptr;
+
+    inline Match(const uint8* _matches) noexcept : matches(_matches)
+    {
+    }
+
+    inline bool operator()(uint32 code, int) const noexcept
+    {
+      return matches[code] != 0;
+    }
+  };
+
+  /**
+    Writes the rows for which compare(value, comparand) holds and the value is
+    present. Without rows the positions are the row indices and begin must be
+    a multiple of 64. Returns the number of rows written.
+  */
+  template<typename TYPE, typename WIDE, typename COMPARE>
+  MemorySize filter(
+    const TYPE* values, const uint64* valid, const MemorySize* rows, MemorySize begin, MemorySize end,
+    COMPARE compare, WIDE comparand, MemorySize* dest) noexcept
+  {
+    MemorySize* const first = dest;
+    if (!rows) {
+      for (MemorySize i = begin; i < end; i += 64) {
+        const MemorySize count = minimum<MemorySize>(end - i, 64);
+        const TYPE* src = values + i;
+        uint64 mask = 0;
+        for (MemorySize j = 0; j < count; ++j) { // branch-free - vectorizable
+          mask |= static_cast<uint64>(compare(src[j], comparand) ? 1 : 0) << j;
+        }
+        if (valid) {
+          mask &= valid[i/64];
+        }
+        while (mask) {
+          *dest++ = i + getLowestBit(mask);
+          mask &= mask - 1;
+        }
+      }
+    } else {
+      for (MemorySize i = begin; i < end; ++i) {
+        const MemorySize row = rows[i];
+        *dest = row;
+        dest += (compare(values[row], comparand) && isPresent(valid, row)) ? 1 : 0;
+      }
+    }
+    return dest - first;
+  }
+
+  template<typename TYPE, typename WIDE>
+  MemorySize filter(
+    const TYPE* values, const uint64* valid, const MemorySize* rows, MemorySize begin, MemorySize end,
+    ColumnQuery::Operator op, WIDE comparand, MemorySize* dest) noexcept
+  {
+    switch (op) {
+    case ColumnQuery::OPERATOR_EQUAL:
+      return filter(values, valid, rows, begin, end, Equal(), comparand, dest);
+    case ColumnQuery::OPERATOR_NOT_EQUAL:
+      return filter(values, valid, rows, begin, end, NotEqual(), comparand, dest);
+    case ColumnQuery::OPERATOR_LESS:
+      return filter(values, valid, rows, begin, end, Less(), comparand, dest);
+    case ColumnQuery::OPERATOR_LESS_EQUAL:
+      return filter(values, valid, rows, begin, end, LessEqual(), comparand, dest);
+    case ColumnQuery::OPERATOR_GREATER:
+      return filter(values, valid, rows, begin, end, Greater(), comparand, dest);
+    case ColumnQuery::OPERATOR_GREATER_EQUAL:
+    default:
+      return filter(values, valid, rows, begin, end, GreaterEqual(), comparand, dest);
+    }
+  }
+
+  /** Returns true if the result of compareTo() matches the operator. */
+  inline bool isMatch(ColumnQuery::Operator op, int comparison) noexcept
+  {
+    switch (op) {
+    case ColumnQuery::OPERATOR_EQUAL:
+      return comparison == 0;
+    case ColumnQuery::OPERATOR_NOT_EQUAL:
+      return comparison != 0;
+    case ColumnQuery::OPERATOR_LESS:
+      return comparison < 0;
+    case ColumnQuery::OPERATOR_LESS_EQUAL:
+      return comparison <= 0;
+    case ColumnQuery::OPERATOR_GREATER:
+      return comparison > 0;
+    case ColumnQuery::OPERATOR_GREATER_EQUAL:
+    default:
+      return comparison >= 0;
+    }
+  }
+
+  template<typename KEY>
+  class SortEntry {
+  public:
+
+    KEY key;
+    MemorySize row;
+  };
+
+  class Ascending {
+  public:
+
+    template<typename ENTRY>
+    inline bool operator()(const ENTRY& a, const ENTRY& b) const noexcept
+    {
+      return a.key <= b.key;
+    }
+  };
+
+  class Descending {
+  public:
+
+    template<typename ENTRY>
+    inline bool operator()(const ENTRY& a, const ENTRY& b) const noexcept
+    {
+      return a.key >= b.key;
+    }
+  };
+
+  /** Returns the value of the row as the sort key. */
+  template<typename TYPE, typename KEY>
+  class ValueKey {
+  public:
+
+    const TYPE* values = nullptr;
+
+    inline ValueKey(const TYPE* _values) noexcept : values(_values)
+    {
+    }
+
+    inline KEY operator()(MemorySize row) const noexcept
+    {
+      return values[row];
+    }
+  };
+
+  /** Returns the rank of the string of the row as the sort key. */
+  class RankKey {
+  public:
+
+    const uint32* codes = nullptr;
+    const uint32* ranks = nullptr;
+
+    inline RankKey(const uint32* _codes, const uint32* _ranks) noexcept : codes(_codes), ranks(_ranks)
+    {
+    }
+
+    inline uint32 operator()(MemorySize row) const noexcept
+    {
+      return ranks[codes[row]];
+    }
+  };
+
+  /** Stable sort of the rows by key. Rows with missing values are moved last. */
+  template<typename KEY, typename GET>
+  void sortRows(Array<MemorySize>& rows, const uint64* valid, GET get, bool ascending)
+  {
+    const MemorySize size = rows.getSize();
+    Array<SortEntry<KEY> > entries;
+    entries.setSize(size);
+    SortEntry<KEY>* entry = entries.getElements();
+    MemorySize* dest = rows.getElements();
+    MemorySize count = 0;
+    MemorySize nulls = 0;
+    for (MemorySize i = 0; i < size; ++i) {
+      const MemorySize row = dest[i];
+      if (isPresent(valid, row)) {
+        entry[count].key = get(row);
+        entry[count].row = row;
+        ++count;
+      } else {
+        dest[nulls++] = row; // nulls <= i so not overwritten before read
+      }
+    }
+    // move nulls last keeping order
+    for (MemorySize i = nulls; i > 0; --i) {
+      dest[count + i - 1] = dest[i - 1];
+    }
+    entries.setSize(count);
+    if (ascending) {
+      entries.sort(Ascending());
+    } else {
+      entries.sort(Descending());
+    }
+    entry = entries.getElements();
+    for (MemorySize i = 0; i < count; ++i) {
+      dest[i] = entry[i].row;
+    }
+  }
+
+  template<typename TYPE>
+  inline void gatherValues(Array<TYPE>& dest, const Array<TYPE>& src, const MemorySize* rows, MemorySize size)
+  {
+    dest.setSize(size);
+    TYPE* _dest = dest.getElements();
+    const TYPE* _src = src.getFirstReference();
+    for (MemorySize i = 0; i < size; ++i) {
+      _dest[i] = _src[rows[i]];
+    }
+  }
+
+  /** Returns the default name of the aggregation. */
+  String getAggregationName(const ColumnQuery::Aggregation& aggregation, const String& column)
+  {
+    static const char* NAMES[] = {"count", "sum", "min", "max", "avg"};
+    return String(format() << NAMES[aggregation.aggregate] << '(' << column << ')');
+  }
+
+  /**
+    Runs the tasks. The first task runs in the calling thread and the others
+    each in their own thread. Failed tasks are processed again to raise the
+    original exception.
+  */
+  template<typename TASK>
+  class Jobs {
+  public:
+
+    Array<TASK*> tasks;
+    Array<Thread*> threads;
+
+    ~Jobs()
+    {
+      for (Thread* thread : threads) {
+        thread->join();
+        delete thread;
+      }
+      for (TASK* task : tasks) {
+        delete task;
+      }
+    }
+
+    void run()
+    {
+      threads.ensureCapacity(tasks.getSize());
+      for (MemorySize i = 1; i < tasks.getSize(); ++i) {
+        Thread* thread = new Thread(tasks[i]);
+        threads.append(thread);
+        thread->start();
+      }
+      if (tasks) {
+        tasks[0]->run();
+      }
+      for (Thread* thread : threads) {
+        thread->join();
+      }
+      for (TASK* task : tasks) {
+        if (task->failed) {
+          task->process();
+          _throw InvalidException("Query failed.");
+        }
+      }
+    }
+  };
+}
+
+class ColumnQuery::Task : public Runnable {
+public:
+
+  /** The first position of the selection. */
+  MemorySize begin = 0;
+  /** The end position of the selection. */
+  MemorySize end = 0;
+  /** The rows of the selection. nullptr for all rows. */
+  const MemorySize* rows = nullptr;
+  bool failed = false;
+
+  virtual void process() = 0;
+
+  void run() override
+  {
+    try {
+      process();
+    } catch (...) {
+      failed = true; // processed again by caller to raise the exception
+    }
+  }
+};
+
+class ColumnQuery::FilterTask : public Task {
+public:
+
+  const Column* column = nullptr;
+  Operator op = OPERATOR_EQUAL;
+  /** Comparand for bool and integer columns. */
+  int64 integer = 0;
+  /** Comparand for floating point columns. */
+  double real = 0;
+  /** Match per dictionary code for string columns. */
+  const uint8* matches = nullptr;
+  /** The matching rows. */
+  Array<MemorySize> result;
+
+  void process() override
+  {
+    result.setSize(end - begin);
+    MemorySize* dest = result.getElements();
+    const uint64* valid = column->getValidBitmap();
+    MemorySize count = 0;
+    switch (column->getType()) {
+    case DataTable::TYPE_BOOL:
+      count = filter(column->getBools(), valid, rows, begin, end, op, integer, dest);
+      break;
+    case DataTable::TYPE_INT32:
+      count = filter(column->getInts(), valid, rows, begin, end, op, integer, dest);
+      break;
+    case DataTable::TYPE_INT64:
+      count = filter(column->getLongs(), valid, rows, begin, end, op, integer, dest);
+      break;
+    case DataTable::TYPE_FLOAT32:
+      count = filter(column->getFloats(), valid, rows, begin, end, op, real, dest);
+      break;
+    case DataTable::TYPE_FLOAT64:
+      count = filter(column->getDoubles(), valid, rows, begin, end, op, real, dest);
+      break;
+    case DataTable::TYPE_STRING:
+    default:
+      count = filter(column->getCodes(), valid, rows, begin, end, Match(matches), 0, dest);
+    }
+    result.setSize(count);
+  }
+};
+
+class ColumnQuery::GatherTask : public Task {
+public:
+
+  const ColumnTable* table = nullptr;
+  const unsigned int* columns = nullptr;
+  /** The number of rows. */
+  MemorySize size = 0;
+  /** The result per column. */
+  Column* result = nullptr;
+
+  void process() override
+  {
+    for (MemorySize i = begin; i < end; ++i) {
+      gather(table->getColumn(columns[i]), rows, size, result[i]);
+    }
+  }
+};
+
+class ColumnQuery::GroupTask : public Task {
+public:
+
+  const Column* key = nullptr;
+  Groups groups;
+  Array<Accumulator> accumulators;
+
+  GroupTask(const Column& _key, const Array<Aggregation>& aggregations, const ColumnTable& table)
+    : key(&_key), groups(_key)
+  {
+    accumulators.setSize(aggregations.getSize());
+    for (MemorySize i = 0; i < aggregations.getSize(); ++i) {
+      Accumulator& accumulator = accumulators[i];
+      accumulator.column = &table.getColumn(aggregations[i].column);
+      accumulator.integral = isIntegral(accumulator.column->getType());
+    }
+  }
+
+  void process() override
+  {
+    MemorySize batch[BATCH_SIZE];
+    uint64 keys[BATCH_SIZE];
+    uint32 ids[BATCH_SIZE];
+    const uint64* valid = key->getValidBitmap();
+    Accumulator* _accumulators = accumulators.getElements();
+    for (MemorySize i = begin; i < end; i += BATCH_SIZE) {
+      const MemorySize count = minimum<MemorySize>(end - i, BATCH_SIZE);
+      for (MemorySize j = 0; j < count; ++j) {
+        batch[j] = rows ? rows[i + j] : (i + j);
+      }
+      getKeys(*key, batch, count, keys);
+      const MemorySize previous = groups.getSize();
+      if (valid) {
+        for (MemorySize j = 0; j < count; ++j) {
+          ids[j] = isPresent(valid, batch[j]) ? groups.getGroup(keys[j]) : groups.getNullGroup();
+        }
+      } else {
+        for (MemorySize j = 0; j < count; ++j) {
+          ids[j] = groups.getGroup(keys[j]);
+        }
+      }
+      for (MemorySize a = 0; a < accumulators.getSize(); ++a) {
+        if (groups.getSize() != previous) {
+          _accumulators[a].setSize(groups.getSize());
+        }
+        _accumulators[a].update(batch, ids, count);
+      }
+    }
+  }
+};
+
+ColumnQuery::ColumnQuery(const ColumnTable& _table)
+  : table(_table)
+{
+}
+
+ColumnQuery& ColumnQuery::setThreads(unsigned int _threads)
+{
+  if (!_threads) {
+    _threads = maximum<unsigned int>(static_cast<unsigned int>(Process::getNumberOfOnlineProcessors()), 1);
+  }
+  threads = _threads;
+  return *this;
+}
+
+MemorySize ColumnQuery::getNumberOfTasks(MemorySize size) const noexcept
+{
+  return maximum<MemorySize>(minimum<MemorySize>(threads, size/PARALLEL_ROWS), 1);
+}
+
+MemorySize ColumnQuery::getNumberOfRows() const noexcept
+{
+  return all ? table.getNumberOfRows() : rows.getSize();
+}
+
+void ColumnQuery::getRows(Array<MemorySize>& result) const
+{
+  if (!all) {
+    result = rows;
+    return;
+  }
+  const MemorySize size = table.getNumberOfRows();
+  result.setSize(size);
+  MemorySize* dest = result.getElements();
+  for (MemorySize i = 0; i < size; ++i) {
+    dest[i] = i;
+  }
+}
+
+Array<MemorySize> ColumnQuery::getRows() const
+{
+  Array<MemorySize> result;
+  getRows(result);
+  return result;
+}
+
+ColumnQuery& ColumnQuery::where(unsigned int column, Operator op, const AnyValue& value)
+{
+  const Column& c = table.getColumn(column);
+  if (value.getRepresentation() == AnyValue::VOID) {
+    rows.setSize(0);
+    all = false;
+    return *this;
+  }
+
+  Array<uint8> matches;
+  int64 integer = 0;
+  double real = 0;
+  switch (c.getType()) {
+  case DataTable::TYPE_STRING:
+    {
+      const String text = value.getString();
+      const Array<String>& dictionary = c.getDictionary();
+      matches.setSize(dictionary.getSize());
+      uint8* match = matches.getElements();
+      for (MemorySize i = 0; i < dictionary.getSize(); ++i) { // once per distinct string
+        match[i] = isMatch(op, dictionary[i].compareTo(text)) ? 1 : 0;
+      }
+    }
+    break;
+  default:
+    {
+      Column converted(String(), c.getType()); // same conversion as when loading
+      converted.append(value);
+      switch (c.getType()) {
+      case DataTable::TYPE_BOOL:
+        integer = converted.getBools()[0];
+        break;
+      case DataTable::TYPE_INT32:
+        integer = converted.getInts()[0];
+        break;
+      case DataTable::TYPE_INT64:
+        integer = converted.getLongs()[0];
+        break;
+      case DataTable::TYPE_FLOAT32:
+        real = converted.getFloats()[0];
+        break;
+      default:
+        real = converted.getDoubles()[0];
+      }
+    }
+  }
+
+  const MemorySize size = getNumberOfRows();
+  const MemorySize count = getNumberOfTasks(size);
+  Jobs<FilterTask> jobs;
+  jobs.tasks.ensureCapacity(count);
+  for (MemorySize i = 0; i < count; ++i) {
+    FilterTask* task = new FilterTask();
+    jobs.tasks.append(task);
+    task->rows = all ? nullptr : rows.getFirstReference();
+    task->begin = (size * i/count) & ~static_cast<MemorySize>(63);
+    task->end = ((i + 1) < count) ? ((size * (i + 1)/count) & ~static_cast<MemorySize>(63)) : size;
+    task->column = &c;
+    task->op = op;
+    task->integer = integer;
+    task->real = real;
+    task->matches = matches.getFirstReference();
+  }
+  jobs.run();
+
+  if (count == 1) {
+    rows = jobs.tasks[0]->result;
+  } else {
+    MemorySize total = 0;
+    for (const FilterTask* task : jobs.tasks) {
+      total += task->result.getSize();
+    }
+    Array<MemorySize> result;
+    result.setSize(total);
+    MemorySize* dest = result.getElements();
+    for (const FilterTask* task : jobs.tasks) {
+      copy<MemorySize>(dest, task->result.getFirstReference(), task->result.getSize());
+      dest += task->result.getSize();
+    }
+    rows = result;
+  }
+  all = false;
+  return *this;
+}
+
+ColumnQuery& ColumnQuery::whereNotNull(unsigned int column)
+{
+  const Column& c = table.getColumn(column);
+  const uint64* valid = c.getValidBitmap();
+  if (!valid) {
+    return *this;
+  }
+  const MemorySize size = getNumberOfRows();
+  Array<MemorySize> result;
+  result.setSize(size);
+  MemorySize* dest = result.getElements();
+  MemorySize count = 0;
+  if (all) {
+    for (MemorySize i = 0; i < size; i += 64) {
+      uint64 mask = valid[i/64];
+      if ((size - i) < 64) {
+        mask &= (static_cast<uint64>(1) << (size - i)) - 1;
+      }
+      while (mask) {
+        dest[count++] = i + getLowestBit(mask);
+        mask &= mask - 1;
+      }
+    }
+  } else {
+    const MemorySize* src = rows.getFirstReference();
+    for (MemorySize i = 0; i < size; ++i) {
+      dest[count] = src[i];
+      count += isPresent(valid, src[i]) ? 1 : 0;
+    }
+  }
+  result.setSize(count);
+  rows = result;
+  all = false;
+  return *this;
+}
+
+ColumnQuery& ColumnQuery::orderBy(unsigned int column, bool ascending)
+{
+  const Column& c = table.getColumn(column);
+  getRows(rows);
+  all = false;
+  const uint64* valid = c.getValidBitmap();
+  switch (c.getType()) {
+  case DataTable::TYPE_BOOL:
+    sortRows<int64>(rows, valid, ValueKey<uint8, int64>(c.getBools()), ascending);
+    break;
+  case DataTable::TYPE_INT32:
+    sortRows<int64>(rows, valid, ValueKey<int32, int64>(c.getInts()), ascending);
+    break;
+  case DataTable::TYPE_INT64:
+    sortRows<int64>(rows, valid, ValueKey<int64, int64>(c.getLongs()), ascending);
+    break;
+  case DataTable::TYPE_FLOAT32:
+    sortRows<double>(rows, valid, ValueKey<float, double>(c.getFloats()), ascending);
+    break;
+  case DataTable::TYPE_FLOAT64:
+    sortRows<double>(rows, valid, ValueKey<double, double>(c.getDoubles()), ascending);
+    break;
+  case DataTable::TYPE_STRING:
+  default:
+    {
+      // compare each distinct string once and sort by rank
+      const Array<String>& dictionary = c.getDictionary();
+      Array<uint32> order;
+      order.setSize(dictionary.getSize());
+      uint32* _order = order.getElements();
+      for (MemorySize i = 0; i < dictionary.getSize(); ++i) {
+        _order[i] = static_cast<uint32>(i);
+      }
+      const String* strings = dictionary.getFirstReference();
+      class ByString {
+      public:
+
+        const String* strings = nullptr;
+
+        inline ByString(const String* _strings) noexcept : strings(_strings)
+        {
+        }
+
+        inline bool operator()(uint32 a, uint32 b) const noexcept
+        {
+          return strings[a].compareTo(strings[b]) <= 0;
+        }
+      };
+      order.sort(ByString(strings));
+      Array<uint32> ranks;
+      ranks.setSize(dictionary.getSize());
+      uint32* _ranks = ranks.getElements();
+      _order = order.getElements();
+      for (MemorySize i = 0; i < dictionary.getSize(); ++i) {
+        _ranks[_order[i]] = static_cast<uint32>(i);
+      }
+      sortRows<uint32>(rows, valid, RankKey(c.getCodes(), _ranks), ascending);
+    }
+  }
+  return *this;
+}
+
+ColumnQuery& ColumnQuery::limit(MemorySize count)
+{
+  if (count >= getNumberOfRows()) {
+    return *this;
+  }
+  if (all) {
+    getRows(rows);
+    all = false;
+  }
+  rows.setSize(count);
+  return *this;
+}
+
+void ColumnQuery::gather(const Column& column, const MemorySize* rows, MemorySize size, Column& result)
+{
+  if (!rows) {
+    result = column;
+    return;
+  }
+  result.name = column.name;
+  result.type = column.type;
+  switch (column.type) {
+  case DataTable::TYPE_BOOL:
+    gatherValues(result.bools, column.bools, rows, size);
+    break;
+  case DataTable::TYPE_INT32:
+    gatherValues(result.ints, column.ints, rows, size);
+    break;
+  case DataTable::TYPE_INT64:
+    gatherValues(result.longs, column.longs, rows, size);
+    break;
+  case DataTable::TYPE_FLOAT32:
+    gatherValues(result.floats, column.floats, rows, size);
+    break;
+  case DataTable::TYPE_FLOAT64:
+    gatherValues(result.doubles, column.doubles, rows, size);
+    break;
+  case DataTable::TYPE_STRING:
+  default:
+    gatherValues(result.codes, column.codes, rows, size);
+    result.dictionary = column.dictionary; // shared - unused strings are kept
+    result.lookup = column.lookup;
+  }
+  result.size = size;
+  result.nulls = 0;
+  result.valid = Array<uint64>();
+  if (!column.nulls) {
+    return;
+  }
+  Array<uint64> valid;
+  valid.setSize((size + 63)/64, 0);
+  uint64* dest = valid.getElements();
+  const uint64* src = column.getValidBitmap();
+  MemorySize nulls = 0;
+  for (MemorySize i = 0; i < size; ++i) {
+    const bool present = isPresent(src, rows[i]);
+    dest[i/64] |= static_cast<uint64>(present ? 1 : 0) << (i % 64);
+    nulls += present ? 0 : 1;
+  }
+  if (nulls) {
+    result.valid = valid;
+    result.nulls = nulls;
+  }
+}
+
+void ColumnQuery::gather(
+  const ColumnTable& table, const Array<unsigned int>& columns, const MemorySize* rows, MemorySize size, ColumnTable& result) const
+{
+  for (unsigned int column : columns) {
+    table.getColumn(column); // raises OutOfRange
+  }
+  Array<Column> gathered;
+  gathered.setSize(columns.getSize());
+  const MemorySize count = minimum<MemorySize>(getNumberOfTasks(size * columns.getSize()), maximum<MemorySize>(columns.getSize(), 1));
+  Jobs<GatherTask> jobs;
+  jobs.tasks.ensureCapacity(count);
+  for (MemorySize i = 0; i < count; ++i) {
+    GatherTask* task = new GatherTask();
+    jobs.tasks.append(task);
+    task->rows = rows;
+    task->begin = columns.getSize() * i/count;
+    task->end = columns.getSize() * (i + 1)/count;
+    task->table = &table;
+    task->columns = columns.getFirstReference();
+    task->size = size;
+    task->result = gathered.getElements();
+  }
+  jobs.run();
+
+  result.columns.ensureCapacity(result.columns.getSize() + gathered.getSize());
+  for (const Column& column : gathered) {
+    result.columns.append(column);
+  }
+  result.rows = size;
+}
+
+ColumnTable ColumnQuery::select(const Array<unsigned int>& columns) const
+{
+  ColumnTable result;
+  gather(table, columns, all ? nullptr : rows.getFirstReference(), getNumberOfRows(), result);
+  return result;
+}
+
+ColumnTable ColumnQuery::select() const
+{
+  Array<unsigned int> columns;
+  columns.setSize(table.getNumberOfColumns());
+  for (unsigned int i = 0; i < table.getNumberOfColumns(); ++i) {
+    columns[i] = i;
+  }
+  return select(columns);
+}
+
+ColumnTable ColumnQuery::groupBy(unsigned int column, const Array<Aggregation>& aggregations) const
+{
+  const Column& key = table.getColumn(column);
+  for (const Aggregation& aggregation : aggregations) {
+    const Column& c = table.getColumn(aggregation.column);
+    if ((c.getType() == DataTable::TYPE_STRING) && (aggregation.aggregate != AGGREGATE_COUNT)) {
+      _throw InvalidException("Only count is supported for string column.");
+    }
+  }
+
+  const MemorySize size = getNumberOfRows();
+  const MemorySize count = getNumberOfTasks(size);
+  Jobs<GroupTask> jobs;
+  jobs.tasks.ensureCapacity(count);
+  for (MemorySize i = 0; i < count; ++i) {
+    GroupTask* task = new GroupTask(key, aggregations, table);
+    jobs.tasks.append(task);
+    task->rows = all ? nullptr : rows.getFirstReference();
+    task->begin = size * i/count;
+    task->end = size * (i + 1)/count;
+  }
+  jobs.run();
+
+  // merge the groups of later tasks into the first task in order of first occurrence
+  GroupTask* first = jobs.tasks[0];
+  Groups& groups = first->groups;
+  Array<Accumulator>& accumulators = first->accumulators;
+  for (MemorySize i = 1; i < count; ++i) {
+    const GroupTask* task = jobs.tasks[i];
+    for (uint32 g = 0; g < task->groups.getSize(); ++g) {
+      const MemorySize previous = groups.getSize();
+      const uint32 group = task->groups.isNull(g) ? groups.getNullGroup() : groups.getGroup(task->groups.getKey(g));
+      for (MemorySize a = 0; a < accumulators.getSize(); ++a) {
+        if (groups.getSize() != previous) {
+          accumulators[a].setSize(groups.getSize());
+        }
+        accumulators[a].merge(group, task->accumulators[a], g);
+      }
+    }
+  }
+
+  const MemorySize numberOfGroups = groups.getSize();
+  ColumnTable result;
+  result.columns.ensureCapacity(aggregations.getSize() + 1);
+  {
+    Column keys(key.getName(), key.getType());
+    keys.ensureCapacity(numberOfGroups);
+    for (uint32 g = 0; g < numberOfGroups; ++g) {
+      if (groups.isNull(g)) {
+        keys.appendNull();
+        continue;
+      }
+      const uint64 value = groups.getKey(g);
+      switch (key.getType()) {
+      case DataTable::TYPE_BOOL:
+        keys.append(value != 0);
+        break;
+      case DataTable::TYPE_INT32:
+        keys.append(static_cast<int32>(static_cast<int64>(value)));
+        break;
+      case DataTable::TYPE_INT64:
+        keys.append(static_cast<int64>(value));
+        break;
+      case DataTable::TYPE_FLOAT32:
+        keys.append(static_cast<float>(toDouble(value)));
+        break;
+      case DataTable::TYPE_FLOAT64:
+        keys.append(toDouble(value));
+        break;
+      case DataTable::TYPE_STRING:
+      default:
+        keys.append(key.getDictionary()[value]);
+      }
+    }
+    result.columns.append(keys);
+  }
+
+  for (MemorySize a = 0; a < aggregations.getSize(); ++a) {
+    const Aggregation& aggregation = aggregations[a];
+    Accumulator& accumulator = accumulators[a];
+    accumulator.setSize(numberOfGroups); // no groups for no rows
+    const bool integral = accumulator.integral;
+    const String name = aggregation.name ? aggregation.name :
+      getAggregationName(aggregation, table.getColumnName(aggregation.column));
+    DataTable::Type type = DataTable::TYPE_FLOAT64;
+    if ((aggregation.aggregate == AGGREGATE_COUNT) ||
+        (integral && (aggregation.aggregate != AGGREGATE_AVERAGE))) {
+      type = DataTable::TYPE_INT64;
+    }
+    Column values(name, type);
+    values.ensureCapacity(numberOfGroups);
+    const int64* counts = accumulator.counts.getFirstReference();
+    for (uint32 g = 0; g < numberOfGroups; ++g) {
+      if (aggregation.aggregate == AGGREGATE_COUNT) {
+        values.append(counts[g]);
+        continue;
+      }
+      if (!counts[g]) { // only missing values
+        values.appendNull();
+        continue;
+      }
+      if (aggregation.aggregate == AGGREGATE_AVERAGE) {
+        values.append((integral ? static_cast<double>(accumulator.longSums[g]) : accumulator.sums[g])/counts[g]);
+        continue;
+      }
+      const Array<int64>& longs = (aggregation.aggregate == AGGREGATE_SUM) ? accumulator.longSums :
+        ((aggregation.aggregate == AGGREGATE_MINIMUM) ? accumulator.longMinimums : accumulator.longMaximums);
+      const Array<double>& doubles = (aggregation.aggregate == AGGREGATE_SUM) ? accumulator.sums :
+        ((aggregation.aggregate == AGGREGATE_MINIMUM) ? accumulator.minimums : accumulator.maximums);
+      if (integral) {
+        values.append(longs[g]);
+      } else {
+        values.append(doubles[g]);
+      }
+    }
+    result.columns.append(values);
+  }
+  result.rows = numberOfGroups;
+  return result;
+}
+
+ColumnTable ColumnQuery::join(const ColumnQuery& left, unsigned int leftColumn, const ColumnQuery& right, unsigned int rightColumn)
+{
+  const Column& leftKey = left.table.getColumn(leftColumn);
+  const Column& rightKey = right.table.getColumn(rightColumn);
+  const bool strings = leftKey.getType() == DataTable::TYPE_STRING;
+  const bool integral = isIntegral(leftKey.getType());
+  if ((strings != (rightKey.getType() == DataTable::TYPE_STRING)) || (integral != isIntegral(rightKey.getType()))) {
+    _throw InvalidException("Join columns have incompatible types.");
+  }
+
+  Array<MemorySize> leftRows;
+  Array<MemorySize> rightRows;
+  left.getRows(leftRows);
+  right.getRows(rightRows);
+
+  // bucket the right rows by key keeping the order within each key
+  KeyMap map;
+  const MemorySize rightSize = rightRows.getSize();
+  Array<uint32> rightGroups;
+  rightGroups.setSize(rightSize);
+  Array<MemorySize> offsets; // first position per key
+  {
+    Array<uint64> keys;
+    keys.setSize(rightSize);
+    getKeys(rightKey, rightRows.getFirstReference(), rightSize, keys.getElements());
+    const uint64* _keys = keys.getFirstReference();
+    const uint64* valid = rightKey.getValidBitmap();
+    const MemorySize* _rows = rightRows.getFirstReference();
+    uint32* groups = rightGroups.getElements();
+    uint32 count = 0;
+    for (MemorySize i = 0; i < rightSize; ++i) {
+      if (!isPresent(valid, _rows[i])) {
+        groups[i] = NONE;
+        continue;
+      }
+      const uint32 group = map.add(_keys[i], count);
+      if (group == count) {
+        ++count;
+        offsets.append(0);
+      }
+      groups[i] = group;
+      ++offsets[group];
+    }
+    offsets.append(0);
+    MemorySize* _offsets = offsets.getElements();
+    MemorySize total = 0;
+    for (MemorySize g = 0; g <= count; ++g) {
+      const MemorySize n = _offsets[g];
+      _offsets[g] = total;
+      total += n;
+    }
+  }
+  Array<MemorySize> buckets; // right rows ordered by key
+  buckets.setSize(offsets.getSize() ? offsets[offsets.getSize() - 1] : 0);
+  {
+    Array<MemorySize> next = offsets;
+    MemorySize* _next = next.getElements();
+    MemorySize* dest = buckets.getElements();
+    const uint32* groups = rightGroups.getFirstReference();
+    const MemorySize* _rows = rightRows.getFirstReference();
+    for (MemorySize i = 0; i < rightSize; ++i) {
+      if (groups[i] != NONE) {
+        dest[_next[groups[i]]++] = _rows[i];
+      }
+    }
+  }
+
+  // strings are matched by value across dictionaries
+  Array<uint64> translation;
+  if (strings) {
+    const Array<String>& dictionary = leftKey.getDictionary();
+    translation.setSize(dictionary.getSize());
+    uint64* dest = translation.getElements();
+    for (MemorySize i = 0; i < dictionary.getSize(); ++i) {
+      const uint32* code = rightKey.lookup.find(dictionary[i]);
+      dest[i] = code ? *code : static_cast<uint64>(NONE) + 1; // never a code
+    }
+  }
+
+  Array<MemorySize> leftMatches;
+  Array<MemorySize> rightMatches;
+  {
+    const MemorySize leftSize = leftRows.getSize();
+    Array<uint64> keys;
+    keys.setSize(leftSize);
+    uint64* _keys = keys.getElements();
+    getKeys(leftKey, leftRows.getFirstReference(), leftSize, _keys);
+    const uint64* _translation = translation.getFirstReference();
+    const uint64* valid = leftKey.getValidBitmap();
+    const MemorySize* _rows = leftRows.getFirstReference();
+    const MemorySize* _offsets = offsets.getFirstReference();
+    const MemorySize* _buckets = buckets.getFirstReference();
+    for (MemorySize i = 0; i < leftSize; ++i) {
+      const MemorySize row = _rows[i];
+      if (!isPresent(valid, row)) {
+        continue;
+      }
+      const uint32 group = map.find(strings ? _translation[_keys[i]] : _keys[i]);
+      if (group == NONE) {
+        continue;
+      }
+      for (MemorySize j = _offsets[group]; j < _offsets[group + 1]; ++j) {
+        leftMatches.append(row);
+        rightMatches.append(_buckets[j]);
+      }
+    }
+  }
+
+  Array<unsigned int> leftColumns;
+  for (unsigned int i = 0; i < left.table.getNumberOfColumns(); ++i) {
+    leftColumns.append(i);
+  }
+  Array<unsigned int> rightColumns;
+  for (unsigned int i = 0; i < right.table.getNumberOfColumns(); ++i) {
+    if (i != rightColumn) {
+      rightColumns.append(i);
+    }
+  }
+  ColumnTable result;
+  left.gather(left.table, leftColumns, leftMatches.getFirstReference(), leftMatches.getSize(), result);
+  left.gather(right.table, rightColumns, rightMatches.getFirstReference(), rightMatches.getSize(), result);
+  return result;
+}
+
+#if defined(_COM_AZURE_DEV__BASE__TESTS)
+
+class TEST_CLASS(ColumnQuery) : public UnitTest {
+public:
+
+  TEST_PRIORITY(200);
+  TEST_PROJECT("base/data");
+
+  void run() override
+  {
+    const Array<DataTable::Column> columns = {
+      DataTable::Column{"Name", DataTable::TYPE_STRING},
+      DataTable::Column{"Count", DataTable::TYPE_INT32},
+      DataTable::Column{"Value", DataTable::TYPE_FLOAT64},
+      DataTable::Column{"Flag", DataTable::TYPE_BOOL}
+    };
+    const ColumnTable table = ColumnTable::loadFromString(
+      "b;3;1.5;true\n"
+      "a;1;0.5;false\n"
+      "c;;2.5;true\n"
+      "a;7;;true\n"
+      "b;-2;1.5;false\n"
+      "a;4;3;true\n",
+      columns
+    );
+
+    ColumnQuery query(table);
+    TEST_EQUAL(query.getNumberOfRows(), 6);
+    query.where(1, ColumnQuery::OPERATOR_GREATER, 2); // null Count never matches
+    TEST_EQUAL(query.getRows(), Array<MemorySize>({0, 3, 5}));
+    query.where(0, ColumnQuery::OPERATOR_EQUAL, "a");
+    TEST_EQUAL(query.getRows(), Array<MemorySize>({3, 5}));
+    TEST_EQUAL(ColumnQuery(table).where(0, ColumnQuery::OPERATOR_LESS, "b").getRows(), Array<MemorySize>({1, 3, 5}));
+    TEST_EQUAL(ColumnQuery(table).where(2, ColumnQuery::OPERATOR_LESS_EQUAL, 1.5).getRows(), Array<MemorySize>({0, 1, 4}));
+    TEST_EQUAL(ColumnQuery(table).where(3, ColumnQuery::OPERATOR_NOT_EQUAL, true).getRows(), Array<MemorySize>({1, 4}));
+    TEST_EQUAL(ColumnQuery(table).where(1, ColumnQuery::OPERATOR_EQUAL, AnyValue()).getNumberOfRows(), 0);
+    TEST_EQUAL(ColumnQuery(table).where(1, ColumnQuery::OPERATOR_GREATER_EQUAL, "3").getNumberOfRows(), 3);
+    TEST_EQUAL(ColumnQuery(table).whereNotNull(2).getRows(), Array<MemorySize>({0, 1, 2, 4, 5}));
+
+    // stable order with missing values last
+    TEST_EQUAL(ColumnQuery(table).orderBy(2).getRows(), Array<MemorySize>({1, 0, 4, 2, 5, 3}));
+    TEST_EQUAL(ColumnQuery(table).orderBy(2, false).getRows(), Array<MemorySize>({5, 2, 0, 4, 1, 3}));
+    TEST_EQUAL(ColumnQuery(table).orderBy(1).orderBy(0).getRows(), Array<MemorySize>({1, 5, 3, 4, 0, 2}));
+    TEST_EQUAL(ColumnQuery(table).orderBy(0, false).limit(2).getRows(), Array<MemorySize>({2, 0}));
+    TEST_EQUAL(ColumnQuery(table).limit(2).getRows(), Array<MemorySize>({0, 1}));
+
+    const ColumnTable selected = ColumnQuery(table).where(3, ColumnQuery::OPERATOR_EQUAL, true).select({2, 0});
+    TEST_EQUAL(selected.getNumberOfRows(), 4);
+    TEST_EQUAL(selected.getColumnName(0), "Value");
+    TEST_EQUAL(selected.getColumn(0).getNumberOfNulls(), 1);
+    TEST_ASSERT(selected.getColumn(0).isNull(2));
+    TEST_EQUAL(selected.getValue(3, 0).getDouble(), 3);
+    TEST_EQUAL(selected.getColumn(1).getString(1), "c");
+    TEST_EQUAL(ColumnQuery(table).select().getNumberOfColumns(), 4);
+    TEST_EXCEPTION(ColumnQuery(table).select({4}), OutOfRange);
+
+    const ColumnTable groups = ColumnQuery(table).groupBy(0, {
+      {ColumnQuery::AGGREGATE_COUNT, 1},
+      {ColumnQuery::AGGREGATE_SUM, 1, "Total"},
+      {ColumnQuery::AGGREGATE_MINIMUM, 2},
+      {ColumnQuery::AGGREGATE_MAXIMUM, 1},
+      {ColumnQuery::AGGREGATE_AVERAGE, 2}
+    });
+    TEST_EQUAL(groups.getNumberOfRows(), 3);
+    TEST_EQUAL(groups.getNumberOfColumns(), 6);
+    TEST_EQUAL(groups.getColumnName(1), "count(Count)");
+    TEST_EQUAL(groups.getColumnName(2), "Total");
+    TEST_ASSERT(groups.getColumnType(2) == DataTable::TYPE_INT64);
+    TEST_ASSERT(groups.getColumnType(5) == DataTable::TYPE_FLOAT64);
+    TEST_EQUAL(groups.getColumn(0).getString(0), "b");
+    TEST_EQUAL(groups.getColumn(0).getString(1), "a");
+    TEST_EQUAL(groups.getValue(1, 1).getLongLongInteger(), 3);
+    TEST_EQUAL(groups.getValue(1, 2).getLongLongInteger(), 12);
+    TEST_EQUAL(groups.getValue(0, 3).getDouble(), 1.5);
+    TEST_EQUAL(groups.getValue(1, 4).getLongLongInteger(), 7);
+    TEST_EQUAL(groups.getValue(1, 5).getDouble(), 1.75);
+    TEST_EQUAL(groups.getValue(2, 1).getLongLongInteger(), 0);
+    TEST_ASSERT(groups.getColumn(2).isNull(2)); // only missing values
+
+    const ColumnTable byCount = ColumnQuery(table).groupBy(1, {{ColumnQuery::AGGREGATE_COUNT, 0}});
+    TEST_EQUAL(byCount.getNumberOfRows(), 6);
+    TEST_ASSERT(byCount.getColumn(0).isNull(2)); // missing key is a group
+    TEST_EXCEPTION(ColumnQuery(table).groupBy(3, {{ColumnQuery::AGGREGATE_SUM, 0}}), InvalidException);
+
+    const Array<DataTable::Column> otherColumns = {
+      DataTable::Column{"Key", DataTable::TYPE_STRING},
+      DataTable::Column{"Weight", DataTable::TYPE_INT64}
+    };
+    const ColumnTable other = ColumnTable::loadFromString("a;10\nc;30\nd;40\na;11\n", otherColumns);
+    const ColumnTable joined = ColumnQuery::join(ColumnQuery(table).where(1, ColumnQuery::OPERATOR_LESS, 5), 0, ColumnQuery(other), 0);
+    TEST_EQUAL(joined.getNumberOfColumns(), 5);
+    TEST_EQUAL(joined.getColumnName(4), "Weight");
+    TEST_EQUAL(joined.getNumberOfRows(), 4);
+    TEST_EQUAL(joined.getValue(0, 1).getInteger(), 1);
+    TEST_EQUAL(joined.getValue(0, 4).getLongLongInteger(), 10);
+    TEST_EQUAL(joined.getValue(1, 4).getLongLongInteger(), 11);
+    TEST_EQUAL(joined.getValue(2, 1).getInteger(), 4);
+    TEST_EXCEPTION(ColumnQuery::join(ColumnQuery(table), 0, ColumnQuery(other), 1), InvalidException);
+
+    // threads give the same result
+    ColumnTable large(columns);
+    const String names[] = {"x", "y", "z"};
+    for (unsigned int i = 0; i < 300000; ++i) {
+      DataTable::Row row;
+      row.append(AnyValue(names[i % 3]));
+      row.append((i % 13) ? AnyValue(static_cast<int>(i % 1000)) : AnyValue());
+      row.append(AnyValue(i * 0.25));
+      row.append(AnyValue((i % 5) == 0));
+      large.appendRow(row);
+    }
+    const Array<ColumnQuery::Aggregation> aggregations = {
+      {ColumnQuery::AGGREGATE_COUNT, 1}, {ColumnQuery::AGGREGATE_SUM, 1}, {ColumnQuery::AGGREGATE_MAXIMUM, 2}
+    };
+    ColumnQuery serial(large);
+    serial.where(2, ColumnQuery::OPERATOR_LESS, 70000.0);
+    ColumnQuery parallel(large);
+    parallel.setThreads(4).where(2, ColumnQuery::OPERATOR_LESS, 70000.0);
+    TEST_EQUAL(serial.getNumberOfRows(), 280000);
+    TEST_EQUAL(parallel.getRows(), serial.getRows());
+    const ColumnTable serialGroups = serial.groupBy(1, aggregations);
+    const ColumnTable parallelGroups = parallel.groupBy(1, aggregations);
+    TEST_EQUAL(serialGroups.getNumberOfRows(), 1001);
+    TEST_EQUAL(parallelGroups.getNumberOfRows(), serialGroups.getNumberOfRows());
+    bool same = true;
+    for (MemorySize i = 0; i < serialGroups.getNumberOfRows(); ++i) {
+      for (unsigned int c = 0; c < serialGroups.getNumberOfColumns(); ++c) {
+        same &= serialGroups.getValue(i, c).getString() == parallelGroups.getValue(i, c).getString();
+      }
+    }
+    TEST_ASSERT(same);
+    TEST_EQUAL(parallel.select().getNumberOfRows(), 280000);
+  }
+};
+
+TEST_REGISTER(ColumnQuery);
+
+class TEST_CLASS(ColumnQueryBenchmark) : public UnitTest {
+public:
+
+  TEST_PRIORITY(1000);
+  TEST_PROJECT("base/data");
+  TEST_IMPACT(LOW);
+  TEST_TIMEOUT_MS(120 * 1000);
+
+  void run() override
+  {
+    const MemorySize ROWS = 1024 * 1024;
+    const Array<DataTable::Column> columns = {
+      DataTable::Column{"Key", DataTable::TYPE_STRING},
+      DataTable::Column{"Count", DataTable::TYPE_INT32},
+      DataTable::Column{"Value", DataTable::TYPE_FLOAT64}
+    };
+    Array<String> keys;
+    for (unsigned int i = 0; i < 100; ++i) {
+      keys.append(String(format() << "key " << i));
+    }
+
+    DataTable rows = DataTable::loadFromString("", columns);
+    Array<DataTable::Row>& _rows = rows.getRows();
+    _rows.setSize(ROWS);
+    ColumnTable table(columns);
+    table.ensureCapacity(ROWS);
+    for (MemorySize i = 0; i < ROWS; ++i) {
+      DataTable::Row row;
+      row.append(AnyValue(keys[Random::random<uint32>() % keys.getSize()]));
+      row.append(AnyValue(static_cast<int>(Random::random<uint32>() % 1000)));
+      row.append(AnyValue(static_cast<double>(Random::random<uint32>())/PrimitiveTraits<uint32>::MAXIMUM));
+      table.appendRow(row);
+      _rows[i] = row;
+    }
+
+    // where Count < 500 group by Key with sum of Value
+    Timer timer;
+    HashTable<String, double> sums;
+    for (const DataTable::Row& row : _rows) {
+      if (row[1].getInteger() < 500) {
+        const String key = row[0].getString();
+        if (double* sum = sums.find(key)) {
+          *sum += row[2].getDouble();
+        } else {
+          sums.add(key, row[2].getDouble());
+        }
+      }
+    }
+    const uint64 rowTime = timer.getLiveMicroseconds();
+
+    timer.start();
+    ColumnQuery query(table);
+    query.setThreads(0).where(1, ColumnQuery::OPERATOR_LESS, 500);
+    const ColumnTable grouped = query.groupBy(0, {{ColumnQuery::AGGREGATE_SUM, 2}});
+    const uint64 columnTime = timer.getLiveMicroseconds();
+
+    TEST_EQUAL(grouped.getNumberOfRows(), sums.getSize());
+    TEST_PRINT(format() << "Rows: " << ROWS << " row oriented: " << rowTime << " us, column query: " << columnTime
+               << " us, threads: " << Process::getNumberOfOnlineProcessors());
+  }
+};
+
+TEST_REGISTER(ColumnQueryBenchmark);
+
+#endif
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
@@ -0,0 +1,188 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#pragma once
+
+#include <base/data/ColumnTable.h>
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+/**
+  Query over the rows of a ColumnTable. A query holds a selection of rows
+  which is narrowed by where(), reordered by orderBy(), and cut by limit().
+  The result is built by select(), groupBy(), or join(). Use ColumnTable(const
+  DataTable&) to query a DataTable.
+
+  Filters and aggregations work on the typed column arrays 64 rows at a time
+  without AnyValue. Comparisons produce a 64-bit mask per 64 rows which is
+  combined with the validity bitmap. Missing values never match a filter and
+  are skipped by aggregations except for the missing key of groupBy(). String
+  columns are compared once per distinct string.
+
+  The rows are split between the given number of threads for where(),
+  select(), and groupBy(). The table must outlive the query.
+
+  @code
+  ColumnQuery query(table);
+  query.where(2, ColumnQuery::OPERATOR_GREATER, 100).orderBy(1);
+  ColumnTable result = query.groupBy(0, {{ColumnQuery::AGGREGATE_SUM, 2, "Total"}});
+  @endcode
+
+  @short Column table query.
+  @version 1.0
+*/
+
+class _COM_AZURE_DEV__BASE__API ColumnQuery {
+public:
+
+  /** Comparison operator for where(). */
+  enum Operator {
+    OPERATOR_EQUAL,
+    OPERATOR_NOT_EQUAL,
+    OPERATOR_LESS,
+    OPERATOR_LESS_EQUAL,
+    OPERATOR_GREATER,
+    OPERATOR_GREATER_EQUAL
+  };
+
+  /** Aggregate function for groupBy(). */
+  enum Aggregate {
+    /** The number of present values. INT64 column. */
+    AGGREGATE_COUNT,
+    /** The sum. INT64 column for integer and bool columns and FLOAT64 otherwise. */
+    AGGREGATE_SUM,
+    /** The minimum value. INT64 column for integer and bool columns and FLOAT64 otherwise. */
+    AGGREGATE_MINIMUM,
+    /** The maximum value. INT64 column for integer and bool columns and FLOAT64 otherwise. */
+    AGGREGATE_MAXIMUM,
+    /** The average value. FLOAT64 column. */
+    AGGREGATE_AVERAGE
+  };
+
+  /** Aggregation of a column. */
+  class _COM_AZURE_DEV__BASE__API Aggregation {
+  public:
+
+    /** The aggregate function. */
+    Aggregate aggregate = AGGREGATE_COUNT;
+    /** The aggregated column. */
+    unsigned int column = 0;
+    /** The name of the result column. Defaults to e.g. "sum(Value)". */
+    String name;
+
+    inline Aggregation()
+    {
+    }
+
+    inline Aggregation(Aggregate _aggregate, unsigned int _column, const String& _name = String())
+      : aggregate(_aggregate), column(_column), name(_name)
+    {
+    }
+  };
+
+  /** The minimum number of rows per thread. */
+  static constexpr MemorySize PARALLEL_ROWS = 64 * 1024;
+private:
+
+  class Task;
+  class FilterTask;
+  class GatherTask;
+  class GroupTask;
+
+  /** The table. */
+  const ColumnTable& table;
+  /** The selected rows. Only used once a row has been removed or reordered. */
+  Array<MemorySize> rows;
+  /** All rows are selected in order. */
+  bool all = true;
+  /** The number of threads. */
+  unsigned int threads = 1;
+
+  /** Returns the number of tasks for the given number of rows. */
+  MemorySize getNumberOfTasks(MemorySize size) const noexcept;
+
+  /** Returns the selected row indices in order. */
+  void getRows(Array<MemorySize>& result) const;
+
+  /** Copies the given rows of the column. Copies the column if rows is nullptr. */
+  static void gather(const ColumnTable::Column& column, const MemorySize* rows, MemorySize size, ColumnTable::Column& result);
+
+  /** Appends the given rows of the columns of the table to the result. */
+  void gather(const ColumnTable& table, const Array<unsigned int>& columns, const MemorySize* rows, MemorySize size, ColumnTable& result) const;
+public:
+
+  /** Initializes query selecting all rows of the table. */
+  ColumnQuery(const ColumnTable& table);
+
+  /** Returns the table. */
+  inline const ColumnTable& getTable() const noexcept
+  {
+    return table;
+  }
+
+  /** Sets the number of threads. Uses the number of online processors if 0. */
+  ColumnQuery& setThreads(unsigned int threads);
+
+  /** Returns the number of selected rows. */
+  MemorySize getNumberOfRows() const noexcept;
+
+  /** Returns the selected row indices in order. */
+  Array<MemorySize> getRows() const;
+
+  /**
+    Keeps the rows for which the value of the column compares to the given
+    value. The value is converted to the column type. Strings are compared
+    binary. Missing values and a void value never match.
+  */
+  ColumnQuery& where(unsigned int column, Operator op, const AnyValue& value);
+
+  /** Keeps the rows with a value for the given column. */
+  ColumnQuery& whereNotNull(unsigned int column);
+
+  /**
+    Orders the rows by the given column. The sort is stable so rows with
+    equal values keep the previous order. Order by the least significant
+    column first to order by several columns. Missing values are last.
+  */
+  ColumnQuery& orderBy(unsigned int column, bool ascending = true);
+
+  /** Keeps the first rows only. */
+  ColumnQuery& limit(MemorySize count);
+
+  /** Returns the given columns of the selected rows. */
+  ColumnTable select(const Array<unsigned int>& columns) const;
+
+  /** Returns all columns of the selected rows. */
+  ColumnTable select() const;
+
+  /**
+    Groups the selected rows by the value of the given column. The result has
+    the key column followed by a column per aggregation. The groups are in
+    order of the first row of the group. Missing values form a group of their
+    own. Raises InvalidException for an aggregate other than AGGREGATE_COUNT
+    of a string column.
+  */
+  ColumnTable groupBy(unsigned int column, const Array<Aggregation>& aggregations) const;
+
+  /**
+    Returns the inner join of the selected rows of the queries on equal
+    values of the given columns. The result has all columns of the left table
+    followed by the columns of the right table except the key. The rows are
+    in the order of the left rows and then the right rows. Integer and bool
+    keys match each other as do floating point keys. Missing values never
+    match.
+  */
+  static ColumnTable join(const ColumnQuery& left, unsigned int leftColumn, const ColumnQuery& right, unsigned int rightColumn);
+};
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
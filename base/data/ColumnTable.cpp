@@ -0,0 +1,1112 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#include <base/data/ColumnTable.h>
+#include <base/data/CSVFormat.h>
+#include <base/io/FileInputStream.h>
+#include <base/io/FileOutputStream.h>
+#include <base/io/MemoryInputStream.h>
+#include <base/io/MemoryOutputStream.h>
+#include <base/io/MappedFile.h>
+#include <base/concurrency/Process.h>
+#include <base/concurrency/Thread.h>
+#include <base/string/Posix.h>
+#include <base/string/StringOutputStream.h>
+#include <base/Timer.h>
+#include <base/Random.h>
+#include <base/UnitTest.h>
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+ColumnTable::Column::Column(const String& _name, Type _type)
+  : name(_name), type(_type)
+{
+}
+
+namespace {
+
+  template<typename TYPE>
+  inline void reserve(Array<TYPE>& values, MemorySize capacity)
+  {
+    if (!values) {
+      values.setSize(0); // Array::ensureCapacity() ignores an array without storage
+    }
+    values.ensureCapacity(capacity);
+  }
+}
+
+void ColumnTable::Column::ensureCapacity(MemorySize capacity)
+{
+  switch (type) {
+  case DataTable::TYPE_BOOL:
+    reserve(bools, capacity);
+    break;
+  case DataTable::TYPE_INT32:
+    reserve(ints, capacity);
+    break;
+  case DataTable::TYPE_INT64:
+    reserve(longs, capacity);
+    break;
+  case DataTable::TYPE_FLOAT32:
+    reserve(floats, capacity);
+    break;
+  case DataTable::TYPE_FLOAT64:
+    reserve(doubles, capacity);
+    break;
+  case DataTable::TYPE_STRING:
+  default:
+    reserve(codes, capacity);
+  }
+}
+
+void ColumnTable::Column::appended(bool present)
+{
+  ++size;
+  if (present && !valid) {
+    return; // bitmap is only needed once a value is missing
+  }
+  const MemorySize words = (size + 63)/64;
+  if (!valid) {
+    valid.setSize(words, ~static_cast<uint64>(0)); // all previous values are present
+  } else if (valid.getSize() < words) {
+    valid.append(~static_cast<uint64>(0));
+  }
+  if (!present) {
+    const MemorySize index = size - 1;
+    valid[index/64] &= ~(static_cast<uint64>(1) << (index % 64));
+    ++nulls;
+  }
+}
+
+uint32 ColumnTable::Column::getCode(const String& value)
+{
+  if (const uint32* code = lookup.find(value)) {
+    return *code;
+  }
+  if (dictionary.getSize() >= PrimitiveTraits<uint32>::MAXIMUM) {
+    _throw OutOfRange("Too many distinct strings.");
+  }
+  const uint32 code = static_cast<uint32>(dictionary.getSize());
+  dictionary.append(value);
+  lookup.add(value, code);
+  return code;
+}
+
+void ColumnTable::Column::appendNull()
+{
+  switch (type) {
+  case DataTable::TYPE_BOOL:
+    bools.append(0);
+    break;
+  case DataTable::TYPE_INT32:
+    ints.append(0);
+    break;
+  case DataTable::TYPE_INT64:
+    longs.append(0);
+    break;
+  case DataTable::TYPE_FLOAT32:
+    floats.append(0);
+    break;
+  case DataTable::TYPE_FLOAT64:
+    doubles.append(0);
+    break;
+  case DataTable::TYPE_STRING:
+  default:
+    codes.append(getCode(String()));
+  }
+  appended(false);
+}
+
+void ColumnTable::Column::append(bool value)
+{
+  switch (type) {
+  case DataTable::TYPE_BOOL:
+    bools.append(value ? 1 : 0);
+    appended(true);
+    break;
+  default:
+    append(AnyValue(value));
+  }
+}
+
+void ColumnTable::Column::append(int32 value)
+{
+  switch (type) {
+  case DataTable::TYPE_INT32:
+    ints.append(value);
+    appended(true);
+    break;
+  default:
+    append(AnyValue(value));
+  }
+}
+
+void ColumnTable::Column::append(int64 value)
+{
+  switch (type) {
+  case DataTable::TYPE_INT64:
+    longs.append(value);
+    appended(true);
+    break;
+  default:
+    append(AnyValue(value));
+  }
+}
+
+void ColumnTable::Column::append(float value)
+{
+  switch (type) {
+  case DataTable::TYPE_FLOAT32:
+    floats.append(value);
+    appended(true);
+    break;
+  default:
+    append(AnyValue(value));
+  }
+}
+
+void ColumnTable::Column::append(double value)
+{
+  switch (type) {
+  case DataTable::TYPE_FLOAT64:
+    doubles.append(value);
+    appended(true);
+    break;
+  default:
+    append(AnyValue(value));
+  }
+}
+
+void ColumnTable::Column::append(const String& value)
+{
+  switch (type) {
+  case DataTable::TYPE_STRING:
+    codes.append(getCode(value));
+    appended(true);
+    break;
+  default:
+    append(AnyValue(value));
+  }
+}
+
+namespace {
+
+  /** Parses decimal integer. */
+  template<typename TYPE, typename UNSIGNED>
+  bool parseInteger(const String& text, TYPE& result) noexcept
+  {
+    const char* src = text.native();
+    const char* end = text.getEnd();
+    bool negative = false;
+    if ((src != end) && ((*src == '-') || (*src == '+'))) {
+      negative = (*src++ == '-');
+    }
+    if (src == end) {
+      return false;
+    }
+    const UNSIGNED limit = static_cast<UNSIGNED>(PrimitiveTraits<TYPE>::MAXIMUM) + (negative ? 1 : 0);
+    UNSIGNED value = 0;
+    while (src != end) {
+      const char ch = *src++;
+      if (!ASCIITraits::isDigit(ch)) {
+        return false;
+      }
+      const unsigned int digit = ch - '0';
+      if (value > (limit - digit)/10) {
+        return false; // overflow
+      }
+      value = value * 10 + digit;
+    }
+    result = static_cast<TYPE>(negative ? (0 - value) : value);
+    return true;
+  }
+
+  inline bool parseBoolean(const String& text) noexcept
+  {
+    return !(!text || (text == "false") || (text == "0")); // same as DataTable
+  }
+}
+
+void ColumnTable::Column::append(const AnyValue& value)
+{
+  if (value.getRepresentation() == AnyValue::VOID) {
+    appendNull();
+    return;
+  }
+
+  if (value.isText() && (type != DataTable::TYPE_STRING)) {
+    const String text = value.getString();
+    if (!text) {
+      appendNull();
+      return;
+    }
+    switch (type) {
+    case DataTable::TYPE_BOOL:
+      append(parseBoolean(text));
+      return;
+    case DataTable::TYPE_INT32:
+      {
+        int32 i = 0;
+        if (!parseInteger<int32, uint32>(text, i)) {
+          _throw InvalidException("Not an int32.");
+        }
+        append(i);
+      }
+      return;
+    case DataTable::TYPE_INT64:
+      {
+        int64 i = 0;
+        if (!parseInteger<int64, uint64>(text, i)) {
+          _throw InvalidException("Not an int64.");
+        }
+        append(i);
+      }
+      return;
+    case DataTable::TYPE_FLOAT32:
+      {
+        float f = 0;
+        if (!Posix().getSeries(text, f)) {
+          _throw InvalidException("Not a float.");
+        }
+        append(f);
+      }
+      return;
+    case DataTable::TYPE_FLOAT64:
+    default:
+      {
+        double d = 0;
+        if (!Posix().getSeries(text, d)) {
+          _throw InvalidException("Not a double.");
+        }
+        append(d);
+      }
+      return;
+    }
+  }
+
+  switch (type) {
+  case DataTable::TYPE_BOOL:
+    append(value.getBoolean());
+    break;
+  case DataTable::TYPE_INT32:
+    append(static_cast<int32>(value.getInteger()));
+    break;
+  case DataTable::TYPE_INT64:
+    append(static_cast<int64>(value.getLongLongInteger()));
+    break;
+  case DataTable::TYPE_FLOAT32:
+    append(value.getFloat());
+    break;
+  case DataTable::TYPE_FLOAT64:
+    append(value.getDouble());
+    break;
+  case DataTable::TYPE_STRING:
+  default:
+    append(value.getString());
+  }
+}
+
+AnyValue ColumnTable::Column::getValue(MemorySize index) const
+{
+  if (index >= size) {
+    _throw OutOfRange("Row index out of range.");
+  }
+  if (isNull(index)) {
+    return AnyValue();
+  }
+  switch (type) {
+  case DataTable::TYPE_BOOL:
+    return AnyValue(bools[index] != 0);
+  case DataTable::TYPE_INT32:
+    return AnyValue(ints[index]);
+  case DataTable::TYPE_INT64:
+    return AnyValue(longs[index]);
+  case DataTable::TYPE_FLOAT32:
+    return AnyValue(floats[index]);
+  case DataTable::TYPE_FLOAT64:
+    return AnyValue(doubles[index]);
+  case DataTable::TYPE_STRING:
+  default:
+    return AnyValue(dictionary[codes[index]]);
+  }
+}
+
+namespace {
+
+  /** Appends all values. */
+  template<typename TYPE>
+  inline void appendAll(Array<TYPE>& values, const Array<TYPE>& other)
+  {
+    const MemorySize size = values.getSize();
+    if (other.getSize() == 0) {
+      return;
+    }
+    values.setSize(size + other.getSize());
+    copy<TYPE>(values.getElements() + size, other.getFirstReference(), other.getSize());
+  }
+}
+
+void ColumnTable::Column::appendColumn(const Column& other)
+{
+  if (other.type != type) {
+    _throw InvalidException("Column type mismatch.");
+  }
+  switch (type) {
+  case DataTable::TYPE_BOOL:
+    appendAll(bools, other.bools);
+    break;
+  case DataTable::TYPE_INT32:
+    appendAll(ints, other.ints);
+    break;
+  case DataTable::TYPE_INT64:
+    appendAll(longs, other.longs);
+    break;
+  case DataTable::TYPE_FLOAT32:
+    appendAll(floats, other.floats);
+    break;
+  case DataTable::TYPE_FLOAT64:
+    appendAll(doubles, other.doubles);
+    break;
+  case DataTable::TYPE_STRING:
+  default:
+    {
+      Array<uint32> map; // codes of other to codes of this
+      map.setSize(other.dictionary.getSize());
+      for (MemorySize i = 0; i < other.dictionary.getSize(); ++i) {
+        map[i] = getCode(other.dictionary[i]);
+      }
+      const MemorySize offset = codes.getSize();
+      codes.setSize(offset + other.size);
+      uint32* dest = codes.getElements() + offset;
+      const uint32* src = other.getCodes();
+      const uint32* _map = map.getFirstReference();
+      for (MemorySize i = 0; i < other.size; ++i) {
+        dest[i] = _map[src[i]];
+      }
+    }
+  }
+  if (!valid && !other.nulls) {
+    size += other.size;
+    return;
+  }
+  for (MemorySize i = 0; i < other.size; ++i) {
+    appended(!other.isNull(i));
+  }
+}
+
+namespace {
+
+  /** Calculates stats. ACCUMULATOR avoids rounding for integer sums. */
+  template<typename TYPE, typename ACCUMULATOR>
+  void getStatsImpl(const TYPE* values, MemorySize size, const uint64* valid, ColumnTable::Stats& stats) noexcept
+  {
+    TYPE minimum = 0;
+    TYPE maximum = 0;
+    ACCUMULATOR sum = 0;
+    MemorySize count = 0;
+    if (!valid) { // tight loop - vectorizable
+      if (size > 0) {
+        minimum = values[0];
+        maximum = values[0];
+      }
+      for (MemorySize i = 0; i < size; ++i) {
+        const TYPE v = values[i];
+        minimum = (v < minimum) ? v : minimum;
+        maximum = (v > maximum) ? v : maximum;
+        sum += v;
+      }
+      count = size;
+    } else {
+      for (MemorySize i = 0; i < size; ++i) {
+        if (!((valid[i/64] >> (i % 64)) & 1)) {
+          continue;
+        }
+        const TYPE v = values[i];
+        if (count == 0) {
+          minimum = v;
+          maximum = v;
+        }
+        minimum = (v < minimum) ? v : minimum;
+        maximum = (v > maximum) ? v : maximum;
+        sum += v;
+        ++count;
+      }
+    }
+    stats.count = count;
+    stats.minimum = static_cast<double>(minimum);
+    stats.maximum = static_cast<double>(maximum);
+    stats.sum = static_cast<double>(sum);
+  }
+}
+
+ColumnTable::Stats ColumnTable::Column::getStats() const
+{
+  Stats result;
+  result.nulls = nulls;
+  const uint64* bitmap = getValidBitmap();
+  switch (type) {
+  case DataTable::TYPE_BOOL:
+    getStatsImpl<uint8, uint64>(getBools(), size, bitmap, result);
+    break;
+  case DataTable::TYPE_INT32:
+    getStatsImpl<int32, int64>(getInts(), size, bitmap, result);
+    break;
+  case DataTable::TYPE_INT64:
+    getStatsImpl<int64, int64>(getLongs(), size, bitmap, result);
+    break;
+  case DataTable::TYPE_FLOAT32:
+    getStatsImpl<float, double>(getFloats(), size, bitmap, result);
+    break;
+  case DataTable::TYPE_FLOAT64:
+    getStatsImpl<double, double>(getDoubles(), size, bitmap, result);
+    break;
+  case DataTable::TYPE_STRING:
+  default:
+    result.count = size - nulls;
+    break;
+  }
+  return result;
+}
+
+MemorySize ColumnTable::Column::getMemoryUsage() const noexcept
+{
+  MemorySize result = bools.getSize() * sizeof(uint8) +
+    ints.getSize() * sizeof(int32) +
+    longs.getSize() * sizeof(int64) +
+    floats.getSize() * sizeof(float) +
+    doubles.getSize() * sizeof(double) +
+    codes.getSize() * sizeof(uint32) +
+    valid.getSize() * sizeof(uint64);
+  for (MemorySize i = 0; i < dictionary.getSize(); ++i) {
+    result += sizeof(String) + dictionary[i].getLength();
+  }
+  return result;
+}
+
+ColumnTable::ColumnTable()
+{
+}
+
+ColumnTable::ColumnTable(const Array<ColumnInfo>& _columns)
+{
+  reserve(columns, _columns.getSize());
+  for (MemorySize c = 0; c < _columns.getSize(); ++c) {
+    columns.append(Column(_columns[c].name, _columns[c].type));
+  }
+}
+
+ColumnTable::ColumnTable(const DataTable& table)
+{
+  reserve(columns, table.getNumberOfColumns());
+  for (unsigned int c = 0; c < table.getNumberOfColumns(); ++c) {
+    columns.append(Column(table.getColumnName(c), table.getColumnType(c)));
+  }
+  ensureCapacity(table.getNumberOfRows());
+  const Array<DataTable::Row>& rows = table.getRows();
+  for (MemorySize i = 0; i < rows.getSize(); ++i) {
+    appendRow(rows[i]);
+  }
+}
+
+void ColumnTable::ensureCapacity(MemorySize capacity)
+{
+  for (MemorySize c = 0; c < columns.getSize(); ++c) {
+    columns[c].ensureCapacity(capacity);
+  }
+}
+
+void ColumnTable::appendRow(const DataTable::Row& row)
+{
+  for (MemorySize c = 0; c < columns.getSize(); ++c) {
+    if (c < row.getSize()) {
+      columns[c].append(row[c]);
+    } else {
+      columns[c].appendNull();
+    }
+  }
+  ++rows;
+}
+
+void ColumnTable::append(const ColumnTable& other)
+{
+  if (other.columns.getSize() != columns.getSize()) {
+    _throw InvalidException("Number of columns mismatch.");
+  }
+  for (MemorySize c = 0; c < columns.getSize(); ++c) {
+    columns[c].appendColumn(other.columns[c]);
+  }
+  rows += other.rows;
+}
+
+DataTable::Row ColumnTable::getRow(MemorySize index) const
+{
+  DataTable::Row result;
+  reserve(result, columns.getSize());
+  for (MemorySize c = 0; c < columns.getSize(); ++c) {
+    result.append(columns[c].getValue(index));
+  }
+  return result;
+}
+
+MemorySize ColumnTable::getMemoryUsage() const noexcept
+{
+  MemorySize result = 0;
+  for (MemorySize c = 0; c < columns.getSize(); ++c) {
+    result += columns[c].getMemoryUsage();
+  }
+  return result;
+}
+
+ColumnTable ColumnTable::load(const String& path, const Array<ColumnInfo>& columns, const Config& config)
+{
+  FileInputStream fis(path);
+  return load(&fis, columns, config);
+}
+
+ColumnTable ColumnTable::loadFromString(const String& data, const Array<ColumnInfo>& columns, const Config& config)
+{
+  MemoryInputStream mis(data);
+  return load(&mis, columns, config);
+}
+
+class ColumnTable::Builder : public DataTable::LineBuilder {
+public:
+
+  ColumnTable table;
+  Posix posix;
+
+  Builder(const Array<DataTable::Column>& _columns, const DataTable::Config& _config)
+    : DataTable::LineBuilder(_columns, _config), table(_columns)
+  {
+  }
+
+  /** Used when the lines do not begin with the header. */
+  void skipHeader() noexcept
+  {
+    firstLine = false;
+  }
+
+  void invalid(const char* message, const Array<String>& line)
+  {
+    printInvalid(message, line);
+    _throw InvalidException(message);
+  }
+
+  void setColumnName(unsigned int column, const String& name) override
+  {
+    table.setColumnName(column, name);
+  }
+
+  void appendCustom(unsigned int column, const AnyValue& value) override
+  {
+    table.columns[column].append(value);
+  }
+
+  /** Converts the text directly to the column type without going through AnyValue. */
+  void appendField(unsigned int c, const String& s, const Array<String>& line) override
+  {
+    Column& column = table.columns[c];
+    if (column.getType() == DataTable::TYPE_STRING) {
+      column.append(s);
+      return;
+    }
+    if (!s) {
+      column.appendNull(); // blank field
+      return;
+    }
+    switch (column.getType()) {
+    case DataTable::TYPE_BOOL:
+      column.append(parseBoolean(s));
+      break;
+    case DataTable::TYPE_INT32:
+      {
+        int32 i = 0;
+        if (!parseInteger<int32, uint32>(s, i)) {
+          invalid("Not an int32.", line);
+        }
+        column.append(i);
+      }
+      break;
+    case DataTable::TYPE_INT64:
+      {
+        int64 i = 0;
+        if (!parseInteger<int64, uint64>(s, i)) {
+          invalid("Not an int64.", line);
+        }
+        column.append(i);
+      }
+      break;
+    case DataTable::TYPE_FLOAT32:
+      {
+        float f = 0;
+        if (!posix.getSeries(s, f)) {
+          invalid("Not a float.", line);
+        }
+        column.append(f);
+      }
+      break;
+    case DataTable::TYPE_FLOAT64:
+    default:
+      {
+        double d = 0;
+        if (!posix.getSeries(s, d)) {
+          invalid("Not a double.", line);
+        }
+        column.append(d);
+      }
+    }
+  }
+
+  void appendRow() override
+  {
+    ++table.rows;
+  }
+};
+
+ColumnTable ColumnTable::load(InputStream* is, const Array<ColumnInfo>& columns, const Config& config)
+{
+  Builder build(columns, config);
+  CSVFormat csv(config.separator, config.trimSpaces);
+  csv.load(is, &build);
+  return build.table;
+}
+
+class ColumnTable::Job : public Runnable {
+public:
+
+  Builder build;
+  CSVFormat csv;
+  const uint8* src = nullptr;
+  const uint8* end = nullptr;
+  bool failed = false;
+
+  Job(const Array<DataTable::Column>& columns, const DataTable::Config& config, bool header)
+    : build(columns, config), csv(config.separator, config.trimSpaces)
+  {
+    if (!header) {
+      build.skipHeader();
+    }
+  }
+
+  void load()
+  {
+    csv.load(src, end, &build);
+  }
+
+  void run() override
+  {
+    try {
+      load();
+    } catch (...) {
+      failed = true; // reloaded by caller to raise the exception
+    }
+  }
+};
+
+ColumnTable ColumnTable::loadParallel(
+  const uint8* src, const uint8* end, const Array<ColumnInfo>& columns, const Config& config, unsigned int threads)
+{
+  if (!threads) {
+    threads = maximum<unsigned int>(static_cast<unsigned int>(Process::getNumberOfOnlineProcessors()), 1);
+  }
+  while ((src != end) && ((*src == '\n') || (*src == '\r'))) { // header must begin the first chunk
+    ++src;
+  }
+  const MemorySize size = end - src;
+  const MemorySize count = maximum<MemorySize>(minimum<MemorySize>(threads, size/PARALLEL_CHUNK_SIZE), 1);
+
+  /** Joins and releases the threads and jobs. */
+  class Jobs {
+  public:
+
+    Array<Job*> jobs;
+    Array<Thread*> threads;
+
+    ~Jobs()
+    {
+      for (Thread* thread : threads) {
+        thread->join();
+        delete thread;
+      }
+      for (Job* job : jobs) {
+        delete job;
+      }
+    }
+  };
+
+  Jobs jobs;
+  jobs.jobs.ensureCapacity(count);
+  const uint8* begin = src;
+  for (MemorySize i = 0; i < count; ++i) {
+    const uint8* last = end;
+    if ((i + 1) < count) { // split after line end
+      last = maximum(begin, src + size * (i + 1)/count);
+      while ((last != end) && (*last != '\n') && (*last != '\r')) {
+        ++last;
+      }
+      if (last != end) {
+        ++last;
+      }
+    }
+    Job* job = new Job(columns, config, i == 0);
+    jobs.jobs.append(job);
+    job->src = begin;
+    job->end = last;
+    begin = last;
+  }
+
+  jobs.threads.ensureCapacity(count - 1);
+  for (MemorySize i = 1; i < count; ++i) {
+    Thread* thread = new Thread(jobs.jobs[i]);
+    jobs.threads.append(thread);
+    thread->start();
+  }
+  jobs.jobs[0]->run();
+  for (Thread* thread : jobs.threads) {
+    thread->join();
+  }
+
+  for (MemorySize i = 0; i < count; ++i) {
+    const Job* job = jobs.jobs[i];
+    if (job->failed) { // load again to raise the original exception
+      Job retry(columns, config, i == 0);
+      retry.src = job->src;
+      retry.end = job->end;
+      retry.load();
+      _throw InvalidException("Failed to load CSV data.");
+    }
+  }
+
+  ColumnTable result = jobs.jobs[0]->build.table;
+  for (MemorySize i = 1; i < count; ++i) {
+    result.append(jobs.jobs[i]->build.table);
+  }
+  return result;
+}
+
+ColumnTable ColumnTable::loadParallel(const String& path, const Array<ColumnInfo>& columns, const Config& config, unsigned int threads)
+{
+  const long long WINDOW = 1024 * 1024 * 1024;
+  File file(path, File::READ, 0);
+  const long long size = file.getSize();
+  const long long granularity = MappedFile::getGranularity();
+  Config next = config;
+  next.header = DataTable::HEADER_NONE; // only the first window has the header
+
+  ColumnTable result(columns);
+  long long offset = 0; // the first byte which has not been loaded
+  while (offset < size) {
+    const long long base = offset - (offset % granularity);
+    const unsigned int length = static_cast<unsigned int>(minimum<long long>(size - base, WINDOW));
+    MappedFile map(file, FileRegion(base, length));
+    const uint8* bytes = map.getBytes();
+    const uint8* src = bytes + (offset - base);
+    const uint8* end = bytes + length;
+    if ((base + length) < size) { // partial line is loaded with the next window
+      while ((end != src) && (end[-1] != '\n') && (end[-1] != '\r')) {
+        --end;
+      }
+      if (end == src) {
+        _throw InvalidException("Line is too long.");
+      }
+    }
+    if (offset == 0) {
+      result = loadParallel(src, end, columns, config, threads);
+    } else {
+      result.append(loadParallel(src, end, columns, next, threads));
+    }
+    offset = base + (end - bytes);
+  }
+  return result;
+}
+
+void ColumnTable::saveCSV(OutputStream* os, char separator)
+{
+  FormatOutputStream stream(*os);
+  const Literal eol = MESSAGE("\r\n");
+  for (MemorySize c = 0; c < columns.getSize(); ++c) {
+    if (c > 0) {
+      stream << separator;
+    }
+    stream << CSVFormat::quote(columns[c].getName());
+  }
+  stream << eol;
+  for (MemorySize i = 0; i < rows; ++i) {
+    for (MemorySize c = 0; c < columns.getSize(); ++c) {
+      if (c > 0) {
+        stream << separator;
+      }
+      const Column& column = columns[c];
+      if (column.isNull(i)) {
+        continue; // blank field
+      }
+      switch (column.getType()) {
+      case DataTable::TYPE_BOOL:
+        stream << (column.getBools()[i] ? MESSAGE("true") : MESSAGE("false"));
+        break;
+      case DataTable::TYPE_INT32:
+        stream << column.getInts()[i];
+        break;
+      case DataTable::TYPE_INT64:
+        stream << column.getLongs()[i];
+        break;
+      case DataTable::TYPE_FLOAT32:
+        stream << column.getFloats()[i];
+        break;
+      case DataTable::TYPE_FLOAT64:
+        stream << column.getDoubles()[i];
+        break;
+      case DataTable::TYPE_STRING:
+      default:
+        stream << CSVFormat::quote(column.getString(i));
+      }
+    }
+    stream << eol;
+  }
+  stream << FLUSH;
+}
+
+void ColumnTable::saveCSV(const String& path)
+{
+  FileOutputStream fos(path);
+  saveCSV(&fos);
+}
+
+FormatOutputStream& ColumnTable::dumpStats(FormatOutputStream& stream) const
+{
+  static const char* TYPES[] = {"bool", "int32", "int64", "float32", "float64", "string"};
+  for (unsigned int c = 0; c < getNumberOfColumns(); ++c) {
+    const Column& column = columns[c];
+    const char* type = TYPES[(column.getType() < getArraySize(TYPES)) ? column.getType() : DataTable::TYPE_STRING];
+    if (column.getType() == DataTable::TYPE_STRING) {
+      stream << "Column %1: Type:%2 Distinct:%3 Nulls:%4" %
+        Subst(c, type, column.getDictionary().getSize(), column.getNumberOfNulls()) << EOL;
+      continue;
+    }
+    const Stats stats = column.getStats();
+    stream << "Column %1: Type:%2 Min:%3 Max:%4 Average:%5 Nulls:%6" %
+      Subst(c, type, stats.minimum, stats.maximum, stats.getAverage(), stats.nulls) << EOL;
+  }
+  stream << FLUSH;
+  return stream;
+}
+
+#if defined(_COM_AZURE_DEV__BASE__TESTS)
+
+class TEST_CLASS(ColumnTable) : public UnitTest {
+public:
+
+  TEST_PRIORITY(200);
+  TEST_PROJECT("base/data");
+
+  void run() override
+  {
+    const Array<DataTable::Column> columns = {
+      DataTable::Column{"Name", DataTable::TYPE_STRING},
+      DataTable::Column{"Count", DataTable::TYPE_INT32},
+      DataTable::Column{"Value", DataTable::TYPE_FLOAT64},
+      DataTable::Column{"Flag", DataTable::TYPE_BOOL}
+    };
+    ColumnTable table = ColumnTable::loadFromString(
+      "Name;Count;Value;Flag\n"
+      "a;1;0.5;true\n"
+      "b;;1e-7;false\n"
+      "a;-20;;1\n",
+      columns,
+      DataTable::Config(DataTable::HEADER_USE)
+    );
+    TEST_EQUAL(table.getNumberOfColumns(), 4);
+    TEST_EQUAL(table.getNumberOfRows(), 3);
+    TEST_EQUAL(table.getColumnName(1), "Count");
+
+    const ColumnTable::Column& name = table.getColumn(0);
+    TEST_EQUAL(name.getDictionary().getSize(), 2);
+    TEST_EQUAL(name.getCodes()[0], name.getCodes()[2]);
+    TEST_EQUAL(name.getString(1), "b");
+
+    const ColumnTable::Column& count = table.getColumn(1);
+    TEST_EQUAL(count.getNumberOfNulls(), 1);
+    TEST_ASSERT(count.isNull(1) && !count.isNull(0) && !count.isNull(2));
+    TEST_ASSERT(table.getValue(1, 1).getRepresentation() == AnyValue::VOID);
+    TEST_EQUAL(table.getValue(2, 1).getInteger(), -20);
+
+    const ColumnTable::Stats stats = table.getStats(1);
+    TEST_EQUAL(stats.count, 2);
+    TEST_EQUAL(stats.nulls, 1);
+    TEST_EQUAL(stats.minimum, -20);
+    TEST_EQUAL(stats.maximum, 1);
+    TEST_EQUAL(stats.sum, -19);
+
+    DataTable::IntStats<int32> intStats;
+    table.calculate(1, intStats); // nulls are skipped
+    TEST_EQUAL(intStats.getMinimum(), -20);
+    TEST_EQUAL(intStats.getMaximum(), 1);
+
+    MemoryOutputStream mos;
+    table.saveCSV(&mos);
+    Allocator<uint8> buffer;
+    mos.swap(buffer);
+    const String csv(reinterpret_cast<const char*>(buffer.getElements()), buffer.getSize());
+    TEST_EQUAL(
+      csv,
+      "\"Name\";\"Count\";\"Value\";\"Flag\"\r\n"
+      "\"a\";1;0.5;true\r\n"
+      "\"b\";;1e-7;false\r\n"
+      "\"a\";-20;;true\r\n"
+    );
+
+    // round trip
+    ColumnTable copy = ColumnTable::loadFromString(csv, columns, DataTable::Config(DataTable::HEADER_USE));
+    TEST_EQUAL(copy.getNumberOfRows(), 3);
+    TEST_EQUAL(copy.getColumn(2).getNumberOfNulls(), 1);
+    TEST_EQUAL(copy.getValue(1, 2).getDouble(), 1e-7);
+
+    // from row oriented table
+    DataTable rows = DataTable::loadFromString("Name;Count;Value;Flag\n", columns, DataTable::Config(DataTable::HEADER_USE));
+    for (MemorySize i = 0; i < table.getNumberOfRows(); ++i) {
+      rows.getRows().append(table.getRow(i));
+    }
+    ColumnTable converted(rows);
+    TEST_EQUAL(converted.getNumberOfRows(), 3);
+    TEST_EQUAL(converted.getColumnName(3), "Flag");
+    TEST_EQUAL(converted.getColumn(1).getNumberOfNulls(), 1);
+    TEST_EQUAL(converted.getColumn(0).getString(2), "a");
+    TEST_ASSERT(converted.getValue(2, 3).getBoolean());
+
+    TEST_EXCEPTION(ColumnTable::loadFromString("x;99999999999\n", columns), InvalidException);
+
+    // parallel load gives the same table as serial load
+    StringOutputStream sos;
+    sos << "Name;Count;Value;Flag\r\n";
+    for (unsigned int i = 0; i < 40000; ++i) {
+      sos << "\"key " << (i % 97) << ";\";" << ((i % 11) ? String(format() << i) : String()) << ';'
+          << (i * 0.5) << ';' << ((i % 3) ? "true" : "false") << ((i % 2) ? "\r\n" : "\n");
+    }
+    const String text = sos;
+    const ColumnTable serial = ColumnTable::loadFromString(text, columns, DataTable::Config(DataTable::HEADER_USE));
+    const ColumnTable parallel = ColumnTable::loadParallel(
+      text.getBytes(), text.getBytes() + text.getLength(), columns, DataTable::Config(DataTable::HEADER_USE), 4
+    );
+    TEST_EQUAL(parallel.getNumberOfRows(), 40000);
+    TEST_EQUAL(parallel.getColumnName(0), "Name");
+    TEST_EQUAL(parallel.getColumn(0).getDictionary().getSize(), 97);
+    TEST_EQUAL(parallel.getColumn(1).getNumberOfNulls(), serial.getColumn(1).getNumberOfNulls());
+    bool same = (serial.getNumberOfRows() == parallel.getNumberOfRows());
+    for (MemorySize i = 0; same && (i < serial.getNumberOfRows()); ++i) {
+      for (unsigned int c = 0; c < 4; ++c) {
+        same &= (serial.getValue(i, c).getString() == parallel.getValue(i, c).getString());
+      }
+    }
+    TEST_ASSERT(same);
+
+    const String invalid = text + "x;1.5;0;true\n";
+    TEST_EXCEPTION(
+      ColumnTable::loadParallel(invalid.getBytes(), invalid.getBytes() + invalid.getLength(), columns, DataTable::Config(), 4),
+      InvalidException
+    );
+  }
+};
+
+TEST_REGISTER(ColumnTable);
+
+class TEST_CLASS(ColumnTableBenchmark) : public UnitTest {
+public:
+
+  TEST_PRIORITY(1000);
+  TEST_PROJECT("base/data");
+  TEST_IMPACT(LOW);
+  TEST_TIMEOUT_MS(120 * 1000);
+
+  void run() override
+  {
+    const MemorySize ROWS = 256 * 1024;
+    const Array<DataTable::Column> columns = {
+      DataTable::Column{"Key", DataTable::TYPE_STRING},
+      DataTable::Column{"Value", DataTable::TYPE_FLOAT64}
+    };
+    const String keys[] = {"alpha", "beta", "gamma", "delta"};
+
+    DataTable rows = DataTable::loadFromString("", columns);
+    Array<DataTable::Row>& _rows = rows.getRows();
+    _rows.setSize(ROWS); // appending rows one at a time copies all rows on each append
+    ColumnTable table(columns);
+    table.ensureCapacity(ROWS);
+    for (MemorySize i = 0; i < ROWS; ++i) {
+      DataTable::Row row;
+      row.append(AnyValue(keys[i % getArraySize(keys)]));
+      row.append(AnyValue(static_cast<double>(Random::random<uint32>())/PrimitiveTraits<uint32>::MAXIMUM));
+      table.appendRow(row);
+      _rows[i] = row;
+    }
+
+    Timer timer;
+    DataTable::FloatStats<double> rowStats;
+    rows.calculate(1, rowStats);
+    const uint64 rowTime = timer.getLiveMicroseconds();
+
+    timer.start();
+    const ColumnTable::Stats stats = table.getStats(1);
+    const uint64 columnTime = timer.getLiveMicroseconds();
+
+    TEST_EQUAL(stats.count, ROWS);
+    TEST_EQUAL(stats.minimum, rowStats.getMinimum());
+    TEST_EQUAL(stats.maximum, rowStats.getMaximum());
+    TEST_PRINT(format() << "Rows: " << ROWS << " row oriented: " << rowTime << " us, column oriented: " << columnTime << " us");
+    TEST_PRINT(format() << "Column memory: " << table.getMemoryUsage() << " bytes");
+  }
+};
+
+TEST_REGISTER(ColumnTableBenchmark);
+
+class TEST_CLASS(ColumnTableLoadBenchmark) : public UnitTest {
+public:
+
+  TEST_PRIORITY(1000);
+  TEST_PROJECT("base/data");
+  TEST_IMPACT(LOW);
+  TEST_TIMEOUT_MS(120 * 1000);
+
+  void run() override
+  {
+    const Array<DataTable::Column> columns = {
+      DataTable::Column{"Id", DataTable::TYPE_INT64},
+      DataTable::Column{"Key", DataTable::TYPE_STRING},
+      DataTable::Column{"Value", DataTable::TYPE_FLOAT64},
+      DataTable::Column{"Count", DataTable::TYPE_INT32}
+    };
+    StringOutputStream sos;
+    for (unsigned int i = 0; i < 500000; ++i) {
+      sos << i << ";\"key " << (i % 1000) << "\";" << (i * 0.125) << ';' << (i % 4096) << '\n';
+    }
+    const String text = sos;
+
+    Timer timer;
+    const ColumnTable serial = ColumnTable::loadFromString(text, columns);
+    const uint64 serialTime = timer.getLiveMicroseconds();
+    timer.start();
+    const ColumnTable parallel = ColumnTable::loadParallel(text.getBytes(), text.getBytes() + text.getLength(), columns);
+    const uint64 parallelTime = timer.getLiveMicroseconds();
+    TEST_EQUAL(serial.getNumberOfRows(), parallel.getNumberOfRows());
+
+    const double megabytes = text.getLength()/(1024.0 * 1024);
+    TEST_PRINT(format() << "Size: " << text.getLength() << " bytes, serial: " << megabytes * 1000000/maximum<uint64>(serialTime, 1)
+               << " MB/s, parallel: " << megabytes * 1000000/maximum<uint64>(parallelTime, 1) << " MB/s, threads: "
+               << Process::getNumberOfOnlineProcessors());
+  }
+};
+
+TEST_REGISTER(ColumnTableLoadBenchmark);
+
+#endif
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
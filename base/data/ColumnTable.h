@@ -0,0 +1,412 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#pragma once
+
+#include <base/data/DataTable.h>
+#include <base/collection/HashTable.h>
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+/**
+  Column oriented data table. Each column is stored as a contiguous array of
+  the column type instead of an AnyValue per cell. String columns are
+  dictionary encoded with a 32-bit code per row. Missing values are tracked by
+  a validity bitmap which is only allocated once the column has a missing
+  value. Uses the same load and save API as DataTable and the same handling of
+  the load config (see DataTable::LineBuilder). Unlike DataTable, blank fields
+  of non-string columns are loaded as missing values.
+
+  @short Column oriented data table.
+  @version 1.0
+*/
+
+class _COM_AZURE_DEV__BASE__API ColumnTable {
+  friend class ColumnTableFile;
+  friend class ColumnQuery;
+public:
+
+  typedef DataTable::Type Type;
+  typedef DataTable::Config Config;
+
+  /** Column info. */
+  typedef DataTable::Column ColumnInfo;
+
+  /** Statistics for a numeric column. Missing values are skipped. */
+  class _COM_AZURE_DEV__BASE__API Stats {
+  public:
+
+    /** The number of values. */
+    MemorySize count = 0;
+    /** The number of missing values. */
+    MemorySize nulls = 0;
+    /** The minimum value. */
+    double minimum = 0;
+    /** The maximum value. */
+    double maximum = 0;
+    /** The sum. */
+    double sum = 0;
+
+    /** Returns the average value. */
+    inline double getAverage() const noexcept
+    {
+      return (count > 0) ? sum/count : 0;
+    }
+  };
+
+  /** Column storage. */
+  class _COM_AZURE_DEV__BASE__API Column {
+    friend class ColumnTable;
+    friend class ColumnTableFile;
+    friend class ColumnQuery;
+  private:
+
+    /** The name. */
+    String name;
+    /** The type. */
+    Type type = DataTable::TYPE_INT32;
+    /** The number of rows. */
+    MemorySize size = 0;
+    /** The number of missing values. */
+    MemorySize nulls = 0;
+    /** Values for TYPE_BOOL. */
+    Array<uint8> bools;
+    /** Values for TYPE_INT32. */
+    Array<int32> ints;
+    /** Values for TYPE_INT64. */
+    Array<int64> longs;
+    /** Values for TYPE_FLOAT32. */
+    Array<float> floats;
+    /** Values for TYPE_FLOAT64. */
+    Array<double> doubles;
+    /** Dictionary codes for TYPE_STRING. */
+    Array<uint32> codes;
+    /** The distinct strings. */
+    Array<String> dictionary;
+    /** Lookup of dictionary code. */
+    HashTable<String, uint32> lookup;
+    /** Validity bitmap. Bit is set for present values. Empty if no values are missing. */
+    Array<uint64> valid;
+
+    /** Updates size and validity bitmap after a value has been appended. */
+    void appended(bool present);
+
+    /** Returns the dictionary code for the given string. */
+    uint32 getCode(const String& value);
+  public:
+
+    /** Initializes column. */
+    Column(const String& name = String(), Type type = DataTable::TYPE_INT32);
+
+    /** Returns the name. */
+    inline const String& getName() const noexcept
+    {
+      return name;
+    }
+
+    /** Returns the type. */
+    inline Type getType() const noexcept
+    {
+      return type;
+    }
+
+    /** Returns the number of rows. */
+    inline MemorySize getSize() const noexcept
+    {
+      return size;
+    }
+
+    /** Returns the number of missing values. */
+    inline MemorySize getNumberOfNulls() const noexcept
+    {
+      return nulls;
+    }
+
+    /** Returns true if the given value is missing. */
+    inline bool isNull(MemorySize index) const noexcept
+    {
+      return valid && !((valid[index/64] >> (index % 64)) & 1);
+    }
+
+    /** Returns the validity bitmap. Returns nullptr if no values are missing. */
+    inline const uint64* getValidBitmap() const noexcept
+    {
+      return valid ? valid.getFirstReference() : nullptr;
+    }
+
+    /** Reserves capacity for the given number of rows. */
+    void ensureCapacity(MemorySize capacity);
+
+    /** Appends a missing value. */
+    void appendNull();
+
+    /** Appends value. */
+    void append(bool value);
+
+    /** Appends value. */
+    void append(int32 value);
+
+    /** Appends value. */
+    void append(int64 value);
+
+    /** Appends value. */
+    void append(float value);
+
+    /** Appends value. */
+    void append(double value);
+
+    /** Appends value. */
+    void append(const String& value);
+
+    /** Appends value converted to the column type. Void value is appended as missing. Text is parsed. */
+    void append(const AnyValue& value);
+
+    /** Appends all values of the given column which must have the same type. */
+    void appendColumn(const Column& other);
+
+    /** Returns the value. Missing value is returned as invalid AnyValue. */
+    AnyValue getValue(MemorySize index) const;
+
+    /** Returns the values of TYPE_BOOL column. */
+    inline const uint8* getBools() const noexcept
+    {
+      return bools.getFirstReference();
+    }
+
+    /** Returns the values of TYPE_INT32 column. */
+    inline const int32* getInts() const noexcept
+    {
+      return ints.getFirstReference();
+    }
+
+    /** Returns the values of TYPE_INT64 column. */
+    inline const int64* getLongs() const noexcept
+    {
+      return longs.getFirstReference();
+    }
+
+    /** Returns the values of TYPE_FLOAT32 column. */
+    inline const float* getFloats() const noexcept
+    {
+      return floats.getFirstReference();
+    }
+
+    /** Returns the values of TYPE_FLOAT64 column. */
+    inline const double* getDoubles() const noexcept
+    {
+      return doubles.getFirstReference();
+    }
+
+    /** Returns the dictionary codes of TYPE_STRING column. */
+    inline const uint32* getCodes() const noexcept
+    {
+      return codes.getFirstReference();
+    }
+
+    /** Returns the distinct strings of TYPE_STRING column. */
+    inline const Array<String>& getDictionary() const noexcept
+    {
+      return dictionary;
+    }
+
+    /** Returns the string for the given row. */
+    inline const String& getString(MemorySize index) const
+    {
+      return dictionary[codes[index]];
+    }
+
+    /** Returns statistics for numeric column. */
+    Stats getStats() const;
+
+    /** Returns the number of bytes used for the values. */
+    MemorySize getMemoryUsage() const noexcept;
+  };
+private:
+
+  /** Builds table from CSV lines. */
+  class Builder;
+
+  /** Builds table from part of CSV data. */
+  class Job;
+
+  /** The columns. */
+  Array<Column> columns;
+  /** The number of rows. */
+  MemorySize rows = 0;
+public:
+
+  /** Loads table from file. */
+  static ColumnTable load(const String& path, const Array<ColumnInfo>& columns, const Config& config = Config());
+
+  /** Loads table from input stream. */
+  static ColumnTable load(InputStream* is, const Array<ColumnInfo>& columns, const Config& config = Config());
+
+  /** Loads table from string. */
+  static ColumnTable loadFromString(const String& data, const Array<ColumnInfo>& columns, const Config& config = Config());
+
+  /** The minimum number of bytes per thread for loadParallel(). */
+  static constexpr MemorySize PARALLEL_CHUNK_SIZE = 256 * 1024;
+
+  /**
+    Loads table from CSV data in memory using the given number of threads.
+    The data is split into chunks at line ends and each chunk is parsed and
+    converted into its own table which are then appended in order. The
+    result is the same as for load(). Custom converters of the config must be
+    MT-safe.
+
+    @param threads The number of threads. Uses the number of online processors if 0.
+  */
+  static ColumnTable loadParallel(const uint8* src, const uint8* end, const Array<ColumnInfo>& columns, const Config& config = Config(), unsigned int threads = 0);
+
+  /**
+    Loads table from file using loadParallel(). The file is mapped into memory
+    a window at a time so the file may be larger than the address space.
+  */
+  static ColumnTable loadParallel(const String& path, const Array<ColumnInfo>& columns, const Config& config = Config(), unsigned int threads = 0);
+
+  /** Saves CSV data. Missing values are written as blank fields. */
+  void saveCSV(OutputStream* os, char separator = ';');
+
+  /** Saves CSV data. */
+  void saveCSV(const String& path);
+
+  /** Initializes empty table. */
+  ColumnTable();
+
+  /** Initializes empty table with the given columns. */
+  ColumnTable(const Array<ColumnInfo>& columns);
+
+  /** Initializes table from row oriented table. */
+  ColumnTable(const DataTable& table);
+
+  /** Returns the number of columns. */
+  inline unsigned int getNumberOfColumns() const noexcept
+  {
+    return static_cast<unsigned int>(columns.getSize());
+  }
+
+  /** Returns the number of rows. */
+  inline MemorySize getNumberOfRows() const noexcept
+  {
+    return rows;
+  }
+
+  /** Returns the column. */
+  inline const Column& getColumn(unsigned int column) const
+  {
+    return columns[column];
+  }
+
+  /** Returns the type of the column. */
+  inline Type getColumnType(unsigned int column) const
+  {
+    return getColumn(column).getType();
+  }
+
+  /** Returns the name of the column. */
+  inline const String& getColumnName(unsigned int column) const
+  {
+    return getColumn(column).getName();
+  }
+
+  /** Sets the name of the column. */
+  inline void setColumnName(unsigned int column, const String& name)
+  {
+    columns[column].name = name;
+  }
+
+  /** Reserves capacity for the given number of rows. */
+  void ensureCapacity(MemorySize capacity);
+
+  /** Appends row. The values are converted to the column types. */
+  void appendRow(const DataTable::Row& row);
+
+  /** Appends all rows of the given table which must have the same column types. */
+  void append(const ColumnTable& other);
+
+  /** Returns the given row. */
+  DataTable::Row getRow(MemorySize index) const;
+
+  /** Returns the value. */
+  inline AnyValue getValue(MemorySize index, unsigned int column) const
+  {
+    return getColumn(column).getValue(index);
+  }
+
+  /** Returns statistics for numeric column. */
+  inline Stats getStats(unsigned int column) const
+  {
+    return getColumn(column).getStats();
+  }
+
+  /** Calculates value for column. Missing values are skipped. */
+  template<typename OP>
+  void calculate(unsigned int column, OP& op) const
+  {
+    const Column& c = getColumn(column);
+    switch (c.getType()) {
+    case DataTable::TYPE_BOOL:
+      calculate(c, c.getBools(), op);
+      break;
+    case DataTable::TYPE_INT32:
+      calculate(c, c.getInts(), op);
+      break;
+    case DataTable::TYPE_INT64:
+      calculate(c, c.getLongs(), op);
+      break;
+    case DataTable::TYPE_FLOAT32:
+      calculate(c, c.getFloats(), op);
+      break;
+    case DataTable::TYPE_FLOAT64:
+      calculate(c, c.getDoubles(), op);
+      break;
+    default:
+      {
+        const uint32* codes = c.getCodes();
+        const Array<String>& dictionary = c.getDictionary();
+        for (MemorySize i = 0; i < c.getSize(); ++i) {
+          if (!c.isNull(i)) {
+            op(dictionary[codes[i]]);
+          }
+        }
+      }
+    }
+  }
+private:
+
+  template<typename TYPE, typename OP>
+  static void calculate(const Column& c, const TYPE* values, OP& op)
+  {
+    const MemorySize size = c.getSize();
+    if (!c.getNumberOfNulls()) {
+      for (MemorySize i = 0; i < size; ++i) {
+        op(values[i]);
+      }
+      return;
+    }
+    for (MemorySize i = 0; i < size; ++i) {
+      if (!c.isNull(i)) {
+        op(values[i]);
+      }
+    }
+  }
+public:
+
+  /** Returns the number of bytes used for the values. */
+  MemorySize getMemoryUsage() const noexcept;
+
+  /** Prints stats for the columns. */
+  FormatOutputStream& dumpStats(FormatOutputStream& stream) const;
+};
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
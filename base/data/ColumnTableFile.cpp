@@ -0,0 +1,813 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#include <base/data/ColumnTableFile.h>
+#include <base/compression/ZLibDeflater.h>
+#include <base/compression/ZLibInflater.h>
+#include <base/filesystem/FileSystem.h>
+#include <base/io/FileOutputStream.h>
+#include <base/io/MappedFile.h>
+#include <base/io/MemoryOutputStream.h>
+#include <base/string/InvalidFormat.h>
+#include <base/string/StringOutputStream.h>
+#include <base/Timer.h>
+#include <base/Random.h>
+#include <base/UnitTest.h>
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+namespace {
+
+  const uint8 MAGIC[4] = {'B', 'C', 'O', 'L'};
+  const unsigned int HEADER_SIZE = 16;
+  const unsigned int TRAILER_SIZE = 16;
+  const MemorySize MAXIMUM_WRITE = 1024 * 1024 * 1024;
+
+  /** The arrays of a column. Each array has an offset, a stored size, and a loaded size. */
+  enum {
+    REGION_VALUES,
+    REGION_VALID,
+    REGION_DICTIONARY,
+    REGIONS
+  };
+
+  /** Returns the number of bytes per value of the given type. */
+  inline unsigned int getValueSize(DataTable::Type type) noexcept
+  {
+    switch (type) {
+    case DataTable::TYPE_BOOL:
+      return sizeof(uint8);
+    case DataTable::TYPE_INT32:
+      return sizeof(int32);
+    case DataTable::TYPE_INT64:
+      return sizeof(int64);
+    case DataTable::TYPE_FLOAT32:
+      return sizeof(float);
+    case DataTable::TYPE_FLOAT64:
+      return sizeof(double);
+    case DataTable::TYPE_STRING:
+    default:
+      return sizeof(uint32); // dictionary codes
+    }
+  }
+
+  /** Writes to stream and keeps track of the offset. */
+  class Writer {
+  private:
+
+    OutputStream* os = nullptr;
+    uint64 offset = 0;
+  public:
+
+    inline Writer(OutputStream* _os) noexcept
+      : os(_os)
+    {
+    }
+
+    inline uint64 getOffset() const noexcept
+    {
+      return offset;
+    }
+
+    void write(const void* buffer, MemorySize size)
+    {
+      const uint8* src = static_cast<const uint8*>(buffer);
+      while (size > 0) {
+        const unsigned int bytesWritten =
+          os->write(src, static_cast<unsigned int>(minimum(size, MAXIMUM_WRITE)), false);
+        if (!bytesWritten) {
+          _throw IOException("Unable to write column table.");
+        }
+        src += bytesWritten;
+        size -= bytesWritten;
+        offset += bytesWritten;
+      }
+    }
+
+    template<typename TYPE>
+    inline void put(TYPE value)
+    {
+      write(&value, sizeof(value));
+    }
+
+    /** Pads to 8 bytes. */
+    inline void align()
+    {
+      const uint8 zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+      write(zeros, (8 - (offset % 8)) % 8);
+    }
+  };
+
+  /** Reads the footer. Raises InvalidFormat if truncated. */
+  class Reader {
+  private:
+
+    const uint8* src = nullptr;
+    const uint8* end = nullptr;
+  public:
+
+    inline Reader(const uint8* _src, const uint8* _end) noexcept
+      : src(_src), end(_end)
+    {
+    }
+
+    inline bool isEmpty() const noexcept
+    {
+      return src == end;
+    }
+
+    const uint8* getBytes(MemorySize size)
+    {
+      if (static_cast<MemorySize>(end - src) < size) {
+        _throw InvalidFormat("Truncated column table footer.");
+      }
+      const uint8* result = src;
+      src += size;
+      return result;
+    }
+
+    template<typename TYPE>
+    inline TYPE get()
+    {
+      TYPE result;
+      copy<uint8>(reinterpret_cast<uint8*>(&result), getBytes(sizeof(TYPE)), sizeof(TYPE));
+      return result;
+    }
+  };
+
+  /** Appends bytes to array. */
+  inline void appendBytes(Array<uint8>& buffer, const uint8* src, MemorySize size)
+  {
+    const MemorySize offset = buffer.getSize();
+    buffer.setSize(offset + size);
+    copy<uint8>(buffer.getElements() + offset, src, size);
+  }
+
+  /** Returns the ZLib compressed bytes. */
+  Array<uint8> compress(const uint8* src, MemorySize size)
+  {
+    ZLibDeflater deflater;
+    Array<uint8> result;
+    result.setSize(0);
+    uint8 buffer[16 * 1024];
+    while (size > 0) {
+      const MemorySize bytesPushed = deflater.push(src, minimum(size, MAXIMUM_WRITE));
+      src += bytesPushed;
+      size -= bytesPushed;
+      if (!bytesPushed) { // buffer is full
+        appendBytes(result, buffer, deflater.pull(buffer, sizeof(buffer)));
+      }
+    }
+    deflater.pushEnd();
+    while (!deflater.atEnd()) {
+      appendBytes(result, buffer, deflater.pull(buffer, sizeof(buffer)));
+    }
+    return result;
+  }
+
+  /** Decompresses ZLib compressed bytes which must decompress to exactly the given size. */
+  void decompress(const uint8* src, MemorySize size, uint8* dest, MemorySize rawSize)
+  {
+    try {
+      ZLibInflater inflater;
+      const uint8* end = src + size;
+      uint8* destEnd = dest + rawSize;
+      while (src != end) {
+        const MemorySize bytesPushed = inflater.push(src, minimum<MemorySize>(end - src, MAXIMUM_WRITE));
+        src += bytesPushed;
+        if (!bytesPushed) { // buffer is full
+          if (dest == destEnd) {
+            _throw InvalidFormat("Invalid compressed column.");
+          }
+          dest += inflater.pull(dest, minimum<MemorySize>(destEnd - dest, MAXIMUM_WRITE));
+        }
+      }
+      inflater.pushEnd();
+      while (!inflater.atEnd()) {
+        if (dest != destEnd) {
+          dest += inflater.pull(dest, minimum<MemorySize>(destEnd - dest, MAXIMUM_WRITE));
+        } else {
+          uint8 extra = 0;
+          if (inflater.pull(&extra, 1)) {
+            _throw InvalidFormat("Invalid compressed column.");
+          }
+        }
+      }
+      if (dest != destEnd) {
+        _throw InvalidFormat("Invalid compressed column.");
+      }
+    } catch (IOException&) {
+      _throw InvalidFormat("Invalid compressed column.");
+    }
+  }
+
+  /** Writes array and stores the location in the given regions. */
+  void writeRegion(Writer& writer, const void* src, MemorySize size, bool useCompression, uint64* regions)
+  {
+    writer.align();
+    regions[0] = writer.getOffset();
+    regions[2] = size;
+    if (useCompression && (size > 0)) {
+      const Array<uint8> compressed = compress(static_cast<const uint8*>(src), size);
+      if (compressed.getSize() < size) { // a smaller stored size indicates compression
+        writer.write(compressed.getFirstReference(), compressed.getSize());
+        regions[1] = compressed.getSize();
+        return;
+      }
+    }
+    writer.write(src, size);
+    regions[1] = size;
+  }
+
+  /** Returns the dictionary as offsets followed by the UTF-8 bytes. */
+  Array<uint8> getDictionary(const Array<String>& dictionary)
+  {
+    const MemorySize count = dictionary.getSize();
+    MemorySize size = (count + 1) * sizeof(uint64);
+    for (const auto& value : dictionary) {
+      size += value.getLength();
+    }
+    Array<uint8> result;
+    result.setSize(size);
+    uint64* offsets = reinterpret_cast<uint64*>(result.getElements());
+    uint8* dest = result.getElements() + (count + 1) * sizeof(uint64);
+    uint64 offset = 0;
+    for (MemorySize i = 0; i < count; ++i) {
+      const String& value = dictionary[i];
+      offsets[i] = offset;
+      copy<uint8>(dest + offset, value.getBytes(), value.getLength());
+      offset += value.getLength();
+    }
+    offsets[count] = offset;
+    return result;
+  }
+
+  /** Memory which may be unaligned. */
+  template<typename TYPE>
+  inline TYPE getUnaligned(const uint8* src) noexcept
+  {
+    TYPE result;
+    copy<uint8>(reinterpret_cast<uint8*>(&result), src, sizeof(TYPE));
+    return result;
+  }
+}
+
+class ColumnTableFile::Source {
+public:
+
+  /** Returns the size of the file. */
+  virtual uint64 getSize() const noexcept = 0;
+
+  /** Returns the given bytes. The bytes are only valid until the next call. */
+  virtual const uint8* getBytes(uint64 offset, uint64 size) = 0;
+
+  virtual ~Source() noexcept(false)
+  {
+  }
+};
+
+class ColumnTableFile::MemorySource : public Source {
+private:
+
+  const uint8* src = nullptr;
+  const uint8* end = nullptr;
+public:
+
+  inline MemorySource(const uint8* _src, const uint8* _end) noexcept
+    : src(_src), end(_end)
+  {
+  }
+
+  uint64 getSize() const noexcept override
+  {
+    return end - src;
+  }
+
+  const uint8* getBytes(uint64 offset, uint64 size) override
+  {
+    return src + offset;
+  }
+};
+
+class ColumnTableFile::FileSource : public Source {
+private:
+
+  /** Owns the mapping of a region. */
+  class Mapping : public ReferenceCountedObject {
+  public:
+
+    MappedFile map;
+
+    inline Mapping(const File& file, const FileRegion& region)
+      : map(file, region)
+    {
+    }
+  };
+
+  File file;
+  uint64 size = 0;
+  Reference<Mapping> mapping;
+public:
+
+  FileSource(const String& path)
+    : file(path, File::READ, 0)
+  {
+    size = file.getSize();
+  }
+
+  uint64 getSize() const noexcept override
+  {
+    return size;
+  }
+
+  const uint8* getBytes(uint64 offset, uint64 size) override
+  {
+    if (size == 0) {
+      return nullptr;
+    }
+    const uint64 base = offset - (offset % MappedFile::getGranularity());
+    if ((offset - base + size) > PrimitiveTraits<unsigned int>::MAXIMUM) {
+      _throw OutOfRange("Column is too large to be mapped.");
+    }
+    mapping = nullptr; // release previous region first
+    mapping = new Mapping(file, FileRegion(base, static_cast<unsigned int>(offset - base + size)));
+    return mapping->map.getBytes() + (offset - base);
+  }
+};
+
+void ColumnTableFile::save(const ColumnTable& table, OutputStream* os, Compression compression)
+{
+  Array<Compression> compressions;
+  compressions.setSize(table.getNumberOfColumns(), compression);
+  save(table, os, compressions);
+}
+
+void ColumnTableFile::save(const ColumnTable& table, OutputStream* os, const Array<Compression>& compression)
+{
+#if (_COM_AZURE_DEV__BASE__BYTE_ORDER != _COM_AZURE_DEV__BASE__LITTLE_ENDIAN)
+  _throw NotSupported("Column table file requires little endian byte order.");
+#endif
+  if (compression.getSize() != table.getNumberOfColumns()) {
+    _throw OutOfRange("Compression does not match number of columns.");
+  }
+  const unsigned int numberOfColumns = table.getNumberOfColumns();
+  const MemorySize rows = table.getNumberOfRows();
+
+  Writer writer(os);
+  writer.write(MAGIC, sizeof(MAGIC));
+  writer.put<uint32>(VERSION);
+  writer.put<uint64>(0);
+
+  Array<uint64> regions;
+  regions.setSize(numberOfColumns * REGIONS * 3, 0);
+  for (unsigned int c = 0; c < numberOfColumns; ++c) {
+    const ColumnTable::Column& column = table.getColumn(c);
+    const bool useCompression = (compression[c] == COMPRESSION_ZLIB) && ZLibDeflater::isSupported();
+    uint64* region = regions.getElements() + c * REGIONS * 3;
+    const void* values = nullptr;
+    switch (column.getType()) {
+    case DataTable::TYPE_BOOL:
+      values = column.getBools();
+      break;
+    case DataTable::TYPE_INT32:
+      values = column.getInts();
+      break;
+    case DataTable::TYPE_INT64:
+      values = column.getLongs();
+      break;
+    case DataTable::TYPE_FLOAT32:
+      values = column.getFloats();
+      break;
+    case DataTable::TYPE_FLOAT64:
+      values = column.getDoubles();
+      break;
+    case DataTable::TYPE_STRING:
+    default:
+      values = column.getCodes();
+    }
+    writeRegion(writer, values, rows * getValueSize(column.getType()), useCompression, region + REGION_VALUES * 3);
+    if (column.getNumberOfNulls()) {
+      writeRegion(writer, column.getValidBitmap(), (rows + 63)/64 * sizeof(uint64), useCompression, region + REGION_VALID * 3);
+    }
+    if (column.getType() == DataTable::TYPE_STRING) {
+      const Array<uint8> dictionary = getDictionary(column.getDictionary());
+      writeRegion(writer, dictionary.getFirstReference(), dictionary.getSize(), useCompression, region + REGION_DICTIONARY * 3);
+    }
+  }
+
+  writer.align();
+  const uint64 footerOffset = writer.getOffset();
+  writer.put<uint64>(rows);
+  writer.put<uint32>(numberOfColumns);
+  for (unsigned int c = 0; c < numberOfColumns; ++c) {
+    const ColumnTable::Column& column = table.getColumn(c);
+    const ColumnTable::Stats stats = column.getStats();
+    const String& name = column.getName();
+    writer.put<uint32>(static_cast<uint32>(name.getLength()));
+    writer.write(name.getBytes(), name.getLength());
+    writer.put<uint8>(static_cast<uint8>(column.getType()));
+    writer.put<uint8>(static_cast<uint8>(compression[c]));
+    writer.put<uint16>(0);
+    writer.put<uint64>(column.getNumberOfNulls());
+    writer.put<uint64>(column.getDictionary().getSize());
+    writer.put<uint64>(stats.count);
+    writer.put<double>(stats.minimum);
+    writer.put<double>(stats.maximum);
+    writer.put<double>(stats.sum);
+    writer.write(regions.getFirstReference() + c * REGIONS * 3, REGIONS * 3 * sizeof(uint64));
+  }
+  const uint64 footerSize = writer.getOffset() - footerOffset;
+  if (footerSize > PrimitiveTraits<uint32>::MAXIMUM) {
+    _throw OutOfRange("Column table footer is too large.");
+  }
+  writer.put<uint64>(footerOffset);
+  writer.put<uint32>(static_cast<uint32>(footerSize));
+  writer.write(MAGIC, sizeof(MAGIC));
+  os->flush();
+}
+
+void ColumnTableFile::save(const ColumnTable& table, const String& path, Compression compression)
+{
+  FileOutputStream fos(path);
+  save(table, &fos, compression);
+}
+
+ColumnTableFile::Schema ColumnTableFile::getSchema(Source& source, Array<uint64>& regions)
+{
+#if (_COM_AZURE_DEV__BASE__BYTE_ORDER != _COM_AZURE_DEV__BASE__LITTLE_ENDIAN)
+  _throw NotSupported("Column table file requires little endian byte order.");
+#endif
+  const uint64 size = source.getSize();
+  if (size < (HEADER_SIZE + TRAILER_SIZE)) {
+    _throw InvalidFormat("Not a column table.");
+  }
+  const uint8* header = source.getBytes(0, HEADER_SIZE);
+  if (!equal(header, MAGIC, sizeof(MAGIC))) {
+    _throw InvalidFormat("Not a column table.");
+  }
+  if (getUnaligned<uint32>(header + 4) != VERSION) {
+    _throw InvalidFormat("Unsupported column table version.");
+  }
+  const uint8* trailer = source.getBytes(size - TRAILER_SIZE, TRAILER_SIZE);
+  const uint64 footerOffset = getUnaligned<uint64>(trailer);
+  const uint32 footerSize = getUnaligned<uint32>(trailer + 8);
+  if (!equal(trailer + 12, MAGIC, sizeof(MAGIC)) ||
+      (footerOffset < HEADER_SIZE) || (footerOffset > (size - TRAILER_SIZE)) ||
+      (footerSize != (size - TRAILER_SIZE - footerOffset))) {
+    _throw InvalidFormat("Invalid column table trailer.");
+  }
+
+  const uint8* footer = source.getBytes(footerOffset, footerSize);
+  Reader reader(footer, footer + footerSize);
+  Schema schema;
+  const uint64 rows = reader.get<uint64>();
+  const uint32 numberOfColumns = reader.get<uint32>();
+  if ((rows > PrimitiveTraits<MemorySize>::MAXIMUM) || (numberOfColumns > (footerSize/64))) {
+    _throw InvalidFormat("Invalid column table footer.");
+  }
+  schema.rows = static_cast<MemorySize>(rows);
+  schema.columns.setSize(numberOfColumns);
+  regions.setSize(numberOfColumns * REGIONS * 3);
+  for (uint32 c = 0; c < numberOfColumns; ++c) {
+    ColumnSchema& column = schema.columns[c];
+    const uint32 length = reader.get<uint32>();
+    const uint8* name = reader.getBytes(length);
+    column.name = String(reinterpret_cast<const char*>(name), length);
+    const uint8 type = reader.get<uint8>();
+    const uint8 compression = reader.get<uint8>();
+    reader.get<uint16>();
+    if ((type > DataTable::TYPE_STRING) || (compression > COMPRESSION_ZLIB)) {
+      _throw InvalidFormat("Invalid column table footer.");
+    }
+    column.type = static_cast<DataTable::Type>(type);
+    column.compression = static_cast<Compression>(compression);
+    column.stats.nulls = static_cast<MemorySize>(reader.get<uint64>());
+    const uint64 distinct = reader.get<uint64>();
+    column.stats.count = static_cast<MemorySize>(reader.get<uint64>());
+    column.stats.minimum = reader.get<double>();
+    column.stats.maximum = reader.get<double>();
+    column.stats.sum = reader.get<double>();
+    if ((column.stats.nulls > rows) || (column.stats.count > rows) ||
+        (distinct > PrimitiveTraits<uint32>::MAXIMUM) || ((type != DataTable::TYPE_STRING) && distinct) ||
+        ((type == DataTable::TYPE_STRING) && rows && !distinct)) {
+      _throw InvalidFormat("Invalid column table footer.");
+    }
+    column.distinct = static_cast<MemorySize>(distinct);
+
+    const uint64 expected[REGIONS] = {
+      rows * getValueSize(column.type),
+      column.stats.nulls ? (rows + 63)/64 * sizeof(uint64) : 0,
+      0
+    };
+    uint64* region = regions.getElements() + c * REGIONS * 3;
+    for (unsigned int r = 0; r < REGIONS; ++r) {
+      const uint64 offset = region[r * 3 + 0] = reader.get<uint64>();
+      const uint64 storedSize = region[r * 3 + 1] = reader.get<uint64>();
+      const uint64 rawSize = region[r * 3 + 2] = reader.get<uint64>();
+      if ((storedSize && ((offset < HEADER_SIZE) || (offset > footerOffset) || (storedSize > (footerOffset - offset)))) ||
+          (storedSize > rawSize) || ((r != REGION_DICTIONARY) && (rawSize != expected[r])) ||
+          ((storedSize < rawSize) && (column.compression != COMPRESSION_ZLIB))) {
+        _throw InvalidFormat("Invalid column table footer.");
+      }
+      column.storedSize += static_cast<MemorySize>(storedSize);
+      column.size += static_cast<MemorySize>(rawSize);
+    }
+    const uint64 dictionarySize = region[REGION_DICTIONARY * 3 + 2];
+    if ((type == DataTable::TYPE_STRING) ? (dictionarySize < ((distinct + 1) * sizeof(uint64))) : (dictionarySize != 0)) {
+      _throw InvalidFormat("Invalid column table footer.");
+    }
+  }
+  if (!reader.isEmpty()) {
+    _throw InvalidFormat("Invalid column table footer.");
+  }
+  return schema;
+}
+
+ColumnTableFile::Schema ColumnTableFile::getSchema(const uint8* src, const uint8* end)
+{
+  MemorySource source(src, end);
+  Array<uint64> regions;
+  return getSchema(source, regions);
+}
+
+ColumnTableFile::Schema ColumnTableFile::getSchema(const String& path)
+{
+  FileSource source(path);
+  Array<uint64> regions;
+  return getSchema(source, regions);
+}
+
+namespace {
+
+  /** Reads array of the given size into destination. */
+  void readRegion(const uint8* src, const uint64* region, uint8* dest)
+  {
+    if (region[1] < region[2]) {
+      decompress(src, static_cast<MemorySize>(region[1]), dest, static_cast<MemorySize>(region[2]));
+    } else {
+      copy<uint8>(dest, src, static_cast<MemorySize>(region[2]));
+    }
+  }
+
+  /** Sets the values from the array. */
+  template<typename SOURCE, typename TYPE>
+  void readValues(SOURCE& source, const uint64* region, MemorySize rows, Array<TYPE>& values)
+  {
+    values.setSize(rows);
+    if (rows > 0) {
+      readRegion(source.getBytes(region[0], region[1]), region, reinterpret_cast<uint8*>(values.getElements()));
+    }
+  }
+}
+
+ColumnTable ColumnTableFile::load(Source& source)
+{
+  Array<uint64> regions;
+  const Schema schema = getSchema(source, regions);
+  const MemorySize rows = schema.rows;
+
+  ColumnTable result;
+  result.rows = rows;
+  result.columns.setSize(schema.columns.getSize());
+  for (MemorySize c = 0; c < schema.columns.getSize(); ++c) {
+    const ColumnSchema& info = schema.columns[c];
+    const uint64* region = regions.getFirstReference() + c * REGIONS * 3;
+    ColumnTable::Column& column = result.columns[c];
+    column = ColumnTable::Column(info.name, info.type);
+    column.size = rows;
+    column.nulls = info.stats.nulls;
+
+    const uint64* values = region + REGION_VALUES * 3;
+    switch (info.type) {
+    case DataTable::TYPE_BOOL:
+      readValues(source, values, rows, column.bools);
+      break;
+    case DataTable::TYPE_INT32:
+      readValues(source, values, rows, column.ints);
+      break;
+    case DataTable::TYPE_INT64:
+      readValues(source, values, rows, column.longs);
+      break;
+    case DataTable::TYPE_FLOAT32:
+      readValues(source, values, rows, column.floats);
+      break;
+    case DataTable::TYPE_FLOAT64:
+      readValues(source, values, rows, column.doubles);
+      break;
+    case DataTable::TYPE_STRING:
+    default:
+      readValues(source, values, rows, column.codes);
+      {
+        const uint32* codes = column.codes.getFirstReference();
+        for (MemorySize i = 0; i < rows; ++i) {
+          if (codes[i] >= info.distinct) {
+            _throw InvalidFormat("Invalid dictionary code.");
+          }
+        }
+      }
+    }
+
+    if (info.stats.nulls) {
+      const uint64* valid = region + REGION_VALID * 3;
+      readValues(source, valid, static_cast<MemorySize>(valid[2]/sizeof(uint64)), column.valid);
+    }
+
+    if (info.type == DataTable::TYPE_STRING) {
+      const uint64* dictionary = region + REGION_DICTIONARY * 3;
+      Array<uint8> bytes;
+      readValues(source, dictionary, static_cast<MemorySize>(dictionary[2]), bytes);
+      const MemorySize distinct = info.distinct;
+      const uint8* text = bytes.getFirstReference() + (distinct + 1) * sizeof(uint64);
+      const uint64 textSize = bytes.getSize() - (distinct + 1) * sizeof(uint64);
+      column.dictionary.setSize(distinct);
+      for (MemorySize i = 0; i < distinct; ++i) {
+        const uint64 begin = getUnaligned<uint64>(bytes.getFirstReference() + i * sizeof(uint64));
+        const uint64 end = getUnaligned<uint64>(bytes.getFirstReference() + (i + 1) * sizeof(uint64));
+        if ((begin > end) || (end > textSize)) {
+          _throw InvalidFormat("Invalid dictionary.");
+        }
+        const String value(reinterpret_cast<const char*>(text + begin), static_cast<MemorySize>(end - begin));
+        column.dictionary[i] = value;
+        column.lookup.add(value, static_cast<uint32>(i));
+      }
+    }
+  }
+  return result;
+}
+
+ColumnTable ColumnTableFile::load(const uint8* src, const uint8* end)
+{
+  MemorySource source(src, end);
+  return load(source);
+}
+
+ColumnTable ColumnTableFile::load(const String& path)
+{
+  FileSource source(path);
+  return load(source);
+}
+
+#if defined(_COM_AZURE_DEV__BASE__TESTS)
+
+class TEST_CLASS(ColumnTableFile) : public UnitTest {
+public:
+
+  TEST_PRIORITY(200);
+  TEST_PROJECT("base/data");
+
+  static Allocator<uint8> getBytes(const ColumnTable& table, ColumnTableFile::Compression compression)
+  {
+    MemoryOutputStream mos;
+    ColumnTableFile::save(table, &mos, compression);
+    Allocator<uint8> result;
+    mos.swap(result);
+    return result;
+  }
+
+  static String getCSV(ColumnTable& table)
+  {
+    MemoryOutputStream mos;
+    table.saveCSV(&mos);
+    Allocator<uint8> bytes;
+    mos.swap(bytes);
+    return String(reinterpret_cast<const char*>(bytes.getElements()), bytes.getSize());
+  }
+
+  void run() override
+  {
+    const Array<DataTable::Column> columns = {
+      DataTable::Column{"Name", DataTable::TYPE_STRING},
+      DataTable::Column{"Count", DataTable::TYPE_INT32},
+      DataTable::Column{"Id", DataTable::TYPE_INT64},
+      DataTable::Column{"Ratio", DataTable::TYPE_FLOAT32},
+      DataTable::Column{"Value", DataTable::TYPE_FLOAT64},
+      DataTable::Column{"Flag", DataTable::TYPE_BOOL}
+    };
+    StringOutputStream sos;
+    sos << "Name;Count;Id;Ratio;Value;Flag\n";
+    for (unsigned int i = 0; i < 1000; ++i) {
+      sos << "\"name " << (i % 7) << "\";" << ((i % 10) ? String(format() << i) : String()) << ';'
+          << (i * 1000000007LL) << ';' << (i * 0.5) << ';' << (i * 0.125) << ';' << ((i % 3) ? "true" : "false") << '\n';
+    }
+    ColumnTable table = ColumnTable::loadFromString(sos, columns, DataTable::Config(DataTable::HEADER_USE));
+
+    const Allocator<uint8> plain = getBytes(table, ColumnTableFile::COMPRESSION_NONE);
+    const Allocator<uint8> compressed = getBytes(table, ColumnTableFile::COMPRESSION_ZLIB);
+    ColumnTable copy = ColumnTableFile::load(plain.getElements(), plain.getElements() + plain.getSize());
+    TEST_EQUAL(copy.getNumberOfColumns(), table.getNumberOfColumns());
+    TEST_EQUAL(copy.getNumberOfRows(), table.getNumberOfRows());
+    TEST_EQUAL(copy.getColumn(1).getNumberOfNulls(), 100);
+    TEST_ASSERT(copy.getColumn(1).isNull(10) && !copy.getColumn(1).isNull(11));
+    TEST_EQUAL(copy.getColumn(0).getString(8), "name 1");
+    TEST_EQUAL(copy.getColumn(2).getLongs()[999], 999 * 1000000007LL);
+    TEST_EQUAL(getCSV(copy), getCSV(table));
+
+    if (ZLibDeflater::isSupported()) {
+      TEST_ASSERT(compressed.getSize() < plain.getSize());
+    }
+    ColumnTable decompressed = ColumnTableFile::load(compressed.getElements(), compressed.getElements() + compressed.getSize());
+    TEST_EQUAL(getCSV(decompressed), getCSV(table));
+
+    // strings can be appended after load
+    ColumnTable appended = decompressed;
+    appended.append(table);
+    TEST_EQUAL(appended.getColumn(0).getDictionary().getSize(), 7);
+
+    const ColumnTableFile::Schema schema = ColumnTableFile::getSchema(compressed.getElements(), compressed.getElements() + compressed.getSize());
+    TEST_EQUAL(schema.rows, 1000);
+    TEST_EQUAL(schema.columns.getSize(), 6);
+    TEST_EQUAL(schema.columns[1].name, "Count");
+    TEST_EQUAL(schema.columns[1].type, DataTable::TYPE_INT32);
+    TEST_EQUAL(schema.columns[1].stats.nulls, 100);
+    TEST_EQUAL(schema.columns[1].stats.maximum, 999);
+    TEST_EQUAL(schema.columns[0].distinct, 7);
+    TEST_EQUAL(schema.columns[4].stats.sum, table.getStats(4).sum);
+
+    const String path = FileSystem::join(FileSystem::getTempFolder(), FileSystem::getTempFileName());
+    ColumnTableFile::save(table, path, ColumnTableFile::COMPRESSION_ZLIB);
+    TEST_EQUAL(ColumnTableFile::getSchema(path).columns[0].distinct, 7);
+    ColumnTable fromFile = ColumnTableFile::load(path);
+    FileSystem::removeFile(path);
+    TEST_EQUAL(getCSV(fromFile), getCSV(table));
+
+    const ColumnTable empty(columns);
+    const Allocator<uint8> emptyBytes = getBytes(empty, ColumnTableFile::COMPRESSION_ZLIB);
+    const ColumnTable emptyCopy = ColumnTableFile::load(emptyBytes.getElements(), emptyBytes.getElements() + emptyBytes.getSize());
+    TEST_EQUAL(emptyCopy.getNumberOfColumns(), 6);
+    TEST_EQUAL(emptyCopy.getNumberOfRows(), 0);
+
+    // malformed data
+    TEST_EXCEPTION(ColumnTableFile::load(plain.getElements(), plain.getElements() + 20), InvalidFormat);
+    TEST_EXCEPTION(ColumnTableFile::load(plain.getElements(), plain.getElements() + plain.getSize() - 1), InvalidFormat);
+    Allocator<uint8> corrupt = compressed;
+    corrupt.getElements()[HEADER_SIZE + 2] ^= 0xff;
+    TEST_EXCEPTION(ColumnTableFile::load(corrupt.getElements(), corrupt.getElements() + corrupt.getSize()), InvalidFormat);
+  }
+};
+
+TEST_REGISTER(ColumnTableFile);
+
+class TEST_CLASS(ColumnTableFileBenchmark) : public UnitTest {
+public:
+
+  TEST_PRIORITY(1000);
+  TEST_PROJECT("base/data");
+  TEST_IMPACT(LOW);
+  TEST_TIMEOUT_MS(120 * 1000);
+
+  void run() override
+  {
+    const Array<DataTable::Column> columns = {
+      DataTable::Column{"Id", DataTable::TYPE_INT64},
+      DataTable::Column{"Key", DataTable::TYPE_STRING},
+      DataTable::Column{"Value", DataTable::TYPE_FLOAT64},
+      DataTable::Column{"Count", DataTable::TYPE_INT32}
+    };
+    StringOutputStream sos;
+    for (unsigned int i = 0; i < 500000; ++i) {
+      sos << i << ";\"key " << (i % 1000) << "\";" << (Random::random<uint32>() * 0.125) << ';' << (i % 4096) << '\n';
+    }
+    const String text = sos;
+    ColumnTable table = ColumnTable::loadFromString(text, columns);
+
+    Timer timer;
+    MemoryOutputStream csv;
+    table.saveCSV(&csv);
+    const uint64 csvWriteTime = timer.getLiveMicroseconds();
+    timer.start();
+    const ColumnTable fromCSV = ColumnTable::loadFromString(text, columns);
+    const uint64 csvReadTime = timer.getLiveMicroseconds();
+
+    for (unsigned int compression = ColumnTableFile::COMPRESSION_NONE; compression <= ColumnTableFile::COMPRESSION_ZLIB; ++compression) {
+      timer.start();
+      MemoryOutputStream mos;
+      ColumnTableFile::save(table, &mos, static_cast<ColumnTableFile::Compression>(compression));
+      const uint64 writeTime = timer.getLiveMicroseconds();
+      Allocator<uint8> bytes;
+      mos.swap(bytes);
+      timer.start();
+      const ColumnTable fromBinary = ColumnTableFile::load(bytes.getElements(), bytes.getElements() + bytes.getSize());
+      const uint64 readTime = timer.getLiveMicroseconds();
+      TEST_EQUAL(fromBinary.getNumberOfRows(), fromCSV.getNumberOfRows());
+      TEST_PRINT(format() << "Binary (" << (compression ? "zlib" : "none") << "): " << bytes.getSize() << " bytes, write: "
+                 << writeTime << " us, read: " << readTime << " us");
+    }
+    TEST_PRINT(format() << "CSV: " << text.getLength() << " bytes, write: " << csvWriteTime << " us, read: " << csvReadTime << " us");
+  }
+};
+
+TEST_REGISTER(ColumnTableFileBenchmark);
+
+#endif
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
@@ -0,0 +1,127 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#pragma once
+
+#include <base/data/ColumnTable.h>
+#include <base/io/OutputStream.h>
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+/**
+  Binary columnar file format for ColumnTable. Use ColumnTable(const
+  DataTable&) to save a DataTable.
+
+  The values of each column are stored as contiguous little endian arrays in
+  the same layout as in memory. Each array may be compressed with ZLib. A
+  footer at the end of the file holds the schema, the statistics, and the
+  location of the arrays so the schema is available without reading the
+  values. Loading copies the arrays without any parsing. Only the distinct
+  strings of string columns are converted.
+
+  Layout:
+  @code
+  header: "BCOL" version:uint32 reserved:uint64
+  arrays: values, validity bitmap, and dictionary of each column aligned to 8 bytes
+  footer: rows:uint64 columns:uint32 column...
+  trailer: footer offset:uint64 footer size:uint32 "BCOL"
+  @endcode
+
+  @short Binary columnar file format.
+  @version 1.0
+*/
+
+class _COM_AZURE_DEV__BASE__API ColumnTableFile {
+private:
+
+  /** Provides the bytes of the file. */
+  class Source;
+  /** Source for data in memory. */
+  class MemorySource;
+  /** Source for file mapped into memory a region at a time. */
+  class FileSource;
+public:
+
+  /** The file format version. */
+  static constexpr uint32 VERSION = 1;
+
+  /** Compression of the arrays of a column. */
+  enum Compression {
+    COMPRESSION_NONE,
+    COMPRESSION_ZLIB
+  };
+
+  /** Schema and statistics of a column. */
+  class _COM_AZURE_DEV__BASE__API ColumnSchema {
+  public:
+
+    /** The name. */
+    String name;
+    /** The type. */
+    DataTable::Type type = DataTable::TYPE_INT32;
+    /** The compression of the arrays. */
+    Compression compression = COMPRESSION_NONE;
+    /** The number of distinct strings for string column. */
+    MemorySize distinct = 0;
+    /** The statistics. */
+    ColumnTable::Stats stats;
+    /** The number of bytes in the file. */
+    MemorySize storedSize = 0;
+    /** The number of bytes once loaded. */
+    MemorySize size = 0;
+  };
+
+  /** Schema of the table. */
+  class _COM_AZURE_DEV__BASE__API Schema {
+  public:
+
+    /** The number of rows. */
+    MemorySize rows = 0;
+    /** The columns. */
+    Array<ColumnSchema> columns;
+  };
+
+  /**
+    Writes the table to the stream.
+
+    @param compression The compression for all columns. Arrays which do not get smaller are stored uncompressed.
+  */
+  static void save(const ColumnTable& table, OutputStream* os, Compression compression = COMPRESSION_NONE);
+
+  /** Writes the table to the stream with the given compression per column. */
+  static void save(const ColumnTable& table, OutputStream* os, const Array<Compression>& compression);
+
+  /** Writes the table to the file. */
+  static void save(const ColumnTable& table, const String& path, Compression compression = COMPRESSION_NONE);
+
+  /** Returns the schema of the table in memory. Raises InvalidFormat if the data is malformed. */
+  static Schema getSchema(const uint8* src, const uint8* end);
+
+  /** Returns the schema of the table in the file. Only the footer is read. */
+  static Schema getSchema(const String& path);
+
+  /** Loads the table in memory. Raises InvalidFormat if the data is malformed. */
+  static ColumnTable load(const uint8* src, const uint8* end);
+
+  /** Loads the table from the file. The file is mapped into memory. */
+  static ColumnTable load(const String& path);
+private:
+
+  /** Returns the schema and the location of the arrays. */
+  static Schema getSchema(Source& source, Array<uint64>& regions);
+
+  /** Loads the table. */
+  static ColumnTable load(Source& source);
+};
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
@@ -17,6 +17,7 @@
 #include <base/io/FileOutputStream.h>
 #include <base/io/BufferedOutputStream.h>
 #include <base/io/MemoryInputStream.h>
+#include <base/io/MemoryOutputStream.h>
 #include <base/string/Posix.h>
 #include <base/Integer.h>
 #include <base/LongInteger.h>
@@ -65,138 +66,153 @@ DataTable DataTable::loadFromString(const String& data, const Array<Column>& col
   return load(&mis, columns, config);
 }
 
+DataTable::LineBuilder::LineBuilder(const Array<Column>& _columns, const Config& _config)
+  : columns(_columns), config(_config)
+{
+  customColumns = config.customColumns;
+  customColumns.setSize(columns.getSize(), nullptr);
+  mapColumns = config.mapColumns;
+}
+
+void DataTable::LineBuilder::printInvalid(const char* message, const Array<String>& line)
+{
+  if (config.printInvalid) {
+    ferr << "Error: " << message << EOL
+         << "> " << line << ENDL;
+  }
+}
+
+void DataTable::LineBuilder::operator()(const Array<String>& line)
+{
+  // TAG: add info about error position - line/column
+  // TAG: add support for pipelining with threads
+  // TAG: convert to values during load support - e.g. date
+  ++count;
+  if (!line) {
+    return;
+  }
+
+  if (config.printInvalid) {
+    ferr << count << "> " << line << ENDL;
+  }
+
+  if (!config.assumeBlank) {
+    if (line.getSize() < columns.getSize()) {
+      printInvalid("Too few columns.", line);
+      _throw OutOfRange("Too few columns.");
+    }
+  }
+
+  if (firstLine) {
+    firstLine = false;
+    if (config.header != DataTable::HEADER_NONE) {
+      if (config.header == DataTable::HEADER_USE) {
+        for (MemorySize c = 0; c < columns.getSize(); ++c) {
+          const unsigned int cc = !mapColumns ? c : config.mapColumns[c];
+          const bool useBlank = (cc >= line.getSize()) && config.assumeBlank;
+          const String& s = useBlank ? (format() << "<" << c << ">") : line[cc];
+          setColumnName(c, s);
+        }
+      }
+      return;
+    }
+  }
+
+  for (MemorySize c = 0; c < columns.getSize(); ++c) {
+    const unsigned int cc = !mapColumns ? c : config.mapColumns[c];
+    const bool useBlank = (cc >= line.getSize()) && config.assumeBlank;
+    const String& s = useBlank ? String() : line[cc];
+    if (DataTable::Custom* custom = customColumns[c]) {
+      // TAG: should we check type here
+      appendCustom(c, (*custom)(s));
+      continue;
+    }
+    appendField(c, s, line);
+  }
+  appendRow();
+}
+
 namespace {
 
-  class BuildDataTable : public CSVFormat::LineConsumer {
+  class BuildDataTable : public DataTable::LineBuilder {
   public:
 
-    const Array<DataTable::Column>& columns;
-    const DataTable::Config& config;
-    Array<DataTable::Custom*> customColumns;
-    bool mapColumns = false;
     DataTable table;
-    mutable Posix posix;
-    mutable AnyValue v;
-    bool firstLine = true;
-    MemorySize count = 0;
-    
+    Posix posix;
+    AnyValue v;
+    Array<AnyValue> row;
+
     BuildDataTable(const Array<DataTable::Column>& _columns, const DataTable::Config& _config)
-      : columns(_columns), config(_config)
+      : DataTable::LineBuilder(_columns, _config)
     {
-      customColumns = config.customColumns;
-      customColumns.setSize(columns.getSize(), nullptr);
-      mapColumns = config.mapColumns;
     }
 
-    void operator()(const Array<String>& line) override
+    void setColumnName(unsigned int column, const String& name) override
     {
-      // TAG: add info about error position - line/column
-      // TAG: add support for pipelining with threads
-      // TAG: convert to values during load support - e.g. date
-      // TAG: lookup strings and reuse
-      ++count;
-      if (!line) {
-        return;
-      }
+      table.setColumnName(column, name);
+    }
 
-      if (config.printInvalid) {
-        ferr << count << "> " << line << ENDL;
-      }
+    void appendCustom(unsigned int column, const AnyValue& value) override
+    {
+      row.append(value);
+    }
 
-      if (!config.assumeBlank) {
-        if (line.getSize() < columns.getSize()) {
-          if (config.printInvalid) {
-            ferr << "Error: " << "Too few columns." << EOL
-                 << "> " << line << ENDL;
+    void appendField(unsigned int c, const String& s, const Array<String>& line) override
+    {
+      // TAG: lookup strings and reuse
+      const DataTable::Column& column = columns[c];
+      switch (column.type) {
+      case DataTable::TYPE_BOOL:
+        v = !(!s || (s == "false") || (s == "0")); // TAG: need definition of true and false
+        break;
+      case DataTable::TYPE_INT32:
+        v = Integer::parse(s);
+        break;
+      case DataTable::TYPE_INT64:
+        // TAG: print on error - use nothrow
+        v = LongInteger::parse(s);
+        break;
+      case DataTable::TYPE_FLOAT32:
+        {
+          float f = 0;
+          if (!posix.getSeries(s, f)) {
+            printInvalid("Not a float.", line);
+            _throw InvalidException("Not a float.");
           }
-          _throw OutOfRange("Too few columns.");
+          v = f;
         }
-      }
-
-      if (firstLine) {
-        firstLine = false;
-        if (config.header != DataTable::HEADER_NONE) {
-          if (config.header == DataTable::HEADER_USE) {
-            for (MemorySize c = 0; c < columns.getSize(); ++c) {
-              const unsigned int cc = !mapColumns ? c : config.mapColumns[c];
-              const bool useBlank = (cc >= line.getSize()) && config.assumeBlank;
-              const String& s = useBlank ? (format() << "<" << c << ">") : line[cc];
-              table.setColumnName(c, s);
-            }
+        break;
+      case DataTable::TYPE_FLOAT64:
+        {
+          float d = 0;
+          if (!posix.getSeries(s, d)) {
+            printInvalid("Not a double.", line);
+            _throw InvalidException("Not a double.");
           }
-          return;
-        }
-      }
-      
-      Array<AnyValue> row;
-      row.ensureCapacity(columns.getSize());
-      for (MemorySize c = 0; c < columns.getSize(); ++c) {
-        const unsigned int cc = !mapColumns ? c : config.mapColumns[c];
-        const bool useBlank = (cc >= line.getSize()) && config.assumeBlank;
-        const String& s = useBlank ? String() : line[cc];
-        const DataTable::Column& column = columns[c];
-        if (DataTable::Custom* custom = customColumns[c]) {
-          v = (*custom)(s);
-          // TAG: should we check type here
-          row.append(v);
-          continue;
+          v = d;
         }
-        
-        switch (column.type) {
-        case DataTable::TYPE_BOOL:
-          v = !(!s || (s == "false") || (s == "0")); // TAG: need definition of true and false
-          break;
-        case DataTable::TYPE_INT32:
-          v = Integer::parse(s);
-          break;
-        case DataTable::TYPE_INT64:
-          // TAG: print on error - use nothrow
-          v = LongInteger::parse(s);
-          break;
-        case DataTable::TYPE_FLOAT32:
-          {
-            float f = 0;
-            if (!posix.getSeries(s, f)) {
-              if (config.printInvalid) {
-                ferr << "Error: " << "Not a float." << EOL
-                     << "> " << line << ENDL;
-              }
-              _throw InvalidException("Not a float.");
-            }
-            v = f;
-          }
-          break;
-        case DataTable::TYPE_FLOAT64:
-          {
-            float d = 0;
-            if (!posix.getSeries(s, d)) {
-              if (config.printInvalid) {
-                ferr << "Error: " << "Not a double." << EOL
-                     << "> " << line << ENDL;
-              }
-              _throw InvalidException("Not a double.");
-            }
-            v = d;
-          }
-          break;
-        case DataTable::TYPE_STRING:
-        default:
+        break;
+      case DataTable::TYPE_STRING:
+      default:
 #if 0
-          {
-            Date d = Date::parseISO8601(s, true);
-            v = d.getValue();
-          }
-#endif
-          v = s;
+        {
+          Date d = Date::parseISO8601(s, true);
+          v = d.getValue();
         }
-        row.append(v);
+#endif
+        v = s;
       }
-      
+      row.append(v);
+    }
+
+    void appendRow() override
+    {
       Array<DataTable::Row>& rows = table.getRows();
       if (rows.getSize() >= rows.getCapacity()) {
         rows.ensureCapacity(maximum<MemorySize>(rows.getCapacity() * 2, 1024));
       }
       rows.append(row);
+      row = Array<AnyValue>();
     }
   };
 }
@@ -214,30 +230,33 @@ void DataTable::saveCSV(OutputStream* os, char separator)
 {
   // https://tools.ietf.org/html/rfc4180
   // TAG: add proper CSVFormat::quote to support escaping "" not \"
-  BufferedOutputStream bos(*os);
-  const char* eol = "\r\n";
+  FormatOutputStream stream(*os); // numbers are formatted directly into the buffer
+  const Literal eol = MESSAGE("\r\n");
   bool first = true;
   for (const auto& column : columns) {
     if (!first) {
-      bos.write(reinterpret_cast<const uint8*>(&separator), 1);
+      stream << separator;
     }
     first = false;
-    String s(CSVFormat::quote(column.name));
-    bos.write(s.getBytes(), s.getLength());
-    bos.write(reinterpret_cast<const uint8*>(eol), 2);
+    stream << CSVFormat::quote(column.name);
   }
+  stream << eol;
   for (const auto& row : rows) {
     bool first = true;
     for (const auto& value : row) {
       if (!first) {
-        bos.write(reinterpret_cast<const uint8*>(&separator), 1);
+        stream << separator;
       }
       first = false;
-      String s(CSVFormat::quote(value.getString()));
-      bos.write(s.getBytes(), s.getLength());
-      bos.write(reinterpret_cast<const uint8*>(eol), 2);
+      if (value.isInteger() || value.isFloatingPoint()) {
+        stream << '"' << value << '"'; // no temporary string - numbers need no escaping
+      } else {
+        stream << CSVFormat::quote(value.getString());
+      }
     }
+    stream << eol;
   }
+  stream << FLUSH;
 }
 
 void DataTable::saveCSV(const String& path)
@@ -410,7 +429,7 @@ String getContainerAsHTML(const DataTable::DataTableSnippet& snippet)
 // TAG: add support for splitting string into one or more columns
 // add geo locaton https://en.wikipedia.org/wiki/ISO_6709
 
-#if 0 && defined(_COM_AZURE_DEV__BASE__TESTS)
+#if defined(_COM_AZURE_DEV__BASE__TESTS)
 
 class TEST_CLASS(DataTable) : public UnitTest {
 public:
@@ -422,10 +441,40 @@ public:
 
   void run() override
   {
-    DataTable table = DataTable::load("path", {
+    DataTable names = DataTable::loadFromString("\"John\";\"Doe\"\n", {
       DataTable::Column{"First", DataTable::TYPE_STRING},
       DataTable::Column{"Last", DataTable::TYPE_STRING}
     });
+    TEST_EQUAL(names.getNumberOfRows(), 1);
+    TEST_EQUAL(names.getValueAsString(0, 1), "Doe");
+
+    DataTable table = DataTable::loadFromString(
+      "\"Name\";\"Count\";\"Value\"\n",
+      {
+        DataTable::Column{"Name", DataTable::TYPE_STRING},
+        DataTable::Column{"Count", DataTable::TYPE_INT32},
+        DataTable::Column{"Value", DataTable::TYPE_FLOAT64}
+      },
+      DataTable::Config(DataTable::HEADER_USE)
+    );
+    DataTable::Row row;
+    row.append(AnyValue(String("a")));
+    row.append(AnyValue(1));
+    row.append(AnyValue(0.5));
+    table.getRows().append(row);
+    row = DataTable::Row();
+    row.append(AnyValue(String("b")));
+    row.append(AnyValue(-20));
+    row.append(AnyValue(1e-7));
+    table.getRows().append(row);
+    TEST_EQUAL(table.getNumberOfRows(), 2);
+
+    MemoryOutputStream mos;
+    table.saveCSV(&mos);
+    Allocator<uint8> buffer;
+    mos.swap(buffer);
+    const String csv(reinterpret_cast<const char*>(buffer.getElements()), buffer.getSize());
+    TEST_EQUAL(csv, "\"Name\";\"Count\";\"Value\"\r\n\"a\";\"1\";\"0.5\"\r\n\"b\";\"-20\";\"1e-7\"\r\n");
   }
 };
 
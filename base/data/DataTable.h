@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include <base/data/CSVFormat.h>
 #include <base/collection/Array.h>
 #include <base/collection/HashSet.h>
 #include <base/io/InputStream.h>
@@ -170,6 +171,49 @@ public:
     }
   };
   
+  /**
+    Applies the load config (header, column mapping, blank fields, and custom
+    converters) to the lines of CSV data. The conversion of the fields is left
+    to the table being built.
+  */
+  class _COM_AZURE_DEV__BASE__API LineBuilder : public CSVFormat::LineConsumer {
+  protected:
+
+    /** The columns. */
+    const Array<Column>& columns;
+    /** The config. */
+    const Config& config;
+    /** Custom converters per column. */
+    Array<Custom*> customColumns;
+    /** Columns are mapped. */
+    bool mapColumns = false;
+    /** The next line is the first line. */
+    bool firstLine = true;
+    /** The number of lines. */
+    MemorySize count = 0;
+
+    /** Prints invalid line if enabled by config. */
+    void printInvalid(const char* message, const Array<String>& line);
+
+    /** Sets the name of the column from the header. */
+    virtual void setColumnName(unsigned int column, const String& name) = 0;
+
+    /** Converts and appends the field of the current row. */
+    virtual void appendField(unsigned int column, const String& text, const Array<String>& line) = 0;
+
+    /** Appends the value returned by the custom converter of the column. */
+    virtual void appendCustom(unsigned int column, const AnyValue& value) = 0;
+
+    /** Called when all fields of the current row have been appended. */
+    virtual void appendRow() = 0;
+  public:
+
+    /** Initializes builder. */
+    LineBuilder(const Array<Column>& columns, const Config& config);
+
+    void operator()(const Array<String>& line) override;
+  };
+
   /** Loads table from file. */
   static DataTable load(const String& path, const Array<Column>& columns, const Config& config = Config());
 
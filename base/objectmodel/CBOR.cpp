@@ -0,0 +1,159 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#include <base/objectmodel/CBOR.h>
+#include <base/objectmodel/CBORReader.h>
+#include <base/objectmodel/CBORWriter.h>
+#include <base/objectmodel/JSON.h>
+#include <base/io/MemoryInputStream.h>
+#include <base/io/MemoryOutputStream.h>
+#include <base/Timer.h>
+#include <base/UnitTest.h>
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+void CBOR::write(OutputStream* os, const Reference<ObjectModel::Value>& value)
+{
+  CBORWriter writer(os);
+  writer.value(value);
+  writer.flush();
+}
+
+Allocator<uint8> CBOR::getCBOR(const Reference<ObjectModel::Value>& value)
+{
+  MemoryOutputStream mos;
+  write(&mos, value);
+  Allocator<uint8> result;
+  mos.swap(result);
+  return result;
+}
+
+Reference<ObjectModel::Value> CBOR::parse(const uint8* src, const uint8* end)
+{
+  MemoryInputStream mis(src, end);
+  CBORReader reader(&mis);
+  ObjectModel objectModel;
+  reader.next();
+  auto result = reader.getValue(objectModel);
+  if (reader.next() != CBORReader::EVENT_END_DOCUMENT) {
+    _throw CBORException("Unexpected data after CBOR item.", reader.getPosition());
+  }
+  return result;
+}
+
+#if defined(_COM_AZURE_DEV__BASE__TESTS)
+
+class TEST_CLASS(CBOR) : public UnitTest {
+public:
+
+  TEST_PRIORITY(50);
+  TEST_PROJECT("base/objectmodel");
+
+  void run() override
+  {
+    ObjectModel o;
+    auto root = o.createObject();
+    root->setValue(base::String("name"), Reference<ObjectModel::Value>(o.createString("value")));
+    root->setValue(base::String("integer"), Reference<ObjectModel::Value>(o.createInteger(-1234567890123LL)));
+    root->setValue(base::String("float"), Reference<ObjectModel::Value>(o.createFloat(3.25)));
+    root->setValue(base::String("precise"), Reference<ObjectModel::Value>(o.createFloat(0.1)));
+    root->setValue(base::String("flag"), Reference<ObjectModel::Value>(o.createBoolean(false)));
+    root->setValue(base::String("none"), Reference<ObjectModel::Value>(o.createVoid()));
+    base::Array<uint8> bytes;
+    for (unsigned int i = 0; i < 300; ++i) {
+      bytes.append(static_cast<uint8>(i));
+    }
+    root->setValue(base::String("binary"), Reference<ObjectModel::Value>(o.createBinary(bytes)));
+    auto array = o.createArray();
+    array->append(o.createInteger(1));
+    array->append(o.createString("\xc3\xa6"));
+    array->append(o.createObject());
+    root->setValue(base::String("array"), Reference<ObjectModel::Value>(array));
+
+    const Allocator<uint8> encoded = CBOR::getCBOR(root);
+    auto decoded = CBOR::parse(encoded).cast<ObjectModel::Object>();
+    TEST_ASSERT(decoded);
+    TEST_EQUAL(decoded->values.getSize(), root->values.getSize());
+    TEST_EQUAL(decoded->getString("/name", ""), "value");
+    TEST_EQUAL(decoded->getInteger("/integer", 0), -1234567890123LL);
+    TEST_EQUAL(decoded->getFloat("/float", 0), 3.25);
+    TEST_EQUAL(decoded->getFloat("/precise", 0), 0.1);
+    TEST_EQUAL(decoded->getBoolean("/flag", true), false);
+    TEST_EQUAL(decoded->getValue("none")->getType(), ObjectModel::Value::TYPE_VOID);
+    auto binary = decoded->getValue("binary").cast<ObjectModel::Binary>();
+    TEST_ASSERT(binary && (binary->value.getSize() == 300) && (binary->value[299] == static_cast<uint8>(299)));
+    TEST_EQUAL(JSON::getJSONNoFormatting(decoded->getValue("array")), JSON::getJSONNoFormatting(array));
+
+    const uint8 trailing[] = {0x01, 0x02};
+    TEST_EXCEPTION(CBOR::parse(trailing, trailing + sizeof(trailing)), CBORException);
+    TEST_EXCEPTION(CBOR::parse(trailing, trailing), CBORException);
+  }
+};
+
+TEST_REGISTER(CBOR);
+
+class TEST_CLASS(CBORBenchmark) : public UnitTest {
+public:
+
+  TEST_PRIORITY(1000);
+  TEST_PROJECT("base/objectmodel");
+  TEST_IMPACT(LOW);
+
+  void run() override
+  {
+    ObjectModel o;
+    auto root = o.createArray();
+    root->values.setSize(10000);
+    for (unsigned int i = 0; i < 10000; ++i) {
+      auto item = o.createObject();
+      item->setValue(base::String("id"), Reference<ObjectModel::Value>(o.createInteger(i)));
+      item->setValue(base::String("name"), Reference<ObjectModel::Value>(o.createString(format() << "user " << i)));
+      item->setValue(base::String("score"), Reference<ObjectModel::Value>(o.createFloat(i * 0.25)));
+      item->setValue(base::String("active"), Reference<ObjectModel::Value>(o.createBoolean((i % 3) != 0)));
+      auto tags = o.createArray();
+      tags->append(o.createString("alpha"));
+      tags->append(o.createString("beta"));
+      tags->append(o.createVoid());
+      item->setValue(base::String("tags"), Reference<ObjectModel::Value>(tags));
+      item->setValue(base::String("text"), Reference<ObjectModel::Value>(o.createString("The quick brown fox jumps over the lazy dog. \"Quoted\" text.")));
+      root->values[i] = item;
+    }
+
+    Timer timer;
+    const String json = JSON::getJSONNoFormatting(root);
+    const uint64 jsonEncodeTime = timer.getLiveMicroseconds();
+    timer.start();
+    auto fromJSON = JSON::parse(json);
+    const uint64 jsonDecodeTime = timer.getLiveMicroseconds();
+    TEST_ASSERT(fromJSON);
+
+    timer.start();
+    const Allocator<uint8> cbor = CBOR::getCBOR(root);
+    const uint64 cborEncodeTime = timer.getLiveMicroseconds();
+    timer.start();
+    auto fromCBOR = CBOR::parse(cbor);
+    const uint64 cborDecodeTime = timer.getLiveMicroseconds();
+    TEST_ASSERT(fromCBOR);
+
+    TEST_PRINT(format() << "JSON: " << json.getLength() << " bytes, encode: " << jsonEncodeTime
+               << " us, decode: " << jsonDecodeTime << " us");
+    TEST_PRINT(format() << "CBOR: " << cbor.getSize() << " bytes, encode: " << cborEncodeTime
+               << " us, decode: " << cborDecodeTime << " us");
+  }
+};
+
+TEST_REGISTER(CBORBenchmark);
+
+#endif
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
@@ -0,0 +1,90 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#pragma once
+
+#include <base/objectmodel/ObjectModel.h>
+#include <base/io/InputStream.h>
+#include <base/io/OutputStream.h>
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+/** CBOR exception. */
+class _COM_AZURE_DEV__BASE__API CBORException : public Exception {
+private:
+
+  /** The offset of the item. */
+  uint64 offset = 0;
+public:
+
+  inline CBORException()
+  {
+  }
+
+  inline CBORException(const char* message)
+    : Exception(message)
+  {
+  }
+
+  inline CBORException(const char* message, uint64 _offset)
+    : Exception(message), offset(_offset)
+  {
+  }
+
+  /** Returns the byte offset of the item. */
+  inline uint64 getOffset() const noexcept
+  {
+    return offset;
+  }
+
+  inline bool isCommonException() const noexcept override
+  {
+    return true;
+  }
+
+  _COM_AZURE_DEV__BASE__EXCEPTION_THIS_TYPE()
+};
+
+/**
+  Concise Binary Object Representation (CBOR). See
+  https://tools.ietf.org/html/rfc8949.
+
+  Encodes and decodes ObjectModel values. Binary values are encoded as byte
+  strings. Integers keep their 64-bit signed type and floats are written with
+  the shortest of 32-bit and 64-bit precision which is exact. Use CBORReader
+  and CBORWriter for streaming.
+
+  @short CBOR encoding.
+  @version 1.0
+*/
+
+class _COM_AZURE_DEV__BASE__API CBOR {
+public:
+
+  /** Writes the encoded value to the given stream. */
+  static void write(OutputStream* os, const Reference<ObjectModel::Value>& value);
+
+  /** Returns the encoded value. */
+  static Allocator<uint8> getCBOR(const Reference<ObjectModel::Value>& value);
+
+  /** Decodes a single value. Raises CBORException if malformed. */
+  static Reference<ObjectModel::Value> parse(const uint8* src, const uint8* end);
+
+  /** Decodes a single value. Raises CBORException if malformed. */
+  static inline Reference<ObjectModel::Value> parse(const Allocator<uint8>& buffer)
+  {
+    return parse(buffer.getElements(), buffer.getElements() + buffer.getSize());
+  }
+};
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
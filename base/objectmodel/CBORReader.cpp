@@ -0,0 +1,456 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#include <base/objectmodel/CBORReader.h>
+#include <base/objectmodel/CBORWriter.h>
+#include <base/io/MemoryInputStream.h>
+#include <base/io/MemoryOutputStream.h>
+#include <base/math/Math.h>
+#include <base/UnitTest.h>
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+namespace {
+
+  enum {
+    MAJOR_UNSIGNED = 0,
+    MAJOR_NEGATIVE = 1,
+    MAJOR_BYTES = 2,
+    MAJOR_TEXT = 3,
+    MAJOR_ARRAY = 4,
+    MAJOR_MAP = 5,
+    MAJOR_TAG = 6,
+    MAJOR_SIMPLE = 7
+  };
+
+  const uint8 INDEFINITE = 31;
+  const uint8 BREAK = 0xff;
+
+  /** Returns the double for the given IEEE 754 half-precision bits. */
+  inline double getHalf(uint16 bits) noexcept
+  {
+    const int exponent = (bits >> 10) & 0x1f;
+    const int mantissa = bits & 0x3ff;
+    double result = 0;
+    if (exponent == 0) {
+      result = mantissa * (1.0/(1 << 24)); // subnormal
+    } else if (exponent == 31) {
+      result = mantissa ? Math::getNaN<double>() : Math::getInfinity<double>();
+    } else if (exponent >= 25) {
+      result = (mantissa + 1024) * static_cast<double>(1 << (exponent - 25));
+    } else {
+      result = (mantissa + 1024)/static_cast<double>(1 << (25 - exponent));
+    }
+    return (bits & 0x8000) ? -result : result;
+  }
+}
+
+CBORReader::CBORReader(InputStream* _is, unsigned int bufferSize)
+  : is(_is), buffer(maximum<unsigned int>(bufferSize, 64)), levels(16), token(256)
+{
+  src = buffer.begin();
+  end = src;
+}
+
+bool CBORReader::fill()
+{
+  if (eof) {
+    return false;
+  }
+  offset += end - buffer.begin();
+  src = buffer.begin();
+  end = src;
+  const unsigned int available = is->available();
+  if (available > 0) {
+    end += is->read(buffer.begin(), minimum<MemorySize>(buffer.size(), available), false);
+  }
+  if (src == end) {
+    eof = true;
+    return false;
+  }
+  return true;
+}
+
+uint64 CBORReader::readArgument(uint8 info)
+{
+  if (info < 24) {
+    return info;
+  }
+  if (info > 27) {
+    _throw CBORException("Unsupported additional information.", getOffset());
+  }
+  uint64 result = 0;
+  for (unsigned int i = 1 << (info - 24); i > 0; --i) {
+    result = (result << 8) | readByte();
+  }
+  return result;
+}
+
+void CBORReader::readBytes(uint64 size)
+{
+  // grow with the bytes actually read - the size of malformed input cannot be trusted
+  while (size > 0) {
+    if ((src == end) && !fill()) {
+      _throw CBORException("Unexpected end of CBOR.", getOffset());
+    }
+    const MemorySize count = static_cast<MemorySize>(minimum<uint64>(end - src, size));
+    if ((tokenLength + count) > token.size()) {
+      token.resize(maximum<MemorySize>(token.size() * 2, tokenLength + count));
+    }
+    copy<uint8>(token.begin() + tokenLength, src, count);
+    tokenLength += count;
+    src += count;
+    size -= count;
+  }
+}
+
+void CBORReader::readString(uint8 major, uint8 info)
+{
+  tokenLength = 0;
+  if (info != INDEFINITE) {
+    readBytes(readArgument(info));
+    return;
+  }
+  while (true) { // chunks of the same major type
+    const uint8 initial = readByte();
+    if (initial == BREAK) {
+      break;
+    }
+    if (((initial >> 5) != major) || ((initial & 0x1f) == INDEFINITE)) {
+      _throw CBORException("Malformed string chunk.", getOffset() - 1);
+    }
+    readBytes(readArgument(initial & 0x1f));
+  }
+}
+
+void CBORReader::push(bool map, uint8 info)
+{
+  const bool indefinite = (info == INDEFINITE);
+  uint64 remaining = indefinite ? 0 : readArgument(info);
+  if (map) {
+    if (remaining > (PrimitiveTraits<uint64>::MAXIMUM/2)) {
+      _throw CBORException("Malformed map.", getOffset());
+    }
+    remaining *= 2;
+  }
+  if (depth == levels.size()) {
+    levels.resize(depth * 2);
+  }
+  Level& level = levels[depth++];
+  level.map = map;
+  level.indefinite = indefinite;
+  level.expectKey = map;
+  level.remaining = remaining;
+}
+
+CBORReader::Event CBORReader::readItem(uint8 initial)
+{
+  const uint8 info = initial & 0x1f;
+  switch (initial >> 5) {
+  case MAJOR_UNSIGNED:
+    {
+      const uint64 value = readArgument(info);
+      if (value > static_cast<uint64>(PrimitiveTraits<int64>::MAXIMUM)) {
+        floatingPoint = static_cast<double>(value);
+        return EVENT_FLOAT;
+      }
+      integer = static_cast<int64>(value);
+      return EVENT_INTEGER;
+    }
+  case MAJOR_NEGATIVE:
+    {
+      const uint64 value = readArgument(info); // -1 - value
+      if (value > static_cast<uint64>(PrimitiveTraits<int64>::MAXIMUM)) {
+        floatingPoint = -1.0 - static_cast<double>(value);
+        return EVENT_FLOAT;
+      }
+      integer = ~static_cast<int64>(value);
+      return EVENT_INTEGER;
+    }
+  case MAJOR_BYTES:
+    readString(MAJOR_BYTES, info);
+    return EVENT_BINARY;
+  case MAJOR_TEXT:
+    readString(MAJOR_TEXT, info);
+    return EVENT_STRING;
+  case MAJOR_ARRAY:
+    push(false, info);
+    return EVENT_BEGIN_ARRAY;
+  case MAJOR_MAP:
+    push(true, info);
+    return EVENT_BEGIN_OBJECT;
+  case MAJOR_SIMPLE:
+    switch (info) {
+    case 20:
+    case 21:
+      boolean = (info == 21);
+      return EVENT_BOOLEAN;
+    case 22: // null
+    case 23: // undefined
+      return EVENT_NULL;
+    case 25:
+      floatingPoint = getHalf(static_cast<uint16>(readArgument(info)));
+      return EVENT_FLOAT;
+    case 26:
+      {
+        const uint32 bits = static_cast<uint32>(readArgument(info));
+        float f = 0;
+        copy<uint8>(reinterpret_cast<uint8*>(&f), reinterpret_cast<const uint8*>(&bits), sizeof(f));
+        floatingPoint = f;
+        return EVENT_FLOAT;
+      }
+    case 27:
+      {
+        const uint64 bits = readArgument(info);
+        copy<uint8>(reinterpret_cast<uint8*>(&floatingPoint), reinterpret_cast<const uint8*>(&bits), sizeof(floatingPoint));
+        return EVENT_FLOAT;
+      }
+    }
+    break;
+  }
+  _throw CBORException("Unsupported CBOR item.", getOffset() - 1);
+}
+
+CBORReader::Event CBORReader::next()
+{
+  tokenLength = 0;
+  if (depth > 0) {
+    const Level& level = levels[depth - 1];
+    if (!level.indefinite && (level.remaining == 0)) {
+      --depth;
+      return event = (level.map ? EVENT_END_OBJECT : EVENT_END_ARRAY);
+    }
+  } else if ((src == end) && !fill()) {
+    return event = EVENT_END_DOCUMENT;
+  }
+
+  uint8 initial = readByte();
+  if (initial == BREAK) {
+    if ((depth == 0) || !levels[depth - 1].indefinite) {
+      _throw CBORException("Unexpected break.", getOffset() - 1);
+    }
+    const Level& level = levels[depth - 1];
+    if (level.map && !level.expectKey) {
+      _throw CBORException("Missing value for map key.", getOffset() - 1);
+    }
+    --depth;
+    return event = (level.map ? EVENT_END_OBJECT : EVENT_END_ARRAY);
+  }
+  while ((initial >> 5) == MAJOR_TAG) { // semantics of tags are not supported
+    readArgument(initial & 0x1f);
+    initial = readByte();
+  }
+
+  bool key = false;
+  if (depth > 0) {
+    Level& level = levels[depth - 1];
+    if (!level.indefinite) {
+      --level.remaining;
+    }
+    if (level.map) {
+      key = level.expectKey;
+      level.expectKey = !level.expectKey;
+    }
+  }
+  if (key) {
+    if ((initial >> 5) != MAJOR_TEXT) {
+      _throw CBORException("Expected text string for map key.", getOffset() - 1);
+    }
+    readString(MAJOR_TEXT, initial & 0x1f);
+    return event = EVENT_KEY;
+  }
+  return event = readItem(initial);
+}
+
+bool CBORReader::isText(const char* text) const noexcept
+{
+  const MemorySize length = getNullTerminatedLength(text);
+  return (length == tokenLength) && (compare(reinterpret_cast<const char*>(token.cbegin()), text, length) == 0);
+}
+
+void CBORReader::skipValue()
+{
+  switch (event) {
+  case EVENT_KEY:
+    next();
+    skipValue();
+    break;
+  case EVENT_BEGIN_OBJECT:
+  case EVENT_BEGIN_ARRAY:
+    {
+      const MemorySize level = depth;
+      while (depth >= level) {
+        next();
+      }
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+Reference<ObjectModel::Value> CBORReader::getValue(ObjectModel& objectModel)
+{
+  switch (event) {
+  case EVENT_NULL:
+    return objectModel.createVoid();
+  case EVENT_BOOLEAN:
+    return objectModel.createBoolean(boolean);
+  case EVENT_INTEGER:
+    return objectModel.createInteger(integer);
+  case EVENT_FLOAT:
+    return objectModel.createFloat(floatingPoint);
+  case EVENT_STRING:
+    return objectModel.createString(getString());
+  case EVENT_BINARY:
+    {
+      base::Array<uint8> bytes;
+      bytes.setSize(tokenLength);
+      copy<uint8>(bytes.getElements(), token.cbegin(), tokenLength);
+      return objectModel.createBinary(bytes);
+    }
+  case EVENT_BEGIN_ARRAY:
+    {
+      Reference<ObjectModel::Array> result = objectModel.createArray();
+      MemorySize count = 0;
+      while (next() != EVENT_END_ARRAY) {
+        if (count == result->values.getSize()) { // Array::append() copies all elements on each call
+          result->values.setSize(maximum<MemorySize>(count * 2, 16));
+        }
+        result->values[count++] = getValue(objectModel);
+      }
+      result->values.setSize(count);
+      return result;
+    }
+  case EVENT_BEGIN_OBJECT:
+    {
+      Reference<ObjectModel::Object> result = objectModel.createObject();
+      MemorySize count = 0;
+      while (next() != EVENT_END_OBJECT) {
+        if (count == result->values.getSize()) {
+          result->values.setSize(maximum<MemorySize>(count * 2, 16));
+        }
+        ObjectModel::Object::Association& member = result->values.getElements()[count++];
+        member.setFirst(objectModel.createString(getString()));
+        next();
+        member.setSecond(getValue(objectModel));
+      }
+      result->values.setSize(count);
+      result->rebuildIndex(); // merges duplicate keys
+      return result;
+    }
+  default:
+    _throw CBORException("Expected value.", getOffset());
+  }
+}
+
+#if defined(_COM_AZURE_DEV__BASE__TESTS)
+
+class TEST_CLASS(CBORReader) : public UnitTest {
+public:
+
+  TEST_PRIORITY(50);
+  TEST_PROJECT("base/objectmodel");
+
+  static bool ensureFailure(const uint8* bytes, MemorySize size)
+  {
+    try {
+      MemoryInputStream mis(bytes, bytes + size);
+      CBORReader reader(&mis, 64);
+      while (reader.next() != CBORReader::EVENT_END_DOCUMENT) {
+      }
+    } catch (CBORException&) {
+      return true;
+    }
+    return false;
+  }
+
+  void run() override
+  {
+    MemoryOutputStream mos;
+    {
+      const uint8 bytes[] = {0, 0xff};
+      CBORWriter writer(&mos);
+      writer.beginObject().key("a").beginArray(4).value(1).value(static_cast<int64>(-1000)).value(0.5).value(true).endArray();
+      writer.key("b").binary(bytes, sizeof(bytes));
+      writer.key("c").beginObject(0).endObject();
+      writer.endObject();
+      writer.value("next");
+      writer.flush();
+    }
+    Allocator<uint8> buffer;
+    mos.swap(buffer);
+
+    MemoryInputStream mis(buffer.getElements(), buffer.getElements() + buffer.getSize());
+    CBORReader reader(&mis, 64);
+    TEST_EQUAL(reader.next(), CBORReader::EVENT_BEGIN_OBJECT);
+    TEST_ASSERT((reader.next() == CBORReader::EVENT_KEY) && reader.isText("a"));
+    TEST_EQUAL(reader.next(), CBORReader::EVENT_BEGIN_ARRAY);
+    TEST_ASSERT((reader.next() == CBORReader::EVENT_INTEGER) && (reader.getInteger() == 1));
+    TEST_ASSERT((reader.next() == CBORReader::EVENT_INTEGER) && (reader.getInteger() == -1000));
+    TEST_ASSERT((reader.next() == CBORReader::EVENT_FLOAT) && (reader.getFloat() == 0.5));
+    TEST_ASSERT((reader.next() == CBORReader::EVENT_BOOLEAN) && reader.getBoolean());
+    TEST_EQUAL(reader.next(), CBORReader::EVENT_END_ARRAY);
+    TEST_ASSERT((reader.next() == CBORReader::EVENT_KEY) && reader.isText("b"));
+    TEST_ASSERT((reader.next() == CBORReader::EVENT_BINARY) && (reader.getSize() == 2) && (reader.getBytes()[1] == 0xff));
+    TEST_ASSERT((reader.next() == CBORReader::EVENT_KEY) && reader.isText("c"));
+    TEST_EQUAL(reader.next(), CBORReader::EVENT_BEGIN_OBJECT);
+    reader.skipValue();
+    TEST_EQUAL(reader.getEvent(), CBORReader::EVENT_END_OBJECT);
+    TEST_EQUAL(reader.next(), CBORReader::EVENT_END_OBJECT);
+    TEST_ASSERT((reader.next() == CBORReader::EVENT_STRING) && (reader.getString() == "next"));
+    TEST_EQUAL(reader.next(), CBORReader::EVENT_END_DOCUMENT);
+
+    {
+      // tag 1, half floats, indefinite strings, and undefined
+      const uint8 bytes[] = {
+        0x84, 0xc1, 0x1a, 0x51, 0x4b, 0x67, 0xb0, 0xf9, 0x3c, 0x00, 0xf9, 0xfc, 0x00,
+        0x82, 0x7f, 0x62, 'a', 'b', 0x61, 'c', 0xff, 0xf7
+      };
+      MemoryInputStream mis(bytes, bytes + sizeof(bytes));
+      CBORReader reader(&mis, 64);
+      ObjectModel o;
+      reader.next();
+      auto value = reader.getValue(o).cast<ObjectModel::Array>();
+      TEST_ASSERT(value && (value->values.getSize() == 4));
+      TEST_EQUAL(value->values[0].cast<ObjectModel::Integer>()->value, 1363896240);
+      TEST_EQUAL(value->values[1].cast<ObjectModel::Float>()->value, 1.0);
+      TEST_EQUAL(value->values[2].cast<ObjectModel::Float>()->value, -Math::getInfinity<double>());
+      auto nested = value->values[3].cast<ObjectModel::Array>();
+      TEST_ASSERT(nested && (nested->values[0].cast<ObjectModel::String>()->value == "abc"));
+      TEST_EQUAL(nested->values[1]->getType(), ObjectModel::Value::TYPE_VOID);
+      TEST_EQUAL(reader.next(), CBORReader::EVENT_END_DOCUMENT);
+    }
+
+    const uint8 truncated[] = {0x82, 0x01};
+    TEST_ASSERT(ensureFailure(truncated, sizeof(truncated)));
+    const uint8 shortString[] = {0x65, 'a', 'b'};
+    TEST_ASSERT(ensureFailure(shortString, sizeof(shortString)));
+    const uint8 badKey[] = {0xa1, 0x01, 0x02};
+    TEST_ASSERT(ensureFailure(badKey, sizeof(badKey)));
+    const uint8 badBreak[] = {0x81, 0xff};
+    TEST_ASSERT(ensureFailure(badBreak, sizeof(badBreak)));
+    const uint8 badChunk[] = {0x7f, 0x41, 'a', 0xff};
+    TEST_ASSERT(ensureFailure(badChunk, sizeof(badChunk)));
+    const uint8 reserved[] = {0x1c};
+    TEST_ASSERT(ensureFailure(reserved, sizeof(reserved)));
+    const uint8 huge[] = {0x5b, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00};
+    TEST_ASSERT(ensureFailure(huge, sizeof(huge)));
+  }
+};
+
+TEST_REGISTER(CBORReader);
+
+#endif
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
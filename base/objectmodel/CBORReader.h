@@ -0,0 +1,208 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#pragma once
+
+#include <base/objectmodel/CBOR.h>
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+/**
+  Pull reader for CBOR items from an input stream with the same events as
+  JSONReader. Only a fixed read buffer and the current string are kept in
+  memory. Definite and indefinite length items are supported. Tags are
+  skipped. A sequence of top-level items is read in order (RFC 8742). Map
+  keys must be text strings.
+
+  @short CBOR pull reader.
+  @version 1.0
+*/
+
+class _COM_AZURE_DEV__BASE__API CBORReader {
+public:
+
+  /** Event. */
+  enum Event {
+    EVENT_NONE, /**< No event has been read. */
+    EVENT_BEGIN_OBJECT,
+    EVENT_END_OBJECT,
+    EVENT_BEGIN_ARRAY,
+    EVENT_END_ARRAY,
+    EVENT_KEY, /**< Member name. Use getString(). */
+    EVENT_NULL, /**< Null or undefined. */
+    EVENT_BOOLEAN, /**< Use getBoolean(). */
+    EVENT_INTEGER, /**< Use getInteger(). */
+    EVENT_FLOAT, /**< Use getFloat(). Integers which do not fit int64 are read as floats. */
+    EVENT_STRING, /**< Use getString(). */
+    EVENT_BINARY, /**< Byte string. Use getBytes(). */
+    EVENT_END_DOCUMENT /**< End of input. */
+  };
+
+  /** The default size of the read buffer. */
+  static constexpr unsigned int DEFAULT_BUFFER_SIZE = 16 * 1024;
+private:
+
+  /** Open array or map. */
+  class Level {
+  public:
+
+    /** True for map. */
+    bool map = false;
+    /** True for indefinite length. */
+    bool indefinite = false;
+    /** True if next item of map is key. */
+    bool expectKey = false;
+    /** The number of items left for definite length. */
+    uint64 remaining = 0;
+  };
+
+  /** The input stream. */
+  InputStream* is = nullptr;
+  /** The read buffer. */
+  PrimitiveArray<uint8> buffer;
+  /** The next byte to read. */
+  const uint8* src = nullptr;
+  /** The end of the read bytes. */
+  const uint8* end = nullptr;
+  /** True if the input stream has been exhausted. */
+  bool eof = false;
+  /** The number of bytes before the read buffer. */
+  uint64 offset = 0;
+
+  /** The open arrays and maps. */
+  PrimitiveArray<Level> levels;
+  /** The number of open arrays and maps. */
+  MemorySize depth = 0;
+  Event event = EVENT_NONE;
+
+  /** The bytes of the current string. */
+  PrimitiveArray<uint8> token;
+  /** The length of the current string. */
+  MemorySize tokenLength = 0;
+  bool boolean = false;
+  int64 integer = 0;
+  double floatingPoint = 0;
+
+  /** Returns the offset of the next byte. */
+  inline uint64 getOffset() const noexcept
+  {
+    return offset + (src - buffer.cbegin());
+  }
+
+  /** Reads more bytes. Returns false at end of input. */
+  bool fill();
+
+  /** Reads byte. Raises CBORException at end of input. */
+  inline uint8 readByte()
+  {
+    if ((src == end) && !fill()) {
+      _throw CBORException("Unexpected end of CBOR.", getOffset());
+    }
+    return *src++;
+  }
+
+  /** Reads the argument for the given additional information. */
+  uint64 readArgument(uint8 info);
+
+  /** Reads the given number of bytes to the current string. */
+  void readBytes(uint64 size);
+
+  /** Reads definite or indefinite length string to the current string. */
+  void readString(uint8 major, uint8 info);
+
+  /** Pushes array or map. */
+  void push(bool map, uint8 info);
+
+  /** Reads item for the given initial byte. */
+  Event readItem(uint8 initial);
+public:
+
+  /**
+    Initializes reader.
+
+    @param is The input stream.
+    @param bufferSize The size of the read buffer.
+  */
+  CBORReader(InputStream* is, unsigned int bufferSize = DEFAULT_BUFFER_SIZE);
+
+  /** Returns the offset of the next byte. */
+  inline uint64 getPosition() const noexcept
+  {
+    return getOffset();
+  }
+
+  /** Reads the next event. Raises CBORException for malformed or unsupported CBOR. */
+  Event next();
+
+  /** Returns the current event. */
+  inline Event getEvent() const noexcept
+  {
+    return event;
+  }
+
+  /** Returns the number of open arrays and maps. */
+  inline MemorySize getDepth() const noexcept
+  {
+    return depth;
+  }
+
+  /** Returns the boolean for EVENT_BOOLEAN. */
+  inline bool getBoolean() const noexcept
+  {
+    return boolean;
+  }
+
+  /** Returns the integer for EVENT_INTEGER. */
+  inline int64 getInteger() const noexcept
+  {
+    return integer;
+  }
+
+  /** Returns the number for EVENT_FLOAT and EVENT_INTEGER. */
+  inline double getFloat() const noexcept
+  {
+    return (event == EVENT_INTEGER) ? static_cast<double>(integer) : floatingPoint;
+  }
+
+  /** Returns the bytes for EVENT_KEY, EVENT_STRING, and EVENT_BINARY. Valid until next(). */
+  inline const uint8* getBytes() const noexcept
+  {
+    return token.cbegin();
+  }
+
+  /** Returns the number of bytes. */
+  inline MemorySize getSize() const noexcept
+  {
+    return tokenLength;
+  }
+
+  /** Returns the text for EVENT_KEY and EVENT_STRING. */
+  inline String getString() const
+  {
+    return String(reinterpret_cast<const char*>(token.cbegin()), tokenLength);
+  }
+
+  /** Returns true if the text equals the given string. */
+  bool isText(const char* text) const noexcept;
+
+  /** Skips the current value including all items of an array or map. */
+  void skipValue();
+
+  /**
+    Returns the current value as an ObjectModel value. For EVENT_BEGIN_OBJECT
+    and EVENT_BEGIN_ARRAY the container is read until the matching end event.
+  */
+  Reference<ObjectModel::Value> getValue(ObjectModel& objectModel);
+};
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
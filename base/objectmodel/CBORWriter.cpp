@@ -0,0 +1,360 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#include <base/objectmodel/CBORWriter.h>
+#include <base/io/MemoryOutputStream.h>
+#include <base/math/Math.h>
+#include <base/UnitTest.h>
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+namespace {
+
+  enum {
+    MAJOR_UNSIGNED = 0,
+    MAJOR_NEGATIVE = 1,
+    MAJOR_BYTES = 2,
+    MAJOR_TEXT = 3,
+    MAJOR_ARRAY = 4,
+    MAJOR_MAP = 5,
+    MAJOR_SIMPLE = 7
+  };
+
+  const uint8 INDEFINITE = 31;
+  const uint8 BREAK = 0xff;
+
+  /** Returns true for comment which has no CBOR representation. */
+  inline bool isComment(const Reference<ObjectModel::Value>& value) noexcept
+  {
+    return value && (value->getType() == ObjectModel::Value::TYPE_STRING) && !value.cast<ObjectModel::String>();
+  }
+}
+
+CBORWriter::CBORWriter(OutputStream* os)
+  : stream(*os), levels(16)
+{
+}
+
+void CBORWriter::beginItem(bool key)
+{
+  if (depth == 0) {
+    if (key) {
+      _throw CBORException("Unexpected key.");
+    }
+    return;
+  }
+  Level& level = levels[depth - 1];
+  if (level.map && (level.expectKey != key)) {
+    _throw CBORException(key ? "Unexpected key." : "Expected key for map member.");
+  }
+  if (!level.map && key) {
+    _throw CBORException("Unexpected key.");
+  }
+  if (!level.indefinite) {
+    if (level.remaining == 0) {
+      _throw CBORException("Too many items.");
+    }
+    --level.remaining;
+  }
+  if (level.map) {
+    level.expectKey = !level.expectKey;
+  }
+}
+
+void CBORWriter::writeHead(uint8 major, uint64 argument)
+{
+  uint8 head[9];
+  unsigned int size = 0;
+  major <<= 5;
+  if (argument < 24) {
+    head[size++] = major | static_cast<uint8>(argument);
+  } else if (argument <= 0xff) {
+    head[size++] = major | 24;
+    head[size++] = static_cast<uint8>(argument);
+  } else if (argument <= 0xffff) {
+    head[size++] = major | 25;
+    head[size++] = static_cast<uint8>(argument >> 8);
+    head[size++] = static_cast<uint8>(argument);
+  } else if (argument <= 0xffffffff) {
+    head[size++] = major | 26;
+    for (int shift = 24; shift >= 0; shift -= 8) {
+      head[size++] = static_cast<uint8>(argument >> shift);
+    }
+  } else {
+    head[size++] = major | 27;
+    for (int shift = 56; shift >= 0; shift -= 8) {
+      head[size++] = static_cast<uint8>(argument >> shift);
+    }
+  }
+  stream.write(head, size);
+}
+
+void CBORWriter::begin(bool map, bool indefinite, uint64 size)
+{
+  beginItem(false);
+  if (indefinite) {
+    const uint8 initial = ((map ? MAJOR_MAP : MAJOR_ARRAY) << 5) | INDEFINITE;
+    stream.write(&initial, 1);
+  } else {
+    writeHead(map ? MAJOR_MAP : MAJOR_ARRAY, size);
+  }
+  if (depth == levels.size()) {
+    levels.resize(depth * 2);
+  }
+  Level& level = levels[depth++];
+  level.map = map;
+  level.indefinite = indefinite;
+  level.expectKey = map;
+  level.remaining = map ? (size * 2) : size;
+}
+
+void CBORWriter::end(bool map)
+{
+  if (depth == 0) {
+    _throw CBORException("Unbalanced CBOR container.");
+  }
+  const Level& level = levels[depth - 1];
+  if ((level.map != map) || (map && !level.expectKey)) {
+    _throw CBORException("Unbalanced CBOR container.");
+  }
+  if (level.indefinite) {
+    stream.write(&BREAK, 1);
+  } else if (level.remaining != 0) {
+    _throw CBORException("Missing items.");
+  }
+  --depth;
+}
+
+CBORWriter& CBORWriter::key(const char* name, MemorySize length)
+{
+  beginItem(true);
+  writeHead(MAJOR_TEXT, length);
+  stream.write(reinterpret_cast<const uint8*>(name), static_cast<unsigned int>(length));
+  return *this;
+}
+
+CBORWriter& CBORWriter::null()
+{
+  beginItem(false);
+  const uint8 initial = 0xf6;
+  stream.write(&initial, 1);
+  return *this;
+}
+
+CBORWriter& CBORWriter::value(bool value)
+{
+  beginItem(false);
+  const uint8 initial = value ? 0xf5 : 0xf4;
+  stream.write(&initial, 1);
+  return *this;
+}
+
+CBORWriter& CBORWriter::value(int32 value)
+{
+  return this->value(static_cast<int64>(value));
+}
+
+CBORWriter& CBORWriter::value(int64 value)
+{
+  beginItem(false);
+  if (value >= 0) {
+    writeHead(MAJOR_UNSIGNED, static_cast<uint64>(value));
+  } else {
+    writeHead(MAJOR_NEGATIVE, ~static_cast<uint64>(value)); // -1 - value
+  }
+  return *this;
+}
+
+CBORWriter& CBORWriter::value(double value)
+{
+  beginItem(false);
+  uint8 bytes[9];
+  if (Math::isNaN(value)) {
+    bytes[0] = 0xf9; // canonical half-precision NaN
+    bytes[1] = 0x7e;
+    bytes[2] = 0x00;
+    stream.write(bytes, 3);
+    return *this;
+  }
+  const float f = static_cast<float>(value);
+  if (static_cast<double>(f) == value) { // exact in single precision
+    uint32 bits = 0;
+    copy<uint8>(reinterpret_cast<uint8*>(&bits), reinterpret_cast<const uint8*>(&f), sizeof(bits));
+    bytes[0] = 0xfa;
+    for (unsigned int i = 0; i < 4; ++i) {
+      bytes[1 + i] = static_cast<uint8>(bits >> (24 - i * 8));
+    }
+    stream.write(bytes, 5);
+  } else {
+    uint64 bits = 0;
+    copy<uint8>(reinterpret_cast<uint8*>(&bits), reinterpret_cast<const uint8*>(&value), sizeof(bits));
+    bytes[0] = 0xfb;
+    for (unsigned int i = 0; i < 8; ++i) {
+      bytes[1 + i] = static_cast<uint8>(bits >> (56 - i * 8));
+    }
+    stream.write(bytes, 9);
+  }
+  return *this;
+}
+
+CBORWriter& CBORWriter::value(const char* value, MemorySize length)
+{
+  beginItem(false);
+  writeHead(MAJOR_TEXT, length);
+  stream.write(reinterpret_cast<const uint8*>(value), static_cast<unsigned int>(length));
+  return *this;
+}
+
+CBORWriter& CBORWriter::binary(const uint8* value, MemorySize size)
+{
+  beginItem(false);
+  writeHead(MAJOR_BYTES, size);
+  stream.write(value, static_cast<unsigned int>(size));
+  return *this;
+}
+
+CBORWriter& CBORWriter::value(const Reference<ObjectModel::Value>& value)
+{
+  if (!value) {
+    return null();
+  }
+  switch (value->getType()) {
+  case ObjectModel::Value::TYPE_VOID:
+    return null();
+  case ObjectModel::Value::TYPE_BOOLEAN:
+    return this->value(value.cast<ObjectModel::Boolean>()->value);
+  case ObjectModel::Value::TYPE_INTEGER:
+    return this->value(value.cast<ObjectModel::Integer>()->value);
+  case ObjectModel::Value::TYPE_FLOAT:
+    return this->value(value.cast<ObjectModel::Float>()->value);
+  case ObjectModel::Value::TYPE_STRING:
+    if (auto s = value.cast<ObjectModel::String>()) {
+      return this->value(s->value);
+    }
+    return null(); // comment
+  case ObjectModel::Value::TYPE_BINARY:
+    {
+      const base::Array<uint8>& bytes = value.cast<ObjectModel::Binary>()->value;
+      return binary(bytes.getFirstReference(), bytes.getSize());
+    }
+  case ObjectModel::Value::TYPE_ARRAY:
+    {
+      const base::Array<Reference<ObjectModel::Value> >& values = value.cast<ObjectModel::Array>()->values;
+      MemorySize count = 0;
+      for (const auto& v : values) {
+        count += isComment(v) ? 0 : 1;
+      }
+      beginArray(count);
+      for (const auto& v : values) {
+        if (!isComment(v)) {
+          this->value(v);
+        }
+      }
+      return endArray();
+    }
+  case ObjectModel::Value::TYPE_OBJECT:
+    {
+      const base::Array<ObjectModel::Object::Association>& values = value.cast<ObjectModel::Object>()->values;
+      MemorySize count = 0;
+      for (const auto& member : values) {
+        count += isComment(member.getSecond()) ? 0 : 1;
+      }
+      beginObject(count);
+      for (const auto& member : values) {
+        if (!isComment(member.getSecond())) {
+          key(member.getFirst()->value);
+          this->value(member.getSecond());
+        }
+      }
+      return endObject();
+    }
+  default:
+    _throw CBORException("Unsupported value.");
+  }
+}
+
+void CBORWriter::flush()
+{
+  stream.flush();
+}
+
+#if defined(_COM_AZURE_DEV__BASE__TESTS)
+
+class TEST_CLASS(CBORWriter) : public UnitTest {
+public:
+
+  TEST_PRIORITY(50);
+  TEST_PROJECT("base/objectmodel");
+
+  static String getHex(MemoryOutputStream& mos)
+  {
+    static const char DIGITS[] = "0123456789abcdef";
+    Allocator<uint8> buffer;
+    mos.swap(buffer);
+    String result;
+    for (const uint8 b : buffer) {
+      result.append(DIGITS[b >> 4]);
+      result.append(DIGITS[b & 0xf]);
+    }
+    return result;
+  }
+
+  void run() override
+  {
+    // examples from RFC 8949 appendix A
+    {
+      MemoryOutputStream mos;
+      CBORWriter writer(&mos);
+      writer.beginArray().value(0).value(23).value(24).value(static_cast<int64>(1000000000000LL)).value(-1).value(-1000);
+      writer.value(static_cast<int64>(PrimitiveTraits<int64>::MINIMUM)).endArray();
+      writer.flush();
+      TEST_EQUAL(getHex(mos), "9f00171818"
+                 "1b000000e8d4a51000" "20" "3903e7" "3b7fffffffffffffff" "ff");
+    }
+    {
+      MemoryOutputStream mos;
+      CBORWriter writer(&mos);
+      writer.value(1.1).value(100000.0).value(-4.0).value(Math::getNaN<double>()).value(Math::getInfinity<double>());
+      writer.flush();
+      TEST_EQUAL(getHex(mos), "fb3ff199999999999a" "fa47c35000" "fac0800000" "f97e00" "fa7f800000");
+    }
+    {
+      MemoryOutputStream mos;
+      CBORWriter writer(&mos);
+      const uint8 bytes[] = {1, 2, 3, 4};
+      writer.beginObject(2).key("a").value(1).key("b").beginArray(2).value(2).value(3).endArray().endObject();
+      writer.value("\xc3\xbc").binary(bytes, sizeof(bytes)).value(false).value(true).null();
+      writer.flush();
+      TEST_EQUAL(getHex(mos), "a26161016162820203" "62c3bc" "4401020304" "f4f5f6");
+    }
+
+    MemoryOutputStream mos;
+    CBORWriter writer(&mos);
+    writer.beginObject(1);
+    TEST_EXCEPTION(writer.value(1), CBORException);
+    TEST_EXCEPTION(writer.endObject(), CBORException);
+    writer.key("a");
+    TEST_EXCEPTION(writer.key("b"), CBORException);
+    writer.value(1);
+    TEST_EXCEPTION(writer.key("c"), CBORException);
+    writer.endObject();
+    writer.beginArray(1);
+    TEST_EXCEPTION(writer.endArray(), CBORException);
+  }
+};
+
+TEST_REGISTER(CBORWriter);
+
+#endif
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
@@ -0,0 +1,183 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#pragma once
+
+#include <base/objectmodel/CBOR.h>
+#include <base/io/BufferedOutputStream.h>
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+/**
+  Incremental CBOR writer to an output stream. Arrays and maps are written
+  with indefinite length unless the number of items is given up front. Raises
+  CBORException if the calls do not form a valid item (e.g. a value without
+  key within a map or too many items for a definite length array).
+
+  @code
+  CBORWriter writer(&fos);
+  writer.beginObject(2);
+  writer.key("id").value(123);
+  writer.key("data").binary(bytes, size);
+  writer.endObject();
+  writer.flush();
+  @endcode
+
+  @short CBOR writer.
+  @version 1.0
+*/
+
+class _COM_AZURE_DEV__BASE__API CBORWriter {
+private:
+
+  /** Open array or map. */
+  class Level {
+  public:
+
+    /** True for map. */
+    bool map = false;
+    /** True for indefinite length. */
+    bool indefinite = false;
+    /** True if next item of map is key. */
+    bool expectKey = false;
+    /** The number of items left for definite length. */
+    uint64 remaining = 0;
+  };
+
+  /** The buffered output. */
+  BufferedOutputStream stream;
+  /** The open arrays and maps. */
+  PrimitiveArray<Level> levels;
+  /** The number of open arrays and maps. */
+  MemorySize depth = 0;
+
+  /** Checks that an item may be written. */
+  void beginItem(bool key);
+
+  /** Writes major type and argument. */
+  void writeHead(uint8 major, uint64 argument);
+
+  /** Writes begin of array or map. */
+  void begin(bool map, bool indefinite, uint64 size);
+
+  /** Writes end of array or map. */
+  void end(bool map);
+public:
+
+  /** Initializes writer. */
+  CBORWriter(OutputStream* os);
+
+  /** Returns the number of open arrays and maps. */
+  inline MemorySize getDepth() const noexcept
+  {
+    return depth;
+  }
+
+  /** Begins array of indefinite length. */
+  inline CBORWriter& beginArray()
+  {
+    begin(false, true, 0);
+    return *this;
+  }
+
+  /** Begins array with the given number of elements. */
+  inline CBORWriter& beginArray(uint64 size)
+  {
+    begin(false, false, size);
+    return *this;
+  }
+
+  /** Ends array. */
+  inline CBORWriter& endArray()
+  {
+    end(false);
+    return *this;
+  }
+
+  /** Begins map of indefinite length. */
+  inline CBORWriter& beginObject()
+  {
+    begin(true, true, 0);
+    return *this;
+  }
+
+  /** Begins map with the given number of members. */
+  inline CBORWriter& beginObject(uint64 size)
+  {
+    begin(true, false, size);
+    return *this;
+  }
+
+  /** Ends map. */
+  inline CBORWriter& endObject()
+  {
+    end(true);
+    return *this;
+  }
+
+  /** Writes member name. */
+  CBORWriter& key(const char* name, MemorySize length);
+
+  /** Writes member name. */
+  inline CBORWriter& key(const char* name)
+  {
+    return key(name, getNullTerminatedLength(name));
+  }
+
+  /** Writes member name. */
+  inline CBORWriter& key(const String& name)
+  {
+    return key(name.native(), name.getLength());
+  }
+
+  /** Writes null. */
+  CBORWriter& null();
+
+  /** Writes boolean. */
+  CBORWriter& value(bool value);
+
+  /** Writes integer. */
+  CBORWriter& value(int32 value);
+
+  /** Writes integer. */
+  CBORWriter& value(int64 value);
+
+  /** Writes float. */
+  CBORWriter& value(double value);
+
+  /** Writes UTF-8 string. */
+  CBORWriter& value(const char* value, MemorySize length);
+
+  /** Writes UTF-8 string. */
+  inline CBORWriter& value(const char* value)
+  {
+    return this->value(value, getNullTerminatedLength(value));
+  }
+
+  /** Writes UTF-8 string. */
+  inline CBORWriter& value(const String& value)
+  {
+    return this->value(value.native(), value.getLength());
+  }
+
+  /** Writes ObjectModel value. Arrays and objects are written with definite length. */
+  CBORWriter& value(const Reference<ObjectModel::Value>& value);
+
+  /** Writes byte string. */
+  CBORWriter& binary(const uint8* value, MemorySize size);
+
+  /** Writes the buffered output to the output stream. */
+  void flush();
+};
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
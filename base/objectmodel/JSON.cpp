@@ -16,6 +16,8 @@
 
 #include <base/objectmodel/JSON.h>
 #include <base/io/File.h>
+#include <base/string/StringOutputStream.h>
+#include <base/Timer.h>
 #include <base/UnitTest.h>
 
 _COM_AZURE_DEV__BASE__ENTER_NAMESPACE
@@ -300,7 +302,7 @@ Reference<ObjectModel::String> JSON::parseString(JSONParser& parser)
             }
             const uint32 high = value - 0xd800; // leading
             const uint32 low = value2 - 0xdc00; // trailing
-            const ucs4 ch = (high << 10) | low;
+            const ucs4 ch = 0x10000 + ((high << 10) | low);
             uint8 bytes[4];
             MemorySize size = Unicode::writeUTF8(bytes, ch);
             for (MemorySize i = 0; i < size; ++i) {
@@ -308,7 +310,7 @@ Reference<ObjectModel::String> JSON::parseString(JSONParser& parser)
             }
           } else {
             uint8 bytes[4];
-            MemorySize size = Unicode::writeUTF8(bytes, ch);
+            MemorySize size = Unicode::writeUTF8(bytes, value);
             for (MemorySize i = 0; i < size; ++i) {
               buffer.push(bytes[i]);
             }
@@ -445,28 +447,22 @@ Reference<ObjectModel::Value> JSON::parseValue(JSONParser& parser)
   }
 }
 
-Reference<ObjectModel::Value> JSON::parse(const uint8* src, const uint8* end)
-{
-  JSONParser parser(src, end);
-  
-  // TAG: add support for UTF-16 and UTF-32
-  
-  // we may read BOM - but not write it - see rfc7159
-  if (static_cast<uint8>(parser.peek()) == 0xef) {
-    parser.skip();
-    if (static_cast<uint8>(parser.peek()) == 0xbb) {
-      parser.skip();
-      if (static_cast<uint8>(parser.peek()) == 0xbf) {
-        parser.skip();
-      } else {
-        parser.unwind();
-        parser.unwind();
-      }
-    } else {
-      parser.unwind();
+namespace {
+
+  /** Skips UTF-8 BOM. We may read BOM - but not write it - see rfc7159. */
+  inline const uint8* skipBOM(const uint8* src, const uint8* end) noexcept
+  {
+    if (((end - src) >= 3) && (src[0] == 0xef) && (src[1] == 0xbb) && (src[2] == 0xbf)) {
+      return src + 3;
     }
+    return src;
   }
-  
+}
+
+Reference<ObjectModel::Value> JSON::parseRecursive(const uint8* src, const uint8* end)
+{
+  // TAG: add support for UTF-16 and UTF-32
+  JSONParser parser(skipBOM(src, end), end);
   Reference<ObjectModel::Value> result = JSON::parseValue(parser);
   skipSpaces(parser);
   if (parser.hasMore()) {
@@ -475,6 +471,333 @@ Reference<ObjectModel::Value> JSON::parse(const uint8* src, const uint8* end)
   return result;
 }
 
+class JSON::IndexedParser {
+private:
+
+  JSON& json;
+  const uint8* begin = nullptr;
+  const uint8* end = nullptr;
+  const uint32* positions = nullptr;
+  MemorySize size = 0;
+  MemorySize index = 0;
+  /** Elements of the arrays being parsed. Array::append() copies all elements on each call. */
+  base::Array<Reference<ObjectModel::Value> > stack;
+  MemorySize stackSize = 0;
+  /** Members of the objects being parsed. */
+  base::Array<ObjectModel::Object::Association> members;
+  MemorySize membersSize = 0;
+
+  /** Pushes value onto the stack. */
+  void push(Reference<ObjectModel::Value>&& value)
+  {
+    if (stackSize == stack.getSize()) {
+      stack.setSize(maximum<MemorySize>(stackSize * 2, 64));
+    }
+    stack[stackSize++] = moveObject(value);
+  }
+
+  /** Pushes member onto the stack. */
+  void push(Reference<ObjectModel::String>&& key, Reference<ObjectModel::Value>&& value)
+  {
+    if (membersSize == members.getSize()) {
+      members.setSize(maximum<MemorySize>(membersSize * 2, 64));
+    }
+    ObjectModel::Object::Association& member = members[membersSize++];
+    member.setFirst(moveObject(key));
+    member.setSecond(moveObject(value));
+  }
+public:
+
+  IndexedParser(JSON& _json, const uint8* _begin, const uint8* _end, const JSONStructuralIndex& structure, MemorySize first = 0) noexcept
+    : json(_json), begin(_begin), end(_end), index(first)
+  {
+    positions = structure.getPositions();
+    size = structure.getSize();
+  }
+
+  /** Returns the line and column for the given byte. */
+  LineColumn getPosition(const uint8* at) const noexcept
+  {
+    MemorySize line = 0;
+    const uint8* lastLine = begin;
+    for (const uint8* src = begin; src != at; ++src) {
+      if (*src == '\n') {
+        ++line;
+        lastLine = src + 1;
+      }
+    }
+    return LineColumn(line + 1, JSONParser::getColumn(lastLine, at) + 1);
+  }
+
+  /** Returns true if all tokens have been read. */
+  inline bool isEnd() const noexcept
+  {
+    return index == size;
+  }
+
+  /** Returns the current token. */
+  inline const uint8* getToken() const noexcept
+  {
+    return (index < size) ? (begin + positions[index]) : end;
+  }
+
+  /** Returns the end of the current token excluding trailing space. */
+  inline const uint8* getTokenEnd() const noexcept
+  {
+    const uint8* result = ((index + 1) < size) ? (begin + positions[index + 1]) : end;
+    while (true) {
+      switch (result[-1]) {
+      case ' ':
+      case '\n':
+      case '\r':
+      case '\t':
+        --result;
+        continue;
+      }
+      break;
+    }
+    return result;
+  }
+
+  /** Reads the given structural character. */
+  inline bool read(char ch) noexcept
+  {
+    if ((index < size) && (begin[positions[index]] == ch)) {
+      ++index;
+      return true;
+    }
+    return false;
+  }
+
+  Reference<ObjectModel::Value> parseLiteral(const uint8* src, const char* literal, MemorySize length)
+  {
+    if (((getTokenEnd() - src) != static_cast<MemoryDiff>(length)) || (compare(src, reinterpret_cast<const uint8*>(literal), length) != 0)) {
+      _throw JSONException("Malformed literal.", getPosition(src));
+    }
+    ++index;
+    switch (*src) {
+    case 't':
+      return json.objectModel.createBoolean(true);
+    case 'f':
+      return json.objectModel.createBoolean(false);
+    default:
+      return json.objectModel.createVoid();
+    }
+  }
+
+  Reference<ObjectModel::Value> parseNumber(const uint8* src)
+  {
+    const uint8* end = getTokenEnd();
+    const uint8* p = src;
+    const bool negative = (*p == '-');
+    if (negative) {
+      ++p;
+    }
+    const uint8* digits = p;
+    if ((p != end) && (*p == '0')) {
+      ++p;
+    } else {
+      while ((p != end) && (*p >= '0') && (*p <= '9')) {
+        ++p;
+      }
+    }
+    if (p == digits) {
+      _throw JSONException("Malformed number.", getPosition(src));
+    }
+    ++index;
+
+    if (p == end) { // integer
+      // numbers in the range [-(2**53)+1, (2**53)-1] must be exact
+      uint64 value = 0;
+      bool overflow = (p - digits) > 19;
+      for (const uint8* q = digits; !overflow && (q != p); ++q) {
+        const uint64 next = value * 10 + (*q - '0');
+        overflow = (value > (PrimitiveTraits<uint64>::MAXIMUM/10)) || (next < value);
+        value = next;
+      }
+      const uint64 limit = static_cast<uint64>(PrimitiveTraits<int64>::MAXIMUM) + (negative ? 1 : 0);
+      if (!overflow && (value <= limit)) {
+        return json.objectModel.createInteger(negative ? static_cast<int64>(0 - value) : static_cast<int64>(value));
+      }
+    }
+
+    if ((p != end) && (*p == '.')) { // fraction - digits are optional like for recursive descent (e.g. 123.)
+      ++p;
+      while ((p != end) && (*p >= '0') && (*p <= '9')) {
+        ++p;
+      }
+    }
+    if ((p != end) && ((*p == 'e') || (*p == 'E'))) { // exponent
+      ++p;
+      if ((p != end) && ((*p == '-') || (*p == '+'))) {
+        ++p;
+      }
+      const uint8* exponent = p;
+      while ((p != end) && (*p >= '0') && (*p <= '9')) {
+        ++p;
+      }
+      if (p == exponent) {
+        _throw JSONException("Malformed float.", getPosition(p));
+      }
+    }
+    if (p != end) {
+      _throw JSONException("Malformed number.", getPosition(p));
+    }
+
+    double d = 0;
+    if (!json.posix.getSeries(reinterpret_cast<const char*>(digits), reinterpret_cast<const char*>(end), d)) {
+      _throw JSONException("Malformed float.", getPosition(src));
+    }
+    return json.objectModel.createFloat(negative ? -d : d);
+  }
+
+  Reference<ObjectModel::String> parseString(const uint8* src)
+  {
+    const uint8* last = getTokenEnd() - 1; // closing quote
+    if ((last <= src) || (*last != '"')) {
+      _throw JSONException("Malformed string literal.", getPosition(src));
+    }
+    ++index;
+
+    const uint8* p = src + 1;
+    while ((p != last) && (*p >= 0x20) && (*p < 0x80) && (*p != '\\')) {
+      ++p;
+    }
+    if (p == last) { // plain ASCII
+      return json.objectModel.createString(String(reinterpret_cast<const char*>(src + 1), last - (src + 1)));
+    }
+
+    JSONParser parser(src, last + 1); // escapes and UTF-8 are handled by recursive descent
+    Reference<ObjectModel::String> result = json.parseString(parser);
+    if (parser.hasMore()) {
+      _throw JSONException("Malformed string literal.", getPosition(parser.getCurrent()));
+    }
+    return result;
+  }
+
+  Reference<ObjectModel::Array> parseArray()
+  {
+    ++index; // [
+    Reference<ObjectModel::Array> result = json.objectModel.createArray();
+    if (read(']')) {
+      return result; // empty
+    }
+    const MemorySize base = stackSize;
+    while (true) {
+      push(parseValue());
+      if (read(',')) {
+        continue;
+      }
+      if (read(']')) {
+        break;
+      }
+      _throw JSONException("Malformed array.", getPosition(getToken()));
+    }
+    const MemorySize count = stackSize - base;
+    result->values.setSize(count); // single allocation
+    Reference<ObjectModel::Value>* dest = result->values.getElements();
+    Reference<ObjectModel::Value>* elements = stack.getElements() + base;
+    for (MemorySize i = 0; i < count; ++i) {
+      dest[i] = moveObject(elements[i]);
+    }
+    stackSize = base;
+    return result;
+  }
+
+  Reference<ObjectModel::Object> parseObject()
+  {
+    ++index; // {
+    Reference<ObjectModel::Object> result = json.objectModel.createObject();
+    if (read('}')) {
+      return result; // empty
+    }
+    const MemorySize base = membersSize;
+    while (true) {
+      const uint8* key = getToken();
+      if ((key == end) || (*key != '"')) {
+        _throw JSONException("Expected string.", getPosition(key));
+      }
+      Reference<ObjectModel::String> name = parseString(key);
+      if (!read(':')) {
+        _throw JSONException("Expected colon.", getPosition(getToken()));
+      }
+      push(moveObject(name), parseValue());
+      if (read(',')) {
+        continue;
+      }
+      if (read('}')) {
+        break;
+      }
+      _throw JSONException("Malformed object.", getPosition(getToken()));
+    }
+    const MemorySize count = membersSize - base;
+    result->values.setSize(count); // single allocation
+    ObjectModel::Object::Association* dest = result->values.getElements();
+    ObjectModel::Object::Association* elements = members.getElements() + base;
+    for (MemorySize i = 0; i < count; ++i) {
+      dest[i] = moveObject(elements[i]);
+    }
+    membersSize = base;
+    result->rebuildIndex(); // merges duplicate keys
+    return result;
+  }
+
+  Reference<ObjectModel::Value> parseValue()
+  {
+    const uint8* src = getToken();
+    if (src == end) {
+      _throw JSONException("Unexpected end reached.", getPosition(end));
+    }
+    switch (*src) {
+    case '{':
+      return parseObject();
+    case '[':
+      return parseArray();
+    case '"':
+      return parseString(src);
+    case 't':
+      return parseLiteral(src, "true", 4);
+    case 'f':
+      return parseLiteral(src, "false", 5);
+    case 'n':
+      return parseLiteral(src, "null", 4);
+    case '}':
+    case ']':
+    case ':':
+    case ',':
+      _throw JSONException("Expected value.", getPosition(src));
+    default:
+      return parseNumber(src);
+    }
+  }
+};
+
+Reference<ObjectModel::Value> JSON::parse(const uint8* src, const uint8* end)
+{
+  // TAG: add support for UTF-16 and UTF-32
+  src = skipBOM(src, end);
+  if (static_cast<MemorySize>(end - src) > JSONStructuralIndex::MAXIMUM_SIZE) {
+    return parseRecursive(src, end);
+  }
+
+  index.build(src, end);
+  IndexedParser parser(*this, src, end, index);
+  Reference<ObjectModel::Value> result = parser.parseValue();
+  if (!parser.isEnd()) {
+    _throw JSONException("Unexpected content after object.", parser.getPosition(parser.getToken()));
+  }
+  return result;
+}
+
+Reference<ObjectModel::Value> JSON::parse(const uint8* src, const uint8* end, const JSONStructuralIndex& index, MemorySize token)
+{
+  if (token >= index.getSize()) {
+    _throw OutOfRange();
+  }
+  IndexedParser parser(*this, src, end, index, token);
+  return parser.parseValue();
+}
+
 Reference<ObjectModel::Value> JSON::parse(const String& text)
 {
   JSON json;
@@ -526,6 +849,48 @@ public:
 #endif
   }
 
+  bool compareIndexed(const String& text)
+  {
+    const uint8* src = text.getBytes();
+    const uint8* end = src + text.getLength();
+    auto indexed = JSON().parse(src, end);
+    auto recursive = JSON().parseRecursive(src, end);
+    return JSON::getJSONNoFormatting(indexed) == JSON::getJSONNoFormatting(recursive);
+  }
+
+  /** Returns random document. Strings cross the 64 byte blocks of the structural index. */
+  static String getRandomDocument(uint32& seed, unsigned int depth = 0)
+  {
+    static const char* STRINGS[] = {
+      "text", "", "a\\\"b", "\\\\", "\\\\\\\"", "x\\u00e9y", "\\ud83d\\ude00", "\xc3\xa9t\xc3\xa9", "{[:,]}", "tab\\t", " spaced "
+    };
+    static const char* SCALARS[] = {
+      "0", "-1", "123456789", "-9223372036854775808", "9223372036854775807", "1.5", "-2.5e-3", "6E+2", "true", "false", "null"
+    };
+    seed = seed * 1664525 + 1013904223; // LCG
+    const uint32 r = seed >> 8;
+    StringOutputStream stream;
+    if ((depth < 4) && ((r % 4) == 0)) {
+      stream << ((r & 0x10) ? '[' : '{');
+      const unsigned int count = (r >> 5) % 6;
+      for (unsigned int i = 0; i < count; ++i) {
+        if (i > 0) {
+          stream << ((r & 0x20) ? ", " : ",");
+        }
+        if (!(r & 0x10)) {
+          stream << '"' << STRINGS[(r + i) % getArraySize(STRINGS)] << i << "\":" << ((r & 0x40) ? "\n  " : "");
+        }
+        stream << getRandomDocument(seed, depth + 1);
+      }
+      stream << ((r & 0x10) ? ']' : '}');
+    } else if ((r % 4) == 1) {
+      stream << '"' << STRINGS[(r >> 4) % getArraySize(STRINGS)] << String("----------------------------------------------------------------------", (r >> 8) % 70) << '"';
+    } else {
+      stream << SCALARS[(r >> 4) % getArraySize(SCALARS)];
+    }
+    return stream.toString();
+  }
+
   void run() override
   {
     ObjectModel o;
@@ -620,6 +985,31 @@ public:
     TEST_ASSERT(JSON().parse("\"Hello world!\""));
     TEST_ASSERT(JSON().parse("42"));
     TEST_ASSERT(JSON().parse("true"));
+    TEST_ASSERT(JSON().parse("1.5"));
+    TEST_ASSERT(JSON().parse("\xef\xbb\xbf[]"));
+    TEST_ASSERT(ensureFailure(""));
+    TEST_ASSERT(ensureFailure("[01]"));
+    TEST_ASSERT(ensureFailure("[1.e]"));
+    TEST_ASSERT(ensureFailure("[truex]"));
+    TEST_ASSERT(ensureFailure("[\"a\" \"b\"]"));
+    TEST_ASSERT(ensureFailure("[\"a\\\"]"));
+    TEST_ASSERT(ensureFailure("{\"a\" 1}"));
+    TEST_ASSERT(compareIndexed("[\"\\\\\", \"\\\"\", 1e2, -0, 9223372036854775807, -9223372036854775808]"));
+    {
+      auto a = JSON().parse("[18446744073709551616, -9223372036854775809]").cast<ObjectModel::Array>();
+      TEST_ASSERT(a->getAt(0).isType<ObjectModel::Float>() && (a->getAt(0).cast<ObjectModel::Float>()->value > 1e19)); // overflow
+      TEST_ASSERT(a->getAt(1).isType<ObjectModel::Float>() && (a->getAt(1).cast<ObjectModel::Float>()->value < -9e18));
+    }
+    {
+      uint32 seed = 0x5eed;
+      for (unsigned int i = 0; i < 200; ++i) {
+        const String text = "[" + getRandomDocument(seed) + "]";
+        if (!compareIndexed(text)) {
+          TEST_ASSERT(!"Indexed parse differs.");
+          break;
+        }
+      }
+    }
   
     const char* test3 = R""""(
 {
@@ -665,6 +1055,54 @@ public:
 
 TEST_REGISTER(JSON);
 
+class TEST_CLASS(JSONBenchmark) : public UnitTest {
+public:
+
+  TEST_PRIORITY(1000);
+  TEST_PROJECT("base/objectmodel");
+  TEST_IMPACT(LOW);
+
+  void run() override
+  {
+    StringOutputStream stream;
+    stream << '[';
+    for (unsigned int i = 0; i < 10000; ++i) {
+      if (i > 0) {
+        stream << ',' << '\n';
+      }
+      stream << "{\"id\": " << i << ", \"name\": \"user " << i << "\", \"score\": " << (i * 0.25)
+             << ", \"active\": " << ((i % 3) ? "true" : "false") << ", \"tags\": [\"alpha\", \"beta\", null]"
+             << ", \"text\": \"The quick brown fox jumps over the lazy dog. \\\"Quoted\\\" text.\"}";
+    }
+    stream << ']';
+    const String text = stream.toString();
+    const uint8* src = text.getBytes();
+    const uint8* end = src + text.getLength();
+
+    JSON json;
+    Timer timer;
+    auto recursive = json.parseRecursive(src, end);
+    const uint64 recursiveTime = timer.getLiveMicroseconds();
+
+    timer.start();
+    auto indexed = json.parse(src, end);
+    const uint64 indexedTime = timer.getLiveMicroseconds();
+
+    timer.start();
+    JSONStructuralIndex index;
+    index.build(src, end);
+    const uint64 indexTime = timer.getLiveMicroseconds();
+
+    TEST_EQUAL(JSON::getJSONNoFormatting(indexed), JSON::getJSONNoFormatting(recursive));
+    const double megabytes = text.getLength()/(1024.0 * 1024);
+    TEST_PRINT(format() << "Size: " << text.getLength() << " bytes, recursive: " << megabytes * 1000000/maximum<uint64>(recursiveTime, 1)
+               << " MB/s, indexed: " << megabytes * 1000000/maximum<uint64>(indexedTime, 1)
+               << " MB/s, structural index only: " << megabytes * 1000000/maximum<uint64>(indexTime, 1) << " MB/s");
+  }
+};
+
+TEST_REGISTER(JSONBenchmark);
+
 #endif
 
 _COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
@@ -14,6 +14,7 @@
 #pragma once
 
 #include <base/objectmodel/ObjectModel.h>
+#include <base/objectmodel/JSONStructuralIndex.h>
 #include <base/string/Parser.h>
 #include <base/string/Posix.h>
 
@@ -98,6 +99,10 @@ public:
 
   Implementation preserves 64-bit signed integer and float types.
 
+  parse() works in two stages. First a JSONStructuralIndex is built for the
+  entire text. The values are then created by walking the index so that only
+  the bytes of the values are visited.
+
   @short JSON
   @version 1.0
 */
@@ -181,6 +186,10 @@ private:
   ObjectModel objectModel;
   PrimitiveArray<char> buffer; // reused - do NOT reuse on recursion
   Posix posix; // get series of floats
+  JSONStructuralIndex index; // reused
+
+  /** Creates values from the structural index. */
+  class IndexedParser;
 
   /** Skip space. */
   inline void skipSpaces(JSONParser& parser) noexcept
@@ -226,6 +235,15 @@ public:
   /** Returns ObjectModel for the given JSON text. */
   Reference<ObjectModel::Value> parse(const uint8* src, const uint8* end);
 
+  /**
+    Returns ObjectModel for the value at the given token of a structural index
+    built for the given text. Content after the value is not examined.
+  */
+  Reference<ObjectModel::Value> parse(const uint8* src, const uint8* end, const JSONStructuralIndex& index, MemorySize token);
+
+  /** Returns ObjectModel for the given JSON text using recursive descent only. */
+  Reference<ObjectModel::Value> parseRecursive(const uint8* src, const uint8* end);
+
   /** Returns ObjectModel for the given JSON text. */
   static Reference<ObjectModel::Value> parse(const String& text);
 
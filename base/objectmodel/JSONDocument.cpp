@@ -0,0 +1,400 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#include <base/objectmodel/JSONDocument.h>
+#include <base/objectmodel/JSONWriter.h>
+#include <base/string/StringOutputStream.h>
+#include <base/Timer.h>
+#include <base/UnitTest.h>
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+JSONDocument::Mapping::Mapping(const File& _file, const FileRegion& region)
+  : file(_file, region)
+{
+}
+
+JSONDocument::JSONDocument(const uint8* src, const uint8* end)
+{
+  initialize(src, end);
+}
+
+JSONDocument::JSONDocument(const String& _text)
+  : text(_text)
+{
+  initialize(text.getBytes(), text.getBytes() + text.getLength());
+}
+
+JSONDocument::JSONDocument(const File& file)
+{
+  const long long size = file.getSize();
+  if (size > static_cast<long long>(JSONStructuralIndex::MAXIMUM_SIZE)) {
+    _throw JSONException("JSON file is too large.");
+  }
+  if (size == 0) { // empty region cannot be mapped
+    initialize(nullptr, nullptr);
+    return;
+  }
+  mapping = new Mapping(file, FileRegion(0, static_cast<unsigned int>(size)));
+  const uint8* src = mapping->file.getBytes();
+  initialize(src, src + size);
+}
+
+void JSONDocument::initialize(const uint8* src, const uint8* _end)
+{
+  if (((_end - src) >= 3) && (src[0] == 0xef) && (src[1] == 0xbb) && (src[2] == 0xbf)) { // BOM
+    src += 3;
+  }
+  if (static_cast<MemorySize>(_end - src) > JSONStructuralIndex::MAXIMUM_SIZE) {
+    _throw JSONException("JSON text is too large.");
+  }
+  begin = src;
+  end = _end;
+  index.build(begin, end);
+
+  const MemorySize size = index.getSize();
+  if (size == 0) {
+    _throw JSONException("Unexpected end reached.", getPosition(end));
+  }
+  matches.setSize(size);
+  uint32* dest = matches.getElements();
+  Array<uint32> open;
+  MemorySize depth = 0;
+  for (MemorySize i = 0; i < size; ++i) {
+    const uint8 ch = getToken(i);
+    if ((ch == '{') || (ch == '[')) {
+      if (depth == open.getSize()) {
+        open.setSize(maximum<MemorySize>(depth * 2, 64));
+      }
+      open[depth++] = static_cast<uint32>(i);
+    } else if ((ch == '}') || (ch == ']')) {
+      if ((depth == 0) || (getToken(open[depth - 1]) != ((ch == '}') ? '{' : '['))) {
+        _throw JSONException("Unbalanced JSON container.", getPosition(begin + index.getPosition(i)));
+      }
+      dest[open[--depth]] = static_cast<uint32>(i);
+    }
+  }
+  if (depth != 0) {
+    _throw JSONException("Unexpected end reached.", getPosition(end));
+  }
+  if (skip(0) != size) {
+    _throw JSONException("Unexpected content after object.", getPosition(begin + index.getPosition(skip(0))));
+  }
+}
+
+LineColumn JSONDocument::getPosition(const uint8* at) const noexcept
+{
+  MemorySize line = 0;
+  const uint8* lastLine = begin;
+  for (const uint8* src = begin; src != at; ++src) {
+    if (*src == '\n') {
+      ++line;
+      lastLine = src + 1;
+    }
+  }
+  return LineColumn(line + 1, JSON::JSONParser::getColumn(lastLine, at) + 1);
+}
+
+void JSONDocument::checkValue(MemorySize token, MemorySize close) const
+{
+  if (token >= close) {
+    _throw JSONException("Expected value.", getPosition(begin + index.getPosition(close)));
+  }
+  switch (getToken(token)) {
+  case '}':
+  case ']':
+  case ':':
+  case ',':
+    _throw JSONException("Expected value.", getPosition(begin + index.getPosition(token)));
+  }
+}
+
+bool JSONDocument::isKey(MemorySize token, const String& name)
+{
+  const uint8* src = begin + index.getPosition(token);
+  if (*src != '"') {
+    _throw JSONException("Expected string.", getPosition(src));
+  }
+  const uint8* last = begin + index.getPosition(token + 1); // token + 1 exists within object
+  while ((last[-1] == ' ') || (last[-1] == '\n') || (last[-1] == '\r') || (last[-1] == '\t')) {
+    --last;
+  }
+  --last; // closing quote
+  if ((last <= src) || (*last != '"')) {
+    _throw JSONException("Malformed string literal.", getPosition(src));
+  }
+
+  const uint8* p = src + 1;
+  while ((p != last) && (*p != '\\')) {
+    ++p;
+  }
+  if (p == last) { // no escapes
+    const MemorySize length = last - (src + 1);
+    return (length == name.getLength()) && (compare(src + 1, name.getBytes(), length) == 0);
+  }
+  JSON::JSONParser parser(src, last + 1);
+  return json.parseString(parser)->value == name;
+}
+
+MemoryDiff JSONDocument::findMember(MemorySize object, const String& name)
+{
+  const MemorySize close = matches[object];
+  MemorySize token = object + 1;
+  if (token == close) {
+    return -1; // empty
+  }
+  MemoryDiff result = -1;
+  while (true) {
+    if ((token + 1) >= close) {
+      _throw JSONException("Expected colon.", getPosition(begin + index.getPosition(close)));
+    }
+    if (getToken(token + 1) != ':') {
+      _throw JSONException("Expected colon.", getPosition(begin + index.getPosition(token + 1)));
+    }
+    checkValue(token + 2, close);
+    if (isKey(token, name)) {
+      result = token + 2; // last member wins
+    }
+    const MemorySize next = skip(token + 2);
+    if (next == close) {
+      break;
+    }
+    if (getToken(next) != ',') {
+      _throw JSONException("Malformed object.", getPosition(begin + index.getPosition(next)));
+    }
+    token = next + 1;
+  }
+  return result;
+}
+
+MemoryDiff JSONDocument::findElement(MemorySize array, MemorySize elementIndex) const
+{
+  const MemorySize close = matches[array];
+  MemorySize token = array + 1;
+  if (token == close) {
+    return -1; // empty
+  }
+  while (true) {
+    checkValue(token, close);
+    if (elementIndex-- == 0) {
+      return token;
+    }
+    const MemorySize next = skip(token);
+    if (next == close) {
+      return -1;
+    }
+    if (getToken(next) != ',') {
+      _throw JSONException("Malformed array.", getPosition(begin + index.getPosition(next)));
+    }
+    token = next + 1;
+  }
+}
+
+MemoryDiff JSONDocument::find(const char* path, bool forceNull)
+{
+  if (!path) {
+    return -1;
+  }
+  MemoryDiff current = 0; // entire document
+  while (*path) {
+    if (*path != '/') {
+      _throw ObjectModelException("Invalid path.");
+    }
+    ++path;
+
+    const uint8 ch = getToken(current);
+    if (ch == '{') {
+      const char* _begin = path;
+      while (*path && (*path != '/')) { // find separator
+        ++path;
+      }
+      String key(_begin, path - _begin);
+      key.replaceAll("~1", "/"); // must be first
+      key.replaceAll("~0", "~");
+
+      current = findMember(current, key);
+      if (current < 0) {
+        if (forceNull) {
+          return -1;
+        }
+        _throw ObjectModelException("Path not found.");
+      }
+
+    } else if (ch == '[') {
+      const char* ibegin = path;
+      MemorySize elementIndex = 0;
+      bool overflow = false;
+      if (*path == '0') {
+        ++path;
+      } else {
+        while ((*path >= '0') && (*path <= '9')) {
+          const MemorySize next = elementIndex * 10 + (*path++ - '0');
+          overflow |= (next / 10) != elementIndex;
+          elementIndex = next;
+        }
+      }
+      if ((path == ibegin) || (*path && (*path != '/')) || overflow) {
+        _throw ObjectModelException("Invalid array index.");
+      }
+
+      current = findElement(current, elementIndex);
+      if (current < 0) {
+        if (forceNull) {
+          return -1;
+        }
+        _throw ObjectModelException("Array index out of range.");
+      }
+    } else {
+      if (forceNull) {
+        return -1;
+      }
+      _throw ObjectModelException("Path not found.");
+    }
+  }
+  return current;
+}
+
+Reference<ObjectModel::Value> JSONDocument::getValue(const char* path, bool forceNull)
+{
+  const MemoryDiff token = find(path, forceNull);
+  if (token < 0) {
+    return nullptr;
+  }
+  return json.parse(begin, end, index, token);
+}
+
+MemorySize JSONDocument::getSize(const char* path)
+{
+  const MemoryDiff token = find(path, false);
+  const uint8 ch = getToken(token);
+  if ((ch != '{') && (ch != '[')) {
+    _throw ObjectModelException("Expected array or object.");
+  }
+  const MemorySize close = matches[token];
+  if ((token + 1) == close) {
+    return 0; // empty
+  }
+  MemorySize separators = 0;
+  for (MemorySize i = token + 1; i < close;) { // nested containers are skipped
+    if (getToken(i) == ',') {
+      ++separators;
+      ++i;
+    } else {
+      i = skip(i);
+    }
+  }
+  return separators + 1;
+}
+
+#if defined(_COM_AZURE_DEV__BASE__TESTS)
+
+class TEST_CLASS(JSONDocument) : public UnitTest {
+public:
+
+  TEST_PRIORITY(50);
+  TEST_PROJECT("base/objectmodel");
+
+  void run() override
+  {
+    const String text = "\xef\xbb\xbf{\"a\": [1, {\"x\": [[], {}]}, \"s\"], \"b\": {\"c/d\": true, \"e~f\": null},\n"
+      "\"esc\\u0041ped\": 1.5, \"dup\": 1, \"dup\": 2, \"last\": \"value\"}";
+    JSONDocument document(text);
+    TEST_EQUAL(document.getValue("/a/0").cast<ObjectModel::Integer>()->value, 1);
+    TEST_EQUAL(document.getValue("/a/2").cast<ObjectModel::String>()->value, "s");
+    TEST_EQUAL(document.getValue("/b/c~1d").cast<ObjectModel::Boolean>()->value, true);
+    TEST_EQUAL(document.getValue("/b/e~0f")->getType(), ObjectModel::Value::TYPE_VOID);
+    TEST_EQUAL(document.getValue("/escAped").cast<ObjectModel::Float>()->value, 1.5);
+    TEST_EQUAL(document.getValue("/dup").cast<ObjectModel::Integer>()->value, 2);
+    TEST_EQUAL(document.getValue("/last").cast<ObjectModel::String>()->value, "value");
+    TEST_EQUAL(JSON::getJSONNoFormatting(document.getValue("/a/1")), JSON::getJSONNoFormatting(JSON::parse("{\"x\": [[], {}]}")));
+    TEST_ASSERT(document.getValue("").cast<ObjectModel::Object>());
+
+    TEST_EQUAL(document.getSize(""), 6);
+    TEST_EQUAL(document.getSize("/a"), 3);
+    TEST_EQUAL(document.getSize("/a/1/x"), 2);
+    TEST_EQUAL(document.getSize("/a/1/x/0"), 0);
+    TEST_EQUAL(document.getSize("/b"), 2);
+
+    TEST_ASSERT(document.hasValue("/a/1/x/1"));
+    TEST_ASSERT(!document.hasValue("/a/3"));
+    TEST_ASSERT(!document.hasValue("/a/1/y"));
+    TEST_ASSERT(!document.hasValue("/last/x"));
+    TEST_ASSERT(!document.getValue("/missing", true));
+    TEST_EXCEPTION(document.getValue("/missing"), ObjectModelException);
+    TEST_EXCEPTION(document.getValue("/a/01"), ObjectModelException);
+    TEST_EXCEPTION(document.getValue("a"), ObjectModelException);
+
+    TEST_EXCEPTION(JSONDocument(String("{\"a\": [1, 2}")), JSONException);
+    TEST_EXCEPTION(JSONDocument(String("[1] 2")), JSONException);
+    TEST_EXCEPTION(JSONDocument(String("")), JSONException);
+    JSONDocument malformed(String("{\"a\": 1, \"c\": [1,,2]}")); // values are validated on request
+    TEST_EQUAL(malformed.getValue("/c/0").cast<ObjectModel::Integer>()->value, 1);
+    TEST_EXCEPTION(malformed.getValue("/c/1"), JSONException);
+    JSONDocument missingColon(String("{\"a\": 1, \"b\" 2}"));
+    TEST_EXCEPTION(missingColon.getValue("/a"), JSONException);
+  }
+};
+
+TEST_REGISTER(JSONDocument);
+
+class TEST_CLASS(JSONDocumentBenchmark) : public UnitTest {
+public:
+
+  TEST_PRIORITY(1000);
+  TEST_PROJECT("base/objectmodel");
+  TEST_IMPACT(LOW);
+
+  void run() override
+  {
+    StringOutputStreamWrapper sos;
+    {
+      JSONWriter writer(&sos);
+      writer.beginObject().key("items").beginArray();
+      for (unsigned int i = 0; i < 50000; ++i) {
+        writer.beginObject();
+        writer.key("id").value(static_cast<int64>(i));
+        writer.key("name").value(format() << "user " << i);
+        writer.key("tags").beginArray().value("alpha").value("beta").endArray();
+        writer.key("text").value("The quick brown fox jumps over the lazy dog.");
+        writer.endObject();
+      }
+      writer.endArray().key("version").value(3).endObject();
+      writer.flush();
+    }
+    const String text = sos.getString();
+
+    Timer timer;
+    auto tree = JSON::parse(text);
+    const uint64 parseTime = timer.getLiveMicroseconds();
+    TEST_ASSERT(tree);
+
+    timer.start();
+    JSONDocument document(text);
+    const uint64 indexTime = timer.getLiveMicroseconds();
+    timer.start();
+    auto name = document.getValue("/items/40000/name").cast<ObjectModel::String>();
+    auto version = document.getValue("/version").cast<ObjectModel::Integer>();
+    const uint64 lookupTime = timer.getLiveMicroseconds();
+    TEST_ASSERT(name && (name->value == "user 40000"));
+    TEST_ASSERT(version && (version->value == 3));
+
+    TEST_PRINT(format() << "Size: " << text.getLength() << " bytes, parse: " << parseTime
+               << " us, index: " << indexTime << " us, lookup: " << lookupTime << " us");
+  }
+};
+
+TEST_REGISTER(JSONDocumentBenchmark);
+
+#endif
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
@@ -0,0 +1,150 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#pragma once
+
+#include <base/objectmodel/JSON.h>
+#include <base/io/MappedFile.h>
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+/**
+  Lazy JSON document. Only the structural index of the text is built up
+  front. Values are created on request for a JSON pointer
+  (https://tools.ietf.org/html/rfc6901) by skipping the unrelated arrays and
+  objects without visiting their content. Use this to read a few values from
+  large files.
+
+  The structure of the entire text is validated on construction but values
+  are only validated once requested. Like for ObjectModel the last member
+  wins for duplicate keys. The text must remain unchanged for the lifetime of
+  the document.
+
+  @code
+  JSONDocument document(File("large.json", File::READ, 0));
+  String name = document.getValue("/items/1000/name").cast<ObjectModel::String>()->value;
+  @endcode
+
+  @short Lazy JSON document.
+  @version 1.0
+*/
+
+class _COM_AZURE_DEV__BASE__API JSONDocument {
+private:
+
+  /** Owns the mapping of the file. */
+  class Mapping : public ReferenceCountedObject {
+  public:
+
+    MappedFile file;
+
+    Mapping(const File& _file, const FileRegion& region);
+  };
+
+  /** The mapped file if any. */
+  Reference<Mapping> mapping;
+  /** The owned text if any. */
+  String text;
+  /** The first byte of the text. */
+  const uint8* begin = nullptr;
+  /** The end of the text. */
+  const uint8* end = nullptr;
+  /** The structural index of the text. */
+  JSONStructuralIndex index;
+  /** The token of the matching end for each begin of array and object. */
+  Array<uint32> matches;
+  /** Creates the requested values. */
+  JSON json;
+
+  /** Builds the index. */
+  void initialize(const uint8* src, const uint8* end);
+
+  /** Returns the line and column of the given byte. */
+  LineColumn getPosition(const uint8* at) const noexcept;
+
+  /** Returns the first byte of the given token. */
+  inline uint8 getToken(MemorySize token) const noexcept
+  {
+    return begin[index.getPosition(token)];
+  }
+
+  /** Returns the token following the value at the given token. */
+  inline MemorySize skip(MemorySize token) const noexcept
+  {
+    const uint8 ch = getToken(token);
+    return ((ch == '{') || (ch == '[')) ? (matches[token] + 1) : (token + 1);
+  }
+
+  /** Raises JSONException unless the given token begins a value within the container. */
+  void checkValue(MemorySize token, MemorySize close) const;
+
+  /** Returns true if the key at the given token equals the given name. */
+  bool isKey(MemorySize token, const String& name);
+
+  /** Returns the token of the member with the given key. Returns -1 if not found. */
+  MemoryDiff findMember(MemorySize object, const String& name);
+
+  /** Returns the token of the element at the given index. Returns -1 if not found. */
+  MemoryDiff findElement(MemorySize array, MemorySize elementIndex) const;
+
+  /** Returns the token for the given JSON pointer. Returns -1 if not found and forceNull is set. */
+  MemoryDiff find(const char* path, bool forceNull);
+public:
+
+  /**
+    Initializes document for the given text. The text is not copied and must
+    outlive the document. Raises JSONException if the structure is malformed.
+  */
+  JSONDocument(const uint8* src, const uint8* end);
+
+  /** Initializes document for the given text. */
+  JSONDocument(const String& text);
+
+  /** Initializes document by mapping the entire file into memory. */
+  JSONDocument(const File& file);
+
+  JSONDocument(const JSONDocument&) = delete;
+  JSONDocument& operator=(const JSONDocument&) = delete;
+
+  /** Returns the number of structural tokens. */
+  inline MemorySize getNumberOfTokens() const noexcept
+  {
+    return index.getSize();
+  }
+
+  /** Returns true if the given JSON pointer exists. */
+  inline bool hasValue(const char* path)
+  {
+    return find(path, true) >= 0;
+  }
+
+  /**
+    Returns the value at the given JSON pointer. The value is created on each
+    call. Use "" for the entire document.
+
+    @param path The JSON pointer of the desired value.
+    @param forceNull Avoid exception if value doesn't exist. Returns nullptr otherwise.
+  */
+  Reference<ObjectModel::Value> getValue(const char* path, bool forceNull = false);
+
+  /** Returns the value at the given JSON pointer. */
+  inline Reference<ObjectModel::Value> getValue(const String& path, bool forceNull = false)
+  {
+    return getValue(path.native(), forceNull);
+  }
+
+  /** Returns the number of elements or members of the array or object at the given JSON pointer without creating it. */
+  MemorySize getSize(const char* path);
+};
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
@@ -0,0 +1,643 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#include <base/objectmodel/JSONReader.h>
+#include <base/objectmodel/JSONWriter.h>
+#include <base/io/MemoryInputStream.h>
+#include <base/string/StringOutputStream.h>
+#include <base/string/Unicode.h>
+#include <base/Timer.h>
+#include <base/UnitTest.h>
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+namespace {
+
+  /** Returns the UTF-16 word of \\u escape. Returns -1 if malformed. */
+  inline int32 getUTF16Word(const char* src, const char* end) noexcept
+  {
+    if ((end - src) < 4) {
+      return -1;
+    }
+    int32 result = 0;
+    for (unsigned int i = 0; i < 4; ++i) {
+      if (!ASCIITraits::isHexDigit(src[i])) {
+        return -1;
+      }
+      result = (result << 4) | ASCIITraits::digitToValue(src[i]);
+    }
+    return result;
+  }
+}
+
+JSONReader::JSONReader(InputStream* _is, unsigned int bufferSize)
+  : is(_is), buffer(maximum<unsigned int>(bufferSize, 64)), containers(64), token(256)
+{
+  src = buffer.begin();
+  end = src;
+  token[0] = 0;
+}
+
+bool JSONReader::fill()
+{
+  if (eof) {
+    return false;
+  }
+  offset += end - buffer.begin();
+  src = buffer.begin();
+  end = src;
+  const unsigned int available = is->available();
+  if (available > 0) {
+    end += is->read(buffer.begin(), minimum<MemorySize>(buffer.size(), available), false);
+  }
+  if (src == end) {
+    eof = true;
+    return false;
+  }
+  return true;
+}
+
+LineColumn JSONReader::getPosition() const noexcept
+{
+  return LineColumn(line + 1, static_cast<MemorySize>(getOffset() - lineStart) + 1);
+}
+
+void JSONReader::push(const uint8* src, MemorySize size)
+{
+  if ((tokenLength + size + 1) > token.size()) { // room for terminator
+    token.resize(maximum<MemorySize>(token.size() * 2, tokenLength + size + 1));
+  }
+  copy<char>(token.begin() + tokenLength, reinterpret_cast<const char*>(src), size);
+  tokenLength += size;
+}
+
+void JSONReader::skipSpaces()
+{
+  while (true) {
+    if ((src == end) && !fill()) {
+      return;
+    }
+    switch (*src) {
+    case '\n':
+      ++line;
+      lineStart = getOffset() + 1;
+      // fall through
+    case ' ':
+    case '\r':
+    case '\t':
+      ++src;
+      continue;
+    }
+    return;
+  }
+}
+
+void JSONReader::read(char ch)
+{
+  if (peek() != static_cast<uint8>(ch)) {
+    _throw JSONException("Unexpected character.", getPosition());
+  }
+  ++src;
+}
+
+void JSONReader::readString()
+{
+  ++src; // opening quote
+  tokenLength = 0;
+  bool escaped = false;
+  while (true) {
+    if ((src == end) && !fill()) {
+      _throw JSONException("Unterminated string.", getPosition());
+    }
+    const uint8* p = src;
+    while ((p != end) && (*p != '"') && (*p != '\\') && (*p >= 0x20)) {
+      ++p;
+    }
+    push(src, p - src);
+    src = p;
+    if (src == end) {
+      continue;
+    }
+    if (*src == '"') {
+      ++src;
+      break;
+    }
+    if (*src != '\\') {
+      _throw JSONException("Unexpected control character in string literal.", getPosition());
+    }
+    escaped = true;
+    push(src++, 1);
+    peek();
+    push(src++, 1); // escaped character is never the closing quote
+  }
+
+  if (escaped) { // decode in place - escapes are longer than the UTF-8 they decode to
+    char* dest = token.begin();
+    const char* s = dest;
+    const char* e = dest + tokenLength;
+    while (s != e) {
+      if (*s != '\\') {
+        *dest++ = *s++;
+        continue;
+      }
+      ++s;
+      switch (*s++) {
+      case '"':
+        *dest++ = '"';
+        break;
+      case '\\':
+        *dest++ = '\\';
+        break;
+      case '/':
+        *dest++ = '/';
+        break;
+      case 'b':
+        *dest++ = '\b';
+        break;
+      case 'f':
+        *dest++ = '\f';
+        break;
+      case 'n':
+        *dest++ = '\n';
+        break;
+      case 'r':
+        *dest++ = '\r';
+        break;
+      case 't':
+        *dest++ = '\t';
+        break;
+      case 'u':
+        {
+          const int32 word = getUTF16Word(s, e);
+          if (word < 0) {
+            _throw JSONException("Malformed UTF-16 word for string literal.", getPosition());
+          }
+          s += 4;
+          ucs4 ch = word;
+          if ((word >= 0xd800) && (word <= 0xdfff)) { // surrogate words
+            if (word >= 0xdc00) {
+              _throw JSONException("Unexpected UTF-16 low surrogate.", getPosition());
+            }
+            if (((e - s) < 2) || (s[0] != '\\') || (s[1] != 'u')) {
+              _throw JSONException("Missing UTF-16 low surrogate.", getPosition());
+            }
+            const int32 low = getUTF16Word(s + 2, e);
+            if (!((low >= 0xdc00) && (low <= 0xdfff))) {
+              _throw JSONException("Expected UTF-16 low surrogate.", getPosition());
+            }
+            s += 6;
+            ch = 0x10000 + ((static_cast<ucs4>(word - 0xd800) << 10) | static_cast<ucs4>(low - 0xdc00));
+          }
+          dest += Unicode::writeUTF8(reinterpret_cast<uint8*>(dest), ch);
+        }
+        break;
+      default:
+        _throw JSONException("Malformed string literal.", getPosition());
+      }
+    }
+    tokenLength = dest - token.begin();
+  }
+  token[tokenLength] = 0;
+}
+
+void JSONReader::readLiteral(const char* literal, MemorySize length)
+{
+  for (MemorySize i = 0; i < length; ++i) {
+    if (peek() != static_cast<uint8>(literal[i])) {
+      _throw JSONException("Malformed literal.", getPosition());
+    }
+    ++src;
+  }
+}
+
+JSONReader::Event JSONReader::readNumber()
+{
+  const LineColumn position = getPosition();
+  tokenLength = 0;
+  while (true) {
+    if ((src == end) && !fill()) {
+      break;
+    }
+    const uint8* p = src;
+    while ((p != end) && (((*p >= '0') && (*p <= '9')) || (*p == '-') || (*p == '+') || (*p == '.') || (*p == 'e') || (*p == 'E'))) {
+      ++p;
+    }
+    push(src, p - src);
+    src = p;
+    if (src != end) {
+      break;
+    }
+  }
+  token[tokenLength] = 0;
+
+  const char* p = token.begin();
+  const char* e = p + tokenLength;
+  const bool negative = (*p == '-');
+  if (negative) {
+    ++p;
+  }
+  const char* digits = p;
+  if ((p != e) && (*p == '0')) {
+    ++p;
+  } else {
+    while ((p != e) && (*p >= '0') && (*p <= '9')) {
+      ++p;
+    }
+  }
+  if (p == digits) {
+    _throw JSONException("Malformed number.", position);
+  }
+
+  if (p == e) { // integer
+    uint64 value = 0;
+    bool overflow = (p - digits) > 19;
+    for (const char* q = digits; !overflow && (q != p); ++q) {
+      const uint64 next = value * 10 + (*q - '0');
+      overflow = (value > (PrimitiveTraits<uint64>::MAXIMUM/10)) || (next < value);
+      value = next;
+    }
+    const uint64 limit = static_cast<uint64>(PrimitiveTraits<int64>::MAXIMUM) + (negative ? 1 : 0);
+    if (!overflow && (value <= limit)) {
+      integer = negative ? static_cast<int64>(0 - value) : static_cast<int64>(value);
+      return EVENT_INTEGER;
+    }
+  }
+
+  if ((p != e) && (*p == '.')) { // fraction - digits are optional like for JSON::parse() (e.g. 123.)
+    ++p;
+    while ((p != e) && (*p >= '0') && (*p <= '9')) {
+      ++p;
+    }
+  }
+  if ((p != e) && ((*p == 'e') || (*p == 'E'))) { // exponent
+    ++p;
+    if ((p != e) && ((*p == '-') || (*p == '+'))) {
+      ++p;
+    }
+    const char* exponent = p;
+    while ((p != e) && (*p >= '0') && (*p <= '9')) {
+      ++p;
+    }
+    if (p == exponent) {
+      _throw JSONException("Malformed float.", position);
+    }
+  }
+  if (p != e) {
+    _throw JSONException("Malformed number.", position);
+  }
+
+  double d = 0;
+  if (!posix.getSeries(digits, e, d)) {
+    _throw JSONException("Malformed float.", position);
+  }
+  floatingPoint = negative ? -d : d;
+  return EVENT_FLOAT;
+}
+
+JSONReader::Event JSONReader::readValue()
+{
+  state = STATE_NEXT;
+  switch (peek()) {
+  case '{':
+  case '[':
+    {
+      const uint8 ch = *src++;
+      if (depth == containers.size()) {
+        containers.resize(depth * 2);
+      }
+      containers[depth++] = ch;
+      state = STATE_FIRST;
+      return (ch == '{') ? EVENT_BEGIN_OBJECT : EVENT_BEGIN_ARRAY;
+    }
+  case '"':
+    readString();
+    return EVENT_STRING;
+  case 't':
+    readLiteral("true", 4);
+    boolean = true;
+    return EVENT_BOOLEAN;
+  case 'f':
+    readLiteral("false", 5);
+    boolean = false;
+    return EVENT_BOOLEAN;
+  case 'n':
+    readLiteral("null", 4);
+    return EVENT_NULL;
+  case '-':
+  case '0':
+  case '1':
+  case '2':
+  case '3':
+  case '4':
+  case '5':
+  case '6':
+  case '7':
+  case '8':
+  case '9':
+    return readNumber();
+  default:
+    _throw JSONException("Expected value.", getPosition());
+  }
+}
+
+JSONReader::Event JSONReader::readKey()
+{
+  if (peek() != '"') {
+    _throw JSONException("Expected member name.", getPosition());
+  }
+  readString();
+  skipSpaces();
+  read(':');
+  state = STATE_VALUE;
+  return EVENT_KEY;
+}
+
+JSONReader::Event JSONReader::close(uint8 ch)
+{
+  ++src;
+  --depth;
+  state = STATE_NEXT;
+  return (ch == '}') ? EVENT_END_OBJECT : EVENT_END_ARRAY;
+}
+
+JSONReader::Event JSONReader::next()
+{
+  if (event == EVENT_END_DOCUMENT) {
+    return event;
+  }
+  skipSpaces();
+  if (depth == 0) { // top-level values
+    if (!hasMore()) {
+      return event = EVENT_END_DOCUMENT;
+    }
+    return event = readValue();
+  }
+
+  const bool object = containers[depth - 1] == '{';
+  const uint8 closing = object ? '}' : ']';
+  switch (state) {
+  case STATE_VALUE:
+    return event = readValue();
+  case STATE_FIRST:
+    if (peek() == closing) {
+      return event = close(closing);
+    }
+    return event = (object ? readKey() : readValue());
+  case STATE_NEXT:
+  default:
+    {
+      const uint8 ch = peek();
+      if (ch == ',') {
+        ++src;
+        skipSpaces();
+        return event = (object ? readKey() : readValue());
+      } else if (ch == closing) {
+        return event = close(closing);
+      }
+      _throw JSONException(object ? "Malformed object." : "Malformed array.", getPosition());
+    }
+  }
+}
+
+bool JSONReader::isText(const char* text) const noexcept
+{
+  const MemorySize length = getNullTerminatedLength(text);
+  return (length == tokenLength) && (compare(token.cbegin(), text, length) == 0);
+}
+
+void JSONReader::skipValue()
+{
+  switch (event) {
+  case EVENT_KEY:
+    next();
+    skipValue();
+    break;
+  case EVENT_BEGIN_OBJECT:
+  case EVENT_BEGIN_ARRAY:
+    {
+      const MemorySize level = depth;
+      while (depth >= level) {
+        next();
+      }
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+Reference<ObjectModel::Value> JSONReader::getValue(ObjectModel& objectModel)
+{
+  switch (event) {
+  case EVENT_NULL:
+    return objectModel.createVoid();
+  case EVENT_BOOLEAN:
+    return objectModel.createBoolean(boolean);
+  case EVENT_INTEGER:
+    return objectModel.createInteger(integer);
+  case EVENT_FLOAT:
+    return objectModel.createFloat(floatingPoint);
+  case EVENT_STRING:
+    return objectModel.createString(getString());
+  case EVENT_BEGIN_ARRAY:
+    {
+      Reference<ObjectModel::Array> result = objectModel.createArray();
+      MemorySize count = 0;
+      while (next() != EVENT_END_ARRAY) {
+        if (count == result->values.getSize()) { // Array::append() copies all elements on each call
+          result->values.setSize(maximum<MemorySize>(count * 2, 16));
+        }
+        result->values[count++] = getValue(objectModel);
+      }
+      result->values.setSize(count);
+      return result;
+    }
+  case EVENT_BEGIN_OBJECT:
+    {
+      Reference<ObjectModel::Object> result = objectModel.createObject();
+      MemorySize count = 0;
+      while (next() != EVENT_END_OBJECT) {
+        if (count == result->values.getSize()) {
+          result->values.setSize(maximum<MemorySize>(count * 2, 16));
+        }
+        ObjectModel::Object::Association& member = result->values.getElements()[count++];
+        member.setFirst(objectModel.createString(getString()));
+        next();
+        member.setSecond(getValue(objectModel));
+      }
+      result->values.setSize(count);
+      result->rebuildIndex(); // merges duplicate keys
+      return result;
+    }
+  default:
+    _throw JSONException("Expected value.", getPosition());
+  }
+}
+
+#if defined(_COM_AZURE_DEV__BASE__TESTS)
+
+class TEST_CLASS(JSONReader) : public UnitTest {
+public:
+
+  TEST_PRIORITY(50);
+  TEST_PROJECT("base/objectmodel");
+
+  static bool ensureFailure(const char* text)
+  {
+    try {
+      const String data(text);
+      MemoryInputStream mis(data);
+      JSONReader reader(&mis, 64);
+      while (reader.next() != JSONReader::EVENT_END_DOCUMENT) {
+      }
+    } catch (JSONException&) {
+      return true;
+    }
+    return false;
+  }
+
+  void run() override
+  {
+    const String text = "{\"a\": [1, -2, 3.5, true, false, null], \"b\\n\": \"x\\u00e6\\ud83d\\ude00\", \"c\": {}, \"d\": []}";
+    MemoryInputStream mis(text);
+    JSONReader reader(&mis, 64); // small buffer to cross boundaries
+    TEST_ASSERT(reader.next() == JSONReader::EVENT_BEGIN_OBJECT);
+    TEST_ASSERT((reader.next() == JSONReader::EVENT_KEY) && reader.isText("a"));
+    TEST_ASSERT(reader.next() == JSONReader::EVENT_BEGIN_ARRAY);
+    TEST_EQUAL(reader.getDepth(), 2U);
+    TEST_ASSERT((reader.next() == JSONReader::EVENT_INTEGER) && (reader.getInteger() == 1));
+    TEST_ASSERT((reader.next() == JSONReader::EVENT_INTEGER) && (reader.getInteger() == -2));
+    TEST_ASSERT((reader.next() == JSONReader::EVENT_FLOAT) && (reader.getFloat() == 3.5));
+    TEST_ASSERT((reader.next() == JSONReader::EVENT_BOOLEAN) && reader.getBoolean());
+    TEST_ASSERT((reader.next() == JSONReader::EVENT_BOOLEAN) && !reader.getBoolean());
+    TEST_ASSERT(reader.next() == JSONReader::EVENT_NULL);
+    TEST_ASSERT(reader.next() == JSONReader::EVENT_END_ARRAY);
+    TEST_ASSERT((reader.next() == JSONReader::EVENT_KEY) && (reader.getString() == "b\n"));
+    TEST_ASSERT((reader.next() == JSONReader::EVENT_STRING) && (reader.getString() == "x\xc3\xa6\xf0\x9f\x98\x80"));
+    TEST_ASSERT(reader.next() == JSONReader::EVENT_KEY);
+    TEST_ASSERT(reader.next() == JSONReader::EVENT_BEGIN_OBJECT);
+    TEST_ASSERT(reader.next() == JSONReader::EVENT_END_OBJECT);
+    TEST_ASSERT(reader.next() == JSONReader::EVENT_KEY);
+    TEST_ASSERT(reader.next() == JSONReader::EVENT_BEGIN_ARRAY);
+    TEST_ASSERT(reader.next() == JSONReader::EVENT_END_ARRAY);
+    TEST_ASSERT(reader.next() == JSONReader::EVENT_END_OBJECT);
+    TEST_EQUAL(reader.getDepth(), 0U);
+    TEST_ASSERT(reader.next() == JSONReader::EVENT_END_DOCUMENT);
+    TEST_ASSERT(reader.next() == JSONReader::EVENT_END_DOCUMENT);
+
+    // newline-delimited with values crossing buffer boundaries
+    StringOutputStream stream;
+    for (unsigned int i = 0; i < 100; ++i) {
+      stream << "{\"id\": " << i << ", \"skip\": {\"x\": [1, [2, {\"y\": \"long text which spans buffers\"}]]}, \"name\": \"user " << i << "\"}\n";
+    }
+    const String lines = stream.toString();
+    MemoryInputStream mis2(lines);
+    JSONReader reader2(&mis2, 64);
+    ObjectModel o;
+    unsigned int count = 0;
+    while (reader2.next() != JSONReader::EVENT_END_DOCUMENT) {
+      TEST_ASSERT(reader2.getEvent() == JSONReader::EVENT_BEGIN_OBJECT);
+      TEST_ASSERT((reader2.next() == JSONReader::EVENT_KEY) && (reader2.next() == JSONReader::EVENT_INTEGER));
+      TEST_EQUAL(reader2.getInteger(), count);
+      TEST_ASSERT((reader2.next() == JSONReader::EVENT_KEY) && reader2.isText("skip"));
+      reader2.skipValue();
+      TEST_ASSERT((reader2.next() == JSONReader::EVENT_KEY) && reader2.isText("name"));
+      reader2.next();
+      TEST_ASSERT(reader2.getValue(o)->toStringNoFormatting() == (format() << "\"user " << count << "\""));
+      TEST_ASSERT(reader2.next() == JSONReader::EVENT_END_OBJECT);
+      ++count;
+    }
+    TEST_EQUAL(count, 100U);
+
+    // materialized value matches JSON::parse()
+    const String document = "{\"a\": [1, 2.5, \"s\", [], {}], \"b\": {\"c\": null, \"d\": true}, \"e\": -9223372036854775808, \"f\": 18446744073709551616}";
+    MemoryInputStream mis3(document);
+    JSONReader reader3(&mis3);
+    reader3.next();
+    TEST_EQUAL(JSON::getJSONNoFormatting(reader3.getValue(o)), JSON::getJSONNoFormatting(JSON::parse(document)));
+    TEST_ASSERT(reader3.next() == JSONReader::EVENT_END_DOCUMENT);
+
+    TEST_ASSERT(ensureFailure("["));
+    TEST_ASSERT(ensureFailure("[1,]"));
+    TEST_ASSERT(ensureFailure("[1 2]"));
+    TEST_ASSERT(ensureFailure("{\"a\" 1}"));
+    TEST_ASSERT(ensureFailure("{1: 2}"));
+    TEST_ASSERT(ensureFailure("{\"a\": 1]"));
+    TEST_ASSERT(ensureFailure("\"abc"));
+    TEST_ASSERT(ensureFailure("\"a\tb\""));
+    TEST_ASSERT(ensureFailure("\"\\x\""));
+    TEST_ASSERT(ensureFailure("\"\\ud800\""));
+    TEST_ASSERT(ensureFailure("01"));
+    TEST_ASSERT(ensureFailure("1e"));
+    TEST_ASSERT(ensureFailure("tru"));
+    TEST_ASSERT(ensureFailure("1,2"));
+    TEST_ASSERT(!ensureFailure(" 1 2 \"x\" [] "));
+  }
+};
+
+TEST_REGISTER(JSONReader);
+
+class TEST_CLASS(JSONReaderBenchmark) : public UnitTest {
+public:
+
+  TEST_PRIORITY(1000);
+  TEST_PROJECT("base/objectmodel");
+  TEST_IMPACT(LOW);
+
+  void run() override
+  {
+    StringOutputStreamWrapper sos;
+    {
+      JSONWriter writer(&sos);
+      writer.beginArray();
+      for (unsigned int i = 0; i < 10000; ++i) {
+        writer.beginObject();
+        writer.key("id").value(static_cast<int64>(i));
+        writer.key("name").value(format() << "user " << i);
+        writer.key("score").value(i * 0.25);
+        writer.key("active").value((i % 3) != 0);
+        writer.key("tags").beginArray().value("alpha").value("beta").null().endArray();
+        writer.key("text").value("The quick brown fox jumps over the lazy dog. \"Quoted\" text.");
+        writer.endObject();
+      }
+      writer.endArray();
+      writer.flush();
+    }
+    const String text = sos.getString();
+
+    Timer timer;
+    MemoryInputStream mis(text);
+    JSONReader reader(&mis);
+    MemorySize events = 0;
+    while (reader.next() != JSONReader::EVENT_END_DOCUMENT) {
+      ++events;
+    }
+    const uint64 readTime = timer.getLiveMicroseconds();
+
+    timer.start();
+    auto tree = JSON::parse(text);
+    const uint64 parseTime = timer.getLiveMicroseconds();
+    TEST_ASSERT(tree);
+
+    const double megabytes = text.getLength()/(1024.0 * 1024);
+    TEST_PRINT(format() << "Size: " << text.getLength() << " bytes, events: " << events
+               << ", reader: " << megabytes * 1000000/maximum<uint64>(readTime, 1)
+               << " MB/s, parse: " << megabytes * 1000000/maximum<uint64>(parseTime, 1) << " MB/s");
+  }
+};
+
+TEST_REGISTER(JSONReaderBenchmark);
+
+#endif
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
@@ -0,0 +1,232 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#pragma once
+
+#include <base/objectmodel/JSON.h>
+#include <base/io/InputStream.h>
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+/**
+  Pull reader for JSON text from an input stream. next() returns one event at
+  a time instead of building an ObjectModel tree. Only a fixed read buffer and
+  the current token are kept in memory, so the input may be of any size.
+  Multiple top-level values separated by whitespace are read in sequence
+  which allows for newline-delimited JSON.
+
+  @code
+  JSONReader reader(&fis);
+  while (reader.next() != JSONReader::EVENT_END_DOCUMENT) {
+    if (reader.getEvent() == JSONReader::EVENT_KEY) {
+      ...
+    }
+  }
+  @endcode
+
+  @short JSON pull reader.
+  @version 1.0
+*/
+
+class _COM_AZURE_DEV__BASE__API JSONReader {
+public:
+
+  /** Event. */
+  enum Event {
+    EVENT_NONE, /**< No event has been read. */
+    EVENT_BEGIN_OBJECT,
+    EVENT_END_OBJECT,
+    EVENT_BEGIN_ARRAY,
+    EVENT_END_ARRAY,
+    EVENT_KEY, /**< Member name. Use getString(). */
+    EVENT_NULL,
+    EVENT_BOOLEAN, /**< Use getBoolean(). */
+    EVENT_INTEGER, /**< Use getInteger(). */
+    EVENT_FLOAT, /**< Use getFloat(). Integers which do not fit int64 are read as floats. */
+    EVENT_STRING, /**< Use getString(). */
+    EVENT_END_DOCUMENT /**< End of input. */
+  };
+
+  /** The default size of the read buffer. */
+  static constexpr unsigned int DEFAULT_BUFFER_SIZE = 16 * 1024;
+private:
+
+  /** The state within the current container. */
+  enum State {
+    STATE_VALUE, /**< Expects value. */
+    STATE_FIRST, /**< Expects first member/element or end of container. */
+    STATE_NEXT /**< Expects separator or end of container. */
+  };
+
+  /** The input stream. */
+  InputStream* is = nullptr;
+  /** The read buffer. */
+  PrimitiveArray<uint8> buffer;
+  /** The next byte to read. */
+  const uint8* src = nullptr;
+  /** The end of the read bytes. */
+  const uint8* end = nullptr;
+  /** True if the input stream has been exhausted. */
+  bool eof = false;
+  /** The number of bytes before the read buffer. */
+  uint64 offset = 0;
+  /** The current line. */
+  MemorySize line = 0;
+  /** The offset of the start of the current line. */
+  uint64 lineStart = 0;
+
+  /** The open containers ('{' or '['). */
+  PrimitiveArray<uint8> containers;
+  /** The number of open containers. */
+  MemorySize depth = 0;
+  State state = STATE_VALUE;
+  Event event = EVENT_NONE;
+
+  /** The text of the current string or number token. */
+  PrimitiveArray<char> token;
+  /** The length of the current token. */
+  MemorySize tokenLength = 0;
+  bool boolean = false;
+  int64 integer = 0;
+  double floatingPoint = 0;
+  /** Float parser. */
+  Posix posix;
+
+  /** Returns the offset of the next byte. */
+  inline uint64 getOffset() const noexcept
+  {
+    return offset + (src - buffer.cbegin());
+  }
+
+  /** Reads more bytes. Returns false at end of input. */
+  bool fill();
+
+  /** Returns true if more bytes are available. */
+  inline bool hasMore()
+  {
+    return (src != end) || fill();
+  }
+
+  /** Returns the next byte. Raises JSONException at end of input. */
+  inline uint8 peek()
+  {
+    if ((src == end) && !fill()) {
+      _throw JSONException("Unexpected end of JSON.", getPosition());
+    }
+    return *src;
+  }
+
+  /** Appends to the current token. */
+  void push(const uint8* src, MemorySize size);
+
+  /** Skips whitespace. */
+  void skipSpaces();
+
+  /** Reads the given character. */
+  void read(char ch);
+
+  /** Reads string into the current token. */
+  void readString();
+
+  /** Reads literal. */
+  void readLiteral(const char* literal, MemorySize length);
+
+  /** Reads number. */
+  Event readNumber();
+
+  /** Reads value. */
+  Event readValue();
+
+  /** Reads member name. */
+  Event readKey();
+
+  /** Closes the current container. */
+  Event close(uint8 ch);
+public:
+
+  /**
+    Initializes reader.
+
+    @param is The input stream.
+    @param bufferSize The size of the read buffer.
+  */
+  JSONReader(InputStream* is, unsigned int bufferSize = DEFAULT_BUFFER_SIZE);
+
+  /** Returns the line and column of the next byte. */
+  LineColumn getPosition() const noexcept;
+
+  /** Reads the next event. Raises JSONException for malformed JSON. */
+  Event next();
+
+  /** Returns the current event. */
+  inline Event getEvent() const noexcept
+  {
+    return event;
+  }
+
+  /** Returns the number of open objects and arrays. */
+  inline MemorySize getDepth() const noexcept
+  {
+    return depth;
+  }
+
+  /** Returns the boolean for EVENT_BOOLEAN. */
+  inline bool getBoolean() const noexcept
+  {
+    return boolean;
+  }
+
+  /** Returns the integer for EVENT_INTEGER. */
+  inline int64 getInteger() const noexcept
+  {
+    return integer;
+  }
+
+  /** Returns the number for EVENT_FLOAT and EVENT_INTEGER. */
+  inline double getFloat() const noexcept
+  {
+    return (event == EVENT_INTEGER) ? static_cast<double>(integer) : floatingPoint;
+  }
+
+  /** Returns the UTF-8 text for EVENT_KEY and EVENT_STRING. Valid until next(). */
+  inline const char* getText() const noexcept
+  {
+    return token.cbegin();
+  }
+
+  /** Returns the length of the text in bytes. */
+  inline MemorySize getTextLength() const noexcept
+  {
+    return tokenLength;
+  }
+
+  /** Returns the text for EVENT_KEY and EVENT_STRING. */
+  inline String getString() const
+  {
+    return String(token.cbegin(), tokenLength);
+  }
+
+  /** Returns true if the text equals the given string. */
+  bool isText(const char* text) const noexcept;
+
+  /** Skips the current value including all members/elements of a container. */
+  void skipValue();
+
+  /**
+    Returns the current value as an ObjectModel value. For EVENT_BEGIN_OBJECT
+    and EVENT_BEGIN_ARRAY the container is read until the matching end event.
+  */
+  Reference<ObjectModel::Value> getValue(ObjectModel& objectModel);
+};
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
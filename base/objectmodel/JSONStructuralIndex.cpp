@@ -0,0 +1,206 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#include <base/objectmodel/JSONStructuralIndex.h>
+#include <base/objectmodel/JSON.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#  define _COM_AZURE_DEV__BASE__JSON_SSE2
+#  include <emmintrin.h>
+#endif
+
+#if (_COM_AZURE_DEV__BASE__COMPILER == _COM_AZURE_DEV__BASE__COMPILER_MSC)
+#  include <intrin.h>
+#endif
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+namespace {
+
+  /** Bit masks for a block of 64 bytes. Bit i is for byte i. */
+  class BlockMasks {
+  public:
+
+    uint64 backslash = 0;
+    uint64 quote = 0;
+    uint64 structural = 0;
+    uint64 whitespace = 0;
+  };
+
+#if defined(_COM_AZURE_DEV__BASE__JSON_SSE2)
+  inline uint64 getMask(__m128i value, char ch) noexcept
+  {
+    return static_cast<uint32>(_mm_movemask_epi8(_mm_cmpeq_epi8(value, _mm_set1_epi8(ch))));
+  }
+#endif
+
+  /** Classifies 64 bytes. */
+  inline void classify(const uint8* src, BlockMasks& masks) noexcept
+  {
+#if defined(_COM_AZURE_DEV__BASE__JSON_SSE2)
+    for (unsigned int i = 0; i < 4; ++i) {
+      const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 16));
+      const __m128i folded = _mm_or_si128(value, _mm_set1_epi8(0x20)); // maps [ to { and ] to }
+      const unsigned int shift = i * 16;
+      masks.backslash |= getMask(value, '\\') << shift;
+      masks.quote |= getMask(value, '"') << shift;
+      masks.structural |= (getMask(folded, '{') | getMask(folded, '}') | getMask(value, ':') | getMask(value, ',')) << shift;
+      masks.whitespace |= (getMask(value, ' ') | getMask(value, '\n') | getMask(value, '\r') | getMask(value, '\t')) << shift;
+    }
+#else
+    for (unsigned int i = 0; i < 64; ++i) {
+      const uint64 bit = static_cast<uint64>(1) << i;
+      switch (src[i]) {
+      case '\\':
+        masks.backslash |= bit;
+        break;
+      case '"':
+        masks.quote |= bit;
+        break;
+      case '{':
+      case '}':
+      case '[':
+      case ']':
+      case ':':
+      case ',':
+        masks.structural |= bit;
+        break;
+      case ' ':
+      case '\n':
+      case '\r':
+      case '\t':
+        masks.whitespace |= bit;
+        break;
+      }
+    }
+#endif
+  }
+
+  /** Returns the XOR of all the lower bits including the bit itself for each bit. */
+  inline uint64 getPrefixXor(uint64 value) noexcept
+  {
+    value ^= value << 1;
+    value ^= value << 2;
+    value ^= value << 4;
+    value ^= value << 8;
+    value ^= value << 16;
+    value ^= value << 32;
+    return value;
+  }
+
+  /** Returns the index of the lowest set bit. Value must not be 0. */
+  inline unsigned int getLowestBit(uint64 value) noexcept
+  {
+#if (_COM_AZURE_DEV__BASE__COMPILER == _COM_AZURE_DEV__BASE__COMPILER_GCC) || \
+    (_COM_AZURE_DEV__BASE__COMPILER == _COM_AZURE_DEV__BASE__COMPILER_LLVM)
+    return __builtin_ctzll(value);
+#elif (_COM_AZURE_DEV__BASE__COMPILER == _COM_AZURE_DEV__BASE__COMPILER_MSC) && defined(_M_X64)
+    unsigned long result = 0;
+    _BitScanForward64(&result, value);
+    return result;
+#else
+    unsigned int result = 0;
+    while (!(value & 1)) {
+      value >>= 1;
+      ++result;
+    }
+    return result;
+#endif
+  }
+
+  /**
+    Returns the mask of escaped bytes. A byte is escaped if preceded by an odd
+    number of backslashes. The state carries a trailing escape into the next
+    block.
+  */
+  inline uint64 getEscaped(uint64 backslash, uint64& previousEscaped) noexcept
+  {
+    if (!backslash) {
+      const uint64 escaped = previousEscaped;
+      previousEscaped = 0;
+      return escaped;
+    }
+    const uint64 EVEN_BITS = 0x5555555555555555ULL;
+    backslash &= ~previousEscaped; // an escaped backslash does not escape
+    const uint64 followsEscape = (backslash << 1) | previousEscaped;
+    const uint64 oddSequenceStarts = backslash & ~EVEN_BITS & ~followsEscape;
+    const uint64 sequencesStartingOnEvenBits = oddSequenceStarts + backslash;
+    previousEscaped = (sequencesStartingOnEvenBits < oddSequenceStarts) ? 1 : 0; // overflow
+    const uint64 invertMask = sequencesStartingOnEvenBits << 1;
+    return (EVEN_BITS ^ invertMask) & followsEscape;
+  }
+}
+
+JSONStructuralIndex::JSONStructuralIndex()
+{
+}
+
+void JSONStructuralIndex::build(const uint8* src, const uint8* end)
+{
+  const MemorySize length = end - src;
+  if (length > MAXIMUM_SIZE) {
+    _throw JSONException("Text is too big for structural index.");
+  }
+
+  size = 0;
+  MemorySize capacity = positions.getSize();
+  uint32* dest = positions.getElements();
+
+  uint64 previousEscaped = 0; // escape carried into next block
+  uint64 previousInString = 0; // all ones if the previous block ended within a string
+  uint64 previousScalar = 0; // 1 if the previous block ended with a scalar byte
+
+  uint8 tail[64];
+  for (MemorySize offset = 0; offset < length; offset += 64) {
+    const uint8* block = src + offset;
+    if ((length - offset) < 64) { // pad with spaces
+      fill<uint8>(tail, getArraySize(tail), ' ');
+      copy<uint8>(tail, block, length - offset);
+      block = tail;
+    }
+
+    BlockMasks masks;
+    classify(block, masks);
+
+    const uint64 escaped = getEscaped(masks.backslash, previousEscaped);
+    const uint64 quote = masks.quote & ~escaped;
+    // set for the opening quote and the content but not the closing quote
+    const uint64 inString = getPrefixXor(quote) ^ previousInString;
+    previousInString = static_cast<uint64>(static_cast<int64>(inString) >> 63);
+
+    const uint64 scalar = ~(masks.structural | masks.whitespace | quote) & ~inString;
+    const uint64 scalarStart = scalar & ~((scalar << 1) | previousScalar);
+    previousScalar = scalar >> 63;
+
+    uint64 bits = (masks.structural & ~inString) | (quote & inString) | scalarStart;
+    if ((length - offset) < 64) {
+      bits &= (static_cast<uint64>(1) << (length - offset)) - 1; // ignore padding
+    }
+
+    if ((size + 64) > capacity) {
+      capacity = maximum<MemorySize>(capacity * 2, 1024);
+      positions.setSize(capacity);
+      dest = positions.getElements();
+    }
+    while (bits) {
+      dest[size++] = static_cast<uint32>(offset + getLowestBit(bits));
+      bits &= bits - 1; // clear lowest bit
+    }
+  }
+
+  if (previousInString) {
+    _throw JSONException("Unterminated string.");
+  }
+}
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
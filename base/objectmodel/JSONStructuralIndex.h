@@ -0,0 +1,74 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#pragma once
+
+#include <base/collection/Array.h>
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+/**
+  Structural index of JSON text. Holds the offsets of the structural
+  characters ({}[]:,), the opening quotes of strings and the first byte of the
+  other scalars (numbers, true, false, and null) in document order.
+
+  The text is classified 64 bytes at a time into bit masks (using SSE2 when
+  available). Escaped quotes and the string regions are resolved with bit
+  arithmetic, so the bytes within strings are never visited individually.
+  This is the first stage of JSON::parse().
+
+  @short JSON structural index.
+  @version 1.0
+*/
+
+class _COM_AZURE_DEV__BASE__API JSONStructuralIndex {
+private:
+
+  /** The offsets. */
+  Array<uint32> positions;
+  /** The number of offsets. */
+  MemorySize size = 0;
+public:
+
+  /** The maximum number of bytes which can be indexed. */
+  static constexpr MemorySize MAXIMUM_SIZE = 0xffffffff;
+
+  /** Initializes empty index. */
+  JSONStructuralIndex();
+
+  /**
+    Builds the index for the given text. The storage is reused across builds.
+    Raises JSONException if a string is not terminated.
+  */
+  void build(const uint8* src, const uint8* end);
+
+  /** Returns the number of offsets. */
+  inline MemorySize getSize() const noexcept
+  {
+    return size;
+  }
+
+  /** Returns the offsets. */
+  inline const uint32* getPositions() const noexcept
+  {
+    return positions.getFirstReference();
+  }
+
+  /** Returns the given offset. */
+  inline uint32 getPosition(MemorySize index) const noexcept
+  {
+    return positions.getFirstReference()[index];
+  }
+};
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
@@ -0,0 +1,315 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#include <base/objectmodel/JSONWriter.h>
+#include <base/objectmodel/JSONReader.h>
+#include <base/io/MemoryInputStream.h>
+#include <base/string/StringOutputStream.h>
+#include <base/math/Math.h>
+#include <base/UnitTest.h>
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+JSONWriter::JSONWriter(OutputStream* os, unsigned int _indent)
+  : stream(*os), containers(64), indent(_indent)
+{
+  stream.setFlags(stream.getFlags() | FormatOutputStream::Symbols::POSIX); // for floats
+}
+
+void JSONWriter::writeIndent(MemorySize level)
+{
+  stream << '\n';
+  for (MemorySize i = level * indent; i > 0; --i) {
+    stream << ' ';
+  }
+}
+
+void JSONWriter::beginValue()
+{
+  if (depth == 0) {
+    if (hasElements) { // next top-level value
+      stream << '\n';
+    }
+  } else if (containers[depth - 1] == '{') {
+    if (!hasKey) {
+      _throw JSONException("Expected key for object member.");
+    }
+    hasKey = false;
+  } else {
+    if (hasElements) {
+      stream << ',';
+    }
+    if (indent) {
+      writeIndent(depth);
+    }
+  }
+  hasElements = true;
+}
+
+void JSONWriter::writeString(const char* src, MemorySize length)
+{
+  static const char DIGITS[] = "0123456789abcdef";
+  stream << '"';
+  const char* end = src + length;
+  while (src != end) {
+    const char* p = src;
+    while ((p != end) && (static_cast<uint8>(*p) >= 0x20) && (*p != '"') && (*p != '\\')) {
+      ++p;
+    }
+    if (p != src) {
+      stream.write(reinterpret_cast<const uint8*>(src), static_cast<unsigned int>(p - src), false);
+      src = p;
+    }
+    if (src == end) {
+      break;
+    }
+    const char ch = *src++;
+    stream << '\\';
+    switch (ch) {
+    case '"':
+      stream << '"';
+      break;
+    case '\\':
+      stream << '\\';
+      break;
+    case '\b':
+      stream << 'b';
+      break;
+    case '\f':
+      stream << 'f';
+      break;
+    case '\n':
+      stream << 'n';
+      break;
+    case '\r':
+      stream << 'r';
+      break;
+    case '\t':
+      stream << 't';
+      break;
+    default:
+      stream << 'u' << '0' << '0' << DIGITS[(ch >> 4) & 0xf] << DIGITS[ch & 0xf];
+    }
+  }
+  stream << '"';
+}
+
+void JSONWriter::begin(uint8 ch)
+{
+  beginValue();
+  if (depth == containers.size()) {
+    containers.resize(depth * 2);
+  }
+  containers[depth++] = ch;
+  hasElements = false;
+  stream << static_cast<char>(ch);
+}
+
+void JSONWriter::end(uint8 ch)
+{
+  const uint8 open = (ch == '}') ? '{' : '[';
+  if ((depth == 0) || (containers[depth - 1] != open) || hasKey) {
+    _throw JSONException("Unbalanced JSON container.");
+  }
+  --depth;
+  if (indent && hasElements) {
+    writeIndent(depth);
+  }
+  hasElements = true;
+  stream << static_cast<char>(ch);
+}
+
+JSONWriter& JSONWriter::key(const char* name, MemorySize length)
+{
+  if ((depth == 0) || (containers[depth - 1] != '{') || hasKey) {
+    _throw JSONException("Unexpected key.");
+  }
+  if (hasElements) {
+    stream << ',';
+  }
+  if (indent) {
+    writeIndent(depth);
+  }
+  writeString(name, length);
+  stream << ':';
+  if (indent) {
+    stream << ' ';
+  }
+  hasElements = true;
+  hasKey = true;
+  return *this;
+}
+
+JSONWriter& JSONWriter::null()
+{
+  beginValue();
+  stream << MESSAGE("null");
+  return *this;
+}
+
+JSONWriter& JSONWriter::value(bool value)
+{
+  beginValue();
+  if (value) {
+    stream << MESSAGE("true");
+  } else {
+    stream << MESSAGE("false");
+  }
+  return *this;
+}
+
+JSONWriter& JSONWriter::value(int32 value)
+{
+  beginValue();
+  stream << value;
+  return *this;
+}
+
+JSONWriter& JSONWriter::value(int64 value)
+{
+  beginValue();
+  stream << value;
+  return *this;
+}
+
+JSONWriter& JSONWriter::value(double value)
+{
+  if (!Math::isFinite(value)) { // JSON has no inf or nan
+    return null();
+  }
+  beginValue();
+  // keep floats distinguishable from integers - ENSUREFLOAT would write 123. which is not strict JSON
+  if ((value == Math::floor(value)) && (Math::abs(value) < 9007199254740992.0)) { // 2**53
+    if ((value == 0) && ((1/value) < 0)) { // -0
+      stream << '-';
+    }
+    stream << static_cast<int64>(value) << '.' << '0';
+  } else {
+    stream << value;
+  }
+  return *this;
+}
+
+JSONWriter& JSONWriter::value(const char* value, MemorySize length)
+{
+  beginValue();
+  writeString(value, length);
+  return *this;
+}
+
+JSONWriter& JSONWriter::value(const Reference<ObjectModel::Value>& value)
+{
+  if (!value) {
+    return null();
+  }
+  switch (value->getType()) {
+  case ObjectModel::Value::TYPE_VOID:
+    return null();
+  case ObjectModel::Value::TYPE_BOOLEAN:
+    return this->value(value.cast<ObjectModel::Boolean>()->value);
+  case ObjectModel::Value::TYPE_INTEGER:
+    return this->value(value.cast<ObjectModel::Integer>()->value);
+  case ObjectModel::Value::TYPE_FLOAT:
+    return this->value(value.cast<ObjectModel::Float>()->value);
+  case ObjectModel::Value::TYPE_STRING:
+    if (auto s = value.cast<ObjectModel::String>()) {
+      return this->value(s->value);
+    }
+    return *this; // comment
+  case ObjectModel::Value::TYPE_ARRAY:
+    beginArray();
+    for (const auto& v : value.cast<ObjectModel::Array>()->values) {
+      this->value(v);
+    }
+    return endArray();
+  case ObjectModel::Value::TYPE_OBJECT:
+    beginObject();
+    for (const auto& member : value.cast<ObjectModel::Object>()->values) {
+      key(member.getFirst()->value);
+      this->value(member.getSecond());
+    }
+    return endObject();
+  default:
+    _throw JSONException("Unsupported value.");
+  }
+}
+
+void JSONWriter::flush()
+{
+  stream << FLUSH;
+}
+
+#if defined(_COM_AZURE_DEV__BASE__TESTS)
+
+class TEST_CLASS(JSONWriter) : public UnitTest {
+public:
+
+  TEST_PRIORITY(50);
+  TEST_PROJECT("base/objectmodel");
+
+  void run() override
+  {
+    StringOutputStreamWrapper sos;
+    {
+      JSONWriter writer(&sos);
+      writer.beginObject();
+      writer.key("a").beginArray().value(1).value(static_cast<int64>(-2)).value(3.5).value(2.0).value(true).null().endArray();
+      writer.key("b\n").value("x\"\\\t\x01\xc3\xa6");
+      writer.key("c").beginObject().endObject();
+      writer.key("d").beginArray().endArray();
+      writer.key("e").value(Math::getNaN<double>());
+      writer.endObject();
+      writer.flush();
+    }
+    TEST_EQUAL(sos.getString(), "{\"a\":[1,-2,3.5,2.0,true,null],\"b\\n\":\"x\\\"\\\\\\t\\u0001\xc3\xa6\",\"c\":{},\"d\":[],\"e\":null}");
+
+    // round trip through reader
+    const String text = sos.getString();
+    MemoryInputStream mis(text);
+    JSONReader reader(&mis);
+    ObjectModel o;
+    reader.next();
+    auto value = reader.getValue(o);
+    StringOutputStreamWrapper copy;
+    {
+      JSONWriter writer(&copy);
+      writer.value(value);
+      writer.flush();
+    }
+    TEST_EQUAL(copy.getString(), text);
+
+    StringOutputStreamWrapper sos2;
+    {
+      JSONWriter writer(&sos2, 2);
+      writer.beginObject().key("a").beginArray().value(1).value(2).endArray().key("b").value(value).endObject();
+      writer.value("next"); // newline-delimited
+      writer.flush();
+    }
+    TEST_EQUAL(sos2.getString(), "{\n  \"a\": [\n    1,\n    2\n  ],\n  \"b\": {\n    \"a\": [\n      1,\n      -2,\n      3.5,\n      2.0,\n      true,\n      null\n    ],\n    \"b\\n\": \"x\\\"\\\\\\t\\u0001\xc3\xa6\",\n    \"c\": {},\n    \"d\": [],\n    \"e\": null\n  }\n}\n\"next\"");
+
+    StringOutputStreamWrapper sos3;
+    JSONWriter writer(&sos3);
+    writer.beginObject();
+    TEST_EXCEPTION(writer.value(1), JSONException);
+    TEST_EXCEPTION(writer.endArray(), JSONException);
+    writer.key("a");
+    TEST_EXCEPTION(writer.key("b"), JSONException);
+    TEST_EXCEPTION(writer.endObject(), JSONException);
+  }
+};
+
+TEST_REGISTER(JSONWriter);
+
+#endif
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
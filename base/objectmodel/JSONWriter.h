@@ -0,0 +1,166 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#pragma once
+
+#include <base/objectmodel/JSON.h>
+#include <base/io/OutputStream.h>
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+/**
+  Incremental JSON writer to an output stream. Separators are inserted
+  automatically and the output is buffered, so no tree or string is built for
+  the document. Raises JSONException if the calls do not form valid JSON (e.g.
+  a value without key within an object). Non-finite floats are written as null.
+
+  @code
+  JSONWriter writer(&fos);
+  writer.beginObject();
+  writer.key("id").value(123);
+  writer.key("tags").beginArray().value("a").value("b").endArray();
+  writer.endObject();
+  writer.flush();
+  @endcode
+
+  @short JSON writer.
+  @version 1.0
+*/
+
+class _COM_AZURE_DEV__BASE__API JSONWriter {
+private:
+
+  /** The buffered output. */
+  FormatOutputStream stream;
+  /** The open containers ('{' or '['). */
+  PrimitiveArray<uint8> containers;
+  /** The number of open containers. */
+  MemorySize depth = 0;
+  /** True if the current container has members/elements. */
+  bool hasElements = false;
+  /** True if a key has been written for the next value. */
+  bool hasKey = false;
+  /** The number of spaces per level. 0 for compact output. */
+  unsigned int indent = 0;
+
+  /** Writes separator and indentation before a value. */
+  void beginValue();
+
+  /** Writes newline and indentation. */
+  void writeIndent(MemorySize level);
+
+  /** Writes quoted string. */
+  void writeString(const char* src, MemorySize length);
+
+  /** Writes begin of container. */
+  void begin(uint8 ch);
+
+  /** Writes end of container. */
+  void end(uint8 ch);
+public:
+
+  /**
+    Initializes writer.
+
+    @param os The output stream.
+    @param indent The number of spaces per level. 0 for compact output.
+  */
+  JSONWriter(OutputStream* os, unsigned int indent = 0);
+
+  /** Returns the number of open objects and arrays. */
+  inline MemorySize getDepth() const noexcept
+  {
+    return depth;
+  }
+
+  /** Begins object. */
+  inline JSONWriter& beginObject()
+  {
+    begin('{');
+    return *this;
+  }
+
+  /** Ends object. */
+  inline JSONWriter& endObject()
+  {
+    end('}');
+    return *this;
+  }
+
+  /** Begins array. */
+  inline JSONWriter& beginArray()
+  {
+    begin('[');
+    return *this;
+  }
+
+  /** Ends array. */
+  inline JSONWriter& endArray()
+  {
+    end(']');
+    return *this;
+  }
+
+  /** Writes member name. */
+  JSONWriter& key(const char* name, MemorySize length);
+
+  /** Writes member name. */
+  inline JSONWriter& key(const char* name)
+  {
+    return key(name, getNullTerminatedLength(name));
+  }
+
+  /** Writes member name. */
+  inline JSONWriter& key(const String& name)
+  {
+    return key(name.native(), name.getLength());
+  }
+
+  /** Writes null. */
+  JSONWriter& null();
+
+  /** Writes boolean. */
+  JSONWriter& value(bool value);
+
+  /** Writes integer. */
+  JSONWriter& value(int32 value);
+
+  /** Writes integer. */
+  JSONWriter& value(int64 value);
+
+  /** Writes float. */
+  JSONWriter& value(double value);
+
+  /** Writes UTF-8 string. */
+  JSONWriter& value(const char* value, MemorySize length);
+
+  /** Writes UTF-8 string. */
+  inline JSONWriter& value(const char* value)
+  {
+    return this->value(value, getNullTerminatedLength(value));
+  }
+
+  /** Writes UTF-8 string. */
+  inline JSONWriter& value(const String& value)
+  {
+    return this->value(value.native(), value.getLength());
+  }
+
+  /** Writes ObjectModel value. */
+  JSONWriter& value(const Reference<ObjectModel::Value>& value);
+
+  /** Writes the buffered output to the output stream. */
+  void flush();
+};
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
@@ -12,9 +12,12 @@
  ***************************************************************************/
 
 #include <base/objectmodel/ObjectModel.h>
+#include <base/objectmodel/JSON.h>
 #include <base/LongInteger.h>
 #include <base/math/Math.h>
 #include <base/string/ANSIEscapeSequence.h>
+#include <base/string/StringOutputStream.h>
+#include <base/Timer.h>
 #include <base/UnitTest.h>
 
 _COM_AZURE_DEV__BASE__ENTER_NAMESPACE
@@ -115,6 +118,11 @@ Reference<ObjectModel::Comment> ObjectModel::createComment(const base::String& v
   return new Comment(value); // new comment
 }
 
+Reference<ObjectModel::Binary> ObjectModel::createBinary(const base::Array<uint8>& value)
+{
+  return new Binary(value);
+}
+
 Reference<ObjectModel::String> ObjectModel::createString(const char* value)
 {
   if (!value || !*value) {
@@ -368,50 +376,156 @@ MemorySize ObjectModel::Object::getSize() const noexcept
   return values.getSize();
 }
 
-bool ObjectModel::Object::hasKey(const Reference<String>& key) const noexcept
+namespace {
+
+  /** Returns the hash of the given key. */
+  inline MemorySize getKeyHash(const char* src, MemorySize length) noexcept
+  {
+    uint64 result = 5381; // same as Hash<String>
+    for (const char* end = src + length; src != end; ++src) {
+      result = 31 * result + static_cast<uint8>(*src);
+    }
+    return static_cast<MemorySize>((result * 0x9e3779b97f4a7c15ULL) >> 32); // mix into lower bits
+  }
+
+  /** Returns true if the key equals the given string. */
+  inline bool isKey(const Reference<ObjectModel::String>& key, const char* src, MemorySize length) noexcept
+  {
+    return key && (key->value.getLength() == length) && (compare(key->value.native(), src, length) == 0);
+  }
+}
+
+MemoryDiff ObjectModel::Object::find(const char* key, MemorySize length) const noexcept
 {
-  if (!key) {
-    return false;
+  const MemorySize size = values.getSize();
+  const Association* elements = values.getFirstReference();
+  if (slots && (indexed == size)) {
+    const uint32* s = slots.getFirstReference();
+    const MemorySize mask = slots.getSize() - 1;
+    for (MemorySize i = getKeyHash(key, length) & mask; s[i]; i = (i + 1) & mask) {
+      const MemorySize position = s[i] - 1;
+      if (isKey(elements[position].getFirst(), key, length)) {
+        return position;
+      }
+    }
+    return -1;
   }
-  for (const auto& v : values) {
-    if (!INLINE_ASSERT(v.getFirst())) {
+  for (MemorySize i = 0; i < size; ++i) {
+    if (!INLINE_ASSERT(elements[i].getFirst())) {
       continue;
     }
-    if (v.getFirst()->value == key->value) {
-      return true;
+    if (isKey(elements[i].getFirst(), key, length)) {
+      return i;
     }
   }
-  return false;
+  return -1;
 }
 
-bool ObjectModel::Object::hasKey(const base::String& key) const noexcept
+void ObjectModel::Object::rebuildIndex()
 {
-  for (const auto& v : values) {
-    if (!INLINE_ASSERT(v.getFirst())) {
+  MemorySize size = values.getSize();
+  if (size < INDEX_THRESHOLD) {
+    slots = base::Array<uint32>();
+    indexed = 0;
+    for (MemorySize i = 1; i < values.getSize();) { // merge duplicates
+      Association* elements = values.getElements();
+      MemoryDiff first = -1;
+      for (MemorySize j = 0; j < i; ++j) {
+        if (elements[i].getFirst() && isKey(elements[j].getFirst(), elements[i].getFirst()->value.native(), elements[i].getFirst()->value.getLength())) {
+          first = j;
+          break;
+        }
+      }
+      if (first >= 0) {
+        elements[first].setSecond(elements[i].getSecond());
+        values.remove(i);
+      } else {
+        ++i;
+      }
+    }
+    return;
+  }
+
+  MemorySize capacity = 64;
+  while (capacity < (size * 2)) { // keep load below 50%
+    capacity *= 2;
+  }
+  slots.setSize(capacity);
+  fill<uint32>(slots.getElements(), capacity, 0);
+  uint32* s = slots.getElements();
+  const MemorySize mask = capacity - 1;
+  Association* elements = values.getElements();
+  MemorySize count = 0;
+  for (MemorySize i = 0; i < size; ++i) {
+    if (!INLINE_ASSERT(elements[i].getFirst())) { // keep but do not index
+      if (count != i) {
+        elements[count] = moveObject(elements[i]);
+      }
+      ++count;
+      continue;
+    }
+    const base::String& key = elements[i].getFirst()->value;
+    MemorySize slot = getKeyHash(key.native(), key.getLength()) & mask;
+    for (; s[slot]; slot = (slot + 1) & mask) {
+      if (isKey(elements[s[slot] - 1].getFirst(), key.native(), key.getLength())) {
+        break;
+      }
+    }
+    if (s[slot]) { // duplicate
+      elements[s[slot] - 1].setSecond(elements[i].getSecond());
       continue;
     }
-    if (v.getFirst()->value == key) {
-      return true;
+    if (count != i) {
+      elements[count] = moveObject(elements[i]);
     }
+    s[slot] = static_cast<uint32>(++count);
+  }
+  if (count != size) {
+    values.setSize(count);
+  }
+  indexed = count;
+}
+
+void ObjectModel::Object::append(const Reference<String>& key, const Reference<Value>& value)
+{
+  values.append(Association(key, value));
+  const MemorySize size = values.getSize();
+  if (size < INDEX_THRESHOLD) {
+    return;
+  }
+  if (!slots || ((indexed + 1) != size) || ((size * 2) > slots.getSize())) {
+    rebuildIndex();
+    return;
   }
-  return false;
+  uint32* s = slots.getElements();
+  const MemorySize mask = slots.getSize() - 1;
+  MemorySize slot = getKeyHash(key->value.native(), key->value.getLength()) & mask;
+  while (s[slot]) {
+    slot = (slot + 1) & mask;
+  }
+  s[slot] = static_cast<uint32>(size);
+  indexed = size;
 }
 
-bool ObjectModel::Object::hasKey(const char* _key) const noexcept
+bool ObjectModel::Object::hasKey(const Reference<String>& key) const noexcept
 {
-  if (!_key) {
+  if (!key) {
     return false;
   }
-  NativeString key(_key);
-  for (const auto& v : values) {
-    if (!INLINE_ASSERT(v.getFirst())) {
-      continue;
-    }
-    if (v.getFirst()->value == key) {
-      return true;
-    }
+  return find(key->value) >= 0;
+}
+
+bool ObjectModel::Object::hasKey(const base::String& key) const noexcept
+{
+  return find(key) >= 0;
+}
+
+bool ObjectModel::Object::hasKey(const char* key) const noexcept
+{
+  if (!key) {
+    return false;
   }
-  return false;
+  return find(key, getNullTerminatedLength(key)) >= 0;
 }
 
 bool ObjectModel::Object::removeKey(const Reference<String>& key) noexcept
@@ -419,42 +533,36 @@ bool ObjectModel::Object::removeKey(const Reference<String>& key) noexcept
   if (!key) {
     return false;
   }
-  for (auto i = values.begin(); i != values.end(); ++i) {
-    auto j = *i;
-    if (j.getFirst()->value == key->value) {
-      values.remove(i);
-      return true;
-    }
-  }
-  return false;
+  return removeKey(key->value);
 }
 
 bool ObjectModel::Object::removeKey(const base::String& key) noexcept
 {
-  for (auto i = values.begin(); i != values.end(); ++i) {
-    auto j = *i;
-    if (j.getFirst()->value == key) {
-      values.remove(i);
-      return true;
-    }
+  const MemoryDiff i = find(key);
+  if (i < 0) {
+    return false;
   }
-  return false;
+  values.remove(i);
+  if (slots) {
+    rebuildIndex(); // positions have moved
+  }
+  return true;
 }
 
-bool ObjectModel::Object::removeKey(const char* _key) noexcept
+bool ObjectModel::Object::removeKey(const char* key) noexcept
 {
-  if (!_key) {
+  if (!key) {
     return false;
   }
-  NativeString key(_key);
-  for (auto i = values.begin(); i != values.end(); ++i) {
-    auto j = *i;
-    if (j.getFirst()->value == key) {
-      values.remove(i);
-      return true;
-    }
+  const MemoryDiff i = find(key, getNullTerminatedLength(key));
+  if (i < 0) {
+    return false;
+  }
+  values.remove(i);
+  if (slots) {
+    rebuildIndex(); // positions have moved
   }
-  return false;
+  return true;
 }
 
 Reference<ObjectModel::Value> ObjectModel::Object::getValue(const Reference<String>& key) const noexcept
@@ -462,45 +570,22 @@ Reference<ObjectModel::Value> ObjectModel::Object::getValue(const Reference<Stri
   if (!key) {
     return nullptr;
   }
-  for (const auto& v : values) {
-    if (!INLINE_ASSERT(v.getFirst())) {
-      continue;
-    }
-    if (v.getFirst()->value == key->value) {
-      return v.getSecond();
-    }
-  }
-  return nullptr;
+  return getValue(key->value);
 }
 
 Reference<ObjectModel::Value> ObjectModel::Object::getValue(const base::String& key) const noexcept
 {
-  for (const auto& v : values) {
-    if (!INLINE_ASSERT(v.getFirst())) {
-      continue;
-    }
-    if (v.getFirst()->value == key) {
-      return v.getSecond();
-    }
-  }
-  return nullptr;
+  const MemoryDiff i = find(key);
+  return (i >= 0) ? values.getFirstReference()[i].getSecond() : Reference<Value>();
 }
 
-Reference<ObjectModel::Value> ObjectModel::Object::getValue(const char* _key) const noexcept
+Reference<ObjectModel::Value> ObjectModel::Object::getValue(const char* key) const noexcept
 {
-  if (!_key) {
+  if (!key) {
     return nullptr;
   }
-  NativeString key(_key);
-  for (const auto& v : values) {
-    if (!INLINE_ASSERT(v.getFirst())) {
-      continue;
-    }
-    if (v.getFirst()->value == key) {
-      return v.getSecond();
-    }
-  }
-  return nullptr;
+  const MemoryDiff i = find(key, getNullTerminatedLength(key));
+  return (i >= 0) ? values.getFirstReference()[i].getSecond() : Reference<Value>();
 }
 
 void ObjectModel::Object::setValue(const Reference<String>& key, const Reference<Value>& value)
@@ -508,16 +593,12 @@ void ObjectModel::Object::setValue(const Reference<String>& key, const Reference
   if (!key) {
     _throw NullPointer("Key is null.");
   }
-  for (auto& v : values) {
-    if (!INLINE_ASSERT(v.getFirst())) {
-      continue;
-    }
-    if (v.getFirst()->value == key->value) {
-      v.setSecond(value);
-      return;
-    }
+  const MemoryDiff i = find(key->value);
+  if (i >= 0) {
+    values.getElements()[i].setSecond(value);
+    return;
   }
-  values.append(Association(key, value));
+  append(key, value);
 }
 
 void ObjectModel::Object::setValue(const Reference<String>& key, const base::String& value)
@@ -525,101 +606,42 @@ void ObjectModel::Object::setValue(const Reference<String>& key, const base::Str
   if (!key) {
     _throw NullPointer("Key is null.");
   }
-  auto _value = globalObjectModel.createString(value);
-  for (auto& v : values) {
-    if (!INLINE_ASSERT(v.getFirst())) {
-      continue;
-    }
-    if (v.getFirst()->value == key->value) {
-      v.setSecond(_value);
-      return;
-    }
-  }
-  values.append(Association(key, _value));
+  setValue(key, Reference<Value>(globalObjectModel.createString(value)));
 }
 
 void ObjectModel::Object::setValue(const base::String& key, const Reference<Value>& value)
 {
-  for (auto& v : values) {
-    if (!INLINE_ASSERT(v.getFirst())) {
-      continue;
-    }
-    if (v.getFirst()->value == key) {
-      v.setSecond(value);
-      return;
-    }
+  const MemoryDiff i = find(key);
+  if (i >= 0) {
+    values.getElements()[i].setSecond(value);
+    return;
   }
-  values.append(Association(globalObjectModel.createString(key), value));
+  append(globalObjectModel.createString(key), value);
 }
 
 void ObjectModel::Object::setValue(const base::String& key, NullPtr)
 {
-  for (auto& v : values) {
-    if (!INLINE_ASSERT(v.getFirst())) {
-      continue;
-    }
-    if (v.getFirst()->value == key) {
-      v.setSecond(nullptr);
-      return;
-    }
-  }
-  values.append(Association(globalObjectModel.createString(key), nullptr));
+  setValue(key, Reference<Value>());
 }
 
 void ObjectModel::Object::setValue(const base::String& key, const bool value)
 {
-  for (auto& v : values) {
-    if (!INLINE_ASSERT(v.getFirst())) {
-      continue;
-    }
-    if (v.getFirst()->value == key) {
-      v.setSecond(globalObjectModel.createBoolean(value));
-      return;
-    }
-  }
-  values.append(Association(globalObjectModel.createString(key), globalObjectModel.createBoolean(value)));
+  setValue(key, Reference<Value>(globalObjectModel.createBoolean(value)));
 }
 
 void ObjectModel::Object::setValue(const base::String& key, const int64 value)
 {
-  for (auto& v : values) {
-    if (!INLINE_ASSERT(v.getFirst())) {
-      continue;
-    }
-    if (v.getFirst()->value == key) {
-      v.setSecond(globalObjectModel.createInteger(value));
-      return;
-    }
-  }
-  values.append(Association(globalObjectModel.createString(key), globalObjectModel.createInteger(value)));
+  setValue(key, Reference<Value>(globalObjectModel.createInteger(value)));
 }
 
 void ObjectModel::Object::setValue(const base::String& key, const double value)
 {
-  for (auto& v : values) {
-    if (!INLINE_ASSERT(v.getFirst())) {
-      continue;
-    }
-    if (v.getFirst()->value == key) {
-      v.setSecond(globalObjectModel.createFloat(value));
-      return;
-    }
-  }
-  values.append(Association(globalObjectModel.createString(key), globalObjectModel.createFloat(value)));
+  setValue(key, Reference<Value>(globalObjectModel.createFloat(value)));
 }
 
 void ObjectModel::Object::setValue(const base::String& key, const base::String& value)
 {
-  for (auto& v : values) {
-    if (!INLINE_ASSERT(v.getFirst())) {
-      continue;
-    }
-    if (v.getFirst()->value == key) {
-      v.setSecond(globalObjectModel.createString(value));
-      return;
-    }
-  }
-  values.append(Association(globalObjectModel.createString(key), globalObjectModel.createString(value)));
+  setValue(key, Reference<Value>(globalObjectModel.createString(value)));
 }
 
 void ObjectModel::Object::setValue(const char* key, const char* value)
@@ -1776,6 +1798,132 @@ public:
 
 TEST_REGISTER(ObjectModel);
 
+class TEST_CLASS(ObjectModelIndex) : public UnitTest {
+public:
+
+  TEST_PRIORITY(200);
+  TEST_PROJECT("base/objectmodel");
+
+  void run() override
+  {
+    ObjectModel o;
+    auto object = o.createObject();
+    for (unsigned int i = 0; i < 1000; ++i) {
+      object->setValue(base::String(format() << "key" << i), static_cast<int64>(i));
+    }
+    object->setValue("key7", "seven"); // replace keeps position
+    TEST_EQUAL(object->getSize(), 1000U);
+    TEST_EQUAL(object->values[7].getFirst()->value, "key7");
+    TEST_EQUAL(object->getString("/key7", ""), "seven");
+    TEST_EQUAL(object->getInteger("/key999", -1), 999);
+    TEST_ASSERT(object->hasKey("key500") && !object->hasKey("key1000") && !object->hasKey("key"));
+
+    TEST_ASSERT(object->removeKey("key500"));
+    TEST_ASSERT(!object->removeKey("key500"));
+    TEST_EQUAL(object->getSize(), 999U);
+    TEST_EQUAL(object->values[500].getFirst()->value, "key501");
+    TEST_EQUAL(object->getInteger("/key501", -1), 501);
+
+    // direct modification
+    object->values.append(ObjectModel::Object::Association(o.createString("key1"), o.createInteger(-1)));
+    object->values.append(ObjectModel::Object::Association(o.createString("extra"), o.createInteger(1)));
+    object->rebuildIndex();
+    TEST_EQUAL(object->getSize(), 1000U);
+    TEST_EQUAL(object->getInteger("/key1", 0), -1);
+    TEST_EQUAL(object->getInteger("/extra", 0), 1);
+
+    // small object
+    auto small = o.createObject();
+    small->values.append(ObjectModel::Object::Association(o.createString("a"), o.createInteger(1)));
+    small->values.append(ObjectModel::Object::Association(o.createString("b"), o.createInteger(2)));
+    small->values.append(ObjectModel::Object::Association(o.createString("a"), o.createInteger(3)));
+    small->rebuildIndex();
+    TEST_EQUAL(small->getSize(), 2U);
+    TEST_EQUAL(small->getInteger("/a", 0), 3);
+
+    // duplicate keys are merged when parsing
+    StringOutputStream stream;
+    stream << '{';
+    for (unsigned int i = 0; i < 100; ++i) {
+      stream << "\"k" << (i % 50) << "\": " << i << ',';
+    }
+    stream << "\"last\": true}";
+    auto parsed = JSON::parse(stream.toString()).cast<ObjectModel::Object>();
+    TEST_ASSERT(parsed);
+    TEST_EQUAL(parsed->getSize(), 51U);
+    TEST_EQUAL(parsed->values[0].getFirst()->value, "k0");
+    TEST_EQUAL(parsed->getInteger("/k0", -1), 50);
+    TEST_EQUAL(parsed->getInteger("/k49", -1), 99);
+  }
+};
+
+TEST_REGISTER(ObjectModelIndex);
+
+class TEST_CLASS(ObjectModelBenchmark) : public UnitTest {
+public:
+
+  TEST_PRIORITY(1000);
+  TEST_PROJECT("base/objectmodel");
+  TEST_IMPACT(LOW);
+
+  void run() override
+  {
+    const unsigned int COUNT = 10000;
+    ObjectModel o;
+    Array<base::String> keys;
+    keys.setSize(COUNT);
+    StringOutputStream stream;
+    stream << '{';
+    for (unsigned int i = 0; i < COUNT; ++i) {
+      keys[i] = base::String(format() << "property_" << i);
+      if (i > 0) {
+        stream << ',';
+      }
+      stream << '"' << keys[i] << "\": " << i;
+    }
+    stream << '}';
+    const base::String text = stream.toString();
+
+    Timer timer;
+    auto object = o.createObject();
+    for (unsigned int i = 0; i < COUNT; ++i) {
+      object->setValue(keys[i], static_cast<int64>(i));
+    }
+    const uint64 buildTime = timer.getLiveMicroseconds();
+
+    timer.start();
+    int64 sum = 0;
+    for (unsigned int i = 0; i < COUNT; ++i) {
+      sum += object->getValue(keys[(i * 7919) % COUNT]).cast<ObjectModel::Integer>()->value;
+    }
+    const uint64 indexedTime = timer.getLiveMicroseconds();
+
+    timer.start();
+    int64 linearSum = 0;
+    for (unsigned int i = 0; i < COUNT; ++i) { // linear scan as without index
+      const base::String& key = keys[(i * 7919) % COUNT];
+      for (const auto& member : object->values) {
+        if (member.getFirst()->value == key) {
+          linearSum += member.getSecond().cast<ObjectModel::Integer>()->value;
+          break;
+        }
+      }
+    }
+    const uint64 linearTime = timer.getLiveMicroseconds();
+    TEST_EQUAL(sum, linearSum);
+
+    timer.start();
+    auto parsed = JSON::parse(text).cast<ObjectModel::Object>();
+    const uint64 parseTime = timer.getLiveMicroseconds();
+    TEST_EQUAL(parsed->getSize(), COUNT);
+
+    TEST_PRINT(format() << "Keys: " << COUNT << ", setValue: " << buildTime << " us, lookups indexed: " << indexedTime
+               << " us, lookups linear: " << linearTime << " us, JSON::parse: " << parseTime << " us");
+  }
+};
+
+TEST_REGISTER(ObjectModelBenchmark);
+
 #endif
 
 _COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
@@ -489,8 +489,31 @@ public:
   public:
     
     typedef Pair<Reference<String>, Reference<Value> > Association;
+    /** The members in insertion order. Call rebuildIndex() after modifying directly. */
     base::Array<Association> values;
 
+    /** The number of members from which the keys are hash indexed. */
+    static constexpr MemorySize INDEX_THRESHOLD = 16;
+  private:
+
+    /** Open addressing hash index of the keys. A slot holds the member position + 1. */
+    base::Array<uint32> slots;
+    /** The number of members in the index. */
+    MemorySize indexed = 0;
+
+    /** Returns the position of the given key. Returns -1 if not found. */
+    MemoryDiff find(const char* key, MemorySize length) const noexcept;
+
+    /** Returns the position of the given key. Returns -1 if not found. */
+    inline MemoryDiff find(const base::String& key) const noexcept
+    {
+      return find(key.native(), key.getLength());
+    }
+
+    /** Appends member and updates index. */
+    void append(const Reference<String>& key, const Reference<Value>& value);
+  public:
+
     /** Returns the type. */
     virtual inline Type getType() const noexcept override
     {
@@ -521,6 +544,13 @@ public:
     Reference<Value> getValue(const base::String& key) const noexcept;
     Reference<Value> getValue(const char* key) const noexcept;
 
+    /**
+      Rebuilds the key index. Required after values has been modified directly.
+      Members with the same key are merged like for setValue(), i.e. the
+      position of the first and the value of the last member are kept.
+    */
+    void rebuildIndex();
+
     /** Sets the value for the given key. key must not be nullptr. */
     void setValue(const Reference<String>& key, const Reference<Value>& value);
     void setValue(const Reference<String>& key, const base::String& value);
@@ -763,6 +793,9 @@ public:
   /** Creates a comment. Similar strings may be reused. */
   Reference<Comment> createComment(const base::String& value);
 
+  /** Creates a binary. */
+  Reference<Binary> createBinary(const base::Array<uint8>& value = base::Array<uint8>());
+
   /** Creates a string. Similar strings may be reused. */
   Reference<String> createString(const char* value);
 
@@ -0,0 +1,284 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#pragma once
+
+#include <base/OutOfRange.h>
+#include <base/Functor.h>
+#include <base/Architecture.h>
+
+#if defined(_COM_AZURE_DEV__BASE__X86_INTRINSICS)
+#  include <immintrin.h>
+#endif
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+/**
+  Schedules independent messages onto the lanes of a multi-buffer hash
+  function with 64 byte blocks, 32-bit words, and the padding of SHA-1 and
+  SHA-256 with a big endian bit length. Each lane hashes one
+  message at a time. A lane takes the next message as soon as its message is
+  complete. Once no messages are left and less than half the lanes are busy,
+  the remaining messages are completed one at a time.
+
+  @short Multi-buffer hash lanes.
+  @ingroup security
+  @version 1.0
+*/
+
+template<unsigned int LANES, unsigned int WORDS>
+class MessageLanes {
+public:
+
+  /** The block size in bytes. */
+  static constexpr unsigned int BLOCK_SIZE = 64;
+
+  /** Pushes one block for each lane. The state holds word i of lane j at state[i][j]. */
+  typedef void (*PushLanes)(uint32 (*state)[LANES], const uint8* const* blocks);
+  /** Pushes the given number of blocks for one message. */
+  typedef void (*PushBlocks)(uint32* messageDigest, const uint8* blocks, MemorySize count);
+private:
+
+  /** A lane. */
+  class Lane {
+  public:
+
+    /** The index of the message. */
+    MemorySize message = 0;
+    /** The next block. */
+    const uint8* next = nullptr;
+    /** The number of blocks left before the padding or the end. */
+    MemorySize blocks = 0;
+    /** The padding blocks are being pushed. */
+    bool padding = false;
+    /** A message is being hashed. */
+    bool active = false;
+    /** The last incomplete block and the padding. */
+    uint8 tail[2 * BLOCK_SIZE];
+    /** The number of blocks in tail. */
+    unsigned int tailBlocks = 0;
+  };
+
+  /** Prepares the lane for the given message. */
+  static void start(Lane& lane, MemorySize message, const uint8* buffer, MemorySize size) noexcept
+  {
+    const MemorySize remaining = size % BLOCK_SIZE;
+    copy(lane.tail, buffer + (size - remaining), remaining);
+    lane.tail[remaining] = 0x80;
+    lane.tailBlocks = (remaining + 1 + 8 <= BLOCK_SIZE) ? 1 : 2;
+    const unsigned int end = lane.tailBlocks * BLOCK_SIZE;
+    fill<uint8>(lane.tail + remaining + 1, end - 8 - (remaining + 1), 0);
+    const uint64 bits = static_cast<uint64>(size) * 8;
+    for (unsigned int i = 0; i < 8; ++i) {
+      lane.tail[end - 1 - i] = static_cast<uint8>(bits >> (i * 8));
+    }
+
+    lane.message = message;
+    lane.blocks = size / BLOCK_SIZE;
+    lane.next = buffer;
+    lane.padding = false;
+    lane.active = true;
+    if (!lane.blocks) {
+      lane.next = lane.tail;
+      lane.blocks = lane.tailBlocks;
+      lane.padding = true;
+    }
+  }
+
+  /** Writes the message digest in big endian. */
+  static void store(const uint32* messageDigest, uint8* digest) noexcept
+  {
+    for (unsigned int i = 0; i < WORDS; ++i) {
+      const uint32 word = messageDigest[i];
+      digest[i * 4 + 0] = static_cast<uint8>(word >> 24);
+      digest[i * 4 + 1] = static_cast<uint8>(word >> 16);
+      digest[i * 4 + 2] = static_cast<uint8>(word >> 8);
+      digest[i * 4 + 3] = static_cast<uint8>(word >> 0);
+    }
+  }
+public:
+
+  /**
+    Writes the message digest of each message to digests. Raises OutOfRange
+    if a message exceeds the given maximum size.
+
+    @param initial The initial message digest.
+    @param pushLanes Pushes a block for all lanes.
+    @param pushBlocks Pushes blocks for a single message.
+    @param maximumSize The maximum message size in bytes.
+    @param messages The messages.
+    @param sizes The message sizes in bytes.
+    @param count The number of messages.
+    @param digests Receives WORDS*4 bytes per message.
+  */
+  static void getDigests(
+    const uint32 (&initial)[WORDS],
+    PushLanes pushLanes,
+    PushBlocks pushBlocks,
+    uint64 maximumSize,
+    const uint8* const* messages,
+    const MemorySize* sizes,
+    MemorySize count,
+    uint8* digests)
+  {
+    for (MemorySize i = 0; i < count; ++i) {
+      if (static_cast<uint64>(sizes[i]) > maximumSize) {
+        _throw OutOfRange();
+      }
+    }
+
+    static const uint8 IDLE[BLOCK_SIZE] = {0};
+    Lane lanes[LANES];
+    uint32 state[WORDS][LANES];
+    const uint8* blocks[LANES];
+    MemorySize nextMessage = 0;
+
+    while (true) {
+      unsigned int active = 0;
+      for (unsigned int lane = 0; lane < LANES; ++lane) {
+        if (!lanes[lane].active && (nextMessage < count)) {
+          start(lanes[lane], nextMessage, messages[nextMessage], sizes[nextMessage]);
+          ++nextMessage;
+          for (unsigned int i = 0; i < WORDS; ++i) {
+            state[i][lane] = initial[i];
+          }
+        }
+        if (lanes[lane].active) {
+          ++active;
+        }
+      }
+      if (!active) {
+        break;
+      }
+
+      if ((nextMessage == count) && (active < (LANES / 2))) { // complete the remaining messages one at a time
+        for (unsigned int lane = 0; lane < LANES; ++lane) {
+          Lane& l = lanes[lane];
+          if (!l.active) {
+            continue;
+          }
+          uint32 messageDigest[WORDS];
+          for (unsigned int i = 0; i < WORDS; ++i) {
+            messageDigest[i] = state[i][lane];
+          }
+          pushBlocks(messageDigest, l.next, l.blocks);
+          if (!l.padding) {
+            pushBlocks(messageDigest, l.tail, l.tailBlocks);
+          }
+          store(messageDigest, digests + l.message * WORDS * 4);
+          l.active = false;
+        }
+        break;
+      }
+
+      MemorySize steps = static_cast<MemorySize>(-1);
+      for (unsigned int lane = 0; lane < LANES; ++lane) {
+        if (lanes[lane].active) {
+          steps = minimum(steps, lanes[lane].blocks);
+        }
+      }
+      for (MemorySize step = 0; step < steps; ++step) {
+        for (unsigned int lane = 0; lane < LANES; ++lane) {
+          blocks[lane] = lanes[lane].active ? (lanes[lane].next + step * BLOCK_SIZE) : IDLE;
+        }
+        pushLanes(state, blocks);
+      }
+
+      for (unsigned int lane = 0; lane < LANES; ++lane) {
+        Lane& l = lanes[lane];
+        if (!l.active) {
+          continue;
+        }
+        l.next += steps * BLOCK_SIZE;
+        l.blocks -= steps;
+        if (l.blocks) {
+          continue;
+        }
+        if (!l.padding) {
+          l.next = l.tail;
+          l.blocks = l.tailBlocks;
+          l.padding = true;
+        } else {
+          uint32 messageDigest[WORDS];
+          for (unsigned int i = 0; i < WORDS; ++i) {
+            messageDigest[i] = state[i][lane];
+          }
+          store(messageDigest, digests + l.message * WORDS * 4);
+          l.active = false;
+        }
+      }
+    }
+  }
+
+  /** Hashes the messages one at a time. */
+  static void getDigests(
+    const uint32 (&initial)[WORDS],
+    PushBlocks pushBlocks,
+    uint64 maximumSize,
+    const uint8* const* messages,
+    const MemorySize* sizes,
+    MemorySize count,
+    uint8* digests)
+  {
+    for (MemorySize i = 0; i < count; ++i) {
+      if (static_cast<uint64>(sizes[i]) > maximumSize) {
+        _throw OutOfRange();
+      }
+    }
+    Lane lane;
+    for (MemorySize message = 0; message < count; ++message) {
+      start(lane, message, messages[message], sizes[message]);
+      uint32 messageDigest[WORDS];
+      copy(messageDigest, initial, WORDS);
+      pushBlocks(messageDigest, lane.next, lane.blocks);
+      if (!lane.padding) {
+        pushBlocks(messageDigest, lane.tail, lane.tailBlocks);
+      }
+      store(messageDigest, digests + message * WORDS * 4);
+    }
+  }
+};
+
+#if defined(_COM_AZURE_DEV__BASE__X86_INTRINSICS)
+/** Loads 8 big endian words at the given offset of 8 blocks. Word i of block j goes to lane j of words[i]. */
+_COM_AZURE_DEV__BASE__TARGET("avx2")
+inline void loadMessageWords(const uint8* const* blocks, unsigned int offset, __m256i* words) noexcept
+{
+  const __m256i SWAP = _mm256_setr_epi8(
+    3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+    3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+  );
+  __m256i rows[8];
+  for (unsigned int lane = 0; lane < 8; ++lane) {
+    rows[lane] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(blocks[lane] + offset));
+  }
+  __m256i pairs[8];
+  for (unsigned int i = 0; i < 8; i += 2) {
+    pairs[i] = _mm256_unpacklo_epi32(rows[i], rows[i + 1]);
+    pairs[i + 1] = _mm256_unpackhi_epi32(rows[i], rows[i + 1]);
+  }
+  __m256i quads[8];
+  for (unsigned int i = 0; i < 8; i += 4) {
+    quads[i + 0] = _mm256_unpacklo_epi64(pairs[i], pairs[i + 2]);
+    quads[i + 1] = _mm256_unpackhi_epi64(pairs[i], pairs[i + 2]);
+    quads[i + 2] = _mm256_unpacklo_epi64(pairs[i + 1], pairs[i + 3]);
+    quads[i + 3] = _mm256_unpackhi_epi64(pairs[i + 1], pairs[i + 3]);
+  }
+  for (unsigned int i = 0; i < 4; ++i) {
+    words[i] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(quads[i], quads[i + 4], 0x20), SWAP);
+    words[i + 4] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(quads[i], quads[i + 4], 0x31), SWAP);
+  }
+}
+#endif
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
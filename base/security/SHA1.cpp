@@ -11,24 +11,369 @@
     For the licensing terms refer to the file 'LICENSE'.
  ***************************************************************************/
 
+#include <base/platforms/features.h>
 #include <base/security/SHA1.h>
 #include <base/security/Bytes.h>
+#include <base/security/MessageLanes.h>
+#include <base/Architecture.h>
 #include <base/Functor.h>
+#include <base/Random.h>
+#include <base/Timer.h>
 #include <base/UnitTest.h>
 
+#if defined(_COM_AZURE_DEV__BASE__X86_INTRINSICS)
+#  include <immintrin.h>
+#endif
+
+#if (_COM_AZURE_DEV__BASE__ARCH == _COM_AZURE_DEV__BASE__ARM64) && \
+    (defined(__ARM_FEATURE_SHA2) || defined(__ARM_FEATURE_CRYPTO))
+#  define _COM_AZURE_DEV__BASE__SHA1_ARM
+#  include <arm_neon.h>
+#endif
+
 _COM_AZURE_DEV__BASE__ENTER_NAMESPACE
 
+namespace {
+
+  const uint32 INITIAL[5] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0}; // H0-H4
+
+  /** The round constants. */
+  const uint32 K[4] = {0x5a827999, 0x6ed9eba1, 0x8f1bbcdc, 0xca62c1d6};
+
+#if defined(_COM_AZURE_DEV__BASE__X86_INTRINSICS)
+  /** Pushes blocks using the SHA extensions. */
+  _COM_AZURE_DEV__BASE__TARGET("sha,sse4.1")
+  void pushBlocksSHA(uint32* messageDigest, const uint8* blocks, MemorySize count) noexcept
+  {
+    const __m128i SWAP = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+    __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(messageDigest)), 0x1b);
+    __m128i e0 = _mm_set_epi32(messageDigest[4], 0, 0, 0);
+    __m128i e1;
+    __m128i w0, w1, w2, w3;
+    for (; count > 0; --count) {
+      const __m128i previousABCD = abcd;
+      const __m128i previousE = e0;
+
+      // rounds 0-3
+      w0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + 0)), SWAP);
+      e0 = _mm_add_epi32(e0, w0);
+      e1 = abcd;
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+
+      // rounds 4-7
+      w1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + 16)), SWAP);
+      e1 = _mm_sha1nexte_epu32(e1, w1);
+      e0 = abcd;
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+      w0 = _mm_sha1msg1_epu32(w0, w1);
+
+      // rounds 8-11
+      w2 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + 32)), SWAP);
+      e0 = _mm_sha1nexte_epu32(e0, w2);
+      e1 = abcd;
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+      w1 = _mm_sha1msg1_epu32(w1, w2);
+      w0 = _mm_xor_si128(w0, w2);
+
+      // rounds 12-15
+      w3 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + 48)), SWAP);
+      e1 = _mm_sha1nexte_epu32(e1, w3);
+      e0 = abcd;
+      w0 = _mm_sha1msg2_epu32(w0, w3);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+      w2 = _mm_sha1msg1_epu32(w2, w3);
+      w1 = _mm_xor_si128(w1, w3);
+
+      // rounds 16-19
+      e0 = _mm_sha1nexte_epu32(e0, w0);
+      e1 = abcd;
+      w1 = _mm_sha1msg2_epu32(w1, w0);
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+      w3 = _mm_sha1msg1_epu32(w3, w0);
+      w2 = _mm_xor_si128(w2, w0);
+
+      // rounds 20-23
+      e1 = _mm_sha1nexte_epu32(e1, w1);
+      e0 = abcd;
+      w2 = _mm_sha1msg2_epu32(w2, w1);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+      w0 = _mm_sha1msg1_epu32(w0, w1);
+      w3 = _mm_xor_si128(w3, w1);
+
+      // rounds 24-27
+      e0 = _mm_sha1nexte_epu32(e0, w2);
+      e1 = abcd;
+      w3 = _mm_sha1msg2_epu32(w3, w2);
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 1);
+      w1 = _mm_sha1msg1_epu32(w1, w2);
+      w0 = _mm_xor_si128(w0, w2);
+
+      // rounds 28-31
+      e1 = _mm_sha1nexte_epu32(e1, w3);
+      e0 = abcd;
+      w0 = _mm_sha1msg2_epu32(w0, w3);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+      w2 = _mm_sha1msg1_epu32(w2, w3);
+      w1 = _mm_xor_si128(w1, w3);
+
+      // rounds 32-35
+      e0 = _mm_sha1nexte_epu32(e0, w0);
+      e1 = abcd;
+      w1 = _mm_sha1msg2_epu32(w1, w0);
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 1);
+      w3 = _mm_sha1msg1_epu32(w3, w0);
+      w2 = _mm_xor_si128(w2, w0);
+
+      // rounds 36-39
+      e1 = _mm_sha1nexte_epu32(e1, w1);
+      e0 = abcd;
+      w2 = _mm_sha1msg2_epu32(w2, w1);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+      w0 = _mm_sha1msg1_epu32(w0, w1);
+      w3 = _mm_xor_si128(w3, w1);
+
+      // rounds 40-43
+      e0 = _mm_sha1nexte_epu32(e0, w2);
+      e1 = abcd;
+      w3 = _mm_sha1msg2_epu32(w3, w2);
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+      w1 = _mm_sha1msg1_epu32(w1, w2);
+      w0 = _mm_xor_si128(w0, w2);
+
+      // rounds 44-47
+      e1 = _mm_sha1nexte_epu32(e1, w3);
+      e0 = abcd;
+      w0 = _mm_sha1msg2_epu32(w0, w3);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 2);
+      w2 = _mm_sha1msg1_epu32(w2, w3);
+      w1 = _mm_xor_si128(w1, w3);
+
+      // rounds 48-51
+      e0 = _mm_sha1nexte_epu32(e0, w0);
+      e1 = abcd;
+      w1 = _mm_sha1msg2_epu32(w1, w0);
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+      w3 = _mm_sha1msg1_epu32(w3, w0);
+      w2 = _mm_xor_si128(w2, w0);
+
+      // rounds 52-55
+      e1 = _mm_sha1nexte_epu32(e1, w1);
+      e0 = abcd;
+      w2 = _mm_sha1msg2_epu32(w2, w1);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 2);
+      w0 = _mm_sha1msg1_epu32(w0, w1);
+      w3 = _mm_xor_si128(w3, w1);
+
+      // rounds 56-59
+      e0 = _mm_sha1nexte_epu32(e0, w2);
+      e1 = abcd;
+      w3 = _mm_sha1msg2_epu32(w3, w2);
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+      w1 = _mm_sha1msg1_epu32(w1, w2);
+      w0 = _mm_xor_si128(w0, w2);
+
+      // rounds 60-63
+      e1 = _mm_sha1nexte_epu32(e1, w3);
+      e0 = abcd;
+      w0 = _mm_sha1msg2_epu32(w0, w3);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+      w2 = _mm_sha1msg1_epu32(w2, w3);
+      w1 = _mm_xor_si128(w1, w3);
+
+      // rounds 64-67
+      e0 = _mm_sha1nexte_epu32(e0, w0);
+      e1 = abcd;
+      w1 = _mm_sha1msg2_epu32(w1, w0);
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 3);
+      w3 = _mm_sha1msg1_epu32(w3, w0);
+      w2 = _mm_xor_si128(w2, w0);
+
+      // rounds 68-71
+      e1 = _mm_sha1nexte_epu32(e1, w1);
+      e0 = abcd;
+      w2 = _mm_sha1msg2_epu32(w2, w1);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+      w3 = _mm_xor_si128(w3, w1);
+
+      // rounds 72-75
+      e0 = _mm_sha1nexte_epu32(e0, w2);
+      e1 = abcd;
+      w3 = _mm_sha1msg2_epu32(w3, w2);
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 3);
+
+      // rounds 76-79
+      e1 = _mm_sha1nexte_epu32(e1, w3);
+      e0 = abcd;
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+
+      e0 = _mm_sha1nexte_epu32(e0, previousE);
+      abcd = _mm_add_epi32(abcd, previousABCD);
+      blocks += SHA1::BLOCK_SIZE;
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(messageDigest), _mm_shuffle_epi32(abcd, 0x1b));
+    messageDigest[4] = _mm_extract_epi32(e0, 3);
+  }
+
+  template<unsigned int BITS>
+  _COM_AZURE_DEV__BASE__TARGET("avx2")
+  inline __m256i rotateLeft(__m256i value) noexcept
+  {
+    return _mm256_or_si256(_mm256_slli_epi32(value, BITS), _mm256_srli_epi32(value, 32 - BITS));
+  }
+
+  /** Pushes one block for each of 8 lanes using AVX2. */
+  _COM_AZURE_DEV__BASE__TARGET("avx2")
+  void pushLanesAVX2(uint32 (*state)[8], const uint8* const* blocks) noexcept
+  {
+    __m256i words[16];
+    loadMessageWords(blocks, 0, words);
+    loadMessageWords(blocks, 32, words + 8);
+
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[0]));
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[1]));
+    __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[2]));
+    __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[3]));
+    __m256i e = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[4]));
+
+    for (unsigned int t = 0; t < SHA1::MESSAGE_SCHEDULE; ++t) {
+      __m256i& word = words[t & 15];
+      if (t >= 16) {
+        word = rotateLeft<1>(_mm256_xor_si256(
+          _mm256_xor_si256(words[(t - 3) & 15], words[(t - 8) & 15]),
+          _mm256_xor_si256(words[(t - 14) & 15], word)
+        ));
+      }
+      __m256i f;
+      if (t < 20) {
+        f = _mm256_xor_si256(d, _mm256_and_si256(b, _mm256_xor_si256(c, d)));
+      } else if ((t >= 40) && (t < 60)) {
+        f = _mm256_or_si256(_mm256_and_si256(b, c), _mm256_and_si256(d, _mm256_or_si256(b, c)));
+      } else {
+        f = _mm256_xor_si256(_mm256_xor_si256(b, c), d);
+      }
+      const __m256i temp = _mm256_add_epi32(
+        _mm256_add_epi32(rotateLeft<5>(a), f),
+        _mm256_add_epi32(_mm256_add_epi32(e, word), _mm256_set1_epi32(K[t / 20]))
+      );
+      e = d;
+      d = c;
+      c = rotateLeft<30>(b);
+      b = a;
+      a = temp;
+    }
+
+    const __m256i result[5] = {a, b, c, d, e};
+    for (unsigned int i = 0; i < 5; ++i) {
+      __m256i* dest = reinterpret_cast<__m256i*>(state[i]);
+      _mm256_storeu_si256(dest, _mm256_add_epi32(_mm256_loadu_si256(dest), result[i]));
+    }
+  }
+
+  /** Pushes one block for each of 16 lanes using AVX-512. */
+  _COM_AZURE_DEV__BASE__TARGET("avx2,avx512f")
+  void pushLanesAVX512(uint32 (*state)[16], const uint8* const* blocks) noexcept
+  {
+    __m512i words[16];
+    {
+      __m256i low[16];
+      __m256i high[16];
+      loadMessageWords(blocks, 0, low);
+      loadMessageWords(blocks, 32, low + 8);
+      loadMessageWords(blocks + 8, 0, high);
+      loadMessageWords(blocks + 8, 32, high + 8);
+      for (unsigned int i = 0; i < 16; ++i) {
+        words[i] = _mm512_inserti64x4(_mm512_castsi256_si512(low[i]), high[i], 1);
+      }
+    }
+
+    __m512i a = _mm512_loadu_si512(state[0]);
+    __m512i b = _mm512_loadu_si512(state[1]);
+    __m512i c = _mm512_loadu_si512(state[2]);
+    __m512i d = _mm512_loadu_si512(state[3]);
+    __m512i e = _mm512_loadu_si512(state[4]);
+
+    // ternary logic 0x96 is x ^ y ^ z, 0xca is x ? y : z, and 0xe8 is the majority
+    for (unsigned int t = 0; t < SHA1::MESSAGE_SCHEDULE; ++t) {
+      __m512i& word = words[t & 15];
+      if (t >= 16) {
+        word = _mm512_rol_epi32(_mm512_xor_si512(
+          _mm512_ternarylogic_epi32(words[(t - 3) & 15], words[(t - 8) & 15], words[(t - 14) & 15], 0x96), word
+        ), 1);
+      }
+      __m512i f;
+      if (t < 20) {
+        f = _mm512_ternarylogic_epi32(b, c, d, 0xca);
+      } else if ((t >= 40) && (t < 60)) {
+        f = _mm512_ternarylogic_epi32(b, c, d, 0xe8);
+      } else {
+        f = _mm512_ternarylogic_epi32(b, c, d, 0x96);
+      }
+      const __m512i temp = _mm512_add_epi32(
+        _mm512_add_epi32(_mm512_rol_epi32(a, 5), f),
+        _mm512_add_epi32(_mm512_add_epi32(e, word), _mm512_set1_epi32(K[t / 20]))
+      );
+      e = d;
+      d = c;
+      c = _mm512_rol_epi32(b, 30);
+      b = a;
+      a = temp;
+    }
+
+    const __m512i result[5] = {a, b, c, d, e};
+    for (unsigned int i = 0; i < 5; ++i) {
+      _mm512_storeu_si512(state[i], _mm512_add_epi32(_mm512_loadu_si512(state[i]), result[i]));
+    }
+  }
+#endif
+
+#if defined(_COM_AZURE_DEV__BASE__SHA1_ARM)
+  /** Pushes blocks using the ARMv8 cryptography extension. */
+  void pushBlocksARM(uint32* messageDigest, const uint8* blocks, MemorySize count) noexcept
+  {
+    uint32x4_t abcd = vld1q_u32(messageDigest);
+    uint32 e0 = messageDigest[4];
+    uint32x4_t words[4];
+    for (; count > 0; --count) {
+      const uint32x4_t previousABCD = abcd;
+      const uint32 previousE = e0;
+      for (unsigned int i = 0; i < 4; ++i) {
+        words[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(blocks + i * 16)));
+      }
+      for (unsigned int group = 0; group < 20; ++group) { // 4 rounds per group
+        uint32x4_t& word = words[group & 3];
+        const uint32x4_t temp = vaddq_u32(word, vdupq_n_u32(K[group / 5]));
+        const uint32 e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+        if (group < 5) {
+          abcd = vsha1cq_u32(abcd, e0, temp);
+        } else if ((group >= 10) && (group < 15)) {
+          abcd = vsha1mq_u32(abcd, e0, temp);
+        } else {
+          abcd = vsha1pq_u32(abcd, e0, temp);
+        }
+        e0 = e1;
+        if (group < 16) {
+          word = vsha1su1q_u32(vsha1su0q_u32(word, words[(group + 1) & 3], words[(group + 2) & 3]), words[(group + 3) & 3]);
+        }
+      }
+      e0 += previousE;
+      abcd = vaddq_u32(abcd, previousABCD);
+      blocks += SHA1::BLOCK_SIZE;
+    }
+    vst1q_u32(messageDigest, abcd);
+    messageDigest[4] = e0;
+  }
+#endif
+}
+
 SHA1::SHA1() noexcept
 {
   clear(buffer);
-  messageDigest[0] = 0x67452301; // H0
-  messageDigest[1] = 0xefcdab89; // H1
-  messageDigest[2] = 0x98badcfe; // H2
-  messageDigest[3] = 0x10325476; // H3
-  messageDigest[4] = 0xc3d2e1f0; // H4
+  copy(messageDigest, INITIAL, getArraySize(INITIAL));
 }
 
-void SHA1::pushBlock(const uint8* block) noexcept
+void SHA1::pushBlock(uint32* messageDigest, const uint8* block) noexcept
 {
   uint32 a = messageDigest[0]; // A = H0
   uint32 b = messageDigest[1]; // B = H1
@@ -136,6 +481,26 @@ void SHA1::pushBlock(const uint8* block) noexcept
   messageDigest[4] += e;
 }
 
+void SHA1::pushBlocks(uint32* messageDigest, const uint8* blocks, MemorySize count) noexcept
+{
+#if defined(_COM_AZURE_DEV__BASE__X86_INTRINSICS)
+  const unsigned int SHA = Architecture::SHA1 | Architecture::SSE41;
+  if ((Architecture::getTechonologies() & SHA) == SHA) {
+    pushBlocksSHA(messageDigest, blocks, count);
+    return;
+  }
+#elif defined(_COM_AZURE_DEV__BASE__SHA1_ARM)
+  if (Architecture::hasTechnology(Architecture::SHA1)) {
+    pushBlocksARM(messageDigest, blocks, count);
+    return;
+  }
+#endif
+  for (; count > 0; --count) {
+    pushBlock(messageDigest, blocks);
+    blocks += BLOCK_SIZE;
+  }
+}
+
 MemorySize SHA1::push(const uint8* buffer, MemorySize size)
 {
   if (size > (MAXIMUM_SIZE - totalSize)) {
@@ -146,16 +511,15 @@ MemorySize SHA1::push(const uint8* buffer, MemorySize size)
   if (size + bytesInBuffer >= BLOCK_SIZE) { // do we have a complete block
     if (bytesInBuffer > 0) { // do we need to empty internal buffer
       copy(this->buffer + bytesInBuffer, buffer, BLOCK_SIZE - bytesInBuffer);
-      pushBlock(this->buffer); // internal buffer
+      pushBlocks(messageDigest, this->buffer, 1); // internal buffer
       buffer += BLOCK_SIZE - bytesInBuffer;
       size -= BLOCK_SIZE - bytesInBuffer;
       bytesInBuffer = 0;
     }
-    while (size >= BLOCK_SIZE) {
-      pushBlock(buffer); // external buffer
-      buffer += BLOCK_SIZE;
-      size -= BLOCK_SIZE;
-    }
+    const MemorySize blocks = size/BLOCK_SIZE;
+    pushBlocks(messageDigest, buffer, blocks); // external buffer
+    buffer += blocks * BLOCK_SIZE;
+    size -= blocks * BLOCK_SIZE;
   }
 
   copy(this->buffer + bytesInBuffer, buffer, size); // put remaining octets into internal buffer
@@ -170,11 +534,11 @@ void SHA1::pushEnd() noexcept
   
   const unsigned int SIZE_FIELD = 64/8;
   
-  if (bytesInBuffer >= (BLOCK_SIZE - SIZE_FIELD)) { // do we need one more block
+  if (bytesInBuffer > (BLOCK_SIZE - SIZE_FIELD)) { // do we need one more block
     while (bytesInBuffer < BLOCK_SIZE) { // zero padding
       buffer[bytesInBuffer++] = 0x00;
     }
-    pushBlock(buffer);
+    pushBlocks(messageDigest, buffer, 1);
     bytesInBuffer = 0;
   }
   while (bytesInBuffer < (BLOCK_SIZE - SIZE_FIELD)) { // zero padding
@@ -187,7 +551,7 @@ void SHA1::pushEnd() noexcept
     --i;
     buffer[bytesInBuffer++] = temp >> (i << 3);
   }
-  pushBlock(buffer);
+  pushBlocks(messageDigest, buffer, 1);
   bytesInBuffer = 0;
 }
 
@@ -205,6 +569,21 @@ String SHA1::getBase64() const noexcept
   return Bytes::getAsBase64(temp, sizeof(temp));
 }
 
+void SHA1::getDigests(const uint8* const* messages, const MemorySize* sizes, MemorySize count, uint8* digests)
+{
+#if defined(_COM_AZURE_DEV__BASE__X86_INTRINSICS)
+  if (Architecture::hasTechnology(Architecture::AVX512F)) {
+    MessageLanes<16, 5>::getDigests(INITIAL, pushLanesAVX512, pushBlocks, MAXIMUM_SIZE, messages, sizes, count, digests);
+    return;
+  }
+  if (Architecture::hasTechnology(Architecture::AVX2)) {
+    MessageLanes<8, 5>::getDigests(INITIAL, pushLanesAVX2, pushBlocks, MAXIMUM_SIZE, messages, sizes, count, digests);
+    return;
+  }
+#endif
+  MessageLanes<1, 5>::getDigests(INITIAL, pushBlocks, MAXIMUM_SIZE, messages, sizes, count, digests);
+}
+
 #if defined(_COM_AZURE_DEV__BASE__TESTS)
 
 class TEST_CLASS(SHA1) : public UnitTest {
@@ -231,11 +610,101 @@ public:
   {
     TEST_EQUAL(getSHA1(""), "da39a3ee5e6b4b0d3255bfef95601890afd80709");
     TEST_EQUAL(getSHA1("abc"), "a9993e364706816aba3e25717850c26c9cd0d89d");
+    TEST_EQUAL( // message and size field fill the last block
+      getSHA1("aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"),
+      "c1c8bbdc22796e28c0e15163d20899b65621d65a"
+    );
+    TEST_EQUAL(
+      getSHA1("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"),
+      "84983e441c3bd26ebaae4aa1f95129e5e54670f1"
+    );
+
+    Array<uint8> million;
+    million.setSize(1000000, 'a');
+    TEST_EQUAL(getSHA1(million.getElements(), million.getSize()), "34aa973cd4c4daa4f61eeb2bdbad27316534016f");
+
+    // all sizes around the block and padding boundaries in every lane position
+    Array<uint8> data;
+    data.setSize(4096);
+    for (MemorySize i = 0; i < data.getSize(); ++i) {
+      data[i] = static_cast<uint8>(Random::random<uint32>());
+    }
+    Array<const uint8*> messages;
+    Array<MemorySize> sizes;
+    for (MemorySize size = 0; size < 300; ++size) {
+      messages.append(data.getElements() + size);
+      sizes.append(size);
+    }
+    messages.append(data.getElements());
+    sizes.append(data.getSize());
+    Array<uint8> digests;
+    digests.setSize(messages.getSize() * SHA1::DIGEST_SIZE);
+    SHA1::getDigests(messages.getElements(), sizes.getElements(), messages.getSize(), digests.getElements());
+    bool equal = true;
+    for (MemorySize i = 0; i < messages.getSize(); ++i) {
+      equal &= Bytes::getAsHex(digests.getElements() + i * SHA1::DIGEST_SIZE, SHA1::DIGEST_SIZE) == getSHA1(messages[i], sizes[i]);
+    }
+    TEST_ASSERT(equal);
   }
 };
 
 TEST_REGISTER(SHA1);
 
+class TEST_CLASS(SHA1Benchmark) : public UnitTest {
+public:
+
+  TEST_PRIORITY(1000);
+  TEST_PROJECT("base/security");
+  TEST_IMPACT(LOW);
+
+  void run() override
+  {
+    Array<uint8> data;
+    data.setSize(64 * 1024 * 1024);
+    for (MemorySize i = 0; i < data.getSize(); ++i) {
+      data[i] = static_cast<uint8>(i * 7);
+    }
+
+    Timer timer;
+    SHA1 digest;
+    digest.push(data.getElements(), data.getSize());
+    digest.pushEnd();
+    const uint64 elapsed = maximum<uint64>(timer.getLiveMicroseconds(), 1);
+    TEST_PRINT(format() << "Stream: " << (data.getSize() / elapsed) << " MB/s");
+
+    for (MemorySize size : {64, 256, 1024, 4096}) {
+      const MemorySize count = data.getSize() / size;
+      Array<const uint8*> messages;
+      Array<MemorySize> sizes;
+      messages.setSize(count);
+      sizes.setSize(count);
+      for (MemorySize i = 0; i < count; ++i) {
+        messages[i] = data.getElements() + i * size;
+        sizes[i] = size;
+      }
+      Array<uint8> digests;
+      digests.setSize(count * SHA1::DIGEST_SIZE);
+
+      timer.start();
+      for (MemorySize i = 0; i < count; ++i) {
+        SHA1 single;
+        single.push(messages[i], size);
+        single.pushEnd();
+      }
+      const uint64 singleTime = maximum<uint64>(timer.getLiveMicroseconds(), 1);
+
+      timer.start();
+      SHA1::getDigests(messages.getElements(), sizes.getElements(), count, digests.getElements());
+      const uint64 multiTime = maximum<uint64>(timer.getLiveMicroseconds(), 1);
+
+      TEST_PRINT(format() << "Messages of " << size << " bytes: one at a time: "
+                 << (data.getSize() / singleTime) << " MB/s, getDigests(): " << (data.getSize() / multiTime) << " MB/s");
+    }
+  }
+};
+
+TEST_REGISTER(SHA1Benchmark);
+
 #endif
 
 _COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
@@ -11,53 +11,378 @@
     For the licensing terms refer to the file 'LICENSE'.
  ***************************************************************************/
 
+#include <base/platforms/features.h>
 #include <base/security/SHA256.h>
 #include <base/security/Bytes.h>
+#include <base/security/MessageLanes.h>
+#include <base/string/StringOutputStream.h>
+#include <base/Architecture.h>
 #include <base/Functor.h>
+#include <base/Random.h>
+#include <base/Timer.h>
 #include <base/UnitTest.h>
 
+#if defined(_COM_AZURE_DEV__BASE__X86_INTRINSICS)
+#  include <immintrin.h>
+#endif
+
+#if (_COM_AZURE_DEV__BASE__ARCH == _COM_AZURE_DEV__BASE__ARM64) && \
+    (defined(__ARM_FEATURE_SHA2) || defined(__ARM_FEATURE_CRYPTO))
+#  define _COM_AZURE_DEV__BASE__SHA256_ARM
+#  include <arm_neon.h>
+#endif
+
 _COM_AZURE_DEV__BASE__ENTER_NAMESPACE
 
-const uint32 SHA256::K[SHA256::MESSAGE_SCHEDULE] = {
-  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
-  0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
-  
-  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
-  0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
-  
-  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
-  0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
-  
-  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
-  0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
-  
-  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
-  0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
-  
-  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
-  0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
-  
-  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
-  0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
-  
-  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
-  0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
-};
+namespace {
+
+  const uint32 K[SHA256::MESSAGE_SCHEDULE] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+    0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+    0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+    0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+    0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+  };
+
+  const uint32 INITIAL[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, // H0-H3
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 // H4-H7
+  };
+
+#if defined(_COM_AZURE_DEV__BASE__X86_INTRINSICS)
+  /** Pushes blocks using the SHA extensions. */
+  _COM_AZURE_DEV__BASE__TARGET("sha,sse4.1")
+  void pushBlocksSHA(uint32* messageDigest, const uint8* blocks, MemorySize count) noexcept
+  {
+    const __m128i SWAP = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i temp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(messageDigest)), 0xb1); // CDAB
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(messageDigest + 4)), 0x1b); // EFGH
+    __m128i state0 = _mm_alignr_epi8(temp, state1, 8); // ABEF
+    state1 = _mm_blend_epi16(state1, temp, 0xf0); // CDGH
+
+    __m128i message;
+    __m128i w0, w1, w2, w3;
+    for (; count > 0; --count) {
+      const __m128i previous0 = state0;
+      const __m128i previous1 = state1;
+
+      // rounds 0-3
+      w0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + 0)), SWAP);
+      message = _mm_add_epi32(w0, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K + 0)));
+      state1 = _mm_sha256rnds2_epu32(state1, state0, message);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(message, 0x0e));
+
+      // rounds 4-7
+      w1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + 16)), SWAP);
+      message = _mm_add_epi32(w1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K + 4)));
+      state1 = _mm_sha256rnds2_epu32(state1, state0, message);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(message, 0x0e));
+      w0 = _mm_sha256msg1_epu32(w0, w1);
+
+      // rounds 8-11
+      w2 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + 32)), SWAP);
+      message = _mm_add_epi32(w2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K + 8)));
+      state1 = _mm_sha256rnds2_epu32(state1, state0, message);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(message, 0x0e));
+      w1 = _mm_sha256msg1_epu32(w1, w2);
+
+      // rounds 12-15
+      w3 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + 48)), SWAP);
+      message = _mm_add_epi32(w3, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K + 12)));
+      state1 = _mm_sha256rnds2_epu32(state1, state0, message);
+      w0 = _mm_sha256msg2_epu32(_mm_add_epi32(w0, _mm_alignr_epi8(w3, w2, 4)), w3);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(message, 0x0e));
+      w2 = _mm_sha256msg1_epu32(w2, w3);
+
+      // rounds 16-19
+      message = _mm_add_epi32(w0, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K + 16)));
+      state1 = _mm_sha256rnds2_epu32(state1, state0, message);
+      w1 = _mm_sha256msg2_epu32(_mm_add_epi32(w1, _mm_alignr_epi8(w0, w3, 4)), w0);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(message, 0x0e));
+      w3 = _mm_sha256msg1_epu32(w3, w0);
+
+      // rounds 20-23
+      message = _mm_add_epi32(w1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K + 20)));
+      state1 = _mm_sha256rnds2_epu32(state1, state0, message);
+      w2 = _mm_sha256msg2_epu32(_mm_add_epi32(w2, _mm_alignr_epi8(w1, w0, 4)), w1);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(message, 0x0e));
+      w0 = _mm_sha256msg1_epu32(w0, w1);
+
+      // rounds 24-27
+      message = _mm_add_epi32(w2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K + 24)));
+      state1 = _mm_sha256rnds2_epu32(state1, state0, message);
+      w3 = _mm_sha256msg2_epu32(_mm_add_epi32(w3, _mm_alignr_epi8(w2, w1, 4)), w2);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(message, 0x0e));
+      w1 = _mm_sha256msg1_epu32(w1, w2);
+
+      // rounds 28-31
+      message = _mm_add_epi32(w3, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K + 28)));
+      state1 = _mm_sha256rnds2_epu32(state1, state0, message);
+      w0 = _mm_sha256msg2_epu32(_mm_add_epi32(w0, _mm_alignr_epi8(w3, w2, 4)), w3);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(message, 0x0e));
+      w2 = _mm_sha256msg1_epu32(w2, w3);
+
+      // rounds 32-35
+      message = _mm_add_epi32(w0, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K + 32)));
+      state1 = _mm_sha256rnds2_epu32(state1, state0, message);
+      w1 = _mm_sha256msg2_epu32(_mm_add_epi32(w1, _mm_alignr_epi8(w0, w3, 4)), w0);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(message, 0x0e));
+      w3 = _mm_sha256msg1_epu32(w3, w0);
+
+      // rounds 36-39
+      message = _mm_add_epi32(w1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K + 36)));
+      state1 = _mm_sha256rnds2_epu32(state1, state0, message);
+      w2 = _mm_sha256msg2_epu32(_mm_add_epi32(w2, _mm_alignr_epi8(w1, w0, 4)), w1);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(message, 0x0e));
+      w0 = _mm_sha256msg1_epu32(w0, w1);
+
+      // rounds 40-43
+      message = _mm_add_epi32(w2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K + 40)));
+      state1 = _mm_sha256rnds2_epu32(state1, state0, message);
+      w3 = _mm_sha256msg2_epu32(_mm_add_epi32(w3, _mm_alignr_epi8(w2, w1, 4)), w2);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(message, 0x0e));
+      w1 = _mm_sha256msg1_epu32(w1, w2);
+
+      // rounds 44-47
+      message = _mm_add_epi32(w3, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K + 44)));
+      state1 = _mm_sha256rnds2_epu32(state1, state0, message);
+      w0 = _mm_sha256msg2_epu32(_mm_add_epi32(w0, _mm_alignr_epi8(w3, w2, 4)), w3);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(message, 0x0e));
+      w2 = _mm_sha256msg1_epu32(w2, w3);
+
+      // rounds 48-51
+      message = _mm_add_epi32(w0, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K + 48)));
+      state1 = _mm_sha256rnds2_epu32(state1, state0, message);
+      w1 = _mm_sha256msg2_epu32(_mm_add_epi32(w1, _mm_alignr_epi8(w0, w3, 4)), w0);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(message, 0x0e));
+      w3 = _mm_sha256msg1_epu32(w3, w0);
+
+      // rounds 52-55
+      message = _mm_add_epi32(w1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K + 52)));
+      state1 = _mm_sha256rnds2_epu32(state1, state0, message);
+      w2 = _mm_sha256msg2_epu32(_mm_add_epi32(w2, _mm_alignr_epi8(w1, w0, 4)), w1);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(message, 0x0e));
+
+      // rounds 56-59
+      message = _mm_add_epi32(w2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K + 56)));
+      state1 = _mm_sha256rnds2_epu32(state1, state0, message);
+      w3 = _mm_sha256msg2_epu32(_mm_add_epi32(w3, _mm_alignr_epi8(w2, w1, 4)), w2);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(message, 0x0e));
+
+      // rounds 60-63
+      message = _mm_add_epi32(w3, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K + 60)));
+      state1 = _mm_sha256rnds2_epu32(state1, state0, message);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(message, 0x0e));
+
+      state0 = _mm_add_epi32(state0, previous0);
+      state1 = _mm_add_epi32(state1, previous1);
+      blocks += SHA256::BLOCK_SIZE;
+    }
+
+    temp = _mm_shuffle_epi32(state0, 0x1b); // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xb1); // DCHG
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(messageDigest), _mm_blend_epi16(temp, state1, 0xf0)); // DCBA
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(messageDigest + 4), _mm_alignr_epi8(state1, temp, 8)); // HGFE
+  }
+
+  template<unsigned int BITS>
+  _COM_AZURE_DEV__BASE__TARGET("avx2")
+  inline __m256i rotateRight(__m256i value) noexcept
+  {
+    return _mm256_or_si256(_mm256_srli_epi32(value, BITS), _mm256_slli_epi32(value, 32 - BITS));
+  }
+
+  /** Pushes one block for each of 8 lanes using AVX2. */
+  _COM_AZURE_DEV__BASE__TARGET("avx2")
+  void pushLanesAVX2(uint32 (*state)[8], const uint8* const* blocks) noexcept
+  {
+    __m256i words[16];
+    loadMessageWords(blocks, 0, words);
+    loadMessageWords(blocks, 32, words + 8);
+
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[0]));
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[1]));
+    __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[2]));
+    __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[3]));
+    __m256i e = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[4]));
+    __m256i f = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[5]));
+    __m256i g = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[6]));
+    __m256i h = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[7]));
+
+    for (unsigned int t = 0; t < SHA256::MESSAGE_SCHEDULE; ++t) {
+      __m256i& word = words[t & 15];
+      if (t >= 16) {
+        const __m256i w2 = words[(t - 2) & 15];
+        const __m256i w15 = words[(t - 15) & 15];
+        const __m256i sigma1 = _mm256_xor_si256(
+          _mm256_xor_si256(rotateRight<17>(w2), rotateRight<19>(w2)), _mm256_srli_epi32(w2, 10)
+        );
+        const __m256i sigma0 = _mm256_xor_si256(
+          _mm256_xor_si256(rotateRight<7>(w15), rotateRight<18>(w15)), _mm256_srli_epi32(w15, 3)
+        );
+        word = _mm256_add_epi32(_mm256_add_epi32(sigma1, words[(t - 7) & 15]), _mm256_add_epi32(sigma0, word));
+      }
+      const __m256i sum1 = _mm256_xor_si256(
+        _mm256_xor_si256(rotateRight<6>(e), rotateRight<11>(e)), rotateRight<25>(e)
+      );
+      const __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+      const __m256i T1 = _mm256_add_epi32(
+        _mm256_add_epi32(_mm256_add_epi32(h, sum1), _mm256_add_epi32(ch, word)),
+        _mm256_set1_epi32(K[t])
+      );
+      const __m256i sum0 = _mm256_xor_si256(
+        _mm256_xor_si256(rotateRight<2>(a), rotateRight<13>(a)), rotateRight<22>(a)
+      );
+      const __m256i maj = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+      const __m256i T2 = _mm256_add_epi32(sum0, maj);
+      h = g;
+      g = f;
+      f = e;
+      e = _mm256_add_epi32(d, T1);
+      d = c;
+      c = b;
+      b = a;
+      a = _mm256_add_epi32(T1, T2);
+    }
+
+    const __m256i result[8] = {a, b, c, d, e, f, g, h};
+    for (unsigned int i = 0; i < 8; ++i) {
+      __m256i* dest = reinterpret_cast<__m256i*>(state[i]);
+      _mm256_storeu_si256(dest, _mm256_add_epi32(_mm256_loadu_si256(dest), result[i]));
+    }
+  }
+
+  /** Pushes one block for each of 16 lanes using AVX-512. */
+  _COM_AZURE_DEV__BASE__TARGET("avx2,avx512f")
+  void pushLanesAVX512(uint32 (*state)[16], const uint8* const* blocks) noexcept
+  {
+    __m512i words[16];
+    {
+      __m256i low[16];
+      __m256i high[16];
+      loadMessageWords(blocks, 0, low);
+      loadMessageWords(blocks, 32, low + 8);
+      loadMessageWords(blocks + 8, 0, high);
+      loadMessageWords(blocks + 8, 32, high + 8);
+      for (unsigned int i = 0; i < 16; ++i) {
+        words[i] = _mm512_inserti64x4(_mm512_castsi256_si512(low[i]), high[i], 1);
+      }
+    }
+
+    __m512i a = _mm512_loadu_si512(state[0]);
+    __m512i b = _mm512_loadu_si512(state[1]);
+    __m512i c = _mm512_loadu_si512(state[2]);
+    __m512i d = _mm512_loadu_si512(state[3]);
+    __m512i e = _mm512_loadu_si512(state[4]);
+    __m512i f = _mm512_loadu_si512(state[5]);
+    __m512i g = _mm512_loadu_si512(state[6]);
+    __m512i h = _mm512_loadu_si512(state[7]);
+
+    // ternary logic 0x96 is x ^ y ^ z, 0xca is x ? y : z, and 0xe8 is the majority
+    for (unsigned int t = 0; t < SHA256::MESSAGE_SCHEDULE; ++t) {
+      __m512i& word = words[t & 15];
+      if (t >= 16) {
+        const __m512i w2 = words[(t - 2) & 15];
+        const __m512i w15 = words[(t - 15) & 15];
+        const __m512i sigma1 = _mm512_ternarylogic_epi32(
+          _mm512_ror_epi32(w2, 17), _mm512_ror_epi32(w2, 19), _mm512_srli_epi32(w2, 10), 0x96
+        );
+        const __m512i sigma0 = _mm512_ternarylogic_epi32(
+          _mm512_ror_epi32(w15, 7), _mm512_ror_epi32(w15, 18), _mm512_srli_epi32(w15, 3), 0x96
+        );
+        word = _mm512_add_epi32(_mm512_add_epi32(sigma1, words[(t - 7) & 15]), _mm512_add_epi32(sigma0, word));
+      }
+      const __m512i sum1 = _mm512_ternarylogic_epi32(
+        _mm512_ror_epi32(e, 6), _mm512_ror_epi32(e, 11), _mm512_ror_epi32(e, 25), 0x96
+      );
+      const __m512i ch = _mm512_ternarylogic_epi32(e, f, g, 0xca);
+      const __m512i T1 = _mm512_add_epi32(
+        _mm512_add_epi32(_mm512_add_epi32(h, sum1), _mm512_add_epi32(ch, word)),
+        _mm512_set1_epi32(K[t])
+      );
+      const __m512i sum0 = _mm512_ternarylogic_epi32(
+        _mm512_ror_epi32(a, 2), _mm512_ror_epi32(a, 13), _mm512_ror_epi32(a, 22), 0x96
+      );
+      const __m512i T2 = _mm512_add_epi32(sum0, _mm512_ternarylogic_epi32(a, b, c, 0xe8));
+      h = g;
+      g = f;
+      f = e;
+      e = _mm512_add_epi32(d, T1);
+      d = c;
+      c = b;
+      b = a;
+      a = _mm512_add_epi32(T1, T2);
+    }
+
+    const __m512i result[8] = {a, b, c, d, e, f, g, h};
+    for (unsigned int i = 0; i < 8; ++i) {
+      _mm512_storeu_si512(state[i], _mm512_add_epi32(_mm512_loadu_si512(state[i]), result[i]));
+    }
+  }
+#endif
+
+#if defined(_COM_AZURE_DEV__BASE__SHA256_ARM)
+  /** Pushes blocks using the ARMv8 cryptography extension. */
+  void pushBlocksARM(uint32* messageDigest, const uint8* blocks, MemorySize count) noexcept
+  {
+    uint32x4_t state0 = vld1q_u32(messageDigest); // ABCD
+    uint32x4_t state1 = vld1q_u32(messageDigest + 4); // EFGH
+    uint32x4_t words[4];
+    for (; count > 0; --count) {
+      const uint32x4_t previous0 = state0;
+      const uint32x4_t previous1 = state1;
+      for (unsigned int i = 0; i < 4; ++i) {
+        words[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(blocks + i * 16)));
+      }
+      for (unsigned int group = 0; group < 16; ++group) { // 4 rounds per group
+        uint32x4_t& word = words[group & 3];
+        const uint32x4_t temp = vaddq_u32(word, vld1q_u32(K + group * 4));
+        if (group < 12) {
+          word = vsha256su0q_u32(word, words[(group + 1) & 3]);
+        }
+        const uint32x4_t abcd = state0;
+        state0 = vsha256hq_u32(state0, state1, temp);
+        state1 = vsha256h2q_u32(state1, abcd, temp);
+        if (group < 12) {
+          word = vsha256su1q_u32(word, words[(group + 2) & 3], words[(group + 3) & 3]);
+        }
+      }
+      state0 = vaddq_u32(state0, previous0);
+      state1 = vaddq_u32(state1, previous1);
+      blocks += SHA256::BLOCK_SIZE;
+    }
+    vst1q_u32(messageDigest, state0);
+    vst1q_u32(messageDigest + 4, state1);
+  }
+#endif
+}
 
 SHA256::SHA256() noexcept
 {
   clear(buffer);
-  messageDigest[0] = 0x6a09e667; // H0
-  messageDigest[1] = 0xbb67ae85; // H1
-  messageDigest[2] = 0x3c6ef372; // H2
-  messageDigest[3] = 0xa54ff53a; // H3
-  messageDigest[4] = 0x510e527f; // H4
-  messageDigest[5] = 0x9b05688c; // H5
-  messageDigest[6] = 0x1f83d9ab; // H6
-  messageDigest[7] = 0x5be0cd19; // H7
+  copy(messageDigest, INITIAL, getArraySize(INITIAL));
 }
 
-void SHA256::pushBlock(const uint8* block) noexcept
+void SHA256::pushBlock(uint32* messageDigest, const uint8* block) noexcept
 {
   uint32 a = messageDigest[0]; // A = H0
   uint32 b = messageDigest[1]; // B = H1
@@ -100,6 +425,26 @@ void SHA256::pushBlock(const uint8* block) noexcept
   messageDigest[7] += h;
 }
 
+void SHA256::pushBlocks(uint32* messageDigest, const uint8* blocks, MemorySize count) noexcept
+{
+#if defined(_COM_AZURE_DEV__BASE__X86_INTRINSICS)
+  const unsigned int SHA = Architecture::SHA256 | Architecture::SSE41;
+  if ((Architecture::getTechonologies() & SHA) == SHA) {
+    pushBlocksSHA(messageDigest, blocks, count);
+    return;
+  }
+#elif defined(_COM_AZURE_DEV__BASE__SHA256_ARM)
+  if (Architecture::hasTechnology(Architecture::SHA256)) {
+    pushBlocksARM(messageDigest, blocks, count);
+    return;
+  }
+#endif
+  for (; count > 0; --count) {
+    pushBlock(messageDigest, blocks);
+    blocks += BLOCK_SIZE;
+  }
+}
+
 MemorySize SHA256::push(const uint8* buffer, MemorySize size)
 {
   if (size > (MAXIMUM_SIZE - totalSize)) {
@@ -110,16 +455,15 @@ MemorySize SHA256::push(const uint8* buffer, MemorySize size)
   if (size + bytesInBuffer >= BLOCK_SIZE) { // do we have a complete block
     if (bytesInBuffer > 0) { // do we need to empty internal buffer
       copy(this->buffer + bytesInBuffer, buffer, BLOCK_SIZE - bytesInBuffer);
-      pushBlock(this->buffer); // internal buffer
+      pushBlocks(messageDigest, this->buffer, 1); // internal buffer
       buffer += BLOCK_SIZE - bytesInBuffer;
       size -= BLOCK_SIZE - bytesInBuffer;
       bytesInBuffer = 0;
     }
-    while (size >= BLOCK_SIZE) {
-      pushBlock(buffer); // external buffer
-      buffer += BLOCK_SIZE;
-      size -= BLOCK_SIZE;
-    }
+    const MemorySize blocks = size/BLOCK_SIZE;
+    pushBlocks(messageDigest, buffer, blocks); // external buffer
+    buffer += blocks * BLOCK_SIZE;
+    size -= blocks * BLOCK_SIZE;
   }
 
   copy(this->buffer + bytesInBuffer, buffer, size); // put remaining octets into internal buffer
@@ -134,11 +478,11 @@ void SHA256::pushEnd() noexcept
   
   const unsigned int SIZE_FIELD = 64/8;
   
-  if (bytesInBuffer >= (BLOCK_SIZE - SIZE_FIELD)) { // do we need one more block
+  if (bytesInBuffer > (BLOCK_SIZE - SIZE_FIELD)) { // do we need one more block
     while (bytesInBuffer < BLOCK_SIZE) { // zero padding
       buffer[bytesInBuffer++] = 0x00;
     }
-    pushBlock(buffer);
+    pushBlocks(messageDigest, buffer, 1);
     bytesInBuffer = 0;
   }
   while (bytesInBuffer < (BLOCK_SIZE - SIZE_FIELD)) { // zero padding
@@ -151,7 +495,7 @@ void SHA256::pushEnd() noexcept
     --i;
     buffer[bytesInBuffer++] = temp >> (i << 3);
   }
-  pushBlock(buffer);
+  pushBlocks(messageDigest, buffer, 1);
   bytesInBuffer = 0;
 }
 
@@ -169,6 +513,21 @@ String SHA256::getBase64() const noexcept
   return Bytes::getAsBase64(temp, sizeof(temp));
 }
 
+void SHA256::getDigests(const uint8* const* messages, const MemorySize* sizes, MemorySize count, uint8* digests)
+{
+#if defined(_COM_AZURE_DEV__BASE__X86_INTRINSICS)
+  if (Architecture::hasTechnology(Architecture::AVX512F)) {
+    MessageLanes<16, 8>::getDigests(INITIAL, pushLanesAVX512, pushBlocks, MAXIMUM_SIZE, messages, sizes, count, digests);
+    return;
+  }
+  if (Architecture::hasTechnology(Architecture::AVX2)) {
+    MessageLanes<8, 8>::getDigests(INITIAL, pushLanesAVX2, pushBlocks, MAXIMUM_SIZE, messages, sizes, count, digests);
+    return;
+  }
+#endif
+  MessageLanes<1, 8>::getDigests(INITIAL, pushBlocks, MAXIMUM_SIZE, messages, sizes, count, digests);
+}
+
 #if defined(_COM_AZURE_DEV__BASE__TESTS)
 
 class TEST_CLASS(SHA256) : public UnitTest {
@@ -195,11 +554,113 @@ public:
   {
     TEST_EQUAL(getSHA256(""), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
     TEST_EQUAL(getSHA256("abc"), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    TEST_EQUAL( // message and size field fill the last block
+      getSHA256("aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"),
+      "9f4390f8d30c2dd92ec9f095b65e2b9ae9b0a925a5258e241c9f1e910f734318"
+    );
+    TEST_EQUAL(
+      getSHA256("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"),
+      "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"
+    );
+
+    Array<uint8> million;
+    million.setSize(1000000, 'a');
+    TEST_EQUAL(
+      getSHA256(million.getElements(), million.getSize()),
+      "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"
+    );
+    SHA256 pieces;
+    for (MemorySize offset = 0; offset < million.getSize();) {
+      const MemorySize size = minimum<MemorySize>(offset % 251 + 1, million.getSize() - offset);
+      pieces.push(million.getElements() + offset, size);
+      offset += size;
+    }
+    pieces.pushEnd();
+    TEST_EQUAL(pieces.getValue(), "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+
+    // all sizes around the block and padding boundaries in every lane position
+    Array<uint8> data;
+    data.setSize(4096);
+    for (MemorySize i = 0; i < data.getSize(); ++i) {
+      data[i] = static_cast<uint8>(Random::random<uint32>());
+    }
+    Array<const uint8*> messages;
+    Array<MemorySize> sizes;
+    for (MemorySize size = 0; size < 300; ++size) {
+      messages.append(data.getElements() + size);
+      sizes.append(size);
+    }
+    messages.append(data.getElements());
+    sizes.append(data.getSize());
+    Array<uint8> digests;
+    digests.setSize(messages.getSize() * SHA256::DIGEST_SIZE);
+    SHA256::getDigests(messages.getElements(), sizes.getElements(), messages.getSize(), digests.getElements());
+    bool equal = true;
+    for (MemorySize i = 0; i < messages.getSize(); ++i) {
+      equal &= Bytes::getAsHex(digests.getElements() + i * SHA256::DIGEST_SIZE, SHA256::DIGEST_SIZE) == getSHA256(messages[i], sizes[i]);
+    }
+    TEST_ASSERT(equal);
+    SHA256::getDigests(nullptr, nullptr, 0, nullptr);
   }
 };
 
 TEST_REGISTER(SHA256);
 
+class TEST_CLASS(SHA256Benchmark) : public UnitTest {
+public:
+
+  TEST_PRIORITY(1000);
+  TEST_PROJECT("base/security");
+  TEST_IMPACT(LOW);
+
+  void run() override
+  {
+    Array<uint8> data;
+    data.setSize(64 * 1024 * 1024);
+    for (MemorySize i = 0; i < data.getSize(); ++i) {
+      data[i] = static_cast<uint8>(i * 7);
+    }
+
+    Timer timer;
+    SHA256 digest;
+    digest.push(data.getElements(), data.getSize());
+    digest.pushEnd();
+    const uint64 elapsed = maximum<uint64>(timer.getLiveMicroseconds(), 1);
+    TEST_PRINT(format() << "Stream: " << (data.getSize() / elapsed) << " MB/s");
+
+    for (MemorySize size : {64, 256, 1024, 4096}) {
+      const MemorySize count = data.getSize() / size;
+      Array<const uint8*> messages;
+      Array<MemorySize> sizes;
+      messages.setSize(count);
+      sizes.setSize(count);
+      for (MemorySize i = 0; i < count; ++i) {
+        messages[i] = data.getElements() + i * size;
+        sizes[i] = size;
+      }
+      Array<uint8> digests;
+      digests.setSize(count * SHA256::DIGEST_SIZE);
+
+      timer.start();
+      for (MemorySize i = 0; i < count; ++i) {
+        SHA256 single;
+        single.push(messages[i], size);
+        single.pushEnd();
+      }
+      const uint64 singleTime = maximum<uint64>(timer.getLiveMicroseconds(), 1);
+
+      timer.start();
+      SHA256::getDigests(messages.getElements(), sizes.getElements(), count, digests.getElements());
+      const uint64 multiTime = maximum<uint64>(timer.getLiveMicroseconds(), 1);
+
+      TEST_PRINT(format() << "Messages of " << size << " bytes: one at a time: "
+                 << (data.getSize() / singleTime) << " MB/s, getDigests(): " << (data.getSize() / multiTime) << " MB/s");
+    }
+  }
+};
+
+TEST_REGISTER(SHA256Benchmark);
+
 #endif
 
 _COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
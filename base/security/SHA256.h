@@ -55,6 +55,8 @@ public:
   static const uint64 MAXIMUM_SIZE = (1ULL << (64 - 3)) - 1;
   /** The message schedule size. */
   static const unsigned int MESSAGE_SCHEDULE = 64;
+  /** The size of the message digest in bytes. */
+  static const unsigned int DIGEST_SIZE = 32;
 private:
 
   /** Message digest buffer. */
@@ -66,11 +68,12 @@ private:
   /** The number of bytes in the buffer. */
   unsigned int bytesInBuffer = 0;
 
-  /** Push one block (16 words). */
-  void pushBlock(const uint8* block) noexcept;
-  
-  static const uint32 K[MESSAGE_SCHEDULE];
-  
+  /** Push one block (16 words) using portable code. */
+  static void pushBlock(uint32* messageDigest, const uint8* block) noexcept;
+
+  /** Push blocks using the SHA instructions when available. */
+  static void pushBlocks(uint32* messageDigest, const uint8* blocks, MemorySize count) noexcept;
+
   static inline uint32 rotateLeft(uint32 value, unsigned int bits) noexcept
   {
     return (value << bits) | (value >> (32 - bits));
@@ -152,6 +155,18 @@ public:
     pushEnd() has been invoked.
   */
   String getBase64() const noexcept;
+
+  /**
+    Calculates the message digests of independent messages. The messages are
+    hashed in parallel in 16 lanes with AVX-512 or 8 lanes with AVX2 when
+    available. Raises OutOfRange if a message exceeds MAXIMUM_SIZE.
+
+    @param messages The messages.
+    @param sizes The sizes of the messages in bytes.
+    @param count The number of messages.
+    @param digests Receives DIGEST_SIZE bytes per message in big endian.
+  */
+  static void getDigests(const uint8* const* messages, const MemorySize* sizes, MemorySize count, uint8* digests);
 };
 
 _COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
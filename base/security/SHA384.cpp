@@ -131,7 +131,7 @@ void SHA384::pushEnd() noexcept
 
   const unsigned int SIZE_FIELD = 128/8;
   
-  if (bytesInBuffer >= (BLOCK_SIZE - SIZE_FIELD)) { // do we need one more block
+  if (bytesInBuffer > (BLOCK_SIZE - SIZE_FIELD)) { // do we need one more block
     while (bytesInBuffer < BLOCK_SIZE) { // zero padding
       buffer[bytesInBuffer++] = 0x00;
     }
@@ -216,6 +216,10 @@ public:
   {
     TEST_EQUAL(getSHA384(""), "38b060a751ac96384cd9327eb1b1e36a21fdb71114be07434c0cc7bf63f6e1da274edebfe76f65fbd51ad2f14898b95b");
     TEST_EQUAL(getSHA384("abc"), "cb00753f45a35e8bb5a03d699ac65007272c32ab0eded1631a8b605a43ff5bed8086072ba1e7cc2358baeca134c825a7");
+    TEST_EQUAL( // message and size field fill the last block
+      getSHA384("aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"),
+      "3c37955051cb5c3026f94d551d5b5e2ac38d572ae4e07172085fed81f8466b8f90dc23a8ffcdea0b8d8e58e8fdacc80a"
+    );
   }
 };
 
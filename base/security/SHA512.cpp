@@ -131,7 +131,7 @@ void SHA512::pushEnd() noexcept
 
   const unsigned int SIZE_FIELD = 128/8;
   
-  if (bytesInBuffer >= (BLOCK_SIZE - SIZE_FIELD)) { // do we need one more block
+  if (bytesInBuffer > (BLOCK_SIZE - SIZE_FIELD)) { // do we need one more block
     while (bytesInBuffer < BLOCK_SIZE) { // zero padding
       buffer[bytesInBuffer++] = 0x00;
     }
@@ -200,6 +200,10 @@ public:
   {
     TEST_EQUAL(getSHA512(""), "cf83e1357eefb8bdf1542850d66d8007d620e4050b5715dc83f4a921d36ce9ce47d0d13c5d85f2b0ff8318d2877eec2f63b931bd47417a81a538327af927da3e");
     TEST_EQUAL(getSHA512("abc"), "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f");
+    TEST_EQUAL( // message and size field fill the last block
+      getSHA512("aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"),
+      "fa9121c7b32b9e01733d034cfc78cbf67f926c7ed83e82200ef86818196921760b4beff48404df811b953828274461673c68d04e297b0eb7b2b4d60fc6b566a2"
+    );
   }
 };
 
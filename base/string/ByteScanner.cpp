@@ -0,0 +1,239 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#include <base/string/ByteScanner.h>
+#include <base/Random.h>
+#include <base/Timer.h>
+#include <base/UnitTest.h>
+
+#if defined(__AVX2__)
+#  define _COM_AZURE_DEV__BASE__SCAN_AVX2
+#  include <immintrin.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#  define _COM_AZURE_DEV__BASE__SCAN_SSE2
+#  include <emmintrin.h>
+#endif
+
+#if (_COM_AZURE_DEV__BASE__COMPILER == _COM_AZURE_DEV__BASE__COMPILER_MSC)
+#  include <intrin.h>
+#endif
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+namespace {
+
+  /** Returns the index of the lowest set bit. Value must not be 0. */
+  inline unsigned int getLowestBit(uint32 value) noexcept
+  {
+#if (_COM_AZURE_DEV__BASE__COMPILER == _COM_AZURE_DEV__BASE__COMPILER_GCC) || \
+    (_COM_AZURE_DEV__BASE__COMPILER == _COM_AZURE_DEV__BASE__COMPILER_LLVM)
+    return __builtin_ctz(value);
+#elif (_COM_AZURE_DEV__BASE__COMPILER == _COM_AZURE_DEV__BASE__COMPILER_MSC)
+    unsigned long result = 0;
+    _BitScanForward(&result, value);
+    return result;
+#else
+    unsigned int result = 0;
+    while (!(value & 1)) {
+      value >>= 1;
+      ++result;
+    }
+    return result;
+#endif
+  }
+
+  /** Returns the first byte which equals any of the needles. */
+  template<unsigned int COUNT>
+  inline const uint8* findAnyImpl(const uint8* src, const uint8* end, const uint8 (&needles)[COUNT]) noexcept
+  {
+#if defined(_COM_AZURE_DEV__BASE__SCAN_AVX2)
+    if ((end - src) >= 32) {
+      __m256i n[COUNT];
+      for (unsigned int i = 0; i < COUNT; ++i) {
+        n[i] = _mm256_set1_epi8(static_cast<char>(needles[i]));
+      }
+      do {
+        const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+        __m256i matches = _mm256_cmpeq_epi8(value, n[0]);
+        for (unsigned int i = 1; i < COUNT; ++i) {
+          matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(value, n[i]));
+        }
+        const uint32 mask = static_cast<uint32>(_mm256_movemask_epi8(matches));
+        if (mask) {
+          return src + getLowestBit(mask);
+        }
+        src += 32;
+      } while ((end - src) >= 32);
+    }
+#endif
+#if defined(_COM_AZURE_DEV__BASE__SCAN_SSE2)
+    if ((end - src) >= 16) {
+      __m128i n[COUNT];
+      for (unsigned int i = 0; i < COUNT; ++i) {
+        n[i] = _mm_set1_epi8(static_cast<char>(needles[i]));
+      }
+      do {
+        const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        __m128i matches = _mm_cmpeq_epi8(value, n[0]);
+        for (unsigned int i = 1; i < COUNT; ++i) {
+          matches = _mm_or_si128(matches, _mm_cmpeq_epi8(value, n[i]));
+        }
+        const uint32 mask = static_cast<uint32>(_mm_movemask_epi8(matches));
+        if (mask) {
+          return src + getLowestBit(mask);
+        }
+        src += 16;
+      } while ((end - src) >= 16);
+    }
+#endif
+    for (; src != end; ++src) {
+      for (unsigned int i = 0; i < COUNT; ++i) {
+        if (*src == needles[i]) {
+          return src;
+        }
+      }
+    }
+    return end;
+  }
+}
+
+const char* ByteScanner::getImplementation() noexcept
+{
+#if defined(_COM_AZURE_DEV__BASE__SCAN_AVX2)
+  return "AVX2";
+#elif defined(_COM_AZURE_DEV__BASE__SCAN_SSE2)
+  return "SSE2";
+#else
+  return "Scalar";
+#endif
+}
+
+const uint8* ByteScanner::find(const uint8* src, const uint8* end, uint8 a) noexcept
+{
+  const uint8 needles[] = {a};
+  return findAnyImpl(src, end, needles);
+}
+
+const uint8* ByteScanner::findAny(const uint8* src, const uint8* end, uint8 a, uint8 b) noexcept
+{
+  const uint8 needles[] = {a, b};
+  return findAnyImpl(src, end, needles);
+}
+
+const uint8* ByteScanner::findAny(const uint8* src, const uint8* end, uint8 a, uint8 b, uint8 c) noexcept
+{
+  const uint8 needles[] = {a, b, c};
+  return findAnyImpl(src, end, needles);
+}
+
+#if defined(_COM_AZURE_DEV__BASE__TESTS)
+
+class TEST_CLASS(ByteScanner) : public UnitTest {
+public:
+
+  TEST_PRIORITY(20);
+  TEST_PROJECT("base/string");
+
+  void run() override
+  {
+    uint8 buffer[200];
+    for (unsigned int i = 0; i < sizeof(buffer); ++i) {
+      buffer[i] = 'a' + (i % 26);
+    }
+    buffer[sizeof(buffer) - 1] = 0;
+
+    // every position, alignment, and length across the vector widths
+    bool same = true;
+    for (unsigned int begin = 0; begin < 40; ++begin) {
+      for (unsigned int position = begin; position < 120; ++position) {
+        const uint8 original = buffer[position];
+        buffer[position] = (position % 2) ? '\n' : '\r';
+        for (unsigned int length = 0; length < 80; ++length) {
+          const uint8* src = buffer + begin;
+          const uint8* end = src + length;
+          const uint8* expected = ((position - begin) < length) ? (buffer + position) : end;
+          same &= ByteScanner::findEndOfLine(src, end) == expected;
+          same &= ByteScanner::find(src, end, buffer[position]) == expected;
+          same &= ByteScanner::findAny(src, end, 0, ';', buffer[position]) == expected;
+        }
+        buffer[position] = original;
+      }
+    }
+    TEST_ASSERT(same);
+
+    const uint8 text[] = "name;\"quoted \\\" text\"\r\nnext";
+    const uint8* end = text + sizeof(text) - 1;
+    TEST_EQUAL(ByteScanner::find(text, end, ';') - text, 4);
+    TEST_EQUAL(ByteScanner::findAny(text, end, '"', '\\') - text, 5);
+    TEST_EQUAL(ByteScanner::findAny(text + 6, end, '"', '\\') - text, 13);
+    TEST_EQUAL(ByteScanner::findEndOfLine(text, end) - text, 21);
+    TEST_EQUAL(ByteScanner::find(text, end, 'z'), end);
+    TEST_EQUAL(ByteScanner::find(text, text, 'n'), text);
+  }
+};
+
+TEST_REGISTER(ByteScanner);
+
+class TEST_CLASS(ByteScannerBenchmark) : public UnitTest {
+public:
+
+  TEST_PRIORITY(1000);
+  TEST_PROJECT("base/string");
+  TEST_IMPACT(LOW);
+
+  void run() override
+  {
+    const MemorySize SIZE = 16 * 1024 * 1024;
+    PrimitiveArray<uint8> buffer(SIZE);
+    for (MemorySize i = 0; i < SIZE; ++i) {
+      buffer[i] = 'a' + (Random::random<uint32>() % 26);
+    }
+    for (MemorySize i = 500; i < SIZE; i += 1000) { // lines of 1000 bytes
+      buffer[i] = '\n';
+    }
+    const uint8* begin = buffer.cbegin();
+    const uint8* end = begin + SIZE;
+
+    Timer timer;
+    MemorySize lines = 0;
+    for (const uint8* src = begin; src != end; ++src) {
+      lines += ((*src == '\n') || (*src == '\r')) ? 1 : 0;
+    }
+    const uint64 scalarTime = timer.getLiveMicroseconds();
+
+    timer.start();
+    MemorySize count = 0;
+    for (const uint8* src = begin; ; ++src) {
+      src = ByteScanner::findEndOfLine(src, end);
+      if (src == end) {
+        break;
+      }
+      ++count;
+    }
+    const uint64 scanTime = timer.getLiveMicroseconds();
+    TEST_EQUAL(count, lines);
+
+    const double megabytes = SIZE/(1024.0 * 1024);
+    TEST_PRINT(format() << "Implementation: " << ByteScanner::getImplementation()
+               << ", scalar: " << megabytes * 1000000/maximum<uint64>(scalarTime, 1)
+               << " MB/s, scanner: " << megabytes * 1000000/maximum<uint64>(scanTime, 1) << " MB/s");
+  }
+};
+
+TEST_REGISTER(ByteScannerBenchmark);
+
+#endif
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
@@ -0,0 +1,51 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#pragma once
+
+#include <base/features.h>
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+/**
+  Finds bytes in text. Compares 32 bytes at a time with AVX2 or 16 bytes at a
+  time with SSE2 when enabled for the build and one byte at a time otherwise.
+  Used by LineReader and CSVFormat to find line ends, separators, and quotes.
+
+  @short Byte scanner.
+  @version 1.0
+*/
+
+class _COM_AZURE_DEV__BASE__API ByteScanner {
+public:
+
+  /** Returns the name of the implementation (e.g. "AVX2", "SSE2", or "Scalar"). */
+  static const char* getImplementation() noexcept;
+
+  /** Returns the first byte which equals the given byte. Returns end if not found. */
+  static const uint8* find(const uint8* src, const uint8* end, uint8 a) noexcept;
+
+  /** Returns the first byte which equals any of the given bytes. Returns end if not found. */
+  static const uint8* findAny(const uint8* src, const uint8* end, uint8 a, uint8 b) noexcept;
+
+  /** Returns the first byte which equals any of the given bytes. Returns end if not found. */
+  static const uint8* findAny(const uint8* src, const uint8* end, uint8 a, uint8 b, uint8 c) noexcept;
+
+  /** Returns the first CR or LF. Returns end if not found. */
+  static inline const uint8* findEndOfLine(const uint8* src, const uint8* end) noexcept
+  {
+    return findAny(src, end, '\n', '\r');
+  }
+};
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
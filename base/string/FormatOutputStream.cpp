@@ -19,6 +19,7 @@
 #include <base/string/Locale.h>
 #include <base/Date.h>
 #include <base/string/StringOutputStream.h>
+#include <base/string/NumberFormat.h>
 #include <base/concurrency/AtomicCounter.h>
 #include <base/TypeInfo.h>
 #include <base/UnitTest.h>
@@ -663,6 +664,27 @@ void FormatOutputStream::addIntegerField(const char* buffer, MemorySize size, bo
   context = defaultContext;
 }
 
+void FormatOutputStream::addFastIntegerField(const char* buffer, MemorySize size)
+{
+  ExclusiveSynchronize<Guard> _guard(guard);
+  write(Cast::pointer<const uint8*>(buffer), static_cast<unsigned int>(size)); // no prefix or padding for decimal
+  context = defaultContext;
+}
+
+void FormatOutputStream::writeAtomic(const char* buffer, MemorySize size, bool flush)
+{
+  ExclusiveSynchronize<Guard> _guard(guard);
+  while (size > 0) {
+    const unsigned int bytesToWrite = static_cast<unsigned int>(minimum<MemorySize>(size, PrimitiveTraits<unsigned int>::MAXIMUM));
+    write(Cast::pointer<const uint8*>(buffer), bytesToWrite); // may throw IOException
+    buffer += bytesToWrite;
+    size -= bytesToWrite;
+  }
+  if (flush) {
+    this->flush(); // may throw IOException
+  }
+}
+
 void FormatOutputStream::addDateField(const Date& date)
 {
   ExclusiveSynchronize<Guard> _guard(guard);
@@ -791,6 +813,13 @@ FormatOutputStream& FormatOutputStream::operator<<(bool value)
 
 FormatOutputStream& FormatOutputStream::operator<<(short value)
 {
+  if (useFastInteger()) {
+    char buffer[NumberFormat::MAXIMUM_INTEGER_LENGTH];
+    const char* end = NumberFormat::formatSigned(buffer, static_cast<int64>(value));
+    addFastIntegerField(buffer, end - buffer);
+    return *this;
+  }
+
   char buffer[sizeof(short) * 8];
   char* dest = &buffer[sizeof(buffer) - 1]; // point to least significant digit position
 
@@ -852,6 +881,13 @@ FormatOutputStream& FormatOutputStream::operator<<(short value)
 
 FormatOutputStream& FormatOutputStream::operator<<(unsigned short value)
 {
+  if (useFastInteger()) {
+    char buffer[NumberFormat::MAXIMUM_INTEGER_LENGTH];
+    const char* end = NumberFormat::formatUnsigned(buffer, static_cast<uint64>(value));
+    addFastIntegerField(buffer, end - buffer);
+    return *this;
+  }
+
   char buffer[sizeof(unsigned short) * 8];
   char* dest = &buffer[sizeof(buffer) - 1]; // point to least significant digit position
 
@@ -909,6 +945,13 @@ FormatOutputStream& FormatOutputStream::operator<<(unsigned short value)
 
 FormatOutputStream& FormatOutputStream::operator<<(int value)
 {
+  if (useFastInteger()) {
+    char buffer[NumberFormat::MAXIMUM_INTEGER_LENGTH];
+    const char* end = NumberFormat::formatSigned(buffer, static_cast<int64>(value));
+    addFastIntegerField(buffer, end - buffer);
+    return *this;
+  }
+
   char buffer[sizeof(int) * 8];
   char* dest = &buffer[sizeof(buffer) - 1]; // point to least significant digit position
 
@@ -970,6 +1013,13 @@ FormatOutputStream& FormatOutputStream::operator<<(int value)
 
 FormatOutputStream& FormatOutputStream::operator<<(unsigned int value)
 {
+  if (useFastInteger()) {
+    char buffer[NumberFormat::MAXIMUM_INTEGER_LENGTH];
+    const char* end = NumberFormat::formatUnsigned(buffer, static_cast<uint64>(value));
+    addFastIntegerField(buffer, end - buffer);
+    return *this;
+  }
+
   char buffer[sizeof(unsigned int) * 8];
   char* dest = &buffer[getArraySize(buffer) - 1]; // point to least significant digit position
 
@@ -1027,6 +1077,13 @@ FormatOutputStream& FormatOutputStream::operator<<(unsigned int value)
 
 FormatOutputStream& FormatOutputStream::operator<<(long value)
 {
+  if (useFastInteger()) {
+    char buffer[NumberFormat::MAXIMUM_INTEGER_LENGTH];
+    const char* end = NumberFormat::formatSigned(buffer, static_cast<int64>(value));
+    addFastIntegerField(buffer, end - buffer);
+    return *this;
+  }
+
   char buffer[sizeof(long) * 8];
   char* dest = &buffer[sizeof(buffer) - 1]; // point to least significant digit position
 
@@ -1088,6 +1145,13 @@ FormatOutputStream& FormatOutputStream::operator<<(long value)
 
 FormatOutputStream& FormatOutputStream::operator<<(unsigned long value)
 {
+  if (useFastInteger()) {
+    char buffer[NumberFormat::MAXIMUM_INTEGER_LENGTH];
+    const char* end = NumberFormat::formatUnsigned(buffer, static_cast<uint64>(value));
+    addFastIntegerField(buffer, end - buffer);
+    return *this;
+  }
+
   char buffer[sizeof(unsigned long) * 8];
   char* dest = &buffer[sizeof(buffer) - 1]; // point to least significant digit position
 
@@ -1145,6 +1209,13 @@ FormatOutputStream& FormatOutputStream::operator<<(unsigned long value)
 
 FormatOutputStream& FormatOutputStream::operator<<(long long value)
 {
+  if (useFastInteger()) {
+    char buffer[NumberFormat::MAXIMUM_INTEGER_LENGTH];
+    const char* end = NumberFormat::formatSigned(buffer, static_cast<int64>(value));
+    addFastIntegerField(buffer, end - buffer);
+    return *this;
+  }
+
   char buffer[sizeof(long long) * 8];
   char* dest = &buffer[sizeof(buffer) - 1]; // point to least significant digit position
 
@@ -1206,6 +1277,13 @@ FormatOutputStream& FormatOutputStream::operator<<(long long value)
 
 FormatOutputStream& FormatOutputStream::operator<<(unsigned long long value)
 {
+  if (useFastInteger()) {
+    char buffer[NumberFormat::MAXIMUM_INTEGER_LENGTH];
+    const char* end = NumberFormat::formatUnsigned(buffer, static_cast<uint64>(value));
+    addFastIntegerField(buffer, end - buffer);
+    return *this;
+  }
+
   char buffer[sizeof(unsigned long long) * 8];
   char* dest = &buffer[sizeof(buffer) - 1]; // point to least significant digit position
 
@@ -1418,7 +1496,7 @@ void convertFloatingPoint(
   // number of words in large integers
   unsigned int integerSize = (maximum<int>(maximum<int>(shiftS, shiftR), maximum<int>(base2Exponent, significant)) /* value bits */
                                         + 2 /* additional shifts */
-                                        + 4 /* multiplication with 10, addition with 10, sum of integers */
+                                        + 8 /* multiplication with 10 of both S and R, addition with 10, sum of integers */
                                         + sizeof(unsigned int)*8 - 1 /* round up */
                                        )/(sizeof(unsigned int)*8);
   BASSERT((integerSize > 0) && (integerSize <= 513));
@@ -1490,7 +1568,7 @@ void convertFloatingPoint(
 
     switch (cutMode) {
     case CUT_MODE_NOGARBAGE: // TAG: works with SCIENTIFIC and ENGINEERING but not FIXED
-      cutPlace = (significant + 1)/3; // N = 2 + floor[significant/log2(10)] => N < 3 + significant/3
+      cutPlace = 2 + ((significant + 1) * 1233)/4096; // N = 2 + floor[p * log10(2)] and log10(2) ~ 1233/4096
       break;
     case CUT_MODE_RELATIVE:
       {
@@ -1577,14 +1655,27 @@ void convertFloatingPoint(
     }
   }
 
+  bool increment = false;
   if (low && !high) {
   } else if (high && !low) {
-    ++buffer[numberOfDigits - 1];
+    increment = true;
   } else {
     LargeIntegerImpl::leftShift(R, integerSize, 1); // R = 2*R // TAG: need ordinary compare
     if (LargeIntegerImpl::lessThan(S, R, integerSize)) { // 2*R > S
-      ++buffer[numberOfDigits - 1];
+      increment = true;
+    }
+  }
+
+  if (increment) { // propagate carry
+    unsigned int i = numberOfDigits;
+    while (i > 0) {
+      if (++buffer[--i] < 10) {
+        return;
+      }
+      buffer[i] = 0;
     }
+    buffer[0] = 1; // 0.99..9 => 0.10..0 * 10
+    ++exponent;
   }
 }
 
@@ -1599,6 +1690,21 @@ FormatOutputStream& FormatOutputStream::operator<<(float _value)
     return *this << (!value.isNegative() ? MESSAGE("inf") : MESSAGE("-inf"));
   }
 
+  if (useFastFloat()) {
+    uint8 digits[NumberFormat::MAXIMUM_DIGITS];
+    unsigned int numberOfDigits = 0;
+    int exponent = 0;
+    if (_value == 0) {
+      digits[0] = 0;
+      writeFastFloatingPointType(value.isNegative(), digits, 1, 0);
+      return *this;
+    } else if (NumberFormat::getShortestDigits(_value, digits, numberOfDigits, exponent)) {
+      writeFastFloatingPointType(value.isNegative(), digits, numberOfDigits, exponent);
+      return *this;
+    }
+    // fallback to exact conversion
+  }
+
   unsigned int precision = 0;
   unsigned int mantissa[(FloatingPoint::FloatRepresentation::SIGNIFICANT + (sizeof(unsigned int) * 8) - 1)/(sizeof(unsigned int) * 8)];
   int exponent = 0;
@@ -1624,6 +1730,21 @@ FormatOutputStream& FormatOutputStream::operator<<(double _value)
   } else if (value.isInfinity()) {
     return *this << (!value.isNegative() ? MESSAGE("inf") : MESSAGE("-inf"));
   }
+
+  if (useFastFloat()) {
+    uint8 digits[NumberFormat::MAXIMUM_DIGITS];
+    unsigned int numberOfDigits = 0;
+    int exponent = 0;
+    if (_value == 0) {
+      digits[0] = 0;
+      writeFastFloatingPointType(value.isNegative(), digits, 1, 0);
+      return *this;
+    } else if (NumberFormat::getShortestDigits(_value, digits, numberOfDigits, exponent)) {
+      writeFastFloatingPointType(value.isNegative(), digits, numberOfDigits, exponent);
+      return *this;
+    }
+    // fallback to exact conversion
+  }
   
   unsigned int precision = 0;
   unsigned int mantissa[(FloatingPoint::DoubleRepresentation::SIGNIFICANT + (sizeof(unsigned int) * 8) - 1)/(sizeof(unsigned int) * 8)];
@@ -1785,6 +1906,82 @@ char* writeInt(char* dest, int value) noexcept
 }
 #endif
 
+void FormatOutputStream::writeFastFloatingPointType(
+  bool negative,
+  const uint8* digits,
+  unsigned int numberOfDigits,
+  int exponent)
+{
+  // same layout as writeFloatingPointType() for FIXED/NECESSARY/POSIX
+  char buffer[64];
+  char* output = buffer;
+  const unsigned int flags = context.flags;
+
+  if (negative) {
+    *output++ = '-';
+  } else if ((flags & Symbols::FPLUS) != 0) { // show plus if sign is forced
+    *output++ = '+';
+  }
+
+  const bool isZero = (numberOfDigits == 1) && (digits[0] == 0);
+  bool showExponent = false;
+  int adjustedExponent = 0;
+  if ((exponent < -3) || (exponent >= 10)) {
+    adjustedExponent = exponent - 1;
+    showExponent = true;
+  }
+
+  const uint8* digit = digits;
+  const uint8* endDigit = digit + numberOfDigits;
+  const int digitsBeforeRadix = !isZero ? maximum(exponent - adjustedExponent, 0) : 1;
+  const int denormalizingZeros = minimum(maximum(adjustedExponent - exponent, 0), static_cast<int>(context.precision));
+
+  if (digitsBeforeRadix > 0) {
+    for (int i = digitsBeforeRadix; i > 0; --i) {
+      *output++ = (digit < endDigit) ? ASCIITraits::valueToDigit(*digit++) : '0';
+    }
+  } else {
+    *output++ = '0';
+  }
+
+  const unsigned int digitsAfterRadix =
+    (static_cast<int>(numberOfDigits) > digitsBeforeRadix) ? (numberOfDigits - digitsBeforeRadix) : 0;
+  const unsigned int totalDigitsAfterRadix = digitsAfterRadix + denormalizingZeros;
+  if (totalDigitsAfterRadix > 0) {
+    *output++ = '.';
+    for (int i = denormalizingZeros; i > 0; --i) {
+      *output++ = '0';
+    }
+    for (unsigned int i = digitsAfterRadix; i > 0; --i) {
+      *output++ = ASCIITraits::valueToDigit(*digit++);
+    }
+  }
+
+  if (showExponent) {
+    *output++ = ((flags & Symbols::UPPER) == 0) ? 'e' : 'E';
+    if (adjustedExponent < 0) {
+      *output++ = '-';
+      adjustedExponent = -adjustedExponent;
+    } else if ((flags & Symbols::PLUSEXP) != 0) {
+      *output++ = '+';
+    }
+    if ((flags & Symbols::ZEROPADEXP) != 0) {
+      *output++ = ASCIITraits::valueToDigit(adjustedExponent/1000 % 10);
+      *output++ = ASCIITraits::valueToDigit(adjustedExponent/100 % 10);
+      *output++ = ASCIITraits::valueToDigit(adjustedExponent/10 % 10);
+      *output++ = ASCIITraits::valueToDigit(adjustedExponent % 10);
+    } else {
+      output = NumberFormat::formatUnsigned(output, adjustedExponent);
+    }
+  } else if ((totalDigitsAfterRadix == 0) && ((flags & Symbols::ENSUREFLOAT) != 0)) {
+    *output++ = '.';
+  }
+
+  ExclusiveSynchronize<Guard> _guard(guard);
+  write(Cast::pointer<const uint8*>(buffer), static_cast<unsigned int>(output - buffer));
+  context = defaultContext;
+}
+
 void FormatOutputStream::writeFloatingPointType(
   unsigned int significant,
   unsigned int* mantissa,
@@ -1876,7 +2073,8 @@ void FormatOutputStream::writeFloatingPointType(
       }
     } else {
 
-      PrimitiveStackArray<uint8> digitBuffer((significant + 1)/3); // N = 2 + floor[n/log2(10)] => N < 3 + n/3
+      // same bound as cutPlace for CUT_MODE_NOGARBAGE in convertFloatingPoint()
+      PrimitiveStackArray<uint8> digitBuffer(2 + ((significant + 1) * 1233)/4096); // N = 2 + floor[p * log10(2)]
       unsigned int numberOfDigits = 0;
       int exponent = 0;
       CutMode cutMode = CUT_MODE_NOGARBAGE;
@@ -361,6 +361,26 @@ protected:
   Context defaultContext;
   /** The current context. */
   Context context;
+
+  /** Returns true if integers can be written without field formatting. */
+  inline bool useFastInteger() const noexcept
+  {
+    return (context.integerBase == Symbols::DECIMAL) && (context.width == 0);
+  }
+
+  /** Returns true if floating-point types can be written as shortest digits without field formatting. */
+  inline bool useFastFloat() const noexcept
+  {
+    return (context.realBase == Symbols::DECIMAL) && (context.realStyle == Symbols::FIXED) &&
+      ((context.flags & (Symbols::NECESSARY | Symbols::POSIX)) == (Symbols::NECESSARY | Symbols::POSIX)) &&
+      (context.width == 0) && (context.justification != Symbols::RADIX);
+  }
+
+  /** Writes a preformatted integer which requires no field formatting. */
+  void addFastIntegerField(const char* buffer, MemorySize size);
+
+  /** Writes the given shortest digits in FIXED style. */
+  void writeFastFloatingPointType(bool negative, const uint8* digits, unsigned int numberOfDigits, int exponent);
 public:
   
   /** Specifies the maximum field width. */
@@ -488,6 +508,17 @@ public:
   */
   FormatOutputStream& operator<<(Action action);
 
+  /**
+    Writes the given preformatted text to the stream as a single unit. The text
+    is never interleaved with text written by other threads. The field context
+    is neither used nor reset. See ThreadFormatOutputStream.
+
+    @param buffer The text.
+    @param size The number of bytes.
+    @param flush Flushes the stream after the text has been written.
+  */
+  void writeAtomic(const char* buffer, MemorySize size, bool flush = false);
+
   class _COM_AZURE_DEV__BASE__API Indent {
   private:
     
@@ -12,6 +12,7 @@
  ***************************************************************************/
 
 #include <base/string/LineReader.h>
+#include <base/string/ByteScanner.h>
 #include <base/io/EndOfFile.h>
 
 _COM_AZURE_DEV__BASE__ENTER_NAMESPACE
@@ -44,24 +45,22 @@ void LineReader::readLine(String& result)
 
     // look for eol
     const uint8* begin = src;
-    while (src != end) {
-      if ((*src == '\n') || (*src == '\r')) {
-        const uint8* lineEnd = src;
-        const uint8 otherCode = (*src == '\n') ? '\r' : '\n';
-        ++src;
-        if (src != end) {
-          if (*src == otherCode) {
-            ++src;
-          }
-        } else {
-          skipCode = otherCode;
+    src = ByteScanner::findEndOfLine(src, end);
+    if (src != end) {
+      const uint8* lineEnd = src;
+      const uint8 otherCode = (*src == '\n') ? '\r' : '\n';
+      ++src;
+      if (src != end) {
+        if (*src == otherCode) {
+          ++src;
         }
-
-        bis.skip(src - begin);
-        result.append(ConstSpan<char>(reinterpret_cast<const char*>(begin), lineEnd - begin));
-        return;
+      } else {
+        skipCode = otherCode;
       }
-      ++src;
+
+      bis.skip(src - begin);
+      result.append(ConstSpan<char>(reinterpret_cast<const char*>(begin), lineEnd - begin));
+      return;
     }
 
     result.append(ConstSpan<char>(reinterpret_cast<const char*>(begin), src - begin));
@@ -97,27 +96,25 @@ String LineReader::readLine()
 
     // look for eol
     const uint8* begin = src;
-    while (src != end) {
-      if ((*src == '\n') || (*src == '\r')) {
-        const uint8 otherCode = (*src == '\n') ? '\r' : '\n';
-        ++src;
-        if (src != end) {
-          if (*src == otherCode) {
-            ++src;
-          }
-        } else {
-          skipCode = otherCode;
+    src = ByteScanner::findEndOfLine(src, end);
+    if (src != end) {
+      const uint8 otherCode = (*src == '\n') ? '\r' : '\n';
+      ++src;
+      if (src != end) {
+        if (*src == otherCode) {
+          ++src;
         }
+      } else {
+        skipCode = otherCode;
+      }
 
-        bis.skip(src - begin);
-        if (!result) {
-          return String(reinterpret_cast<const char*>(begin), src - begin); // common case
-        } else {
-          result.append(ConstSpan<char>(reinterpret_cast<const char*>(begin), src - begin));
-          return result;
-        }
+      bis.skip(src - begin);
+      if (!result) {
+        return String(reinterpret_cast<const char*>(begin), src - begin); // common case
+      } else {
+        result.append(ConstSpan<char>(reinterpret_cast<const char*>(begin), src - begin));
+        return result;
       }
-      ++src;
     }
 
     result.append(ConstSpan<char>(reinterpret_cast<const char*>(begin), src - begin));
@@ -0,0 +1,530 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#include <base/string/NumberFormat.h>
+#include <base/string/StringOutputStream.h>
+#include <base/string/Format.h>
+#include <base/math/Math.h>
+#include <base/Cast.h>
+#include <base/Random.h>
+#include <base/Timer.h>
+#include <base/UnitTest.h>
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+namespace {
+
+  const char DIGIT_PAIRS[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+  /** Do-it-yourself floating-point value f*2^e. */
+  class DiyFp {
+  public:
+
+    uint64 f = 0;
+    int e = 0;
+
+    inline DiyFp() noexcept
+    {
+    }
+
+    inline DiyFp(uint64 _f, int _e) noexcept
+      : f(_f), e(_e)
+    {
+    }
+
+    /** Returns this - b. Exponents must be equal and this must not be less than b. */
+    inline DiyFp minus(const DiyFp& b) const noexcept
+    {
+      return DiyFp(f - b.f, e);
+    }
+
+    /** Returns the product rounded to 64 bits. */
+    inline DiyFp times(const DiyFp& b) const noexcept
+    {
+      const uint64 M32 = 0xffffffffULL;
+      const uint64 a = f >> 32;
+      const uint64 _b = f & M32;
+      const uint64 c = b.f >> 32;
+      const uint64 d = b.f & M32;
+      const uint64 ac = a * c;
+      const uint64 bc = _b * c;
+      const uint64 ad = a * d;
+      const uint64 bd = _b * d;
+      uint64 temp = (bd >> 32) + (ad & M32) + (bc & M32);
+      temp += 1ULL << 31; // round
+      return DiyFp(ac + (ad >> 32) + (bc >> 32) + (temp >> 32), e + b.e + 64);
+    }
+
+    inline DiyFp normalize() const noexcept
+    {
+      uint64 _f = f;
+      int _e = e;
+      while ((_f & 0xffc0000000000000ULL) == 0) {
+        _f <<= 10;
+        _e -= 10;
+      }
+      while ((_f & 0x8000000000000000ULL) == 0) {
+        _f <<= 1;
+        --_e;
+      }
+      return DiyFp(_f, _e);
+    }
+  };
+
+  /** Normalized powers of 10^k for k = -348, -340, ..., 340. */
+  struct CachedPower {
+    uint64 significand;
+    int16 binaryExponent;
+    int16 decimalExponent;
+  };
+
+  const CachedPower CACHED_POWERS[] = {
+    {0xfa8fd5a0081c0288ULL, -1220, -348},
+    {0xbaaee17fa23ebf76ULL, -1193, -340},
+    {0x8b16fb203055ac76ULL, -1166, -332},
+    {0xcf42894a5dce35eaULL, -1140, -324},
+    {0x9a6bb0aa55653b2dULL, -1113, -316},
+    {0xe61acf033d1a45dfULL, -1087, -308},
+    {0xab70fe17c79ac6caULL, -1060, -300},
+    {0xff77b1fcbebcdc4fULL, -1034, -292},
+    {0xbe5691ef416bd60cULL, -1007, -284},
+    {0x8dd01fad907ffc3cULL, -980, -276},
+    {0xd3515c2831559a83ULL, -954, -268},
+    {0x9d71ac8fada6c9b5ULL, -927, -260},
+    {0xea9c227723ee8bcbULL, -901, -252},
+    {0xaecc49914078536dULL, -874, -244},
+    {0x823c12795db6ce57ULL, -847, -236},
+    {0xc21094364dfb5637ULL, -821, -228},
+    {0x9096ea6f3848984fULL, -794, -220},
+    {0xd77485cb25823ac7ULL, -768, -212},
+    {0xa086cfcd97bf97f4ULL, -741, -204},
+    {0xef340a98172aace5ULL, -715, -196},
+    {0xb23867fb2a35b28eULL, -688, -188},
+    {0x84c8d4dfd2c63f3bULL, -661, -180},
+    {0xc5dd44271ad3cdbaULL, -635, -172},
+    {0x936b9fcebb25c996ULL, -608, -164},
+    {0xdbac6c247d62a584ULL, -582, -156},
+    {0xa3ab66580d5fdaf6ULL, -555, -148},
+    {0xf3e2f893dec3f126ULL, -529, -140},
+    {0xb5b5ada8aaff80b8ULL, -502, -132},
+    {0x87625f056c7c4a8bULL, -475, -124},
+    {0xc9bcff6034c13053ULL, -449, -116},
+    {0x964e858c91ba2655ULL, -422, -108},
+    {0xdff9772470297ebdULL, -396, -100},
+    {0xa6dfbd9fb8e5b88fULL, -369, -92},
+    {0xf8a95fcf88747d94ULL, -343, -84},
+    {0xb94470938fa89bcfULL, -316, -76},
+    {0x8a08f0f8bf0f156bULL, -289, -68},
+    {0xcdb02555653131b6ULL, -263, -60},
+    {0x993fe2c6d07b7facULL, -236, -52},
+    {0xe45c10c42a2b3b06ULL, -210, -44},
+    {0xaa242499697392d3ULL, -183, -36},
+    {0xfd87b5f28300ca0eULL, -157, -28},
+    {0xbce5086492111aebULL, -130, -20},
+    {0x8cbccc096f5088ccULL, -103, -12},
+    {0xd1b71758e219652cULL, -77, -4},
+    {0x9c40000000000000ULL, -50, 4},
+    {0xe8d4a51000000000ULL, -24, 12},
+    {0xad78ebc5ac620000ULL, 3, 20},
+    {0x813f3978f8940984ULL, 30, 28},
+    {0xc097ce7bc90715b3ULL, 56, 36},
+    {0x8f7e32ce7bea5c70ULL, 83, 44},
+    {0xd5d238a4abe98068ULL, 109, 52},
+    {0x9f4f2726179a2245ULL, 136, 60},
+    {0xed63a231d4c4fb27ULL, 162, 68},
+    {0xb0de65388cc8ada8ULL, 189, 76},
+    {0x83c7088e1aab65dbULL, 216, 84},
+    {0xc45d1df942711d9aULL, 242, 92},
+    {0x924d692ca61be758ULL, 269, 100},
+    {0xda01ee641a708deaULL, 295, 108},
+    {0xa26da3999aef774aULL, 322, 116},
+    {0xf209787bb47d6b85ULL, 348, 124},
+    {0xb454e4a179dd1877ULL, 375, 132},
+    {0x865b86925b9bc5c2ULL, 402, 140},
+    {0xc83553c5c8965d3dULL, 428, 148},
+    {0x952ab45cfa97a0b3ULL, 455, 156},
+    {0xde469fbd99a05fe3ULL, 481, 164},
+    {0xa59bc234db398c25ULL, 508, 172},
+    {0xf6c69a72a3989f5cULL, 534, 180},
+    {0xb7dcbf5354e9beceULL, 561, 188},
+    {0x88fcf317f22241e2ULL, 588, 196},
+    {0xcc20ce9bd35c78a5ULL, 614, 204},
+    {0x98165af37b2153dfULL, 641, 212},
+    {0xe2a0b5dc971f303aULL, 667, 220},
+    {0xa8d9d1535ce3b396ULL, 694, 228},
+    {0xfb9b7cd9a4a7443cULL, 720, 236},
+    {0xbb764c4ca7a44410ULL, 747, 244},
+    {0x8bab8eefb6409c1aULL, 774, 252},
+    {0xd01fef10a657842cULL, 800, 260},
+    {0x9b10a4e5e9913129ULL, 827, 268},
+    {0xe7109bfba19c0c9dULL, 853, 276},
+    {0xac2820d9623bf429ULL, 880, 284},
+    {0x80444b5e7aa7cf85ULL, 907, 292},
+    {0xbf21e44003acdd2dULL, 933, 300},
+    {0x8e679c2f5e44ff8fULL, 960, 308},
+    {0xd433179d9c8cb841ULL, 986, 316},
+    {0x9e19db92b4e31ba9ULL, 1013, 324},
+    {0xeb96bf6ebadf77d9ULL, 1039, 332},
+    {0xaf87023b9bf0ee6bULL, 1066, 340}
+  };
+
+  const int CACHED_POWERS_OFFSET = 348; // -1 * the first decimal exponent
+  const int DECIMAL_EXPONENT_DISTANCE = 8;
+  const double D_1_LOG2_10 = 0.30102999566398114; // 1/log2(10)
+
+  const int MINIMAL_TARGET_EXPONENT = -60;
+  const int MAXIMAL_TARGET_EXPONENT = -32;
+
+  /** Returns the cached power c = 10^k with minimumExponent <= c.e <= minimumExponent + 28. */
+  inline DiyFp getCachedPower(int minimumExponent, int& decimalExponent) noexcept
+  {
+    const double dk = (minimumExponent + 63) * D_1_LOG2_10;
+    int k = static_cast<int>(dk);
+    if (k < dk) {
+      ++k; // ceil
+    }
+    const unsigned int index = (CACHED_POWERS_OFFSET + k - 1)/DECIMAL_EXPONENT_DISTANCE + 1;
+    BASSERT(index < getArraySize(CACHED_POWERS));
+    const CachedPower& power = CACHED_POWERS[index];
+    decimalExponent = power.decimalExponent;
+    return DiyFp(power.significand, power.binaryExponent);
+  }
+
+  /** Returns the biggest power of ten less than or equal to the given number. */
+  inline void getBiggestPowerTen(uint32 number, uint32& power, int& exponentPlusOne) noexcept
+  {
+    if (number == 0) {
+      power = 0;
+      exponentPlusOne = 0;
+      return;
+    }
+    uint64 p = 1;
+    int e = 1;
+    while ((p * 10) <= number) {
+      p *= 10;
+      ++e;
+    }
+    power = static_cast<uint32>(p);
+    exponentPlusOne = e;
+  }
+
+  /**
+    Moves the last digit closer to w if possible and returns true if the result
+    is guaranteed to be the shortest and closest.
+  */
+  bool roundWeed(
+    uint8* buffer,
+    unsigned int length,
+    uint64 distanceTooHighW,
+    uint64 unsafeInterval,
+    uint64 rest,
+    uint64 tenKappa,
+    uint64 unit) noexcept
+  {
+    const uint64 smallDistance = distanceTooHighW - unit;
+    const uint64 bigDistance = distanceTooHighW + unit;
+    while ((rest < smallDistance) && ((unsafeInterval - rest) >= tenKappa) &&
+           (((rest + tenKappa) < smallDistance) || ((smallDistance - rest) >= (rest + tenKappa - smallDistance)))) {
+      --buffer[length - 1];
+      rest += tenKappa;
+    }
+    if ((rest < bigDistance) && ((unsafeInterval - rest) >= tenKappa) &&
+        (((rest + tenKappa) < bigDistance) || ((bigDistance - rest) > (rest + tenKappa - bigDistance)))) {
+      return false;
+    }
+    return ((2 * unit) <= rest) && (rest <= (unsafeInterval - 4 * unit));
+  }
+
+  /** Generates the shortest digits for w within the boundaries low and high. */
+  bool generateDigits(
+    const DiyFp& low,
+    const DiyFp& w,
+    const DiyFp& high,
+    uint8* buffer,
+    unsigned int& length,
+    int& kappa) noexcept
+  {
+    uint64 unit = 1;
+    const DiyFp tooLow(low.f - unit, low.e);
+    const DiyFp tooHigh(high.f + unit, high.e);
+    uint64 unsafeInterval = tooHigh.minus(tooLow).f;
+    const DiyFp one(1ULL << -w.e, w.e);
+    uint32 integrals = static_cast<uint32>(tooHigh.f >> -one.e);
+    uint64 fractionals = tooHigh.f & (one.f - 1);
+    uint32 divisor = 0;
+    int divisorExponentPlusOne = 0;
+    getBiggestPowerTen(integrals, divisor, divisorExponentPlusOne);
+    kappa = divisorExponentPlusOne;
+    length = 0;
+
+    while (kappa > 0) {
+      buffer[length++] = static_cast<uint8>(integrals/divisor);
+      integrals %= divisor;
+      --kappa;
+      const uint64 rest = (static_cast<uint64>(integrals) << -one.e) + fractionals;
+      if (rest < unsafeInterval) {
+        return roundWeed(
+          buffer, length, tooHigh.minus(w).f, unsafeInterval, rest, static_cast<uint64>(divisor) << -one.e, unit
+        );
+      }
+      divisor /= 10;
+    }
+
+    while (true) {
+      fractionals *= 10;
+      unit *= 10;
+      unsafeInterval *= 10;
+      buffer[length++] = static_cast<uint8>(fractionals >> -one.e);
+      fractionals &= one.f - 1;
+      --kappa;
+      if (fractionals < unsafeInterval) {
+        return roundWeed(buffer, length, tooHigh.minus(w).f * unit, unsafeInterval, fractionals, one.f, unit);
+      }
+      if (length >= NumberFormat::MAXIMUM_DIGITS) {
+        return false;
+      }
+    }
+  }
+
+  /** Grisu3 for v = f*2^e with the given boundary mode. */
+  bool grisu3(
+    uint64 f,
+    int e,
+    bool lowerBoundaryIsCloser,
+    uint8* digits,
+    unsigned int& numberOfDigits,
+    int& exponent) noexcept
+  {
+    const DiyFp w = DiyFp(f, e).normalize();
+    const DiyFp plus = DiyFp((f << 1) + 1, e - 1).normalize();
+    DiyFp minus = lowerBoundaryIsCloser ? DiyFp((f << 2) - 1, e - 2) : DiyFp((f << 1) - 1, e - 1);
+    minus.f <<= minus.e - plus.e;
+    minus.e = plus.e;
+
+    int mk = 0;
+    const DiyFp tenMk = getCachedPower(MINIMAL_TARGET_EXPONENT - (w.e + 64), mk);
+    BASSERT(
+      (MINIMAL_TARGET_EXPONENT <= (w.e + tenMk.e + 64)) && (MAXIMAL_TARGET_EXPONENT >= (w.e + tenMk.e + 64))
+    );
+
+    const DiyFp scaledW = w.times(tenMk);
+    const DiyFp scaledMinus = minus.times(tenMk);
+    const DiyFp scaledPlus = plus.times(tenMk);
+    int kappa = 0;
+    if (!generateDigits(scaledMinus, scaledW, scaledPlus, digits, numberOfDigits, kappa)) {
+      return false;
+    }
+    exponent = -mk + kappa + static_cast<int>(numberOfDigits); // value is 0.d1d2...dn * 10^exponent
+    return true;
+  }
+}
+
+char* NumberFormat::formatUnsigned(char* dest, uint64 value) noexcept
+{
+  char buffer[20];
+  char* end = buffer + sizeof(buffer);
+  char* src = end;
+  while (value >= 100) {
+    const unsigned int i = static_cast<unsigned int>(value % 100) * 2;
+    value /= 100;
+    *--src = DIGIT_PAIRS[i + 1];
+    *--src = DIGIT_PAIRS[i];
+  }
+  if (value >= 10) {
+    const unsigned int i = static_cast<unsigned int>(value) * 2;
+    *--src = DIGIT_PAIRS[i + 1];
+    *--src = DIGIT_PAIRS[i];
+  } else {
+    *--src = static_cast<char>('0' + value);
+  }
+  while (src != end) {
+    *dest++ = *src++;
+  }
+  return dest;
+}
+
+char* NumberFormat::formatSigned(char* dest, int64 value) noexcept
+{
+  if (value < 0) {
+    *dest++ = '-';
+    return formatUnsigned(dest, 0 - static_cast<uint64>(value));
+  }
+  return formatUnsigned(dest, static_cast<uint64>(value));
+}
+
+bool NumberFormat::getShortestDigits(double value, uint8* digits, unsigned int& numberOfDigits, int& exponent) noexcept
+{
+  BASSERT(sizeof(double) == sizeof(uint64));
+  const uint64 bits = Cast::impersonate<uint64>(value);
+  const uint64 fraction = bits & 0x000fffffffffffffULL;
+  const int biasedExponent = static_cast<int>((bits >> 52) & 0x7ff);
+  if (biasedExponent == 0x7ff) {
+    return false; // infinity or nan
+  }
+  if ((biasedExponent == 0) && (fraction == 0)) {
+    return false; // zero
+  }
+  const uint64 f = (biasedExponent != 0) ? (fraction | 0x0010000000000000ULL) : fraction;
+  const int e = ((biasedExponent != 0) ? biasedExponent : 1) - 1075;
+  return grisu3(f, e, (fraction == 0) && (biasedExponent > 1), digits, numberOfDigits, exponent);
+}
+
+bool NumberFormat::getShortestDigits(float value, uint8* digits, unsigned int& numberOfDigits, int& exponent) noexcept
+{
+  BASSERT(sizeof(float) == sizeof(uint32));
+  const uint32 bits = Cast::impersonate<uint32>(value);
+  const uint32 fraction = bits & 0x007fffff;
+  const int biasedExponent = static_cast<int>((bits >> 23) & 0xff);
+  if (biasedExponent == 0xff) {
+    return false; // infinity or nan
+  }
+  if ((biasedExponent == 0) && (fraction == 0)) {
+    return false; // zero
+  }
+  const uint64 f = (biasedExponent != 0) ? (fraction | 0x00800000) : fraction;
+  const int e = ((biasedExponent != 0) ? biasedExponent : 1) - 150;
+  return grisu3(f, e, (fraction == 0) && (biasedExponent > 1), digits, numberOfDigits, exponent);
+}
+
+#if defined(_COM_AZURE_DEV__BASE__TESTS)
+
+class TEST_CLASS(NumberFormat) : public UnitTest {
+public:
+
+  TEST_PRIORITY(30);
+  TEST_PROJECT("base/string");
+
+  static String getInteger(int64 value)
+  {
+    char buffer[NumberFormat::MAXIMUM_INTEGER_LENGTH];
+    const char* end = NumberFormat::formatSigned(buffer, value);
+    return String(buffer, end - buffer);
+  }
+
+  template<typename TYPE>
+  void testFloat(TYPE value)
+  {
+    // width forces the exact conversion
+    const String fast = format() << value;
+    const String exact = format() << FIXED << setWidth(1) << value;
+    TEST_EQUAL(fast, exact);
+  }
+
+  void run() override
+  {
+    TEST_EQUAL(getInteger(0), "0");
+    TEST_EQUAL(getInteger(7), "7");
+    TEST_EQUAL(getInteger(-10), "-10");
+    TEST_EQUAL(getInteger(1234567890123LL), "1234567890123");
+    TEST_EQUAL(getInteger(PrimitiveTraits<int64>::MINIMUM), "-9223372036854775808");
+    TEST_EQUAL(getInteger(PrimitiveTraits<int64>::MAXIMUM), "9223372036854775807");
+    char buffer[NumberFormat::MAXIMUM_INTEGER_LENGTH];
+    TEST_EQUAL(String(buffer, NumberFormat::formatUnsigned(buffer, PrimitiveTraits<uint64>::MAXIMUM) - buffer), "18446744073709551615");
+
+    uint8 digits[NumberFormat::MAXIMUM_DIGITS];
+    unsigned int numberOfDigits = 0;
+    int exponent = 0;
+    TEST_ASSERT(NumberFormat::getShortestDigits(0.1, digits, numberOfDigits, exponent));
+    TEST_ASSERT((numberOfDigits == 1) && (digits[0] == 1) && (exponent == 0));
+    TEST_ASSERT(NumberFormat::getShortestDigits(123.0, digits, numberOfDigits, exponent));
+    TEST_ASSERT((numberOfDigits == 3) && (digits[0] == 1) && (digits[2] == 3) && (exponent == 3));
+
+    testFloat(0.0);
+    testFloat(-0.0);
+    testFloat(1.0);
+    testFloat(0.1);
+    testFloat(0.001);
+    testFloat(0.0001);
+    testFloat(123456789.0);
+    testFloat(1234567890.0);
+    testFloat(1e300);
+    testFloat(5e-324);
+    testFloat(1.7976931348623157e308);
+    testFloat(0.1f);
+    testFloat(3.4028235e38f);
+    testFloat(1e-45f);
+    uint64 seed = 0x2545f4914f6cdd1dULL; // fixed seed to make failures reproducible
+    for (unsigned int i = 0; i < 2000; ++i) {
+      seed = seed * 6364136223846793005ULL + 1442695040888963407ULL; // LCG
+      const uint64 bits = seed ^ (seed >> 32); // mix high bits into the float bits
+      const double d = Cast::impersonate<double>(bits);
+      if (Math::isFinite(d)) {
+        testFloat(d);
+      }
+      const float f = Cast::impersonate<float>(static_cast<uint32>(bits));
+      if (Math::isFinite(f)) {
+        testFloat(f);
+      }
+    }
+    testFloat(Cast::impersonate<float>(static_cast<uint32>(0xdbc22b77))); // requires 9 digits
+    testFloat(Cast::impersonate<float>(static_cast<uint32>(0x1e53d202)));
+    testFloat(Cast::impersonate<float>(static_cast<uint32>(0x4cc3c1b8))); // carry
+    testFloat(Cast::impersonate<double>(static_cast<uint64>(0x49ee484292c532afULL)));
+    TEST_EQUAL(String(format() << ENSUREFLOAT << 12.0), "12.");
+    TEST_EQUAL(String(format() << 1.5e20), "1.5e20");
+    TEST_EQUAL(String(format() << 1.5e-20), "1.5e-20");
+  }
+};
+
+TEST_REGISTER(NumberFormat);
+
+class TEST_CLASS(NumberFormatBenchmark) : public UnitTest {
+public:
+
+  TEST_PRIORITY(1000);
+  TEST_PROJECT("base/string");
+  TEST_IMPACT(LOW);
+
+  void run() override
+  {
+    const unsigned int COUNT = 100000;
+    Array<double> values;
+    values.setSize(COUNT);
+    for (unsigned int i = 0; i < COUNT; ++i) {
+      values[i] = (Random::random<uint32>() % 1000000)/1000.0;
+    }
+
+    StringOutputStream fast;
+    Timer timer;
+    for (unsigned int i = 0; i < COUNT; ++i) {
+      fast << values[i] << ',' << i << ',';
+    }
+    const uint64 fastTime = timer.getLiveMicroseconds();
+
+    StringOutputStream exact;
+    timer.start();
+    for (unsigned int i = 0; i < COUNT; ++i) {
+      exact << setWidth(1) << values[i] << ',' << setWidth(1) << i << ',';
+    }
+    const uint64 exactTime = timer.getLiveMicroseconds();
+
+    TEST_EQUAL(fast.getString(), exact.getString());
+    TEST_PRINT(format() << "Fast: " << fastTime << " us, exact: " << exactTime << " us");
+  }
+};
+
+TEST_REGISTER(NumberFormatBenchmark);
+
+#endif
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
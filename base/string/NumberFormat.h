@@ -0,0 +1,69 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#pragma once
+
+#include <base/Primitives.h>
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+/**
+  Fast conversion of numbers to decimal digits. Integers are converted 2 digits
+  at a time using a lookup table. Floating-point values are converted to the
+  shortest digit sequence which round-trips using the Grisu3 algorithm (see
+  "Printing Floating-Point Numbers Quickly and Accurately with Integers" by
+  Florian Loitsch). Grisu3 rejects about 0.5% of all values in which case the
+  caller must fall back to an exact (bignum) conversion.
+
+  @short Fast number formatting.
+  @version 1.0
+*/
+
+class _COM_AZURE_DEV__BASE__API NumberFormat {
+public:
+
+  /** The maximum number of characters written by formatUnsigned()/formatSigned(). */
+  static constexpr unsigned int MAXIMUM_INTEGER_LENGTH = 20 + 1;
+  /** The maximum number of digits for a shortest float/double. */
+  static constexpr unsigned int MAXIMUM_DIGITS = 17 + 1;
+
+  /**
+    Writes the decimal digits of the value to dest and returns the end of the
+    written digits. Not null-terminated.
+  */
+  static char* formatUnsigned(char* dest, uint64 value) noexcept;
+
+  /**
+    Writes the value with a leading '-' for negative values. Returns the end of
+    the written characters. Not null-terminated.
+  */
+  static char* formatSigned(char* dest, int64 value) noexcept;
+
+  /**
+    Returns the shortest decimal digit sequence (as values 0-9) which uniquely
+    identifies the given positive, finite, non-zero value. On return the value
+    is 0.d1d2...dn * 10^exponent. Returns false if the fast algorithm cannot
+    guarantee the shortest result.
+
+    @param value The value. Sign is ignored.
+    @param digits The digit buffer of at least MAXIMUM_DIGITS elements.
+    @param numberOfDigits The number of digits on return.
+    @param exponent The decimal exponent on return.
+  */
+  static bool getShortestDigits(double value, uint8* digits, unsigned int& numberOfDigits, int& exponent) noexcept;
+
+  /** Returns the shortest decimal digit sequence for float. See double overload. */
+  static bool getShortestDigits(float value, uint8* digits, unsigned int& numberOfDigits, int& exponent) noexcept;
+};
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
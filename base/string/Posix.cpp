@@ -139,7 +139,7 @@ namespace {
     int exponent = 0;
     bool gotExponent = false;
 
-    constexpr unsigned int MAXIMUM_DIGITS = 19;
+    constexpr unsigned int MAXIMUM_DIGITS = 18; // 19 digits may overflow int64
     constexpr unsigned int MAXIMUM_EXPONENT_DIGITS = 9;
     int64 temp = 0;
     unsigned int i = 0;
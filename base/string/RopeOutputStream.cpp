@@ -0,0 +1,299 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#include <base/string/RopeOutputStream.h>
+#include <base/string/StringOutputStream.h>
+#include <base/concurrency/SpinLock.h>
+#include <base/io/MemoryOutputStream.h>
+#include <base/mem/Heap.h>
+#include <base/Timer.h>
+#include <base/UnitTest.h>
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+namespace {
+
+  /** Pool of free segments shared by all rope streams. */
+  class SegmentPool {
+  private:
+
+    SpinLock lock;
+    uint8* segments[RopeOutputStreamWrapper::MAXIMUM_POOLED_SEGMENTS];
+    MemorySize size = 0;
+  public:
+
+    uint8* pop() noexcept
+    {
+      SpinLock::Sync _guard(lock);
+      if (size > 0) {
+        return segments[--size];
+      }
+      return nullptr;
+    }
+
+    bool push(uint8* segment) noexcept
+    {
+      SpinLock::Sync _guard(lock);
+      if (size < getArraySize(segments)) {
+        segments[size++] = segment;
+        return true;
+      }
+      return false;
+    }
+  };
+
+  SegmentPool segmentPool;
+}
+
+uint8* RopeOutputStreamWrapper::acquireSegment()
+{
+  if (uint8* segment = segmentPool.pop()) {
+    return segment;
+  }
+  return Heap::allocate<uint8>(SEGMENT_SIZE);
+}
+
+void RopeOutputStreamWrapper::releaseSegment(uint8* segment) noexcept
+{
+  if (!segmentPool.push(segment)) {
+    Heap::release<uint8>(segment);
+  }
+}
+
+RopeOutputStreamWrapper::RopeOutputStreamWrapper() noexcept
+{
+}
+
+MemorySpan RopeOutputStreamWrapper::getSegment(MemorySize index) const
+{
+  if (index >= segments.getSize()) {
+    _throw OutOfRange(this);
+  }
+  const uint8* segment = segments[index];
+  return MemorySpan(segment, ((index + 1) == segments.getSize()) ? used : SEGMENT_SIZE);
+}
+
+void RopeOutputStreamWrapper::close()
+{
+  bassert(!closed, IOException("Output stream is closed.", this));
+  closed = true;
+}
+
+void RopeOutputStreamWrapper::flush()
+{
+  bassert(!closed, IOException("Output stream is closed.", this));
+}
+
+void RopeOutputStreamWrapper::restart()
+{
+  flush(); // we must empty buffered data
+  closed = false;
+  for (MemorySize i = 0; i < segments.getSize(); ++i) {
+    releaseSegment(segments[i]);
+  }
+  segments.removeAll();
+  used = 0;
+  size = 0;
+}
+
+unsigned int RopeOutputStreamWrapper::write(
+  const uint8* buffer,
+  unsigned int bytesToWrite,
+  bool nonblocking)
+{
+  bassert(!closed, IOException("Output stream is closed.", this));
+  const unsigned int result = bytesToWrite;
+  while (bytesToWrite > 0) {
+    if (segments.isEmpty() || (used == SEGMENT_SIZE)) {
+      segments.append(acquireSegment());
+      used = 0;
+    }
+    const MemorySize bytesToCopy = minimum<MemorySize>(SEGMENT_SIZE - used, bytesToWrite);
+    copy(segments.getLast() + used, buffer, bytesToCopy);
+    used += bytesToCopy;
+    buffer += bytesToCopy;
+    bytesToWrite -= static_cast<unsigned int>(bytesToCopy);
+    size += bytesToCopy;
+  }
+  return result;
+}
+
+void RopeOutputStreamWrapper::copyTo(uint8* dest) const noexcept
+{
+  const MemorySize count = segments.getSize();
+  for (MemorySize i = 0; i < count; ++i) {
+    const MemorySize bytes = ((i + 1) == count) ? used : SEGMENT_SIZE;
+    copy(dest, segments[i], bytes);
+    dest += bytes;
+  }
+}
+
+void RopeOutputStreamWrapper::writeTo(OutputStream& stream) const
+{
+  const MemorySize count = segments.getSize();
+  for (MemorySize i = 0; i < count; ++i) {
+    const MemorySize bytes = ((i + 1) == count) ? used : SEGMENT_SIZE;
+    stream.write(segments[i], static_cast<unsigned int>(bytes), false);
+  }
+}
+
+RopeOutputStreamWrapper::~RopeOutputStreamWrapper()
+{
+  for (MemorySize i = 0; i < segments.getSize(); ++i) {
+    releaseSegment(segments[i]);
+  }
+}
+
+
+
+RopeOutputStream::RopeOutputStream()
+  : FormatOutputStream(stream)
+{
+}
+
+void RopeOutputStream::flush()
+{
+  FormatOutputStream::flush(); // must be first
+  stream.flush();
+}
+
+MemorySize RopeOutputStream::getSize()
+{
+  flush();
+  return stream.getSize();
+}
+
+MemorySize RopeOutputStream::getNumberOfSegments()
+{
+  flush();
+  return stream.getNumberOfSegments();
+}
+
+MemorySpan RopeOutputStream::getSegment(MemorySize index)
+{
+  flush();
+  return stream.getSegment(index);
+}
+
+void RopeOutputStream::writeTo(OutputStream& out)
+{
+  flush();
+  stream.writeTo(out);
+}
+
+String RopeOutputStream::getString()
+{
+  flush();
+  String result = String::makeLength(stream.getSize()); // single allocation
+  stream.copyTo(reinterpret_cast<uint8*>(result.getElements()));
+  return result;
+}
+
+String RopeOutputStream::toString()
+{
+  String result = getString();
+  stream.restart();
+  return result;
+}
+
+void RopeOutputStream::restart()
+{
+  flush();
+  stream.restart();
+}
+
+RopeOutputStream::~RopeOutputStream()
+{
+}
+
+#if defined(_COM_AZURE_DEV__BASE__TESTS)
+
+class TEST_CLASS(RopeOutputStream) : public UnitTest {
+public:
+
+  TEST_PRIORITY(40);
+  TEST_PROJECT("base/string");
+
+  void run() override
+  {
+    RopeOutputStream ros;
+    ros << "Hello, World!";
+    TEST_EQUAL(ros.getString(), "Hello, World!");
+    TEST_EQUAL(ros.toString(), "Hello, World!");
+    TEST_EQUAL(ros.getSize(), 0);
+    TEST_ASSERT(!ros.getString());
+
+    StringOutputStream sos;
+    for (unsigned int i = 0; i < 50000; ++i) {
+      ros << i << ' ' << 123.5 << " line" << EOL;
+      sos << i << ' ' << 123.5 << " line" << EOL;
+    }
+    const String expected = sos.toString();
+    TEST_EQUAL(ros.getSize(), expected.getLength());
+    TEST_ASSERT(ros.getNumberOfSegments() > 1);
+    TEST_EQUAL(ros.getString(), expected);
+
+    MemoryOutputStream mos;
+    ros.writeTo(mos);
+    Allocator<uint8> buffer;
+    mos.swap(buffer);
+    TEST_EQUAL(buffer.getSize(), expected.getLength());
+    TEST_ASSERT(compare(buffer.getElements(), reinterpret_cast<const uint8*>(expected.native()), buffer.getSize()) == 0);
+
+    ros.restart();
+    TEST_EQUAL(ros.getNumberOfSegments(), 0);
+    ros << "abc";
+    TEST_EQUAL(ros.getSegment(0).getSize(), 3); // buffered data is flushed
+  }
+};
+
+TEST_REGISTER(RopeOutputStream);
+
+class TEST_CLASS(RopeOutputStreamBenchmark) : public UnitTest {
+public:
+
+  TEST_PRIORITY(1000);
+  TEST_PROJECT("base/string");
+  TEST_IMPACT(LOW);
+
+  void run() override
+  {
+    const unsigned int COUNT = 200000;
+    const Literal LINE = MESSAGE("{\"name\": \"value\", \"text\": \"0123456789abcdef\"},\n");
+
+    Timer timer;
+    StringOutputStream sos;
+    for (unsigned int i = 0; i < COUNT; ++i) {
+      sos << LINE;
+    }
+    const String s1 = sos.toString();
+    const uint64 stringTime = timer.getLiveMicroseconds();
+
+    timer.start();
+    RopeOutputStream ros;
+    for (unsigned int i = 0; i < COUNT; ++i) {
+      ros << LINE;
+    }
+    const String s2 = ros.toString();
+    const uint64 ropeTime = timer.getLiveMicroseconds();
+
+    TEST_EQUAL(s1.getLength(), s2.getLength());
+    TEST_PRINT(format() << "StringOutputStream: " << stringTime << " us, RopeOutputStream: " << ropeTime << " us");
+  }
+};
+
+TEST_REGISTER(RopeOutputStreamBenchmark);
+
+#endif
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
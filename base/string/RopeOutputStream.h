@@ -0,0 +1,182 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#pragma once
+
+#include <base/io/OutputStream.h>
+#include <base/string/FormatOutputStream.h>
+#include <base/collection/Array.h>
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+/**
+  Internal rope output stream. Data is appended into fixed-size segments which
+  are never moved once written. Released segments are returned to a shared pool
+  for reuse by other rope streams.
+*/
+class _COM_AZURE_DEV__BASE__API RopeOutputStreamWrapper : public virtual Object,
+                                                          public virtual OutputStream {
+public:
+
+  /** The size of each segment. */
+  static constexpr MemorySize SEGMENT_SIZE = 64 * 1024;
+  /** The maximum number of free segments kept in the shared pool. */
+  static constexpr MemorySize MAXIMUM_POOLED_SEGMENTS = 64;
+private:
+
+  /** The segments. All but the last segment are full. */
+  Array<uint8*> segments;
+  /** The number of bytes used in the last segment. */
+  MemorySize used = 0;
+  /** The total number of bytes. */
+  MemorySize size = 0;
+  /** Specifies whether the stream has been closed. */
+  bool closed = false;
+
+  /** Returns a segment from the pool or allocates a new segment. */
+  static uint8* acquireSegment();
+
+  /** Returns the given segment to the pool. */
+  static void releaseSegment(uint8* segment) noexcept;
+public:
+
+  /** Initializes rope. */
+  RopeOutputStreamWrapper() noexcept;
+
+  RopeOutputStreamWrapper(const RopeOutputStreamWrapper& copy) = delete;
+  RopeOutputStreamWrapper& operator=(const RopeOutputStreamWrapper& assign) = delete;
+
+  /** Returns the total number of bytes. */
+  inline MemorySize getSize() const noexcept
+  {
+    return size;
+  }
+
+  /** Returns the number of segments. */
+  inline MemorySize getNumberOfSegments() const noexcept
+  {
+    return segments.getSize();
+  }
+
+  /** Returns the given segment. Suitable for vectored I/O. */
+  MemorySpan getSegment(MemorySize index) const;
+
+  /** Close stream. */
+  void close();
+
+  /** Flush stream. */
+  void flush();
+
+  /** Restarts stream and releases all segments. */
+  void restart();
+
+  /** Writes to rope. */
+  unsigned int write(
+    const uint8* buffer,
+    unsigned int bytesToWrite,
+    bool nonblocking = false);
+
+  /** Copies all segments into the given buffer which must hold getSize() bytes. */
+  void copyTo(uint8* dest) const noexcept;
+
+  /** Writes all segments to the given stream. */
+  void writeTo(OutputStream& stream) const;
+
+  /** Releases segments. */
+  ~RopeOutputStreamWrapper();
+};
+
+
+
+/** Helper class used by RopeOutputStream. */
+class _COM_AZURE_DEV__BASE__API RopeOutputStreamImpl {
+protected:
+
+  RopeOutputStreamWrapper stream;
+};
+
+
+
+/**
+  A rope output stream is a format output stream that directs the stream data
+  into a list of fixed-size segments. Unlike StringOutputStream no data is
+  copied when the content grows. Use this for generating large documents which
+  are written out using writeTo() or converted once using toString().
+
+  @code
+  RopeOutputStream rope;
+  for (const auto& row : rows) {
+    rope << row << EOL;
+  }
+  rope.writeTo(file);
+  @endcode
+
+  @short Rope output stream.
+  @version 1.0
+*/
+
+class _COM_AZURE_DEV__BASE__API RopeOutputStream : protected RopeOutputStreamImpl, public FormatOutputStream {
+public:
+
+  /**
+    Initializes rope output stream.
+  */
+  RopeOutputStream();
+
+  /**
+    Flushes stream.
+  */
+  void flush();
+
+  /**
+    Returns the total number of bytes in the stream. Forces flush.
+  */
+  MemorySize getSize();
+
+  /**
+    Returns the number of segments. Forces flush.
+  */
+  MemorySize getNumberOfSegments();
+
+  /**
+    Returns the given segment. Forces flush. Segments are only valid until the stream is restarted.
+  */
+  MemorySpan getSegment(MemorySize index);
+
+  /**
+    Writes the content to the given stream segment by segment. Does NOT restart stream.
+  */
+  void writeTo(OutputStream& stream);
+
+  /**
+    Returns the content as a string. Same as toString() but does NOT restart stream.
+  */
+  String getString();
+
+  /**
+    Returns the content as a string and restarts the stream.
+  */
+  String toString() override;
+
+  /**
+    Restarts the stream.
+  */
+  void restart();
+
+  /**
+    Destroy stream object.
+  */
+  ~RopeOutputStream();
+};
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
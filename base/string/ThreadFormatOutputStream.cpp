@@ -0,0 +1,161 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#include <base/string/ThreadFormatOutputStream.h>
+#include <base/string/StringOutputStream.h>
+#include <base/concurrency/ThreadLocalContext.h>
+#include <base/concurrency/Thread.h>
+#include <base/concurrency/Runnable.h>
+#include <base/UnitTest.h>
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+ThreadFormatOutputStream::ThreadFormatOutputStream(FormatOutputStream& _destination, bool _flush)
+  : destination(_destination), flush(_flush)
+{
+  auto tlc = Thread::getLocalContext();
+  if (tlc && (tlc->lineOutputStreamUsage == 0)) {
+    tlc->lineOutputStreamUsage++;
+    sos = &tlc->lineOutputStream;
+    sos->restart();
+    sos->FormatOutputStream::reset();
+  } else {
+    sos = new StringOutputStream(); // nested use
+    owner = true;
+  }
+}
+
+FormatOutputStream& ThreadFormatOutputStream::getStream() noexcept
+{
+  return *sos;
+}
+
+MemorySize ThreadFormatOutputStream::getSize() const
+{
+  return sos->getString().getLength();
+}
+
+void ThreadFormatOutputStream::commit()
+{
+  const String& text = sos->getString();
+  if (text) {
+    destination.writeAtomic(text.native(), text.getLength(), flush);
+  }
+  sos->restart();
+}
+
+ThreadFormatOutputStream::~ThreadFormatOutputStream()
+{
+  try {
+    commit();
+  } catch (...) {
+    // we cannot report error from destructor
+  }
+  if (owner) {
+    delete sos;
+  } else if (auto tlc = Thread::getLocalContext()) {
+    BASSERT(tlc->lineOutputStreamUsage > 0);
+    tlc->lineOutputStreamUsage--;
+  }
+}
+
+#if defined(_COM_AZURE_DEV__BASE__TESTS)
+
+class TEST_CLASS(ThreadFormatOutputStream) : public UnitTest {
+public:
+
+  TEST_PRIORITY(50);
+  TEST_PROJECT("base/string");
+  TEST_TIMEOUT_MS(30 * 1000);
+
+  static constexpr unsigned int THREADS = 4;
+  static constexpr unsigned int LINES = 2000;
+
+  class Writer : public Runnable {
+  public:
+
+    FormatOutputStream& destination;
+    unsigned int id = 0;
+
+    Writer(FormatOutputStream& _destination, unsigned int _id)
+      : destination(_destination), id(_id)
+    {
+    }
+
+    void run() override
+    {
+      for (unsigned int i = 0; i < LINES; ++i) {
+        ThreadFormatOutputStream stream(destination, false);
+        stream << "thread=" << id << " line=" << setWidth(5) << ZEROPAD << i << " end" << EOL;
+      }
+    }
+  };
+
+  void run() override
+  {
+    StringOutputStream destination;
+    {
+      ThreadFormatOutputStream outer(destination, false);
+      outer << "outer";
+      {
+        ThreadFormatOutputStream inner(destination, false); // nested uses private buffer
+        inner << "inner" << EOL;
+      }
+      TEST_EQUAL(outer.getSize(), 5);
+      outer << EOL;
+    }
+    TEST_EQUAL(destination.toString(), "inner\nouter\n");
+
+    Writer* writers[THREADS];
+    Thread* threads[THREADS];
+    for (unsigned int i = 0; i < THREADS; ++i) {
+      writers[i] = new Writer(destination, i);
+      threads[i] = new Thread(writers[i]);
+    }
+    for (unsigned int i = 0; i < THREADS; ++i) {
+      threads[i]->start();
+    }
+    for (unsigned int i = 0; i < THREADS; ++i) {
+      threads[i]->join();
+      delete threads[i];
+      delete writers[i];
+    }
+
+    // all lines must be intact
+    const String text = destination.toString();
+    const MemorySize LINE_LENGTH = 24;
+    TEST_EQUAL(text.getLength(), THREADS * LINES * LINE_LENGTH);
+    unsigned int next[THREADS] = {0};
+    bool intact = true;
+    for (MemorySize offset = 0; (offset + LINE_LENGTH) <= text.getLength(); offset += LINE_LENGTH) {
+      const String line = text.substring(offset, offset + LINE_LENGTH);
+      const unsigned int id = line[7] - '0';
+      if (id >= THREADS) {
+        intact = false;
+        break;
+      }
+      const String expected = format() << "thread=" << id << " line=" << setWidth(5) << ZEROPAD << next[id]++ << " end\n";
+      if (line != expected) {
+        intact = false;
+        break;
+      }
+    }
+    TEST_ASSERT(intact);
+  }
+};
+
+TEST_REGISTER(ThreadFormatOutputStream);
+
+#endif
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
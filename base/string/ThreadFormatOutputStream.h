@@ -0,0 +1,87 @@
+/***************************************************************************
+    The Base Framework
+    A framework for developing platform independent applications
+
+    See COPYRIGHT.txt for details.
+
+    This framework is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    For the licensing terms refer to the file 'LICENSE'.
+ ***************************************************************************/
+
+#pragma once
+
+#include <base/string/FormatOutputStream.h>
+
+_COM_AZURE_DEV__BASE__ENTER_NAMESPACE
+
+class StringOutputStream;
+
+/**
+  Formats into a buffer owned by the current thread and hands the complete text
+  to the destination stream in one atomic append. Formatting never touches the
+  guard of the destination stream so many threads can log concurrently without
+  contention and without interleaving partial lines.
+
+  @code
+  {
+    ThreadFormatOutputStream stream(fout);
+    stream << "Thread " << id << " processed " << count << " items" << EOL;
+  } // line is written here
+  @endcode
+
+  The thread local buffer is reused for all lines written by the thread. A
+  private buffer is used when the thread local buffer is already in use (e.g.
+  nested use).
+
+  @short Thread local format output stream.
+  @version 1.0
+*/
+
+class _COM_AZURE_DEV__BASE__API ThreadFormatOutputStream {
+private:
+
+  /** The destination stream. */
+  FormatOutputStream& destination;
+  /** The local stream. */
+  StringOutputStream* sos = nullptr;
+  /** Specifies whether the local stream is owned by this object. */
+  bool owner = false;
+  /** Flush destination on commit. */
+  bool flush = true;
+public:
+
+  /**
+    Initializes the thread local format output stream.
+
+    @param destination The destination stream.
+    @param flush Flush the destination stream after each commit. Default is true.
+  */
+  ThreadFormatOutputStream(FormatOutputStream& destination, bool flush = true);
+
+  ThreadFormatOutputStream(const ThreadFormatOutputStream& copy) = delete;
+  ThreadFormatOutputStream& operator=(const ThreadFormatOutputStream& assign) = delete;
+
+  /** Returns the local stream. */
+  FormatOutputStream& getStream() noexcept;
+
+  /** Write to local stream. */
+  template<class TYPE>
+  inline FormatOutputStream& operator<<(const TYPE& v)
+  {
+    return getStream() << v;
+  }
+
+  /** Returns the number of pending bytes. */
+  MemorySize getSize() const;
+
+  /** Appends the pending text to the destination stream and restarts the local stream. */
+  void commit();
+
+  /** Commits pending text and releases the local stream. */
+  ~ThreadFormatOutputStream();
+};
+
+_COM_AZURE_DEV__BASE__LEAVE_NAMESPACE
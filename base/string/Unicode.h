@@ -207,13 +207,13 @@ public:
       return 2;
     }
     if (ch <= 0xffff) { // 16 bit
-      *dest++ = static_cast<uint8>(((ch >> 12) & ((1 << 4) - 1)) | 0xc0);
+      *dest++ = static_cast<uint8>(((ch >> 12) & ((1 << 4) - 1)) | 0xe0);
       *dest++ = static_cast<uint8>(((ch >> 6) & ((1 << 6) - 1)) | 0x80);
       *dest++ = static_cast<uint8>(((ch >> 0) & ((1 << 6) - 1)) | 0x80);
       return 3;
     }
     if (ch <= 0x10ffff) { // 21 bit
-      *dest++ = static_cast<uint8>(((ch >> 18) & ((1 << 3) - 1)) | 0xc0);
+      *dest++ = static_cast<uint8>(((ch >> 18) & ((1 << 3) - 1)) | 0xf0);
       *dest++ = static_cast<uint8>(((ch >> 12) & ((1 << 6) - 1)) | 0x80);
       *dest++ = static_cast<uint8>(((ch >> 6) & ((1 << 6) - 1)) | 0x80);
       *dest++ = static_cast<uint8>(((ch >> 0) & ((1 << 6) - 1)) | 0x80);